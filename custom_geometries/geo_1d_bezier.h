@@ -60,6 +60,7 @@
 #include "integration/quadrature.h"
 #include "integration/line_gauss_legendre_integration_points.h"
 #include "custom_utilities/bezier_utils.h"
+#include "custom_utilities/compressed_extraction_operator.h"
 
 
 namespace Kratos
@@ -217,11 +218,11 @@ public:
      * Life Cycle
      */
 
-    Geo1dBezier() : BaseType( PointsArrayType() )
+    Geo1dBezier() : BaseType( PointsArrayType() ), mIsCached(false), mCacheSize(0)
     {}
 
     Geo1dBezier(const PointsArrayType& ThisPoints)
-    : BaseType( ThisPoints )
+    : BaseType( ThisPoints ), mIsCached(false), mCacheSize(0)
     {}
 
     /**
@@ -240,6 +241,9 @@ public:
     , mNumber(rOther.mNumber)
     , mExtractionOperator(rOther.mExtractionOperator)
     , mCtrlWeights(rOther.mCtrlWeights)
+    , mBezierWeights(rOther.mBezierWeights)
+    , mIsCached(false)
+    , mCacheSize(0)
     {
         GeometryType::mpGeometryData = &(*mpBezierGeometryData);
     }
@@ -262,15 +266,20 @@ public:
     , mNumber(rOther.mNumber)
     , mExtractionOperator(rOther.mExtractionOperator)
     , mCtrlWeights(rOther.mCtrlWeights)
+    , mBezierWeights(rOther.mBezierWeights)
+    , mIsCached(false)
+    , mCacheSize(0)
     {
         Geometry<TOtherPointType>::mpGeometryData = &(*mpBezierGeometryData);
     }
 
     /**
-     * Destructor. Does nothing!!!
+     * Destructor. Releases the cache memory, if any.
      */
     virtual ~Geo1dBezier()
-    {}
+    {
+        this->ClearCache();
+    }
 
     /**
      * Operators
@@ -295,6 +304,8 @@ public:
         this->mNumber = rOther.mNumber;
         this->mExtractionOperator = rOther.mExtractionOperator;
         this->mCtrlWeights = rOther.mCtrlWeights;
+        this->ClearCache();
+        this->mBezierWeights = rOther.mBezierWeights;
         return *this;
     }
 
@@ -319,6 +330,8 @@ public:
         this->mNumber = rOther.mNumber;
         this->mExtractionOperator = rOther.mExtractionOperator;
         this->mCtrlWeights = rOther.mCtrlWeights;
+        this->ClearCache();
+        this->mBezierWeights = rOther.mBezierWeights;
         return *this;
     }
 
@@ -332,7 +345,7 @@ public:
         ValuesContainerType DummyKnots;
         if (mpBezierGeometryData != NULL)
         {
-            pNewGeom->AssignGeometryData(DummyKnots, DummyKnots, DummyKnots,
+            pNewGeom->AssignGeometryData_(DummyKnots, DummyKnots, DummyKnots,
                 mCtrlWeights, mExtractionOperator, mOrder, 0, 0,
                 static_cast<int>(mpBezierGeometryData->DefaultIntegrationMethod()) + 1);
         }
@@ -825,7 +838,7 @@ public:
         BezierUtils::bernstein(bezier_functions_values, mOrder, rPoint[0]);
 
         //compute the Bezier weight
-        VectorType bezier_weights = prod(trans(mExtractionOperator), mCtrlWeights);
+        const VectorType& bezier_weights = mBezierWeights;
         double denom = inner_prod(bezier_functions_values, bezier_weights);
 
         //compute the shape function values
@@ -851,7 +864,7 @@ public:
         BezierUtils::bernstein(bezier_functions_values, mOrder, rPoint[0]);
 
         //compute the Bezier weight
-        VectorType bezier_weights = prod(trans(mExtractionOperator), mCtrlWeights);
+        const VectorType& bezier_weights = mBezierWeights;
         double denom = inner_prod(bezier_functions_values, bezier_weights);
 
         //compute the shape function values
@@ -876,7 +889,7 @@ public:
         BezierUtils::bernstein(bezier_functions_values, bezier_functions_derivatives, mOrder, rPoint[0]);
 
         //compute the Bezier weight
-        VectorType bezier_weights = prod(trans(mExtractionOperator), mCtrlWeights);
+        const VectorType& bezier_weights = mBezierWeights;
         double denom = inner_prod(bezier_functions_values, bezier_weights);
 
         //compute the shape function values
@@ -909,7 +922,7 @@ public:
         BezierUtils::bernstein(bezier_functions_values, bezier_functions_derivatives, mOrder, rPoint[0]);
 
         //compute the Bezier weight
-        VectorType bezier_weights = prod(trans(mExtractionOperator), mCtrlWeights);
+        const VectorType& bezier_weights = mBezierWeights;
         double denom = inner_prod(bezier_functions_values, bezier_weights);
 
         //compute the shape function values
@@ -973,7 +986,7 @@ public:
                                rCoordinates[0]);
 
         //compute the Bezier weight
-        VectorType bezier_weights = prod(trans(mExtractionOperator), mCtrlWeights);
+        const VectorType& bezier_weights = mBezierWeights;
         double denom = inner_prod(bezier_functions_values, bezier_weights);
 
         //compute the shape function local second gradients
@@ -1014,7 +1027,7 @@ public:
                                rCoordinates[0]);
 
         //compute the Bezier weight
-        VectorType bezier_weights = prod(trans(mExtractionOperator), mCtrlWeights);
+        const VectorType& bezier_weights = mBezierWeights;
         double denom = inner_prod(bezier_functions_values, bezier_weights);
 
         //compute the shape function local third gradients
@@ -1056,7 +1069,7 @@ public:
         rPoints.reserve(number_of_local_points);
 
         // compute the Bezier weight
-        VectorType bezier_weights = prod(trans(mExtractionOperator), mCtrlWeights);
+        const VectorType& bezier_weights = mBezierWeights;
 
         // compute the Bezier control points
         typedef typename PointType::Pointer PointPointerType;
@@ -1120,7 +1133,7 @@ public:
             rValues.resize(number_of_local_points);
 
         // compute the Bezier weight
-        VectorType bezier_weights = prod(trans(mExtractionOperator), mCtrlWeights);
+        const VectorType& bezier_weights = mBezierWeights;
 
         // compute the Bezier control points
         for(std::size_t i = 0; i < number_of_local_points; ++i)
@@ -1232,25 +1245,48 @@ public:
         const int& NumberOfIntegrationMethod
     )
     {
-        mCtrlWeights = Weights;
-        mOrder = Degree1;
-        mNumber = mOrder + 1;
-        mExtractionOperator = ExtractionOperator;
-
-        // size checking
-        if(mExtractionOperator.size1() != this->PointsNumber())
-            KRATOS_THROW_ERROR(std::logic_error, "The number of row of extraction operator must be equal to number of nodes", __FUNCTION__)
-        if(mExtractionOperator.size2() != mNumber)
-            KRATOS_THROW_ERROR(std::logic_error, "The number of column of extraction operator must be equal to (p_u+1)", __FUNCTION__)
-        if(mCtrlWeights.size() != this->PointsNumber())
-            KRATOS_THROW_ERROR(std::logic_error, "The number of weights must be equal to number of nodes", __FUNCTION__)
+        this->AssignGeometryData_(Knots1, Knots2, Knots3, Weights, ExtractionOperator,
+                Degree1, Degree2, Degree3, NumberOfIntegrationMethod);
+    }
 
-        // find the existing integration rule or create new one if not existed
-        BezierUtils::RegisterIntegrationRule<1, 3, 1>(NumberOfIntegrationMethod, Degree1);
+    /**
+     * The compressed extraction operator is stored without populating the dense matrix
+     */
+    virtual void AssignGeometryData
+    (
+        const ValuesContainerType& Knots1,
+        const ValuesContainerType& Knots2,
+        const ValuesContainerType& Knots3,
+        const ValuesContainerType& Weights,
+        const CompressedMatrixType& ExtractionOperator,
+        const int& Degree1,
+        const int& Degree2,
+        const int& Degree3,
+        const int& NumberOfIntegrationMethod
+    )
+    {
+        this->AssignGeometryData_(Knots1, Knots2, Knots3, Weights, ExtractionOperator,
+                Degree1, Degree2, Degree3, NumberOfIntegrationMethod);
+    }
 
-        // get the geometry_data according to integration rule. Note that this is a static geometry_data of a reference Bezier element, not the real Bezier element.
-        mpBezierGeometryData = BezierUtils::RetrieveIntegrationRule<1, 3, 1>(NumberOfIntegrationMethod, Degree1);
-        BaseType::mpGeometryData = &(*mpBezierGeometryData);
+    /**
+     * The extraction operator in CSR format is copied directly, e.g. from a memory-mapped binary input
+     */
+    virtual void AssignGeometryData
+    (
+        const ValuesContainerType& Knots1,
+        const ValuesContainerType& Knots2,
+        const ValuesContainerType& Knots3,
+        const ValuesContainerType& Weights,
+        const CompressedExtractionOperator& ExtractionOperator,
+        const int& Degree1,
+        const int& Degree2,
+        const int& Degree3,
+        const int& NumberOfIntegrationMethod
+    )
+    {
+        this->AssignGeometryData_(Knots1, Knots2, Knots3, Weights, ExtractionOperator,
+                Degree1, Degree2, Degree3, NumberOfIntegrationMethod);
     }
 
 protected:
@@ -1267,10 +1303,17 @@ private:
 
     GeometryData::Pointer mpBezierGeometryData;
 
-    MatrixType mExtractionOperator;
+    CompressedExtractionOperator mExtractionOperator;
 
     ValuesContainerType mCtrlWeights; // weight of control points
 
+    VectorType mBezierWeights; // weight of Bezier control points, i.e. trans(C) * w
+
+    bool mIsCached; // flag to indicate the shape functions values and local gradients at integration points are cached
+    std::size_t mCacheSize; // number of bytes of the cache accounted in the BezierUtils memory budget
+    ShapeFunctionsValuesContainerType mCachedShapeFunctionsValues;
+    ShapeFunctionsLocalGradientsContainerType mCachedShapeFunctionsLocalGradients;
+
     int mOrder; // order of the curve
 
     int mNumber; // number of Bezier shape functions
@@ -1309,6 +1352,9 @@ private:
      */
     MatrixType CalculateShapeFunctionsIntegrationPointsValues(IntegrationMethod ThisMethod ) const
     {
+        if (mIsCached)
+            return mCachedShapeFunctionsValues[ThisMethod];
+
         const IntegrationPointsArrayType& integration_points = BaseType::IntegrationPoints(ThisMethod);
 
         //number of integration points
@@ -1342,6 +1388,9 @@ private:
     ShapeFunctionsGradientsType
     CalculateShapeFunctionsIntegrationPointsLocalGradients(IntegrationMethod ThisMethod ) const
     {
+        if (mIsCached)
+            return mCachedShapeFunctionsLocalGradients[ThisMethod];
+
         const IntegrationPointsArrayType& integration_points = BaseType::IntegrationPoints(ThisMethod);
         ShapeFunctionsGradientsType DN_De( integration_points.size() );
         std::fill( DN_De.begin(), DN_De.end(), MatrixType( this->PointsNumber(), 1 ) );
@@ -1392,10 +1441,118 @@ private:
         IntegrationMethod ThisMethod
     ) const
     {
+        if (mIsCached)
+        {
+            shape_functions_values = mCachedShapeFunctionsValues[ThisMethod];
+            shape_functions_local_gradients = mCachedShapeFunctionsLocalGradients[ThisMethod];
+            return;
+        }
+
         const IntegrationPointsArrayType& integration_points = BaseType::IntegrationPoints(ThisMethod);
         CalculateShapeFunctionsIntegrationPointsValuesAndLocalGradients(shape_functions_values, shape_functions_local_gradients, integration_points);
     }
 
+    /**
+     * Implementation of AssignGeometryData for dense and compressed extraction operator
+     */
+    template<class TMatrixType>
+    void AssignGeometryData_
+    (
+        const ValuesContainerType& Knots1,
+        const ValuesContainerType& Knots2,
+        const ValuesContainerType& Knots3,
+        const ValuesContainerType& Weights,
+        const TMatrixType& ExtractionOperator,
+        const int& Degree1,
+        const int& Degree2,
+        const int& Degree3,
+        const int& NumberOfIntegrationMethod
+    )
+    {
+        mCtrlWeights = Weights;
+        mOrder = Degree1;
+        mNumber = mOrder + 1;
+        mExtractionOperator.Assign(ExtractionOperator);
+
+        // size checking
+        if(mExtractionOperator.size1() != this->PointsNumber())
+            KRATOS_THROW_ERROR(std::logic_error, "The number of row of extraction operator must be equal to number of nodes", __FUNCTION__)
+        if(mExtractionOperator.size2() != mNumber)
+            KRATOS_THROW_ERROR(std::logic_error, "The number of column of extraction operator must be equal to (p_u+1)", __FUNCTION__)
+        if(mCtrlWeights.size() != this->PointsNumber())
+            KRATOS_THROW_ERROR(std::logic_error, "The number of weights must be equal to number of nodes", __FUNCTION__)
+
+        // find the existing integration rule or create new one if not existed
+        BezierUtils::RegisterIntegrationRule<1, 3, 1>(NumberOfIntegrationMethod, Degree1);
+
+        // get the geometry_data according to integration rule. Note that this is a static geometry_data of a reference Bezier element, not the real Bezier element.
+        mpBezierGeometryData = BezierUtils::RetrieveIntegrationRule<1, 3, 1>(NumberOfIntegrationMethod, Degree1);
+        BaseType::mpGeometryData = &(*mpBezierGeometryData);
+
+        // the weights have changed, hence the cache must be re-computed
+        this->UpdateCache();
+    }
+
+    /**
+     * Compute the Bezier weights and, if enabled in BezierUtils and the memory budget allows, the shape functions values
+     * and local gradients at the integration points of all registered integration rules.
+     * It must be called whenever the control weights or the extraction operator change.
+     */
+    void UpdateCache()
+    {
+        this->ClearCache();
+
+        mBezierWeights.resize(mExtractionOperator.size2(), false);
+        mExtractionOperator.TransProd(mBezierWeights, mCtrlWeights);
+
+        if (!BezierUtils::IsGeometryCacheEnabled() || mpBezierGeometryData == NULL)
+            return;
+
+        SizeType NumberOfIntegrationPoints = 0;
+        for (IndexType i = 0; i < GeometryData::NumberOfIntegrationMethods; ++i)
+            NumberOfIntegrationPoints += mpBezierGeometryData->IntegrationPointsNumber(static_cast<IntegrationMethod>(i));
+
+        std::size_t CacheSize = NumberOfIntegrationPoints * this->PointsNumber() * 2 * sizeof(double);
+        if (!BezierUtils::AcquireGeometryCacheMemory(CacheSize))
+            return;
+        mCacheSize = CacheSize;
+
+        for (IndexType i = 0; i < GeometryData::NumberOfIntegrationMethods; ++i)
+        {
+            IntegrationMethod ThisMethod = static_cast<IntegrationMethod>(i);
+            if (mpBezierGeometryData->IntegrationPointsNumber(ThisMethod) > 0)
+                this->CalculateShapeFunctionsIntegrationPointsValuesAndLocalGradients(
+                    mCachedShapeFunctionsValues[i],
+                    mCachedShapeFunctionsLocalGradients[i],
+                    ThisMethod
+                );
+        }
+
+        mIsCached = true;
+    }
+
+    /**
+     * Clear the cache and release its memory from the BezierUtils memory budget
+     */
+    void ClearCache()
+    {
+        if (mIsCached)
+        {
+            for (IndexType i = 0; i < GeometryData::NumberOfIntegrationMethods; ++i)
+            {
+                mCachedShapeFunctionsValues[i].resize(0, 0, false);
+                mCachedShapeFunctionsLocalGradients[i].resize(0);
+            }
+            mIsCached = false;
+        }
+
+        if (mCacheSize > 0)
+        {
+            BezierUtils::ReleaseGeometryCacheMemory(mCacheSize);
+            mCacheSize = 0;
+        }
+    }
+
     ////////////////////////////////////////////////////////////////////////////////////////////////////////
     // end of method to build to GeometryData
     ////////////////////////////////////////////////////////////////////////////////////////////////////////
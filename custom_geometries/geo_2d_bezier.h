@@ -28,6 +28,7 @@ see isogeometric_application/LICENSE.txt
 #include "integration/quadrature.h"
 #include "custom_utilities/bspline_utils.h"
 #include "custom_utilities/bezier_utils.h"
+#include "custom_utilities/compressed_extraction_operator.h"
 //#include "integration/quadrature.h"
 //#include "integration/line_gauss_legendre_integration_points.h"
 
@@ -177,6 +178,7 @@ public:
      */
     typedef typename BaseType::MatrixType MatrixType;
     typedef boost::numeric::ublas::compressed_matrix<typename MatrixType::value_type> CompressedMatrixType;
+    typedef boost::numeric::ublas::matrix_row<MatrixType> MatrixRowType;
 
     /**
      * Type of Vector
@@ -193,11 +195,11 @@ public:
      */
 
     Geo2dBezier()
-    : BaseType( PointsArrayType() ), mpBezierGeometryData(NULL)
+    : BaseType( PointsArrayType() ), mpBezierGeometryData(NULL), mIsCached(false), mCacheSize(0)
     {}
 
     Geo2dBezier( const PointsArrayType& ThisPoints )
-    : BaseType( ThisPoints ), mpBezierGeometryData(NULL)
+    : BaseType( ThisPoints ), mpBezierGeometryData(NULL), mIsCached(false), mCacheSize(0)
     {}
 
 //    Geo2dBezier( const PointsArrayType& ThisPoints, const GeometryData* pGeometryData )
@@ -222,6 +224,9 @@ public:
     , mNumber2(rOther.mNumber2)
     , mExtractionOperator(rOther.mExtractionOperator)
     , mCtrlWeights(rOther.mCtrlWeights)
+    , mBezierWeights(rOther.mBezierWeights)
+    , mIsCached(false)
+    , mCacheSize(0)
     {
         GeometryType::mpGeometryData = &(*mpBezierGeometryData);
     }
@@ -246,15 +251,20 @@ public:
     , mNumber2(rOther.mNumber2)
     , mExtractionOperator(rOther.mExtractionOperator)
     , mCtrlWeights(rOther.mCtrlWeights)
+    , mBezierWeights(rOther.mBezierWeights)
+    , mIsCached(false)
+    , mCacheSize(0)
     {
         Geometry<TOtherPointType>::mpGeometryData = &(*mpBezierGeometryData);
     }
 
     /**
-     * Destructor. Does nothing!!!
+     * Destructor. Releases the cache memory, if any.
      */
     virtual ~Geo2dBezier()
-    {}
+    {
+        this->ClearCache();
+    }
 
     /**
      * Operators
@@ -281,6 +291,8 @@ public:
         this->mNumber2 = rOther.mNumber2;
         this->mExtractionOperator = rOther.mExtractionOperator;
         this->mCtrlWeights = rOther.mCtrlWeights;
+        this->ClearCache();
+        this->mBezierWeights = rOther.mBezierWeights;
         return *this;
     }
 
@@ -307,6 +319,8 @@ public:
         this->mNumber2 = rOther.mNumber2;
         this->mExtractionOperator = rOther.mExtractionOperator;
         this->mCtrlWeights = rOther.mCtrlWeights;
+        this->ClearCache();
+        this->mBezierWeights = rOther.mBezierWeights;
         return *this;
     }
 
@@ -320,7 +334,7 @@ public:
         ValuesContainerType DummyKnots;
         if (mpBezierGeometryData != NULL)
         {
-            pNewGeom->AssignGeometryData(DummyKnots, DummyKnots, DummyKnots,
+            pNewGeom->AssignGeometryData_(DummyKnots, DummyKnots, DummyKnots,
                 mCtrlWeights, mExtractionOperator, mOrder1, mOrder2, 0,
                 static_cast<int>(mpBezierGeometryData->DefaultIntegrationMethod()) + 1);
         }
@@ -370,6 +384,19 @@ public:
         std::cout << typeid(*this).name() << "::" << __FUNCTION__ << std::endl;
         #endif
 
+        if (mIsCached)
+        {
+            shape_functions_values = mCachedShapeFunctionsValues[ThisMethod];
+            shape_functions_local_gradients = mCachedShapeFunctionsLocalGradients[ThisMethod];
+            return;
+        }
+
+        // on tensor product rule, evaluate all integration points at once by sum factorization
+        if (BezierUtils::CalculateRationalShapeFunctionsValuesAndLocalGradients(2, *mpBezierGeometryData, ThisMethod,
+                mOrder1, mOrder2, 0, mExtractionOperator, mCtrlWeights, mBezierWeights,
+                shape_functions_values, shape_functions_local_gradients))
+            return;
+
         IndexType NumberOfIntegrationPoints = this->IntegrationPointsNumber(ThisMethod);
         shape_functions_values.resize(NumberOfIntegrationPoints, this->PointsNumber(), false);
         shape_functions_local_gradients.resize(NumberOfIntegrationPoints);
@@ -393,39 +420,32 @@ public:
             = mpBezierGeometryData->ShapeFunctionsLocalGradients( ThisMethod );
 
         VectorType temp_bezier_values(bezier_functions_values.size2());
-        VectorType bezier_weights(mNumber1*mNumber2);
+        MatrixType rational_local_gradients(2, bezier_functions_values.size2()); // local gradients of the rational Bezier functions
+        const VectorType& bezier_weights = mBezierWeights;
         double denom, tmp1, tmp2;
-        VectorType tmp_gradients1(this->PointsNumber());
-        VectorType tmp_gradients2(this->PointsNumber());
         for(IndexType i = 0; i < NumberOfIntegrationPoints; ++i)
         {
             noalias(temp_bezier_values) = row(bezier_functions_values, i);
 
             //compute the Bezier weight
-            noalias(bezier_weights) = prod(trans(mExtractionOperator), mCtrlWeights);
             denom = inner_prod(temp_bezier_values, bezier_weights);
 
             //compute the shape function values
-            VectorType temp_values = prod(mExtractionOperator, temp_bezier_values);
-            for(IndexType j = 0; j < this->PointsNumber(); ++j)
-                shape_functions_values(i, j) = (temp_values(j) * mCtrlWeights(j)) / denom;
+            MatrixRowType shape_functions_values_row(shape_functions_values, i);
+            mExtractionOperator.ApplyValues(shape_functions_values_row, temp_bezier_values, mCtrlWeights, 1.0 / denom);
 
             //compute the shape function local gradients
 //            shape_functions_local_gradients[i].resize(this->PointsNumber(), 2, false); // is not necessary when fill is used above
             tmp1 = inner_prod(row(bezier_functions_local_gradients[i], 0), bezier_weights);
             tmp2 = inner_prod(row(bezier_functions_local_gradients[i], 1), bezier_weights);
 
-            noalias(tmp_gradients1) = prod(mExtractionOperator,
-                    (1 / denom) * row(bezier_functions_local_gradients[i], 0) - (tmp1 / pow(denom, 2)) * temp_bezier_values );
-
-            noalias(tmp_gradients2) = prod(mExtractionOperator,
-                    (1 / denom) * row(bezier_functions_local_gradients[i], 1) - (tmp2 / pow(denom, 2)) * temp_bezier_values );
+            noalias(row(rational_local_gradients, 0)) =
+                    (1 / denom) * row(bezier_functions_local_gradients[i], 0) - (tmp1 / pow(denom, 2)) * temp_bezier_values;
+            noalias(row(rational_local_gradients, 1)) =
+                    (1 / denom) * row(bezier_functions_local_gradients[i], 1) - (tmp2 / pow(denom, 2)) * temp_bezier_values;
 
-            for(IndexType j = 0; j < this->PointsNumber(); ++j)
-            {
-                shape_functions_local_gradients[i](j, 0) = tmp_gradients1(j) * mCtrlWeights(j);
-                shape_functions_local_gradients[i](j, 1) = tmp_gradients2(j) * mCtrlWeights(j);
-            }
+            // both gradient components are computed in one sweep over the non-zeros of the extraction operator
+            mExtractionOperator.ApplyDerivatives(shape_functions_local_gradients[i], rational_local_gradients, mCtrlWeights);
         }
     }
 
@@ -450,15 +470,11 @@ public:
     virtual JacobiansType& Jacobian( JacobiansType& rResult,
             IntegrationMethod ThisMethod ) const
     {
-        MatrixType shape_functions_values;
-        ShapeFunctionsGradientsType shape_functions_local_gradients;
+        ShapeFunctionsGradientsType temp_local_gradients;
 
         //getting derivatives of shape functions
-        CalculateShapeFunctionsIntegrationPointsValuesAndLocalGradients(
-            shape_functions_values,
-            shape_functions_local_gradients,
-            ThisMethod
-        );
+        const ShapeFunctionsGradientsType& shape_functions_local_gradients
+            = this->IntegrationPointsLocalGradients(temp_local_gradients, ThisMethod);
 
         SizeType NumberOfIntegrationPoints = this->IntegrationPointsNumber( ThisMethod );
 
@@ -506,15 +522,11 @@ public:
     virtual JacobiansType& Jacobian( JacobiansType& rResult,
             IntegrationMethod ThisMethod, Matrix& DeltaPosition ) const
     {
-        MatrixType shape_functions_values;
-        ShapeFunctionsGradientsType shape_functions_local_gradients;
+        ShapeFunctionsGradientsType temp_local_gradients;
 
         //getting derivatives of shape functions
-        CalculateShapeFunctionsIntegrationPointsValuesAndLocalGradients(
-            shape_functions_values,
-            shape_functions_local_gradients,
-            ThisMethod
-        );
+        const ShapeFunctionsGradientsType& shape_functions_local_gradients
+            = this->IntegrationPointsLocalGradients(temp_local_gradients, ThisMethod);
 
         SizeType NumberOfIntegrationPoints = this->IntegrationPointsNumber( ThisMethod );
 
@@ -592,15 +604,11 @@ public:
 
     virtual JacobiansType& Jacobian0( JacobiansType& rResult, IntegrationMethod ThisMethod ) const
     {
-        MatrixType shape_functions_values;
-        ShapeFunctionsGradientsType shape_functions_local_gradients;
+        ShapeFunctionsGradientsType temp_local_gradients;
 
         //getting derivatives of shape functions
-        CalculateShapeFunctionsIntegrationPointsValuesAndLocalGradients(
-            shape_functions_values,
-            shape_functions_local_gradients,
-            ThisMethod
-        );
+        const ShapeFunctionsGradientsType& shape_functions_local_gradients
+            = this->IntegrationPointsLocalGradients(temp_local_gradients, ThisMethod);
 
         SizeType NumberOfIntegrationPoints = this->IntegrationPointsNumber( ThisMethod );
 
@@ -662,7 +670,7 @@ public:
         }
 
         //compute the Bezier weight
-        VectorType bezier_weights = prod(trans(mExtractionOperator), mCtrlWeights);
+        const VectorType& bezier_weights = mBezierWeights;
         double denom = inner_prod(bezier_functions_values, bezier_weights);
 
         //compute the shape function values
@@ -724,7 +732,7 @@ public:
         }
 
         //compute the Bezier weight
-        VectorType bezier_weights = prod(trans(mExtractionOperator), mCtrlWeights);
+        const VectorType& bezier_weights = mBezierWeights;
         double denom = inner_prod(bezier_functions_values, bezier_weights);
 
         //compute the shape function local gradients
@@ -833,7 +841,7 @@ public:
         }
 
         //compute the Bezier weight
-        VectorType bezier_weights = prod(trans(mExtractionOperator), mCtrlWeights);
+        const VectorType& bezier_weights = mBezierWeights;
         double denom = inner_prod(bezier_functions_values, bezier_weights);
 
         //compute the shape function local second gradients
@@ -908,7 +916,7 @@ public:
         rPoints.reserve(number_of_local_points);
 
         // compute the Bezier weight
-        VectorType bezier_weights = prod(trans(mExtractionOperator), mCtrlWeights);
+        const VectorType& bezier_weights = mBezierWeights;
 
         // compute the Bezier control points
         typedef typename PointType::Pointer PointPointerType;
@@ -977,7 +985,7 @@ public:
             rValues.resize(number_of_local_points);
 
         // compute the Bezier weight
-        VectorType bezier_weights = prod(trans(mExtractionOperator), mCtrlWeights);
+        const VectorType& bezier_weights = mBezierWeights;
 
         // compute the Bezier control points
         for(std::size_t i = 0; i < number_of_local_points; ++i)
@@ -1106,14 +1114,95 @@ public:
         const int& Degree3, //not used
         const int& NumberOfIntegrationMethod
     )
+    {
+        this->AssignGeometryData_(Knots1, Knots2, Knots3, Weights, ExtractionOperator,
+                Degree1, Degree2, Degree3, NumberOfIntegrationMethod);
+    }
+
+    /**
+     * TO BE CALLED BY ELEMENT
+     * The compressed extraction operator is stored without populating the dense matrix
+     */
+    virtual void AssignGeometryData(
+        const ValuesContainerType& Knots1, //not used
+        const ValuesContainerType& Knots2, //not used
+        const ValuesContainerType& Knots3, //not used
+        const ValuesContainerType& Weights,
+        const CompressedMatrixType& ExtractionOperator,
+        const int& Degree1,
+        const int& Degree2,
+        const int& Degree3, //not used
+        const int& NumberOfIntegrationMethod
+    )
+    {
+        this->AssignGeometryData_(Knots1, Knots2, Knots3, Weights, ExtractionOperator,
+                Degree1, Degree2, Degree3, NumberOfIntegrationMethod);
+    }
+
+    /**
+     * The extraction operator in CSR format is copied directly, e.g. from a memory-mapped binary input
+     */
+    virtual void AssignGeometryData(
+        const ValuesContainerType& Knots1, //not used
+        const ValuesContainerType& Knots2, //not used
+        const ValuesContainerType& Knots3, //not used
+        const ValuesContainerType& Weights,
+        const CompressedExtractionOperator& ExtractionOperator,
+        const int& Degree1,
+        const int& Degree2,
+        const int& Degree3, //not used
+        const int& NumberOfIntegrationMethod
+    )
+    {
+        this->AssignGeometryData_(Knots1, Knots2, Knots3, Weights, ExtractionOperator,
+                Degree1, Degree2, Degree3, NumberOfIntegrationMethod);
+    }
+
+protected:
+
+//    static const GeometryData msGeometryData;
+    GeometryData::Pointer mpBezierGeometryData;
+
+    CompressedExtractionOperator mExtractionOperator;
+
+    ValuesContainerType mCtrlWeights; //weight of control points
+
+    VectorType mBezierWeights; //weight of Bezier control points, i.e. trans(C) * w
+
+    bool mIsCached; //flag to indicate the shape functions values and local gradients at integration points are cached
+    std::size_t mCacheSize; //number of bytes of the cache accounted in the BezierUtils memory budget
+    ShapeFunctionsValuesContainerType mCachedShapeFunctionsValues;
+    ShapeFunctionsLocalGradientsContainerType mCachedShapeFunctionsLocalGradients;
+
+    int mOrder1; //order of the surface at parametric direction 1
+    int mOrder2; //order of the surface at parametric direction 2
+
+    int mNumber1; //number of bezier shape functions define the surface on parametric direction 1
+    int mNumber2; //number of bezier shape functions define the surface on parametric direction 2
+
+    /**
+     * Implementation of AssignGeometryData for dense and compressed extraction operator
+     */
+    template<class TMatrixType>
+    void AssignGeometryData_(
+        const ValuesContainerType& Knots1, //not used
+        const ValuesContainerType& Knots2, //not used
+        const ValuesContainerType& Knots3, //not used
+        const ValuesContainerType& Weights,
+        const TMatrixType& ExtractionOperator,
+        const int& Degree1,
+        const int& Degree2,
+        const int& Degree3, //not used
+        const int& NumberOfIntegrationMethod
+    )
     {
         mCtrlWeights = Weights;
         mOrder1 = Degree1;
         mOrder2 = Degree2;
         mNumber1 = mOrder1 + 1;
         mNumber2 = mOrder2 + 1;
-        // TODO we have to check here if the compressed_matrix copy is called or not. Otherwise, maybe the full matrix is populated.
-        mExtractionOperator = ExtractionOperator;
+        // only the non-zero entries of the extraction operator are kept
+        mExtractionOperator.Assign(ExtractionOperator);
 
         // size checking
         if(mExtractionOperator.size1() != this->PointsNumber())
@@ -1132,23 +1221,93 @@ public:
             mpBezierGeometryData = BezierUtils::RetrieveIntegrationRule<2, 2, 2>(NumberOfIntegrationMethod, Degree1, Degree2);
             GeometryType::mpGeometryData = &(*mpBezierGeometryData);
         }
+
+        // the weights have changed, hence the cache must be re-computed
+        this->UpdateCache();
     }
 
-protected:
+    /**
+     * Compute the Bezier weights and, if enabled in BezierUtils and the memory budget allows, the shape functions values
+     * and local gradients at the integration points of all registered integration rules.
+     * It must be called whenever the control weights or the extraction operator change.
+     */
+    void UpdateCache()
+    {
+        this->ClearCache();
 
-//    static const GeometryData msGeometryData;
-    GeometryData::Pointer mpBezierGeometryData;
+        mBezierWeights.resize(mExtractionOperator.size2(), false);
+        mExtractionOperator.TransProd(mBezierWeights, mCtrlWeights);
 
-    MatrixType mExtractionOperator;
-    // CompressedMatrixType mExtractionOperator;
+        if (!BezierUtils::IsGeometryCacheEnabled() || mpBezierGeometryData == NULL)
+            return;
 
-    ValuesContainerType mCtrlWeights; //weight of control points
+        SizeType NumberOfIntegrationPoints = 0;
+        for (IndexType i = 0; i < GeometryData::NumberOfIntegrationMethods; ++i)
+            NumberOfIntegrationPoints += mpBezierGeometryData->IntegrationPointsNumber(static_cast<IntegrationMethod>(i));
 
-    int mOrder1; //order of the surface at parametric direction 1
-    int mOrder2; //order of the surface at parametric direction 2
+        std::size_t CacheSize = NumberOfIntegrationPoints * this->PointsNumber() * 3 * sizeof(double);
+        if (!BezierUtils::AcquireGeometryCacheMemory(CacheSize))
+            return;
+        mCacheSize = CacheSize;
 
-    int mNumber1; //number of bezier shape functions define the surface on parametric direction 1
-    int mNumber2; //number of bezier shape functions define the surface on parametric direction 2
+        for (IndexType i = 0; i < GeometryData::NumberOfIntegrationMethods; ++i)
+        {
+            IntegrationMethod ThisMethod = static_cast<IntegrationMethod>(i);
+            if (mpBezierGeometryData->IntegrationPointsNumber(ThisMethod) > 0)
+                this->CalculateShapeFunctionsIntegrationPointsValuesAndLocalGradients(
+                    mCachedShapeFunctionsValues[i],
+                    mCachedShapeFunctionsLocalGradients[i],
+                    ThisMethod
+                );
+        }
+
+        mIsCached = true;
+    }
+
+    /**
+     * Clear the cache and release its memory from the BezierUtils memory budget
+     */
+    void ClearCache()
+    {
+        if (mIsCached)
+        {
+            for (IndexType i = 0; i < GeometryData::NumberOfIntegrationMethods; ++i)
+            {
+                mCachedShapeFunctionsValues[i].resize(0, 0, false);
+                mCachedShapeFunctionsLocalGradients[i].resize(0);
+            }
+            mIsCached = false;
+        }
+
+        if (mCacheSize > 0)
+        {
+            BezierUtils::ReleaseGeometryCacheMemory(mCacheSize);
+            mCacheSize = 0;
+        }
+    }
+
+    /**
+     * Get the shape functions local gradients at the integration points of an integration method.
+     * If the geometry is cached, the reference to the cache is returned. Otherwise the local gradients
+     * are computed in rTempLocalGradients.
+     */
+    const ShapeFunctionsGradientsType& IntegrationPointsLocalGradients(
+        ShapeFunctionsGradientsType& rTempLocalGradients,
+        IntegrationMethod ThisMethod
+    ) const
+    {
+        if (mIsCached)
+            return mCachedShapeFunctionsLocalGradients[ThisMethod];
+
+        MatrixType shape_functions_values;
+        this->CalculateShapeFunctionsIntegrationPointsValuesAndLocalGradients(
+            shape_functions_values,
+            rTempLocalGradients,
+            ThisMethod
+        );
+
+        return rTempLocalGradients;
+    }
 
 private:
 
@@ -1229,7 +1388,7 @@ private:
         }
 
         //compute the Bezier weight
-        VectorType bezier_weights = prod(trans(mExtractionOperator), mCtrlWeights);
+        const VectorType& bezier_weights = mBezierWeights;
         double denom = inner_prod(bezier_functions_values, bezier_weights);
 
         //compute the shape function values
@@ -172,6 +172,7 @@ public:
      * Type of Matrix
      */
     typedef typename BaseType::MatrixType MatrixType;
+    typedef typename BaseType::CompressedMatrixType CompressedMatrixType;
 
     /**
      * Type of Vector
@@ -278,7 +279,7 @@ public:
         ValuesContainerType DummyKnots;
         if (BaseType::mpBezierGeometryData != NULL)
         {
-            pNewGeom->AssignGeometryData(DummyKnots, DummyKnots, DummyKnots,
+            pNewGeom->AssignGeometryData_(DummyKnots, DummyKnots, DummyKnots,
                 BaseType::mCtrlWeights, BaseType::mExtractionOperator, BaseType::mOrder1, BaseType::mOrder2, 0,
                 static_cast<int>(BaseType::mpBezierGeometryData->DefaultIntegrationMethod()) + 1);
         }
@@ -351,15 +352,11 @@ public:
      */
     virtual JacobiansType& Jacobian( JacobiansType& rResult, IntegrationMethod ThisMethod ) const
     {
-        MatrixType shape_functions_values;
-        ShapeFunctionsGradientsType shape_functions_local_gradients;
+        ShapeFunctionsGradientsType temp_local_gradients;
 
         //getting derivatives of shape functions
-        BaseType::CalculateShapeFunctionsIntegrationPointsValuesAndLocalGradients(
-            shape_functions_values,
-            shape_functions_local_gradients,
-            ThisMethod
-        );
+        const ShapeFunctionsGradientsType& shape_functions_local_gradients
+            = BaseType::IntegrationPointsLocalGradients(temp_local_gradients, ThisMethod);
 
         SizeType NumberOfIntegrationPoints = this->IntegrationPointsNumber( ThisMethod );
 
@@ -408,15 +405,11 @@ public:
      */
     virtual JacobiansType& Jacobian( JacobiansType& rResult, IntegrationMethod ThisMethod, Matrix& DeltaPosition ) const
     {
-        MatrixType shape_functions_values;
-        ShapeFunctionsGradientsType shape_functions_local_gradients;
+        ShapeFunctionsGradientsType temp_local_gradients;
 
         //getting derivatives of shape functions
-        BaseType::CalculateShapeFunctionsIntegrationPointsValuesAndLocalGradients(
-            shape_functions_values,
-            shape_functions_local_gradients,
-            ThisMethod
-        );
+        const ShapeFunctionsGradientsType& shape_functions_local_gradients
+            = BaseType::IntegrationPointsLocalGradients(temp_local_gradients, ThisMethod);
 
         SizeType NumberOfIntegrationPoints = this->IntegrationPointsNumber( ThisMethod );
 
@@ -475,15 +468,11 @@ public:
 
     virtual JacobiansType& Jacobian0( JacobiansType& rResult, IntegrationMethod ThisMethod ) const
     {
-        MatrixType shape_functions_values;
-        ShapeFunctionsGradientsType shape_functions_local_gradients;
+        ShapeFunctionsGradientsType temp_local_gradients;
 
         //getting derivatives of shape functions
-        BaseType::CalculateShapeFunctionsIntegrationPointsValuesAndLocalGradients(
-            shape_functions_values,
-            shape_functions_local_gradients,
-            ThisMethod
-        );
+        const ShapeFunctionsGradientsType& shape_functions_local_gradients
+            = BaseType::IntegrationPointsLocalGradients(temp_local_gradients, ThisMethod);
 
         SizeType NumberOfIntegrationPoints = this->IntegrationPointsNumber( ThisMethod );
 
@@ -572,6 +561,71 @@ public:
         const int& Degree3, //not used
         const int& NumberOfIntegrationMethod
     )
+    {
+        this->AssignGeometryData_(Knots1, Knots2, Knots3, Weights, ExtractionOperator,
+                Degree1, Degree2, Degree3, NumberOfIntegrationMethod);
+    }
+
+    /**
+     * TO BE CALLED BY ELEMENT
+     * The compressed extraction operator is stored without populating the dense matrix
+     */
+    virtual void AssignGeometryData(
+        const ValuesContainerType& Knots1, //not used
+        const ValuesContainerType& Knots2, //not used
+        const ValuesContainerType& Knots3, //not used
+        const ValuesContainerType& Weights,
+        const CompressedMatrixType& ExtractionOperator,
+        const int& Degree1,
+        const int& Degree2,
+        const int& Degree3, //not used
+        const int& NumberOfIntegrationMethod
+    )
+    {
+        this->AssignGeometryData_(Knots1, Knots2, Knots3, Weights, ExtractionOperator,
+                Degree1, Degree2, Degree3, NumberOfIntegrationMethod);
+    }
+
+    /**
+     * The extraction operator in CSR format is copied directly, e.g. from a memory-mapped binary input
+     */
+    virtual void AssignGeometryData(
+        const ValuesContainerType& Knots1, //not used
+        const ValuesContainerType& Knots2, //not used
+        const ValuesContainerType& Knots3, //not used
+        const ValuesContainerType& Weights,
+        const CompressedExtractionOperator& ExtractionOperator,
+        const int& Degree1,
+        const int& Degree2,
+        const int& Degree3, //not used
+        const int& NumberOfIntegrationMethod
+    )
+    {
+        this->AssignGeometryData_(Knots1, Knots2, Knots3, Weights, ExtractionOperator,
+                Degree1, Degree2, Degree3, NumberOfIntegrationMethod);
+    }
+
+protected:
+
+    /**
+     * there are no protected class members
+     */
+
+    /**
+     * Implementation of AssignGeometryData for dense and compressed extraction operator
+     */
+    template<class TMatrixType>
+    void AssignGeometryData_(
+        const ValuesContainerType& Knots1, //not used
+        const ValuesContainerType& Knots2, //not used
+        const ValuesContainerType& Knots3, //not used
+        const ValuesContainerType& Weights,
+        const TMatrixType& ExtractionOperator,
+        const int& Degree1,
+        const int& Degree2,
+        const int& Degree3, //not used
+        const int& NumberOfIntegrationMethod
+    )
     {
         BaseType::mCtrlWeights = Weights;
         BaseType::mOrder1 = Degree1;
@@ -579,8 +633,8 @@ public:
         BaseType::mNumber1 = BaseType::mOrder1 + 1;
         BaseType::mNumber2 = BaseType::mOrder2 + 1;
 
-        // TODO we have to check here if the compressed_matrix copy is called or not. Otherwise, maybe the full matrix is populated.
-        BaseType::mExtractionOperator = ExtractionOperator;
+        // only the non-zero entries of the extraction operator are kept
+        BaseType::mExtractionOperator.Assign(ExtractionOperator);
 
         // size checking
         if(BaseType::mExtractionOperator.size1() != this->PointsNumber())
@@ -599,13 +653,11 @@ public:
             BaseType::mpBezierGeometryData = BezierUtils::RetrieveIntegrationRule<2, 3, 2>(NumberOfIntegrationMethod, Degree1, Degree2);
             GeometryType::mpGeometryData = &(*BaseType::mpBezierGeometryData);
         }
-    }
 
-protected:
+        // the weights have changed, hence the cache must be re-computed
+        BaseType::UpdateCache();
+    }
 
-    /**
-     * there are no protected class members
-     */
 
 private:
 
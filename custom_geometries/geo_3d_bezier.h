@@ -27,6 +27,8 @@ see isogeometric_application/LICENSE.txt
 #include "custom_geometries/isogeometric_geometry.h"
 #include "integration/quadrature.h"
 #include "custom_utilities/bspline_utils.h"
+#include "custom_utilities/bezier_utils.h"
+#include "custom_utilities/compressed_extraction_operator.h"
 //#include "integration/quadrature.h"
 //#include "integration/line_gauss_legendre_integration_points.h"
 
@@ -176,6 +178,7 @@ public:
      */
     typedef typename BaseType::MatrixType MatrixType;
     typedef boost::numeric::ublas::compressed_matrix<typename MatrixType::value_type> CompressedMatrixType;
+    typedef boost::numeric::ublas::matrix_row<MatrixType> MatrixRowType;
 
     /**
      * Type of Vector
@@ -192,11 +195,11 @@ public:
      */
 
     Geo3dBezier()
-    : BaseType( PointsArrayType() ), mpBezierGeometryData(NULL)
+    : BaseType( PointsArrayType() ), mpBezierGeometryData(NULL), mIsCached(false), mCacheSize(0)
     {}
 
     Geo3dBezier( const PointsArrayType& ThisPoints )
-    : BaseType( ThisPoints ), mpBezierGeometryData(NULL)
+    : BaseType( ThisPoints ), mpBezierGeometryData(NULL), mIsCached(false), mCacheSize(0)
     {
     }
 
@@ -220,6 +223,9 @@ public:
     , mNumber3(rOther.mNumber3)
     , mExtractionOperator(rOther.mExtractionOperator)
     , mCtrlWeights(rOther.mCtrlWeights)
+    , mBezierWeights(rOther.mBezierWeights)
+    , mIsCached(false)
+    , mCacheSize(0)
     {
         GeometryType::mpGeometryData = &(*mpBezierGeometryData);
     }
@@ -246,15 +252,20 @@ public:
     , mNumber3(rOther.mNumber3)
     , mExtractionOperator(rOther.mExtractionOperator)
     , mCtrlWeights(rOther.mCtrlWeights)
+    , mBezierWeights(rOther.mBezierWeights)
+    , mIsCached(false)
+    , mCacheSize(0)
     {
         Geometry<TOtherPointType>::mpGeometryData = &(*mpBezierGeometryData);
     }
 
     /**
-     * Destructor. Does nothing!!!
+     * Destructor. Releases the cache memory, if any.
      */
     virtual ~Geo3dBezier()
-    {}
+    {
+        this->ClearCache();
+    }
 
     /**
      * Operators
@@ -283,6 +294,8 @@ public:
         this->mNumber3 = rOther.mNumber3;
         this->mExtractionOperator = rOther.mExtractionOperator;
         this->mCtrlWeights = rOther.mCtrlWeights;
+        this->ClearCache();
+        this->mBezierWeights = rOther.mBezierWeights;
         return *this;
     }
 
@@ -311,6 +324,8 @@ public:
         this->mNumber3 = rOther.mNumber3;
         this->mExtractionOperator = rOther.mExtractionOperator;
         this->mCtrlWeights = rOther.mCtrlWeights;
+        this->ClearCache();
+        this->mBezierWeights = rOther.mBezierWeights;
         return *this;
     }
 
@@ -324,7 +339,7 @@ public:
         if (mpBezierGeometryData != NULL)
         {
             ValuesContainerType DummyKnots;
-            pNewGeom->AssignGeometryData(DummyKnots, DummyKnots, DummyKnots,
+            pNewGeom->AssignGeometryData_(DummyKnots, DummyKnots, DummyKnots,
                 mCtrlWeights, mExtractionOperator, mOrder1, mOrder2, mOrder3,
                 static_cast<int>(mpBezierGeometryData->DefaultIntegrationMethod()) + 1);
         }
@@ -391,6 +406,19 @@ public:
         std::cout << typeid(*this).name() << "::" << __FUNCTION__ << std::endl;
         #endif
 
+        if (mIsCached)
+        {
+            shape_functions_values = mCachedShapeFunctionsValues[ThisMethod];
+            shape_functions_local_gradients = mCachedShapeFunctionsLocalGradients[ThisMethod];
+            return;
+        }
+
+        // on tensor product rule, evaluate all integration points at once by sum factorization
+        if (BezierUtils::CalculateRationalShapeFunctionsValuesAndLocalGradients(3, *mpBezierGeometryData, ThisMethod,
+                mOrder1, mOrder2, mOrder3, mExtractionOperator, mCtrlWeights, mBezierWeights,
+                shape_functions_values, shape_functions_local_gradients))
+            return;
+
 //        SizeType NumberOfIntegrationPoints = this->IntegrationPointsNumber(ThisMethod);
         SizeType NumberOfIntegrationPoints = mpBezierGeometryData->IntegrationPoints(ThisMethod).size();
 
@@ -410,23 +438,19 @@ public:
             = mpBezierGeometryData->ShapeFunctionsLocalGradients( ThisMethod );
 
         VectorType temp_bezier_values(bezier_functions_values.size2());
-        VectorType bezier_weights(mNumber1 * mNumber2 * mNumber3);
+        MatrixType rational_local_gradients(3, bezier_functions_values.size2()); // local gradients of the rational Bezier functions
+        const VectorType& bezier_weights = mBezierWeights;
         double denom, tmp1, tmp2, tmp3;
-        VectorType tmp_gradients1(this->PointsNumber());
-        VectorType tmp_gradients2(this->PointsNumber());
-        VectorType tmp_gradients3(this->PointsNumber());
         for(IndexType i = 0; i < NumberOfIntegrationPoints; ++i)
         {
             noalias(temp_bezier_values) = row(bezier_functions_values, i);
 
             //compute the Bezier weight
-            noalias(bezier_weights) = prod(trans(mExtractionOperator), mCtrlWeights);
             denom = inner_prod(temp_bezier_values, bezier_weights);
 
             //compute the shape function values
-            VectorType temp_values = prod(mExtractionOperator, temp_bezier_values);
-            for(IndexType j = 0; j < this->PointsNumber(); ++j)
-                shape_functions_values(i, j) = (temp_values(j) * mCtrlWeights(j) / denom);
+            MatrixRowType shape_functions_values_row(shape_functions_values, i);
+            mExtractionOperator.ApplyValues(shape_functions_values_row, temp_bezier_values, mCtrlWeights, 1.0 / denom);
 
             //compute the shape function local gradients
 //            shape_functions_local_gradients[i].resize(this->PointsNumber(), 3, false);
@@ -434,21 +458,15 @@ public:
             tmp2 = inner_prod(row(bezier_functions_local_gradients[i], 1), bezier_weights);
             tmp3 = inner_prod(row(bezier_functions_local_gradients[i], 2), bezier_weights);
 
-            noalias(tmp_gradients1) = prod( mExtractionOperator,
-                        (1 / denom) * row(bezier_functions_local_gradients[i], 0) - (tmp1 / pow(denom, 2)) * temp_bezier_values );
-
-            noalias(tmp_gradients2) = prod(mExtractionOperator,
-                        (1 / denom) * row(bezier_functions_local_gradients[i], 1) - (tmp2 / pow(denom, 2)) * temp_bezier_values );
+            noalias(row(rational_local_gradients, 0)) =
+                        (1 / denom) * row(bezier_functions_local_gradients[i], 0) - (tmp1 / pow(denom, 2)) * temp_bezier_values;
+            noalias(row(rational_local_gradients, 1)) =
+                        (1 / denom) * row(bezier_functions_local_gradients[i], 1) - (tmp2 / pow(denom, 2)) * temp_bezier_values;
+            noalias(row(rational_local_gradients, 2)) =
+                        (1 / denom) * row(bezier_functions_local_gradients[i], 2) - (tmp3 / pow(denom, 2)) * temp_bezier_values;
 
-            noalias(tmp_gradients3) = prod(mExtractionOperator,
-                        (1 / denom) * row(bezier_functions_local_gradients[i], 2) - (tmp3 / pow(denom, 2)) * temp_bezier_values );
-
-            for(IndexType j = 0; j < this->PointsNumber(); ++j)
-            {
-                shape_functions_local_gradients[i](j, 0) = tmp_gradients1(j) * mCtrlWeights(j);
-                shape_functions_local_gradients[i](j, 1) = tmp_gradients2(j) * mCtrlWeights(j);
-                shape_functions_local_gradients[i](j, 2) = tmp_gradients3(j) * mCtrlWeights(j);
-            }
+            // all gradient components are computed in one sweep over the non-zeros of the extraction operator
+            mExtractionOperator.ApplyDerivatives(shape_functions_local_gradients[i], rational_local_gradients, mCtrlWeights);
         }
     }
 
@@ -457,15 +475,11 @@ public:
      */
     virtual JacobiansType& Jacobian( JacobiansType& rResult, IntegrationMethod ThisMethod ) const
     {
-        MatrixType shape_functions_values;
-        ShapeFunctionsGradientsType shape_functions_local_gradients;
+        ShapeFunctionsGradientsType temp_local_gradients;
 
         //getting local gradients of shape functions
-        CalculateShapeFunctionsIntegrationPointsValuesAndLocalGradients(
-            shape_functions_values,
-            shape_functions_local_gradients,
-            ThisMethod
-        );
+        const ShapeFunctionsGradientsType& shape_functions_local_gradients
+            = this->IntegrationPointsLocalGradients(temp_local_gradients, ThisMethod);
 
 //        SizeType NumberOfIntegrationPoints = this->IntegrationPointsNumber( ThisMethod );
         SizeType NumberOfIntegrationPoints = mpBezierGeometryData->IntegrationPoints(ThisMethod).size();
@@ -507,15 +521,11 @@ public:
      */
     virtual JacobiansType& Jacobian( JacobiansType& rResult, IntegrationMethod ThisMethod, Matrix& DeltaPosition ) const
     {
-        MatrixType shape_functions_values;
-        ShapeFunctionsGradientsType shape_functions_local_gradients;
+        ShapeFunctionsGradientsType temp_local_gradients;
 
         //getting local gradients of shape functions
-        CalculateShapeFunctionsIntegrationPointsValuesAndLocalGradients(
-            shape_functions_values,
-            shape_functions_local_gradients,
-            ThisMethod
-        );
+        const ShapeFunctionsGradientsType& shape_functions_local_gradients
+            = this->IntegrationPointsLocalGradients(temp_local_gradients, ThisMethod);
 
 //        SizeType NumberOfIntegrationPoints = this->IntegrationPointsNumber( ThisMethod );
         SizeType NumberOfIntegrationPoints = mpBezierGeometryData->IntegrationPoints(ThisMethod).size();
@@ -557,15 +567,11 @@ public:
      */
     virtual Matrix& Jacobian( Matrix& rResult, IndexType IntegrationPointIndex, IntegrationMethod ThisMethod ) const
     {
-        MatrixType shape_functions_values;
-        ShapeFunctionsGradientsType shape_functions_local_gradients;
+        ShapeFunctionsGradientsType temp_local_gradients;
 
         //getting local gradients of shape functions
-        CalculateShapeFunctionsIntegrationPointsValuesAndLocalGradients(
-            shape_functions_values,
-            shape_functions_local_gradients,
-            ThisMethod
-        );
+        const ShapeFunctionsGradientsType& shape_functions_local_gradients
+            = this->IntegrationPointsLocalGradients(temp_local_gradients, ThisMethod);
 
         rResult.resize(3, 3, false);
         noalias(rResult) = ZeroMatrix( 3, 3 );
@@ -592,15 +598,11 @@ public:
      */
     virtual Matrix& Jacobian( Matrix& rResult, IndexType IntegrationPointIndex, IntegrationMethod ThisMethod, Matrix& DeltaPosition ) const
     {
-        MatrixType shape_functions_values;
-        ShapeFunctionsGradientsType shape_functions_local_gradients;
+        ShapeFunctionsGradientsType temp_local_gradients;
 
         //getting local gradients of shape functions
-        CalculateShapeFunctionsIntegrationPointsValuesAndLocalGradients(
-            shape_functions_values,
-            shape_functions_local_gradients,
-            ThisMethod
-        );
+        const ShapeFunctionsGradientsType& shape_functions_local_gradients
+            = this->IntegrationPointsLocalGradients(temp_local_gradients, ThisMethod);
 
         rResult.resize(3, 3, false);
         noalias(rResult) = ZeroMatrix( 3, 3 );
@@ -788,15 +790,11 @@ public:
      */
     virtual JacobiansType& Jacobian0( JacobiansType& rResult, IntegrationMethod ThisMethod ) const
     {
-        MatrixType shape_functions_values;
-        ShapeFunctionsGradientsType shape_functions_local_gradients;
+        ShapeFunctionsGradientsType temp_local_gradients;
 
         //getting derivatives of shape functions
-        CalculateShapeFunctionsIntegrationPointsValuesAndLocalGradients(
-            shape_functions_values,
-            shape_functions_local_gradients,
-            ThisMethod
-        );
+        const ShapeFunctionsGradientsType& shape_functions_local_gradients
+            = this->IntegrationPointsLocalGradients(temp_local_gradients, ThisMethod);
 
 //        SizeType NumberOfIntegrationPoints = this->IntegrationPointsNumber( ThisMethod );
         SizeType NumberOfIntegrationPoints = mpBezierGeometryData->IntegrationPoints(ThisMethod).size();
@@ -867,7 +865,7 @@ public:
         }
 
         //compute the Bezier weight
-        VectorType bezier_weights = prod(trans(mExtractionOperator), mCtrlWeights);
+        const VectorType& bezier_weights = mBezierWeights;
         double denom = inner_prod(bezier_functions_values, bezier_weights);
 
         //compute the shape function values
@@ -946,7 +944,7 @@ public:
         }
 
         //compute the Bezier weight
-        VectorType bezier_weights = prod(trans(mExtractionOperator), mCtrlWeights);
+        const VectorType& bezier_weights = mBezierWeights;
         double denom = inner_prod(bezier_functions_values, bezier_weights);
 
         //compute the shape function local gradients
@@ -1109,7 +1107,7 @@ public:
         }
 
         //compute the Bezier weight
-        VectorType bezier_weights = prod(trans(mExtractionOperator), mCtrlWeights);
+        const VectorType& bezier_weights = mBezierWeights;
         double denom = inner_prod(bezier_functions_values, bezier_weights);
 
         //compute the shape function local second gradients
@@ -1214,7 +1212,7 @@ public:
         rPoints.reserve(number_of_local_points);
 
         // compute the Bezier weight
-        VectorType bezier_weights = prod(trans(mExtractionOperator), mCtrlWeights);
+        const VectorType& bezier_weights = mBezierWeights;
 
         // compute the Bezier control points
         typedef typename PointType::Pointer PointPointerType;
@@ -1284,7 +1282,7 @@ public:
             rValues.resize(number_of_local_points);
 
         // compute the Bezier weight
-        VectorType bezier_weights = prod(trans(mExtractionOperator), mCtrlWeights);
+        const VectorType& bezier_weights = mBezierWeights;
 
         // compute the Bezier control points
         for(std::size_t i = 0; i < number_of_local_points; ++i)
@@ -1415,6 +1413,94 @@ public:
         const int& Degree3,
         const int& NumberOfIntegrationMethod
     )
+    {
+        this->AssignGeometryData_(Knots1, Knots2, Knots3, Weights, ExtractionOperator,
+                Degree1, Degree2, Degree3, NumberOfIntegrationMethod);
+    }
+
+    /**
+     * The compressed extraction operator is stored without populating the dense matrix
+     */
+    virtual void AssignGeometryData(
+        const ValuesContainerType& Knots1, //not used
+        const ValuesContainerType& Knots2, //not used
+        const ValuesContainerType& Knots3, //not used
+        const ValuesContainerType& Weights,
+        const CompressedMatrixType& ExtractionOperator,
+        const int& Degree1,
+        const int& Degree2,
+        const int& Degree3,
+        const int& NumberOfIntegrationMethod
+    )
+    {
+        this->AssignGeometryData_(Knots1, Knots2, Knots3, Weights, ExtractionOperator,
+                Degree1, Degree2, Degree3, NumberOfIntegrationMethod);
+    }
+
+    /**
+     * The extraction operator in CSR format is copied directly, e.g. from a memory-mapped binary input
+     */
+    virtual void AssignGeometryData(
+        const ValuesContainerType& Knots1, //not used
+        const ValuesContainerType& Knots2, //not used
+        const ValuesContainerType& Knots3, //not used
+        const ValuesContainerType& Weights,
+        const CompressedExtractionOperator& ExtractionOperator,
+        const int& Degree1,
+        const int& Degree2,
+        const int& Degree3,
+        const int& NumberOfIntegrationMethod
+    )
+    {
+        this->AssignGeometryData_(Knots1, Knots2, Knots3, Weights, ExtractionOperator,
+                Degree1, Degree2, Degree3, NumberOfIntegrationMethod);
+    }
+
+protected:
+
+    /**
+     * there are no protected class members
+     */
+
+    GeometryData::Pointer mpBezierGeometryData;
+    #ifdef ENABLE_PRECOMPUTE
+    GeometryData::Pointer mpGeometryData;
+    #endif
+
+    CompressedExtractionOperator mExtractionOperator;
+
+    ValuesContainerType mCtrlWeights; //weight of control points
+
+    VectorType mBezierWeights; //weight of Bezier control points, i.e. trans(C) * w
+
+    bool mIsCached; //flag to indicate the shape functions values and local gradients at integration points are cached
+    std::size_t mCacheSize; //number of bytes of the cache accounted in the BezierUtils memory budget
+    ShapeFunctionsValuesContainerType mCachedShapeFunctionsValues;
+    ShapeFunctionsLocalGradientsContainerType mCachedShapeFunctionsLocalGradients;
+
+    int mOrder1; //order of the surface at parametric direction 1
+    int mOrder2; //order of the surface at parametric direction 2
+    int mOrder3; //order of the surface at parametric direction 3
+
+    int mNumber1; //number of bezier shape functions define the surface on parametric direction 1
+    int mNumber2; //number of bezier shape functions define the surface on parametric direction 2
+    int mNumber3; //number of bezier shape functions define the surface on parametric direction 3
+
+    /**
+     * Implementation of AssignGeometryData for dense and compressed extraction operator
+     */
+    template<class TMatrixType>
+    void AssignGeometryData_(
+        const ValuesContainerType& Knots1, //not used
+        const ValuesContainerType& Knots2, //not used
+        const ValuesContainerType& Knots3, //not used
+        const ValuesContainerType& Weights,
+        const TMatrixType& ExtractionOperator,
+        const int& Degree1,
+        const int& Degree2,
+        const int& Degree3,
+        const int& NumberOfIntegrationMethod
+    )
     {
         mCtrlWeights = Weights;
         mOrder1 = Degree1;
@@ -1423,7 +1509,7 @@ public:
         mNumber1 = mOrder1 + 1;
         mNumber2 = mOrder2 + 1;
         mNumber3 = mOrder3 + 1;
-        mExtractionOperator = ExtractionOperator;
+        mExtractionOperator.Assign(ExtractionOperator);
 
         // size checking
         if(mExtractionOperator.size1() != this->PointsNumber())
@@ -1460,6 +1546,8 @@ public:
             ShapeFunctionsValuesContainerType shape_functions_values;
             ShapeFunctionsLocalGradientsContainerType shape_functions_local_gradients;
 
+            mBezierWeights.resize(mExtractionOperator.size2(), false);
+            mExtractionOperator.TransProd(mBezierWeights, mCtrlWeights);
             for(IndexType i = 0; i < NumberOfIntegrationMethod; ++i)
             {
                 CalculateShapeFunctionsIntegrationPointsValuesAndLocalGradients(
@@ -1484,30 +1572,93 @@ public:
             GeometryType::mpGeometryData = &(*mpGeometryData);
             #endif
         }
-    }
 
-protected:
+        // the weights have changed, hence the cache must be re-computed
+        this->UpdateCache();
+    }
 
     /**
-     * there are no protected class members
+     * Compute the Bezier weights and, if enabled in BezierUtils and the memory budget allows, the shape functions values
+     * and local gradients at the integration points of all registered integration rules.
+     * It must be called whenever the control weights or the extraction operator change.
      */
+    void UpdateCache()
+    {
+        this->ClearCache();
 
-    GeometryData::Pointer mpBezierGeometryData;
-    #ifdef ENABLE_PRECOMPUTE
-    GeometryData::Pointer mpGeometryData;
-    #endif
+        mBezierWeights.resize(mExtractionOperator.size2(), false);
+        mExtractionOperator.TransProd(mBezierWeights, mCtrlWeights);
 
-    MatrixType mExtractionOperator;
+        if (!BezierUtils::IsGeometryCacheEnabled() || mpBezierGeometryData == NULL)
+            return;
 
-    ValuesContainerType mCtrlWeights; //weight of control points
+        SizeType NumberOfIntegrationPoints = 0;
+        for (IndexType i = 0; i < GeometryData::NumberOfIntegrationMethods; ++i)
+            NumberOfIntegrationPoints += mpBezierGeometryData->IntegrationPointsNumber(static_cast<IntegrationMethod>(i));
 
-    int mOrder1; //order of the surface at parametric direction 1
-    int mOrder2; //order of the surface at parametric direction 2
-    int mOrder3; //order of the surface at parametric direction 3
+        std::size_t CacheSize = NumberOfIntegrationPoints * this->PointsNumber() * 4 * sizeof(double);
+        if (!BezierUtils::AcquireGeometryCacheMemory(CacheSize))
+            return;
+        mCacheSize = CacheSize;
 
-    int mNumber1; //number of bezier shape functions define the surface on parametric direction 1
-    int mNumber2; //number of bezier shape functions define the surface on parametric direction 2
-    int mNumber3; //number of bezier shape functions define the surface on parametric direction 3
+        for (IndexType i = 0; i < GeometryData::NumberOfIntegrationMethods; ++i)
+        {
+            IntegrationMethod ThisMethod = static_cast<IntegrationMethod>(i);
+            if (mpBezierGeometryData->IntegrationPointsNumber(ThisMethod) > 0)
+                this->CalculateShapeFunctionsIntegrationPointsValuesAndLocalGradients(
+                    mCachedShapeFunctionsValues[i],
+                    mCachedShapeFunctionsLocalGradients[i],
+                    ThisMethod
+                );
+        }
+
+        mIsCached = true;
+    }
+
+    /**
+     * Clear the cache and release its memory from the BezierUtils memory budget
+     */
+    void ClearCache()
+    {
+        if (mIsCached)
+        {
+            for (IndexType i = 0; i < GeometryData::NumberOfIntegrationMethods; ++i)
+            {
+                mCachedShapeFunctionsValues[i].resize(0, 0, false);
+                mCachedShapeFunctionsLocalGradients[i].resize(0);
+            }
+            mIsCached = false;
+        }
+
+        if (mCacheSize > 0)
+        {
+            BezierUtils::ReleaseGeometryCacheMemory(mCacheSize);
+            mCacheSize = 0;
+        }
+    }
+
+    /**
+     * Get the shape functions local gradients at the integration points of an integration method.
+     * If the geometry is cached, the reference to the cache is returned. Otherwise the local gradients
+     * are computed in rTempLocalGradients.
+     */
+    const ShapeFunctionsGradientsType& IntegrationPointsLocalGradients(
+        ShapeFunctionsGradientsType& rTempLocalGradients,
+        IntegrationMethod ThisMethod
+    ) const
+    {
+        if (mIsCached)
+            return mCachedShapeFunctionsLocalGradients[ThisMethod];
+
+        MatrixType shape_functions_values;
+        this->CalculateShapeFunctionsIntegrationPointsValuesAndLocalGradients(
+            shape_functions_values,
+            rTempLocalGradients,
+            ThisMethod
+        );
+
+        return rTempLocalGradients;
+    }
 
 private:
 
@@ -1606,7 +1757,7 @@ private:
         }
 
         //compute the Bezier weight
-        VectorType bezier_weights = prod(trans(mExtractionOperator), mCtrlWeights);
+        const VectorType& bezier_weights = mBezierWeights;
         double denom = inner_prod(bezier_functions_values, bezier_weights);
 
         //compute the shape function values
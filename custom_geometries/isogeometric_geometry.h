@@ -72,6 +72,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "utilities/math_utils.h"
 #include "integration/quadrature.h"
 #include "integration/line_gauss_legendre_integration_points.h"
+#include "custom_utilities/compressed_extraction_operator.h"
 
 
 namespace Kratos
@@ -236,6 +237,11 @@ public:
      */
     typedef Matrix MatrixType;
 
+    /**
+     * Type of compressed Matrix
+     */
+    typedef boost::numeric::ublas::compressed_matrix<typename MatrixType::value_type> CompressedMatrixType;
+
     /**
      * Type of Vector
      */
@@ -466,6 +472,46 @@ public:
         KRATOS_THROW_ERROR(std::logic_error, "Calling IsogeometricGeometry base class function", __FUNCTION__)
     }
 
+    /**
+     * Subroutine to pass in the data to the Bezier element, with the extraction operator in compressed form.
+     * By default the extraction operator is converted to dense matrix. The Bezier geometries override this to keep the sparse structure.
+     */
+    virtual void AssignGeometryData(
+        const ValuesContainerType& Knots1,
+        const ValuesContainerType& Knots2,
+        const ValuesContainerType& Knots3,
+        const ValuesContainerType& Weights,
+        const CompressedMatrixType& ExtractionOperator,
+        const int& Degree1,
+        const int& Degree2,
+        const int& Degree3,
+        const int& NumberOfIntegrationMethod)
+    {
+        MatrixType DenseExtractionOperator = ExtractionOperator;
+        this->AssignGeometryData(Knots1, Knots2, Knots3, Weights, DenseExtractionOperator,
+                Degree1, Degree2, Degree3, NumberOfIntegrationMethod);
+    }
+
+    /**
+     * Subroutine to pass in the data to the Bezier element, with the extraction operator given by its CSR arrays.
+     * By default the extraction operator is converted to dense matrix. The Bezier geometries override this to copy the CSR arrays directly.
+     */
+    virtual void AssignGeometryData(
+        const ValuesContainerType& Knots1,
+        const ValuesContainerType& Knots2,
+        const ValuesContainerType& Knots3,
+        const ValuesContainerType& Weights,
+        const CompressedExtractionOperator& ExtractionOperator,
+        const int& Degree1,
+        const int& Degree2,
+        const int& Degree3,
+        const int& NumberOfIntegrationMethod)
+    {
+        MatrixType DenseExtractionOperator = ExtractionOperator.ToMatrix();
+        this->AssignGeometryData(Knots1, Knots2, Knots3, Weights, DenseExtractionOperator,
+                Degree1, Degree2, Degree3, NumberOfIntegrationMethod);
+    }
+
     /**
      * lumping factors for the calculation of the lumped mass matrix
      */
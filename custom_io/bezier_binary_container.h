@@ -0,0 +1,506 @@
+//
+//   Project Name:        Kratos
+//   Last Modified by:    $Author: hbui $
+//   Date:                $Date: 17 Oct 2026 $
+//   Revision:            $Revision: 1.0 $
+//
+//
+
+#if !defined(KRATOS_BEZIER_BINARY_CONTAINER_H_INCLUDED )
+#define  KRATOS_BEZIER_BINARY_CONTAINER_H_INCLUDED
+
+// System includes
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <cstring>
+#include <stdint.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define KRATOS_BEZIER_BINARY_CONTAINER_USE_MMAP
+#endif
+
+// External includes
+
+// Project includes
+#include "includes/define.h"
+#include "custom_utilities/compressed_extraction_operator.h"
+
+namespace Kratos
+{
+
+/**
+ * Binary layout of the heavy data of a Bezier model part, i.e. the nodes, the Bezier geometries (control weights and
+ * extraction operators in CSR format) and the elements/conditions with geometry. Every section is a contiguous array of
+ * 8-byte words, stored in the order:
+ *      Header | node ids | node coordinates (x, y, z) | geometries | weights | row pointers | column indices | values
+ *             | groups | entities | connectivities
+ * hence the file can be memory-mapped and every array is accessed in place.
+ * The row pointers of each geometry start at zero and are relative to the column indices/values offset of that geometry.
+ */
+struct BezierBinaryLayout
+{
+    typedef uint64_t WordType;
+
+    static const WordType Version = 1;
+    static const WordType ByteOrderMark = 0x0102030405060708ULL;
+
+    enum EntityType {ELEMENT = 0, CONDITION = 1};
+
+    struct Header
+    {
+        char Magic[8];
+        WordType Version;
+        WordType ByteOrder;
+        WordType NumberOfNodes;
+        WordType NumberOfGeometries;
+        WordType NumberOfWeights;
+        WordType NumberOfRowPointers;
+        WordType NumberOfNonZeros;
+        WordType NumberOfGroups;
+        WordType NumberOfEntities;
+        WordType NumberOfConnectivities;
+    };
+
+    struct GeometryRecord
+    {
+        WordType Id;
+        WordType NumberOfNodes;
+        int64_t LocalSpaceDim;
+        int64_t GlobalSpaceDim;
+        int64_t Degree1;
+        int64_t Degree2;
+        int64_t Degree3;
+        WordType Size1; // number of rows of the extraction operator
+        WordType Size2; // number of columns of the extraction operator
+        WordType WeightsOffset;
+        WordType RowPtrOffset;
+        WordType NonZerosOffset;
+    };
+
+    struct GroupRecord
+    {
+        char Name[128]; // name of the registered element/condition
+        WordType Type;
+        WordType EntitiesOffset;
+        WordType NumberOfEntities;
+    };
+
+    struct EntityRecord
+    {
+        WordType Id;
+        WordType PropertiesId;
+        WordType GeometryIndex; // index of the geometry record, not the geometry id
+        WordType ConnectivitiesOffset;
+    };
+
+    static const char* Magic() {return "KRBEZBIN";}
+
+    /// Compute the byte offsets of the sections and the total size of the file from the header
+    static WordType ComputeOffsets(const Header& rHeader, std::vector<WordType>& rOffsets)
+    {
+        const WordType sizes[] = {
+            rHeader.NumberOfNodes * sizeof(WordType),
+            rHeader.NumberOfNodes * 3 * sizeof(double),
+            rHeader.NumberOfGeometries * sizeof(GeometryRecord),
+            rHeader.NumberOfWeights * sizeof(double),
+            rHeader.NumberOfRowPointers * sizeof(WordType),
+            rHeader.NumberOfNonZeros * sizeof(WordType),
+            rHeader.NumberOfNonZeros * sizeof(double),
+            rHeader.NumberOfGroups * sizeof(GroupRecord),
+            rHeader.NumberOfEntities * sizeof(EntityRecord),
+            rHeader.NumberOfConnectivities * sizeof(WordType)
+        };
+        const std::size_t nsections = sizeof(sizes) / sizeof(WordType);
+
+        rOffsets.resize(nsections);
+        WordType offset = sizeof(Header);
+        for (std::size_t i = 0; i < nsections; ++i)
+        {
+            rOffsets[i] = offset;
+            offset += sizes[i];
+        }
+        return offset;
+    }
+};
+
+/**
+ * Collect the heavy data of a Bezier model part and write it in the binary layout.
+ * This is used by the converter from the mdpa Bezier blocks.
+ */
+class BezierBinaryWriter
+{
+public:
+    KRATOS_CLASS_POINTER_DEFINITION(BezierBinaryWriter);
+
+    typedef BezierBinaryLayout::WordType WordType;
+
+    BezierBinaryWriter()
+    {}
+
+    virtual ~BezierBinaryWriter()
+    {}
+
+    void AddNode(const std::size_t& Id, const double& X, const double& Y, const double& Z)
+    {
+        mNodeIds.push_back(Id);
+        mNodeCoordinates.push_back(X);
+        mNodeCoordinates.push_back(Y);
+        mNodeCoordinates.push_back(Z);
+    }
+
+    template<class TVectorType>
+    void AddGeometry(const std::size_t& Id, const std::size_t& NumberOfNodes, const int& LocalSpaceDim, const int& GlobalSpaceDim,
+            const int& Degree1, const int& Degree2, const int& Degree3,
+            const TVectorType& rWeights, const CompressedExtractionOperator& rExtractionOperator)
+    {
+        if (mGeometryIndex.find(Id) != mGeometryIndex.end())
+            KRATOS_THROW_ERROR(std::logic_error, "Duplicated Bezier geometry", Id)
+
+        BezierBinaryLayout::GeometryRecord record;
+        record.Id = Id;
+        record.NumberOfNodes = NumberOfNodes;
+        record.LocalSpaceDim = LocalSpaceDim;
+        record.GlobalSpaceDim = GlobalSpaceDim;
+        record.Degree1 = Degree1;
+        record.Degree2 = Degree2;
+        record.Degree3 = Degree3;
+        record.Size1 = rExtractionOperator.size1();
+        record.Size2 = rExtractionOperator.size2();
+        record.WeightsOffset = mWeights.size();
+        record.RowPtrOffset = mRowPtr.size();
+        record.NonZerosOffset = mColInd.size();
+
+        for (std::size_t i = 0; i < rWeights.size(); ++i)
+            mWeights.push_back(rWeights[i]);
+        mRowPtr.insert(mRowPtr.end(), rExtractionOperator.index1_data().begin(), rExtractionOperator.index1_data().end());
+        mColInd.insert(mColInd.end(), rExtractionOperator.index2_data().begin(), rExtractionOperator.index2_data().end());
+        mValues.insert(mValues.end(), rExtractionOperator.value_data().begin(), rExtractionOperator.value_data().end());
+
+        mGeometryIndex[Id] = mGeometries.size();
+        mGeometries.push_back(record);
+    }
+
+    /// Start a new group of elements or conditions. The following entities are added to this group.
+    void AddGroup(const std::string& Name, const BezierBinaryLayout::EntityType& Type)
+    {
+        BezierBinaryLayout::GroupRecord record;
+        if (Name.size() >= sizeof(record.Name))
+            KRATOS_THROW_ERROR(std::logic_error, "The entity name is too long:", Name)
+        std::memset(record.Name, 0, sizeof(record.Name));
+        std::strcpy(record.Name, Name.c_str());
+        record.Type = Type;
+        record.EntitiesOffset = mEntities.size();
+        record.NumberOfEntities = 0;
+        mGroups.push_back(record);
+    }
+
+    template<class TIndexContainerType>
+    void AddEntity(const std::size_t& Id, const std::size_t& PropertiesId, const std::size_t& GeometryId, const TIndexContainerType& rNodeIds)
+    {
+        if (mGroups.size() == 0)
+            KRATOS_THROW_ERROR(std::logic_error, "No group is added before entity", Id)
+
+        std::map<WordType, WordType>::const_iterator it = mGeometryIndex.find(GeometryId);
+        if (it == mGeometryIndex.end())
+            KRATOS_THROW_ERROR(std::logic_error, "The Bezier geometry is not found:", GeometryId)
+        if (rNodeIds.size() != mGeometries[it->second].NumberOfNodes)
+            KRATOS_THROW_ERROR(std::logic_error, "The number of nodes does not match the Bezier geometry at entity", Id)
+
+        BezierBinaryLayout::EntityRecord record;
+        record.Id = Id;
+        record.PropertiesId = PropertiesId;
+        record.GeometryIndex = it->second;
+        record.ConnectivitiesOffset = mConnectivities.size();
+        mConnectivities.insert(mConnectivities.end(), rNodeIds.begin(), rNodeIds.end());
+
+        mEntities.push_back(record);
+        ++mGroups.back().NumberOfEntities;
+    }
+
+    /// Get the number of nodes of a geometry added before
+    std::size_t GetGeometryNumberOfNodes(const std::size_t& GeometryId) const
+    {
+        std::map<WordType, WordType>::const_iterator it = mGeometryIndex.find(GeometryId);
+        if (it == mGeometryIndex.end())
+            KRATOS_THROW_ERROR(std::logic_error, "The Bezier geometry is not found:", GeometryId)
+        return mGeometries[it->second].NumberOfNodes;
+    }
+
+    std::size_t NumberOfNodes() const {return mNodeIds.size();}
+    std::size_t NumberOfGeometries() const {return mGeometries.size();}
+    std::size_t NumberOfEntities() const {return mEntities.size();}
+
+    void Write(const std::string& rFilename) const
+    {
+        BezierBinaryLayout::Header header;
+        std::memcpy(header.Magic, BezierBinaryLayout::Magic(), sizeof(header.Magic));
+        header.Version = BezierBinaryLayout::Version;
+        header.ByteOrder = BezierBinaryLayout::ByteOrderMark;
+        header.NumberOfNodes = mNodeIds.size();
+        header.NumberOfGeometries = mGeometries.size();
+        header.NumberOfWeights = mWeights.size();
+        header.NumberOfRowPointers = mRowPtr.size();
+        header.NumberOfNonZeros = mValues.size();
+        header.NumberOfGroups = mGroups.size();
+        header.NumberOfEntities = mEntities.size();
+        header.NumberOfConnectivities = mConnectivities.size();
+
+        std::ofstream outfile(rFilename.c_str(), std::ios::out | std::ios::binary);
+        if (!outfile)
+            KRATOS_THROW_ERROR(std::runtime_error, "Error opening output file", rFilename)
+
+        outfile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        WriteArray(outfile, mNodeIds);
+        WriteArray(outfile, mNodeCoordinates);
+        WriteArray(outfile, mGeometries);
+        WriteArray(outfile, mWeights);
+        WriteArray(outfile, mRowPtr);
+        WriteArray(outfile, mColInd);
+        WriteArray(outfile, mValues);
+        WriteArray(outfile, mGroups);
+        WriteArray(outfile, mEntities);
+        WriteArray(outfile, mConnectivities);
+
+        if (!outfile)
+            KRATOS_THROW_ERROR(std::runtime_error, "Error writing output file", rFilename)
+        outfile.close();
+    }
+
+private:
+
+    std::vector<WordType> mNodeIds;
+    std::vector<double> mNodeCoordinates;
+    std::vector<BezierBinaryLayout::GeometryRecord> mGeometries;
+    std::vector<double> mWeights;
+    std::vector<WordType> mRowPtr;
+    std::vector<WordType> mColInd;
+    std::vector<double> mValues;
+    std::vector<BezierBinaryLayout::GroupRecord> mGroups;
+    std::vector<BezierBinaryLayout::EntityRecord> mEntities;
+    std::vector<WordType> mConnectivities;
+    std::map<WordType, WordType> mGeometryIndex;
+
+    template<class TDataType>
+    static void WriteArray(std::ofstream& rOStream, const std::vector<TDataType>& rArray)
+    {
+        if (rArray.size() != 0)
+            rOStream.write(reinterpret_cast<const char*>(&rArray[0]), rArray.size() * sizeof(TDataType));
+    }
+};
+
+/**
+ * Read-only access to a binary Bezier container. On POSIX systems the file is memory-mapped, otherwise it is read
+ * into memory in one go. The arrays are returned as pointers into the mapped region, hence no parsing takes place
+ * and the data is only paged in when accessed. The pointers are valid until the container is closed or destroyed.
+ */
+class BezierBinaryContainer
+{
+public:
+    KRATOS_CLASS_POINTER_DEFINITION(BezierBinaryContainer);
+
+    typedef BezierBinaryLayout::WordType WordType;
+    typedef BezierBinaryLayout::Header HeaderType;
+    typedef BezierBinaryLayout::GeometryRecord GeometryRecordType;
+    typedef BezierBinaryLayout::GroupRecord GroupRecordType;
+    typedef BezierBinaryLayout::EntityRecord EntityRecordType;
+
+    BezierBinaryContainer() : mpData(NULL), mSize(0), mIsMapped(false)
+    {}
+
+    BezierBinaryContainer(const std::string& rFilename) : mpData(NULL), mSize(0), mIsMapped(false)
+    {
+        this->Open(rFilename);
+    }
+
+    virtual ~BezierBinaryContainer()
+    {
+        this->Close();
+    }
+
+    void Open(const std::string& rFilename)
+    {
+        this->Close();
+
+        #ifdef KRATOS_BEZIER_BINARY_CONTAINER_USE_MMAP
+        int fd = open(rFilename.c_str(), O_RDONLY);
+        if (fd < 0)
+            KRATOS_THROW_ERROR(std::runtime_error, "Error opening input file", rFilename)
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            close(fd);
+            KRATOS_THROW_ERROR(std::runtime_error, "Error reading the size of input file", rFilename)
+        }
+        mSize = st.st_size;
+        if (mSize != 0)
+        {
+            void* p = mmap(NULL, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED)
+            {
+                close(fd);
+                KRATOS_THROW_ERROR(std::runtime_error, "Error mapping input file", rFilename)
+            }
+            // the sections are traversed from the beginning to the end during reading
+            madvise(p, mSize, MADV_SEQUENTIAL);
+            mpData = static_cast<const char*>(p);
+            mIsMapped = true;
+        }
+        close(fd); // the mapping stays valid after closing the descriptor
+        #else
+        std::ifstream infile(rFilename.c_str(), std::ios::in | std::ios::binary);
+        if (!infile)
+            KRATOS_THROW_ERROR(std::runtime_error, "Error opening input file", rFilename)
+        infile.seekg(0, std::ios::end);
+        mSize = infile.tellg();
+        infile.seekg(0, std::ios::beg);
+        // a buffer of 8-byte words keeps the sections aligned
+        mBuffer.resize((mSize + sizeof(WordType) - 1) / sizeof(WordType));
+        if (mSize != 0)
+        {
+            infile.read(reinterpret_cast<char*>(&mBuffer[0]), mSize);
+            if (!infile)
+                KRATOS_THROW_ERROR(std::runtime_error, "Error reading input file", rFilename)
+            mpData = reinterpret_cast<const char*>(&mBuffer[0]);
+        }
+        #endif
+
+        // a rejected file is released here, since the destructor is not called if the constructor throws
+        try
+        {
+            this->Check(rFilename);
+        }
+        catch (...)
+        {
+            this->Close();
+            throw;
+        }
+    }
+
+    void Close()
+    {
+        #ifdef KRATOS_BEZIER_BINARY_CONTAINER_USE_MMAP
+        if (mIsMapped)
+            munmap(const_cast<char*>(mpData), mSize);
+        #endif
+        mBuffer.clear();
+        mpData = NULL;
+        mSize = 0;
+        mIsMapped = false;
+    }
+
+    bool IsOpen() const {return mpData != NULL;}
+
+    const HeaderType& GetHeader() const {return *reinterpret_cast<const HeaderType*>(mpData);}
+
+    std::size_t NumberOfNodes() const {return GetHeader().NumberOfNodes;}
+    std::size_t NumberOfGeometries() const {return GetHeader().NumberOfGeometries;}
+    std::size_t NumberOfGroups() const {return GetHeader().NumberOfGroups;}
+    std::size_t NumberOfEntities() const {return GetHeader().NumberOfEntities;}
+
+    const WordType* NodeIds() const {return Section<WordType>(0);}
+    const double* NodeCoordinates() const {return Section<double>(1);}
+    const GeometryRecordType& Geometry(const std::size_t& i) const {return Section<GeometryRecordType>(2)[i];}
+    const GroupRecordType& Group(const std::size_t& i) const {return Section<GroupRecordType>(7)[i];}
+    const EntityRecordType& Entity(const std::size_t& i) const {return Section<EntityRecordType>(8)[i];}
+
+    /// Get the control weights of a geometry
+    const double* Weights(const GeometryRecordType& rGeometry) const {return Section<double>(3) + rGeometry.WeightsOffset;}
+
+    /// Get the node ids of an entity. The number of nodes is given by its geometry.
+    const WordType* Connectivities(const EntityRecordType& rEntity) const {return Section<WordType>(9) + rEntity.ConnectivitiesOffset;}
+
+    /// Assign the CSR extraction operator of a geometry
+    void GetExtractionOperator(const GeometryRecordType& rGeometry, CompressedExtractionOperator& rC) const
+    {
+        rC.Assign(rGeometry.Size1, rGeometry.Size2,
+                Section<WordType>(4) + rGeometry.RowPtrOffset,
+                Section<WordType>(5) + rGeometry.NonZerosOffset,
+                Section<double>(6) + rGeometry.NonZerosOffset);
+    }
+
+private:
+
+    const char* mpData;
+    std::size_t mSize;
+    bool mIsMapped;
+    std::vector<WordType> mBuffer;
+    std::vector<WordType> mOffsets;
+
+    template<class TDataType>
+    const TDataType* Section(const std::size_t& i) const
+    {
+        return reinterpret_cast<const TDataType*>(mpData + mOffsets[i]);
+    }
+
+    /// Check the header and the ranges of all the offsets, so that the accessors never read past the end of the file
+    void Check(const std::string& rFilename)
+    {
+        if (mSize < sizeof(HeaderType))
+            KRATOS_THROW_ERROR(std::runtime_error, "The input file is too small to be a binary Bezier container:", rFilename)
+
+        const HeaderType& header = GetHeader();
+        if (std::memcmp(header.Magic, BezierBinaryLayout::Magic(), sizeof(header.Magic)) != 0)
+            KRATOS_THROW_ERROR(std::runtime_error, "The input file is not a binary Bezier container:", rFilename)
+        if (header.ByteOrder != BezierBinaryLayout::ByteOrderMark)
+            KRATOS_THROW_ERROR(std::runtime_error, "The binary Bezier container was written with a different byte order:", rFilename)
+        if (header.Version != BezierBinaryLayout::Version)
+            KRATOS_THROW_ERROR(std::runtime_error, "Unsupported version of binary Bezier container:", header.Version)
+        if (BezierBinaryLayout::ComputeOffsets(header, mOffsets) != mSize)
+            KRATOS_THROW_ERROR(std::runtime_error, "The size of the binary Bezier container does not match its header:", rFilename)
+
+        // the CSR views handed out by GetExtractionOperator are not checked again, hence the row pointers must start at
+        // zero, be monotone and end inside the non-zeros, and the column indices must be smaller than Size2
+        const WordType* rowptr = Section<WordType>(4);
+        const WordType* colind = Section<WordType>(5);
+        for (std::size_t i = 0; i < header.NumberOfGeometries; ++i)
+        {
+            const GeometryRecordType& r = Geometry(i);
+            if (r.WeightsOffset + r.NumberOfNodes > header.NumberOfWeights
+             || r.RowPtrOffset + r.Size1 + 1 > header.NumberOfRowPointers)
+                KRATOS_THROW_ERROR(std::runtime_error, "Corrupted binary Bezier container at geometry", r.Id)
+
+            const WordType* r_rowptr = rowptr + r.RowPtrOffset;
+            if (r_rowptr[0] != 0)
+                KRATOS_THROW_ERROR(std::runtime_error, "Corrupted binary Bezier container at geometry", r.Id)
+            for (std::size_t row = 0; row < r.Size1; ++row)
+                if (r_rowptr[row + 1] < r_rowptr[row])
+                    KRATOS_THROW_ERROR(std::runtime_error, "Corrupted binary Bezier container at geometry", r.Id)
+
+            const WordType nnz = r_rowptr[r.Size1];
+            if (r.NonZerosOffset > header.NumberOfNonZeros || nnz > header.NumberOfNonZeros - r.NonZerosOffset)
+                KRATOS_THROW_ERROR(std::runtime_error, "Corrupted binary Bezier container at geometry", r.Id)
+            for (std::size_t k = 0; k < nnz; ++k)
+                if (colind[r.NonZerosOffset + k] >= r.Size2)
+                    KRATOS_THROW_ERROR(std::runtime_error, "Corrupted binary Bezier container at geometry", r.Id)
+        }
+
+        for (std::size_t i = 0; i < header.NumberOfGroups; ++i)
+        {
+            const GroupRecordType& r = Group(i);
+            if (r.EntitiesOffset + r.NumberOfEntities > header.NumberOfEntities || r.Name[sizeof(r.Name) - 1] != '\0')
+                KRATOS_THROW_ERROR(std::runtime_error, "Corrupted binary Bezier container at group", i)
+        }
+
+        for (std::size_t i = 0; i < header.NumberOfEntities; ++i)
+        {
+            const EntityRecordType& r = Entity(i);
+            if (r.GeometryIndex >= header.NumberOfGeometries
+             || r.ConnectivitiesOffset + Geometry(r.GeometryIndex).NumberOfNodes > header.NumberOfConnectivities)
+                KRATOS_THROW_ERROR(std::runtime_error, "Corrupted binary Bezier container at entity", r.Id)
+        }
+    }
+
+    /// Assignment operator and copy constructor are not allowed, since the container owns the mapping
+    BezierBinaryContainer& operator=(const BezierBinaryContainer& rOther);
+    BezierBinaryContainer(const BezierBinaryContainer& rOther);
+};
+
+}// namespace Kratos.
+
+#endif // KRATOS_BEZIER_BINARY_CONTAINER_H_INCLUDED
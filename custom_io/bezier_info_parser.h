@@ -0,0 +1,363 @@
+//
+//   Project Name:        Kratos
+//   Last Modified by:    $Author: hbui $
+//   Date:                $Date: 17 Oct 2026 $
+//   Revision:            $Revision: 1.0 $
+//
+//
+
+#if !defined(KRATOS_BEZIER_INFO_PARSER_H_INCLUDED )
+#define  KRATOS_BEZIER_INFO_PARSER_H_INCLUDED
+
+// System includes
+#include <string>
+#include <vector>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+// External includes
+
+// Project includes
+#include "includes/define.h"
+#include "utilities/openmp_utils.h"
+#include "custom_io/bezier_model_part_io.h"
+#include "custom_utilities/isogeometric_math_utils.h"
+
+namespace Kratos
+{
+
+/**
+ * Parser of the records of an IsogeometricBezierData block held in a text buffer. The records are first located by a
+ * cheap structural scan, which only skips tokens and balanced brackets. They are then parsed independently, hence in
+ * parallel. The syntax and the conversions of the extraction operator are the same as in BezierModelPartIO, i.e.
+ *      id n local_space_dim global_space_dim p1 p2 p3 [n](weights) Full|MCSR|CSR extraction_operator
+ * where the extraction operator is one matrix value for Full and MCSR, and three vector values (row pointers,
+ * column indices, values) for CSR.
+ */
+class BezierInfoParser
+{
+public:
+    typedef BezierModelPartIO::BezierInfoContainerType BezierInfoContainerType;
+
+    /// Maximum size of the text buffer before the complete records in it are parsed
+    static const std::size_t BatchSize = 1 << 26;
+
+    /// Locate the records in [Begin, End). The offsets of the records are appended to rOffsets and the offset after
+    /// the last complete record is returned. The remaining text, if any, is an incomplete record.
+    static std::size_t SplitRecords(const char* Begin, const char* End, std::vector<std::size_t>& rOffsets)
+    {
+        const char* p = Begin;
+        while(true)
+        {
+            SkipSpaces(p, End);
+            if(p == End)
+                break;
+
+            const char* q = p;
+            bool is_complete = true;
+            for(int i = 0; i < 7 && is_complete; ++i)
+                is_complete = SkipToken(q, End);
+            is_complete = is_complete && SkipValue(q, End);
+
+            const char* word_begin = q;
+            is_complete = is_complete && SkipToken(q, End);
+            if(!is_complete)
+                break;
+
+            SkipSpaces(word_begin, q);
+            const std::string word(word_begin, q);
+            int number_of_values;
+            if(word == "Full" || word == "MCSR")
+                number_of_values = 1;
+            else if(word == "CSR")
+                number_of_values = 3;
+            else
+                KRATOS_THROW_ERROR(std::logic_error, "Invalid matrix type", word)
+
+            for(int i = 0; i < number_of_values && is_complete; ++i)
+                is_complete = SkipValue(q, End);
+            if(!is_complete)
+                break;
+
+            rOffsets.push_back(p - Begin);
+            p = q;
+        }
+        return p - Begin;
+    }
+
+    /// Parse one record in [Begin, End)
+    static BezierInfo::Pointer ParseRecord(const char* Begin, const char* End)
+    {
+        const char* p = Begin;
+
+        BezierInfo::Pointer p_temp_info = BezierInfo::Pointer(new BezierInfo());
+        p_temp_info->SetId(ReadUnsigned(p, End));
+        p_temp_info->n = ReadUnsigned(p, End);
+        p_temp_info->local_space_dim = ReadInteger(p, End);
+        p_temp_info->global_space_dim = ReadInteger(p, End);
+        p_temp_info->p1 = ReadInteger(p, End);
+        p_temp_info->p2 = ReadInteger(p, End);
+        p_temp_info->p3 = ReadInteger(p, End);
+
+        ReadVector(p, End, p_temp_info->weights);
+
+        SkipSpaces(p, End);
+        const char* word_begin = p;
+        SkipToken(p, End);
+        const std::string word(word_begin, p);
+        if(word == std::string("Full"))
+            p_temp_info->mat_type = 0;
+        else if(word == std::string("MCSR"))
+            p_temp_info->mat_type = 1;
+        else if(word == std::string("CSR"))
+            p_temp_info->mat_type = 2;
+        else
+            KRATOS_THROW_ERROR(std::logic_error, "Invalid matrix type", word)
+
+        if(p_temp_info->mat_type == 0)
+        {
+            ReadMatrix(p, End, p_temp_info->C);
+        }
+        else if(p_temp_info->mat_type == 1)
+        {
+            Matrix Temp;
+            ReadMatrix(p, End, Temp);
+            AssignMCSR(*p_temp_info, Temp);
+        }
+        else if(p_temp_info->mat_type == 2)
+        {
+            Vector rowPtr, colInd, values;
+            ReadVector(p, End, rowPtr);
+            ReadVector(p, End, colInd);
+            ReadVector(p, End, values);
+            p_temp_info->C = IsogeometricMathUtils::Triplet2CSR(rowPtr, colInd, values);
+        }
+
+        SkipSpaces(p, End);
+        if(p != End)
+            KRATOS_THROW_ERROR(std::logic_error, "Unexpected data after Bezier geometry", p_temp_info->Id())
+
+        return p_temp_info;
+    }
+
+    /// Parse the complete records in [Begin, End) in parallel and append them to rInfos in the order of the input.
+    /// The offset after the last complete record is returned.
+    static std::size_t ParseRecords(const char* Begin, const char* End, std::vector<BezierInfo::Pointer>& rInfos)
+    {
+        std::vector<std::size_t> offsets;
+        const std::size_t consumed = SplitRecords(Begin, End, offsets);
+        const std::size_t number_of_records = offsets.size();
+        offsets.push_back(consumed);
+
+        const std::size_t first = rInfos.size();
+        rInfos.resize(first + number_of_records);
+
+        int number_of_threads = OpenMPUtils::GetNumThreads();
+        std::vector<unsigned int> record_partition;
+        OpenMPUtils::CreatePartition(number_of_threads, number_of_records, record_partition);
+        std::vector<std::string> error_messages(number_of_threads);
+
+        #pragma omp parallel for
+        for(int k = 0; k < number_of_threads; ++k)
+        {
+            try
+            {
+                for(std::size_t i = record_partition[k]; i < record_partition[k + 1]; ++i)
+                    rInfos[first + i] = ParseRecord(Begin + offsets[i], Begin + offsets[i + 1]);
+            }
+            catch (std::exception& e)
+            {
+                error_messages[k] = e.what();
+            }
+        }
+
+        for(int k = 0; k < number_of_threads; ++k)
+            if(!error_messages[k].empty())
+                KRATOS_THROW_ERROR(std::runtime_error, error_messages[k], "")
+
+        return consumed;
+    }
+
+    /// Assign the extraction operator given in MCSR format. The storage scheme is chosen based on the ratio between
+    /// the number of non-zeros and the full size of the matrix.
+    static void AssignMCSR(BezierInfo& rInfo, const Matrix& Temp)
+    {
+        // check if the input is 2 rows
+        if(Temp.size1() != 2)
+            KRATOS_THROW_ERROR(std::logic_error, "Invalid MCSR matrix for extraction operator found at geometry", rInfo.Id())
+
+        unsigned int size_ex_n = (unsigned int)(Temp(0, 0) - 1);
+        unsigned int size_ex_nz = Temp.size2() - 1;
+        if( ( (double)(size_ex_nz) ) / (size_ex_n * size_ex_n) < 0.2 )
+            rInfo.C = IsogeometricMathUtils::MCSR2CSR(Temp);
+        else
+            rInfo.C = IsogeometricMathUtils::MCSR2MAT(Temp);
+    }
+
+    /// Insert the new Bezier geometries to the container at once. As PointerVectorSet::insert, a new geometry
+    /// replaces the existing one with the same id. This avoids the linear cost of inserting one by one.
+    static void Insert(BezierInfoContainerType& rThisBezierInfo, const std::vector<BezierInfo::Pointer>& rNewInfos)
+    {
+        std::vector<BezierInfo::Pointer> all_infos;
+        all_infos.reserve(rThisBezierInfo.size() + rNewInfos.size());
+        for(BezierInfoContainerType::ptr_iterator it = rThisBezierInfo.ptr_begin(); it != rThisBezierInfo.ptr_end(); ++it)
+            all_infos.push_back(*it);
+        all_infos.insert(all_infos.end(), rNewInfos.begin(), rNewInfos.end());
+
+        // the stable sort keeps the input order of the geometries with the same id, hence the last one is kept
+        std::stable_sort(all_infos.begin(), all_infos.end(), IdLess);
+
+        rThisBezierInfo.clear();
+        rThisBezierInfo.reserve(all_infos.size());
+        for(std::size_t i = 0; i < all_infos.size(); ++i)
+            if(i + 1 == all_infos.size() || all_infos[i + 1]->Id() != all_infos[i]->Id())
+                rThisBezierInfo.push_back(all_infos[i]);
+        rThisBezierInfo.Unique();
+    }
+
+private:
+
+    static bool IdLess(const BezierInfo::Pointer& p1, const BezierInfo::Pointer& p2)
+    {
+        return p1->Id() < p2->Id();
+    }
+
+    static void SkipSpaces(const char*& p, const char* End)
+    {
+        while(p != End && std::isspace(static_cast<unsigned char>(*p)))
+            ++p;
+    }
+
+    static bool SkipToken(const char*& p, const char* End)
+    {
+        SkipSpaces(p, End);
+        if(p == End)
+            return false;
+        while(p != End && !std::isspace(static_cast<unsigned char>(*p)))
+            ++p;
+        return true;
+    }
+
+    /// Skip a vectorial value, i.e. [size](...) with balanced parentheses
+    static bool SkipValue(const char*& p, const char* End)
+    {
+        SkipSpaces(p, End);
+        if(p == End)
+            return false;
+        if(*p != '[')
+            KRATOS_THROW_ERROR(std::logic_error, "Invalid Bezier data, expected [ but found", *p)
+        p = static_cast<const char*>(std::memchr(p, ']', End - p));
+        if(p == NULL)
+            return false;
+        ++p;
+
+        SkipSpaces(p, End);
+        if(p == End)
+            return false;
+        if(*p != '(')
+            KRATOS_THROW_ERROR(std::logic_error, "Invalid Bezier data, expected ( but found", *p)
+        int depth = 0;
+        while(p != End)
+        {
+            if(*p == '(')
+                ++depth;
+            else if(*p == ')' && --depth == 0)
+            {
+                ++p;
+                return true;
+            }
+            ++p;
+        }
+        return false;
+    }
+
+    static void Expect(const char*& p, const char* End, const char& c)
+    {
+        SkipSpaces(p, End);
+        if(p == End || *p != c)
+            KRATOS_THROW_ERROR(std::logic_error, "Invalid Bezier data, expected", c)
+        ++p;
+    }
+
+    static std::size_t ReadUnsigned(const char*& p, const char* End)
+    {
+        SkipSpaces(p, End);
+        char* q;
+        std::size_t value = std::strtoul(p, &q, 10);
+        if(q == p || q > End)
+            KRATOS_THROW_ERROR(std::logic_error, "Invalid Bezier data, expected an unsigned integer", "")
+        p = q;
+        return value;
+    }
+
+    static int ReadInteger(const char*& p, const char* End)
+    {
+        SkipSpaces(p, End);
+        char* q;
+        int value = static_cast<int>(std::strtol(p, &q, 10));
+        if(q == p || q > End)
+            KRATOS_THROW_ERROR(std::logic_error, "Invalid Bezier data, expected an integer", "")
+        p = q;
+        return value;
+    }
+
+    static double ReadDouble(const char*& p, const char* End)
+    {
+        SkipSpaces(p, End);
+        char* q;
+        double value = std::strtod(p, &q);
+        if(q == p || q > End)
+            KRATOS_THROW_ERROR(std::logic_error, "Invalid Bezier data, expected a real number", "")
+        p = q;
+        return value;
+    }
+
+    /// Read a vector in the form [n](v1, v2, ..., vn)
+    static void ReadVector(const char*& p, const char* End, Vector& rValue)
+    {
+        Expect(p, End, '[');
+        std::size_t size = ReadUnsigned(p, End);
+        Expect(p, End, ']');
+        rValue.resize(size, false);
+        Expect(p, End, '(');
+        for(std::size_t i = 0; i < size; ++i)
+        {
+            if(i != 0)
+                Expect(p, End, ',');
+            rValue[i] = ReadDouble(p, End);
+        }
+        Expect(p, End, ')');
+    }
+
+    /// Read a matrix in the form [m,n]((a11, ..., a1n), ..., (am1, ..., amn))
+    static void ReadMatrix(const char*& p, const char* End, Matrix& rValue)
+    {
+        Expect(p, End, '[');
+        std::size_t size1 = ReadUnsigned(p, End);
+        Expect(p, End, ',');
+        std::size_t size2 = ReadUnsigned(p, End);
+        Expect(p, End, ']');
+        rValue.resize(size1, size2, false);
+        Expect(p, End, '(');
+        for(std::size_t i = 0; i < size1; ++i)
+        {
+            if(i != 0)
+                Expect(p, End, ',');
+            Expect(p, End, '(');
+            for(std::size_t j = 0; j < size2; ++j)
+            {
+                if(j != 0)
+                    Expect(p, End, ',');
+                rValue(i, j) = ReadDouble(p, End);
+            }
+            Expect(p, End, ')');
+        }
+        Expect(p, End, ')');
+    }
+};
+
+}// namespace Kratos.
+
+#endif // KRATOS_BEZIER_INFO_PARSER_H_INCLUDED
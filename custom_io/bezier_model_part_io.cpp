@@ -47,6 +47,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 // Project includes
 #include "custom_io/bezier_model_part_io.h"
+#include "custom_io/bezier_info_parser.h"
 #include "custom_geometries/isogeometric_geometry.h"
 #include "custom_geometries/geo_1d_bezier.h"
 #include "custom_geometries/geo_2d_bezier.h"
@@ -60,6 +61,8 @@ namespace Kratos
 
     BezierModelPartIO::BezierModelPartIO(std::string const& Filename, const Flags Options)
     : ModelPartIO(Filename, Options)
+    , mInputFilename(Filename + ".mdpa")
+    , mParallelReading(false)
     , mpBezierInfoContainer(new BezierInfoContainerType())
     {}
 
@@ -98,6 +101,8 @@ namespace Kratos
                 ModelPartIO::ReadConditionsBlock(rThisModelPart);
             else if(word == "BezierBlock")
                 this->ReadBezierBlock(rThisModelPart);
+            else if(word == "BezierBinaryBlock")
+                this->ReadBezierBinaryBlock(rThisModelPart);
             else if(word == "NodalData")
                 ModelPartIO::ReadNodalDataBlock(rThisModelPart);
             else if(word == "ElementalData")
@@ -157,8 +162,14 @@ namespace Kratos
 
     void BezierModelPartIO::ReadIsogeometricBezierDataBlock(BezierInfoContainerType& rThisBezierInfo)
     {
+        if(mParallelReading)
+        {
+            this->ReadIsogeometricBezierDataBlockParallel(rThisBezierInfo);
+            return;
+        }
+
         std::string word;
-        SizeType number_of_geometries_read = 0;
+        std::vector<BezierInfo::Pointer> new_bezier_info;
 
         std::cout << "  [Reading Bezier Geometries : ";
 
@@ -216,18 +227,7 @@ namespace Kratos
             {
                 Matrix Temp;
                 Temp = ModelPartIO::ReadVectorialValue(Temp);
-
-                // check if the input is 2 rows
-                if(Temp.size1() != 2)
-                    KRATOS_THROW_ERROR(std::logic_error, "Invalid MCSR matrix for extraction operator found at geometry", p_temp_info->Id())
-
-                // choose the best storage scheme based ratio between number of nonzeros and the full size of the matrix
-                unsigned int size_ex_n = (unsigned int)(Temp(0, 0) - 1);
-                unsigned int size_ex_nz = Temp.size2() - 1;
-                if( ( (double)(size_ex_nz) ) / (size_ex_n * size_ex_n) < 0.2 )
-                    p_temp_info->C = IsogeometricMathUtils::MCSR2CSR(Temp);
-                else
-                    p_temp_info->C = IsogeometricMathUtils::MCSR2MAT(Temp);
+                BezierInfoParser::AssignMCSR(*p_temp_info, Temp);
             }
             else if(p_temp_info->mat_type == 2)
             {
@@ -240,12 +240,77 @@ namespace Kratos
                 p_temp_info->C = IsogeometricMathUtils::Triplet2CSR(rowPtr, colInd, values);
             }
 
-//            rThisBezierInfo.push_back(p_temp_info);
-            rThisBezierInfo.insert(rThisBezierInfo.begin(), p_temp_info);
-            ++number_of_geometries_read;
+            new_bezier_info.push_back(p_temp_info);
         }
 
-        std::cout << number_of_geometries_read << " geometries read]" << std::endl;
+        // the geometries are inserted at once, since inserting one by one is linear in the size of the container
+        BezierInfoParser::Insert(rThisBezierInfo, new_bezier_info);
+
+        std::cout << new_bezier_info.size() << " geometries read]" << std::endl;
+    }
+
+    void BezierModelPartIO::ReadIsogeometricBezierDataBlockParallel(BezierInfoContainerType& rThisBezierInfo)
+    {
+        KRATOS_TRY
+
+        std::cout << "  [Reading Bezier Geometries (parallel) : ";
+
+        #if defined(KRATOS_SD_REF_NUMBER_2)
+        std::istream& r_input = mFile;
+        #elif defined(KRATOS_SD_REF_NUMBER_3)
+        std::istream& r_input = *mpStream;
+        #endif
+
+        // the text of the block is collected line by line without comments. Whenever the buffer is large enough,
+        // the complete records in it are parsed in parallel and removed from the buffer.
+        std::vector<BezierInfo::Pointer> new_bezier_info;
+        std::string buffer;
+        std::string line;
+        bool is_end_found = false;
+        while(std::getline(r_input, line))
+        {
+            ++mNumberOfLines;
+
+            std::size_t comment_pos = line.find("//");
+            if(comment_pos != std::string::npos)
+                line.erase(comment_pos);
+
+            std::istringstream iss(line);
+            std::string first, second, third;
+            iss >> first;
+            if(first == "End")
+            {
+                iss >> second;
+                if(second != "IsogeometricBezierData")
+                    KRATOS_THROW_ERROR(std::logic_error, "Invalid end of block: expected End IsogeometricBezierData, found End", second)
+                if(iss >> third)
+                    KRATOS_THROW_ERROR(std::logic_error, "End IsogeometricBezierData shall be followed by a new line in parallel reading, found", third)
+                is_end_found = true;
+                break;
+            }
+
+            buffer += line;
+            buffer += '\n';
+
+            if(buffer.size() >= BezierInfoParser::BatchSize)
+            {
+                std::size_t consumed = BezierInfoParser::ParseRecords(buffer.data(), buffer.data() + buffer.size(), new_bezier_info);
+                buffer.erase(0, consumed);
+            }
+        }
+
+        if(!is_end_found)
+            KRATOS_THROW_ERROR(std::logic_error, "End IsogeometricBezierData is not found before the end of file", "")
+
+        std::size_t consumed = BezierInfoParser::ParseRecords(buffer.data(), buffer.data() + buffer.size(), new_bezier_info);
+        if(consumed != buffer.size())
+            KRATOS_THROW_ERROR(std::logic_error, "Incomplete Bezier geometry at the end of IsogeometricBezierData block", "")
+
+        BezierInfoParser::Insert(rThisBezierInfo, new_bezier_info);
+
+        std::cout << new_bezier_info.size() << " geometries read]" << std::endl;
+
+        KRATOS_CATCH("")
     }
 
     void BezierModelPartIO::ReadElementsWithGeometryBlock(NodesContainerType& rThisNodes,
@@ -455,5 +520,388 @@ namespace Kratos
         KRATOS_CATCH("")
     }
 
-}
+    template<class TEntityType, class TEntitiesContainerType>
+    void BezierModelPartIO::ReadBinaryEntities(const BezierBinaryContainer& rContainer,
+                                               const BezierBinaryContainer::GroupRecordType& rGroup,
+                                               NodesContainerType& rThisNodes,
+                                               PropertiesContainerType& rThisProperties,
+                                               TEntitiesContainerType& rThisEntities)
+    {
+        KRATOS_TRY
+
+        typedef IsogeometricGeometry<NodeType> IsogeometricGeometryType;
+
+        const std::string entity_name(rGroup.Name);
+        const bool is_element = (rGroup.Type == BezierBinaryLayout::ELEMENT);
+        std::cout << "  [Reading " << (is_element ? "Elements" : "Conditions") << " : ";
+
+        if(!KratosComponents<TEntityType>::Has(entity_name))
+        {
+            std::stringstream buffer;
+            buffer << (is_element ? "Element " : "Condition ") << entity_name << " is not registered in Kratos.";
+            buffer << " Please check the spelling of the name and see if the application which containing it, is registered corectly.";
+            KRATOS_THROW_ERROR(std::invalid_argument, buffer.str(), "");
+        }
+
+        TEntityType const& r_clone_entity = KratosComponents<TEntityType>::Get(entity_name);
+        typename TEntityType::NodesArrayType temp_entity_nodes;
+
+        Vector dummy;
+        Vector weights;
+        CompressedExtractionOperator extraction_operator;
+
+        rThisEntities.reserve(rThisEntities.size() + rGroup.NumberOfEntities);
+        for(std::size_t i = rGroup.EntitiesOffset; i < rGroup.EntitiesOffset + rGroup.NumberOfEntities; ++i)
+        {
+            const BezierBinaryContainer::EntityRecordType& r_entity = rContainer.Entity(i);
+            const BezierBinaryContainer::GeometryRecordType& r_geometry = rContainer.Geometry(r_entity.GeometryIndex);
+
+            Properties::Pointer p_temp_properties = *(ModelPartIO::FindKey(rThisProperties, r_entity.PropertiesId, "Properties").base());
+
+            // the connectivities
+            temp_entity_nodes.clear();
+            const BezierBinaryContainer::WordType* node_ids = rContainer.Connectivities(r_entity);
+            for(std::size_t j = 0; j < r_geometry.NumberOfNodes; ++j)
+                temp_entity_nodes.push_back(*(ModelPartIO::FindKey(rThisNodes, ModelPartIO::ReorderedNodeId(node_ids[j]), "Node").base()));
+
+            typename IsogeometricGeometryType::Pointer p_temp_geometry
+                = boost::dynamic_pointer_cast<IsogeometricGeometryType>(r_clone_entity.GetGeometry().Create(temp_entity_nodes));
+            if (p_temp_geometry == NULL)
+                KRATOS_THROW_ERROR(std::runtime_error, "The cast to IsogeometricGeometry is failed.", "")
+
+            // the weights and the CSR arrays are taken directly from the mapped file, no dense extraction operator is formed
+            const double* p_weights = rContainer.Weights(r_geometry);
+            if(weights.size() != r_geometry.NumberOfNodes)
+                weights.resize(r_geometry.NumberOfNodes, false);
+            std::copy(p_weights, p_weights + r_geometry.NumberOfNodes, weights.begin());
+            rContainer.GetExtractionOperator(r_geometry, extraction_operator);
+
+            int max_integration_method = (*p_temp_properties)[NUM_IGA_INTEGRATION_METHOD];
+            p_temp_geometry->AssignGeometryData(dummy,
+                                                dummy,
+                                                dummy,
+                                                weights,
+                                                extraction_operator,
+                                                static_cast<int>(r_geometry.Degree1),
+                                                static_cast<int>(r_geometry.Degree2),
+                                                static_cast<int>(r_geometry.Degree3),
+                                                max_integration_method);
+
+            SizeType id = is_element ? ModelPartIO::ReorderedElementId(r_entity.Id) : ModelPartIO::ReorderedConditionId(r_entity.Id);
+            rThisEntities.push_back(r_clone_entity.Create(id, p_temp_geometry, p_temp_properties));
+        }
+        std::cout << rGroup.NumberOfEntities << (is_element ? " elements read]" : " conditions read]") << " [Type: " << entity_name << "]" << std::endl;
+        rThisEntities.Unique();
+
+        KRATOS_CATCH("")
+    }
+
+    void BezierModelPartIO::ReadBezierBinaryBlock(ModelPart & rThisModelPart)
+    {
+        KRATOS_TRY
+
+        std::string binary_filename;
+        ModelPartIO::ReadWord(binary_filename);
+
+        std::string word;
+        ModelPartIO::ReadWord(word);
+        if(!ModelPartIO::CheckEndBlock("BezierBinaryBlock", word))
+            KRATOS_THROW_ERROR(std::logic_error, "BezierBinaryBlock shall only contain the name of the binary file, found", word)
+
+        // a relative path is relative to the mdpa file
+        std::size_t pos = mInputFilename.find_last_of('/');
+        if(binary_filename[0] != '/' && pos != std::string::npos)
+            binary_filename = mInputFilename.substr(0, pos + 1) + binary_filename;
+
+        BezierBinaryContainer container(binary_filename);
+
+        // nodes
+        std::cout << "  [Reading Nodes : ";
+        NodesContainerType& rThisNodes = rThisModelPart.Nodes();
+        const std::size_t number_of_nodes = container.NumberOfNodes();
+        const BezierBinaryContainer::WordType* node_ids = container.NodeIds();
+        const double* node_coordinates = container.NodeCoordinates();
+        rThisNodes.reserve(rThisNodes.size() + number_of_nodes);
+        for(std::size_t i = 0; i < number_of_nodes; ++i)
+        {
+            NodeType::Pointer p_temp_node = NodeType::Pointer(new NodeType(ModelPartIO::ReorderedNodeId(node_ids[i]),
+                    node_coordinates[3*i], node_coordinates[3*i + 1], node_coordinates[3*i + 2]));
+            p_temp_node->SetSolutionStepVariablesList(&rThisModelPart.GetNodalSolutionStepVariablesList());
+            p_temp_node->SetBufferSize(rThisModelPart.GetBufferSize());
+            rThisNodes.push_back(p_temp_node);
+        }
+        rThisNodes.Unique();
+        std::cout << number_of_nodes << " nodes read]" << std::endl;
+
+        // elements and conditions
+        for(std::size_t i = 0; i < container.NumberOfGroups(); ++i)
+        {
+            const BezierBinaryContainer::GroupRecordType& r_group = container.Group(i);
+            if(r_group.Type == BezierBinaryLayout::ELEMENT)
+                this->ReadBinaryEntities<Element>(container, r_group, rThisModelPart.Nodes(), rThisModelPart.rProperties(), rThisModelPart.Elements());
+            else if(r_group.Type == BezierBinaryLayout::CONDITION)
+                this->ReadBinaryEntities<Condition>(container, r_group, rThisModelPart.Nodes(), rThisModelPart.rProperties(), rThisModelPart.Conditions());
+            else
+                KRATOS_THROW_ERROR(std::logic_error, "Invalid entity type in binary Bezier container:", r_group.Type)
+        }
+
+        KRATOS_CATCH("")
+    }
+
+    void BezierModelPartIO::WriteBinary(std::string const& OutputFilename)
+    {
+        KRATOS_TRY
+
+        if(OutputFilename + ".mdpa" == mInputFilename)
+            KRATOS_THROW_ERROR(std::logic_error, "The output file must be different from the input file", OutputFilename)
+
+        BezierBinaryWriter writer;
+
+        ModelPartIO::ResetInput();
+        std::string word;
+        while(true)
+        {
+            ModelPartIO::ReadWord(word);
+            #if defined(KRATOS_SD_REF_NUMBER_2)
+            if(mFile.eof())
+            #elif defined(KRATOS_SD_REF_NUMBER_3)
+            if(mpStream->eof())
+            #endif
+                break;
+            ModelPartIO::ReadBlockName(word);
+            if(word == "Nodes")
+                this->CollectNodesBlock(writer);
+            else if(word == "BezierBlock")
+                this->CollectBezierBlock(writer);
+            else if(word == "BezierBinaryBlock")
+                KRATOS_THROW_ERROR(std::logic_error, "The input is already in binary format", mInputFilename)
+            else
+                this->SkipBezierInputBlock(word);
+        }
+
+        const std::string binary_filename = OutputFilename + ".bmdpa";
+        writer.Write(binary_filename);
+
+        // the mdpa refers to the binary file relative to its own location
+        std::size_t pos = binary_filename.find_last_of('/');
+        this->WriteTextWithoutBinaryBlocks(OutputFilename + ".mdpa",
+                (pos == std::string::npos) ? binary_filename : binary_filename.substr(pos + 1));
+
+        std::cout << "  [Binary Bezier data written to " << binary_filename << " : " << writer.NumberOfNodes() << " nodes, "
+                  << writer.NumberOfGeometries() << " geometries, " << writer.NumberOfEntities() << " elements/conditions]" << std::endl;
+
+        KRATOS_CATCH("")
+    }
+
+    void BezierModelPartIO::CollectNodesBlock(BezierBinaryWriter& rWriter)
+    {
+        KRATOS_TRY
+
+        std::string word;
+        SizeType id;
+        double x, y, z;
+
+        #if defined(KRATOS_SD_REF_NUMBER_2)
+        while(!mFile.eof())
+        #elif defined(KRATOS_SD_REF_NUMBER_3)
+        while(!mpStream->eof())
+        #endif
+        {
+            ModelPartIO::ReadWord(word);
+            if(ModelPartIO::CheckEndBlock("Nodes", word))
+                break;
+
+            ModelPartIO::ExtractValue(word, id);
+            ModelPartIO::ReadWord(word);
+            ModelPartIO::ExtractValue(word, x);
+            ModelPartIO::ReadWord(word);
+            ModelPartIO::ExtractValue(word, y);
+            ModelPartIO::ReadWord(word);
+            ModelPartIO::ExtractValue(word, z);
+
+            rWriter.AddNode(id, x, y, z);
+        }
+
+        KRATOS_CATCH("")
+    }
+
+    void BezierModelPartIO::CollectBezierBlock(BezierBinaryWriter& rWriter)
+    {
+        KRATOS_TRY
+
+        std::string word;
+
+        #if defined(KRATOS_SD_REF_NUMBER_2)
+        while(!mFile.eof())
+        #elif defined(KRATOS_SD_REF_NUMBER_3)
+        while(!mpStream->eof())
+        #endif
+        {
+            ModelPartIO::ReadWord(word);
+
+            if(ModelPartIO::CheckEndBlock("BezierBlock", word))
+                break;
+
+            #if defined(KRATOS_SD_REF_NUMBER_2)
+            if(mFile.eof())
+            #elif defined(KRATOS_SD_REF_NUMBER_3)
+            if(mpStream->eof())
+            #endif
+                break;
+
+            ModelPartIO::ReadBlockName(word);
+            if(word == "IsogeometricBezierData")
+            {
+                BezierInfoContainerType bezier_info;
+                this->ReadIsogeometricBezierDataBlock(bezier_info);
+
+                CompressedExtractionOperator extraction_operator;
+                for(BezierInfoContainerType::ptr_iterator it = bezier_info.ptr_begin(); it != bezier_info.ptr_end(); ++it)
+                {
+                    extraction_operator.Assign((*it)->C);
+                    rWriter.AddGeometry((*it)->Id(), (*it)->n, (*it)->local_space_dim, (*it)->global_space_dim,
+                            (*it)->p1, (*it)->p2, (*it)->p3, (*it)->weights, extraction_operator);
+                }
+            }
+            else if(word == "ElementsWithGeometry")
+                this->CollectEntitiesWithGeometryBlock(word, BezierBinaryLayout::ELEMENT, rWriter);
+            else if(word == "ConditionsWithGeometry")
+                this->CollectEntitiesWithGeometryBlock(word, BezierBinaryLayout::CONDITION, rWriter);
+            else
+                this->SkipBezierInputBlock(word);
+        }
+
+        KRATOS_CATCH("")
+    }
+
+    void BezierModelPartIO::CollectEntitiesWithGeometryBlock(const std::string& BlockName,
+                                                             const BezierBinaryLayout::EntityType& Type,
+                                                             BezierBinaryWriter& rWriter)
+    {
+        KRATOS_TRY
+
+        SizeType id;
+        SizeType properties_id;
+        SizeType geometry_id;
+        SizeType number_of_nodes;
+        std::vector<SizeType> node_ids;
+
+        std::string word;
+        std::string entity_name;
+
+        ModelPartIO::ReadWord(entity_name);
+        rWriter.AddGroup(entity_name, Type);
+
+        #if defined(KRATOS_SD_REF_NUMBER_2)
+        while(!mFile.eof())
+        #elif defined(KRATOS_SD_REF_NUMBER_3)
+        while(!mpStream->eof())
+        #endif
+        {
+            ModelPartIO::ReadWord(word);
+            if(ModelPartIO::CheckEndBlock(BlockName, word))
+                break;
+
+            ModelPartIO::ExtractValue(word, id);
+            ModelPartIO::ReadWord(word);
+            ModelPartIO::ExtractValue(word, properties_id);
+            ModelPartIO::ReadWord(word);
+            ModelPartIO::ExtractValue(word, geometry_id);
+
+            // Reading the connectivities
+            number_of_nodes = rWriter.GetGeometryNumberOfNodes(geometry_id);
+            node_ids.resize(number_of_nodes);
+            for(SizeType i = 0; i < number_of_nodes; ++i)
+            {
+                ModelPartIO::ReadWord(word);
+                ModelPartIO::ExtractValue(word, node_ids[i]);
+            }
+
+            rWriter.AddEntity(id, properties_id, geometry_id, node_ids);
+        }
+
+        KRATOS_CATCH("")
+    }
+
+    void BezierModelPartIO::SkipBezierInputBlock(const std::string& BlockName)
+    {
+        std::string word;
 
+        #if defined(KRATOS_SD_REF_NUMBER_2)
+        while(!mFile.eof())
+        #elif defined(KRATOS_SD_REF_NUMBER_3)
+        while(!mpStream->eof())
+        #endif
+        {
+            ModelPartIO::ReadWord(word);
+            if(word == "End")
+            {
+                ModelPartIO::ReadWord(word);
+                if(word == BlockName)
+                    break;
+            }
+        }
+    }
+
+    void BezierModelPartIO::WriteTextWithoutBinaryBlocks(const std::string& rOutputFilename, const std::string& rBinaryFilename) const
+    {
+        KRATOS_TRY
+
+        // the blocks are detected line by line, i.e. "Begin <name>" and "End <name>" are assumed to start a line
+        std::ifstream infile(mInputFilename.c_str());
+        if(!infile)
+            KRATOS_THROW_ERROR(std::runtime_error, "Error opening input file", mInputFilename)
+
+        std::stringstream buffer;
+        std::size_t marker_position = std::string::npos;
+        std::string line, first, second;
+        int depth = 0;
+        bool skipping = false;
+        while(std::getline(infile, line))
+        {
+            std::istringstream iss(line);
+            first.clear();
+            second.clear();
+            iss >> first >> second;
+            if(first == "Begin")
+            {
+                if(depth == 0 && (second == "Nodes" || second == "BezierBlock"))
+                    skipping = true;
+                ++depth;
+            }
+            else if(first == "End")
+            {
+                --depth;
+                if(depth == 0 && skipping)
+                {
+                    // the binary block takes the place of the last skipped block, where all the nodes, properties
+                    // and geometries referred by the entities have been read
+                    skipping = false;
+                    marker_position = buffer.tellp();
+                    continue;
+                }
+            }
+
+            if(!skipping)
+                buffer << line << std::endl;
+        }
+        infile.close();
+
+        const std::string content = buffer.str();
+        if(marker_position == std::string::npos)
+            marker_position = content.size();
+
+        std::ofstream outfile(rOutputFilename.c_str());
+        if(!outfile)
+            KRATOS_THROW_ERROR(std::runtime_error, "Error opening output file", rOutputFilename)
+        outfile << content.substr(0, marker_position);
+        outfile << "Begin BezierBinaryBlock" << std::endl;
+        outfile << rBinaryFilename << std::endl;
+        outfile << "End BezierBinaryBlock" << std::endl;
+        outfile << content.substr(marker_position);
+        outfile.close();
+
+        KRATOS_CATCH("")
+    }
+
+}
@@ -53,7 +53,9 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 // System includes
 #include <string>
 #include <fstream>
+#include <sstream>
 #include <set>
+#include <algorithm>
 
 
 // External includes
@@ -61,6 +63,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 // Project includes
 #include "includes/model_part_io.h"
+#include "custom_io/bezier_binary_container.h"
 
 
 namespace Kratos
@@ -147,18 +150,50 @@ public:
     /// Read the data and initialize the model part
     virtual void ReadModelPart(ModelPart & rThisModelPart);
 
+    /// Convert the input to the binary format. The nodes and the Bezier blocks are written to OutputFilename.bmdpa,
+    /// the remaining blocks are copied to OutputFilename.mdpa, which refers to the binary file by a BezierBinaryBlock.
+    /// The output can be read by BezierModelPartIO(OutputFilename).
+    void WriteBinary(std::string const& OutputFilename);
+
+    /// Enable/disable the parallel reading of the IsogeometricBezierData blocks. The block is read in batches of
+    /// complete records, which are parsed on all threads. The result is the same as the sequential reading.
+    void SetParallelReading(const bool Flag) {mParallelReading = Flag;}
+
 private:
 
+    std::string mInputFilename;
+
+    bool mParallelReading;
+
     BezierInfoContainerType::Pointer mpBezierInfoContainer;
 
     void ReadBezierBlock(ModelPart & rThisModelPart);
 
     void ReadIsogeometricBezierDataBlock(BezierInfoContainerType& rThisBezierInfo);
 
+    void ReadIsogeometricBezierDataBlockParallel(BezierInfoContainerType& rThisBezierInfo);
+
     void ReadElementsWithGeometryBlock(NodesContainerType& rThisNodes, PropertiesContainerType& rThisProperties, BezierInfoContainerType& rGeometryInfo, ElementsContainerType& rThisElements);
 
     void ReadConditionsWithGeometryBlock(NodesContainerType& rThisNodes, PropertiesContainerType& rThisProperties, BezierInfoContainerType& rGeometryInfo, ConditionsContainerType& rThisConditions);
 
+    void ReadBezierBinaryBlock(ModelPart & rThisModelPart);
+
+    template<class TEntityType, class TEntitiesContainerType>
+    void ReadBinaryEntities(const BezierBinaryContainer& rContainer, const BezierBinaryContainer::GroupRecordType& rGroup,
+            NodesContainerType& rThisNodes, PropertiesContainerType& rThisProperties, TEntitiesContainerType& rThisEntities);
+
+    void CollectNodesBlock(BezierBinaryWriter& rWriter);
+
+    void CollectBezierBlock(BezierBinaryWriter& rWriter);
+
+    void CollectEntitiesWithGeometryBlock(const std::string& BlockName, const BezierBinaryLayout::EntityType& Type,
+            BezierBinaryWriter& rWriter);
+
+    void SkipBezierInputBlock(const std::string& BlockName);
+
+    void WriteTextWithoutBinaryBlocks(const std::string& rOutputFilename, const std::string& rBinaryFilename) const;
+
 };
 
 }
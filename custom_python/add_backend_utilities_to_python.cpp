@@ -102,6 +102,42 @@ void BezierUtils_DumpShapeFunctionsIntegrationPointsValuesAndLocalGradients(
     dummy.DumpShapeFunctionsIntegrationPointsValuesAndLocalGradients(pModelPart, FileName);
 }
 
+void BezierUtils_SetGeometryCache(
+    BezierUtils& dummy,
+    bool Enable,
+    std::size_t MemoryBudget
+)
+{
+    dummy.SetGeometryCache(Enable, MemoryBudget);
+}
+
+std::size_t BezierUtils_GeometryCacheMemory(
+    BezierUtils& dummy
+)
+{
+    return dummy.GeometryCacheMemory();
+}
+
+void BezierUtils_RegisterIntegrationRule(
+    BezierUtils& dummy,
+    unsigned int Dimension,
+    unsigned int WorkingSpaceDimension,
+    unsigned int NumberOfIntegrationMethod,
+    unsigned int Order1,
+    unsigned int Order2,
+    unsigned int Order3
+)
+{
+    dummy.RegisterIntegrationRule(Dimension, WorkingSpaceDimension, NumberOfIntegrationMethod, Order1, Order2, Order3);
+}
+
+std::size_t BezierUtils_NumberOfIntegrationRules(
+    BezierUtils& dummy
+)
+{
+    return dummy.NumberOfIntegrationRules();
+}
+
 template<class T>
 void BezierUtils_ComputeCentroid(
     BezierUtils& dummy,
@@ -632,6 +668,92 @@ void BezierPostUtility_TransferVariablesToNodes_Elements(BezierPostUtility& rDum
     rDummy.TransferVariablesToNodes(rThisVariable, r_model_part, ElementsArray, pSolver);
 }
 
+/// Split a python list of variables into the double and the Vector variables, for the projection of several variables at once
+void IsogeometricApplication_ExtractL2ProjectionVariables(const boost::python::list& variables,
+    std::vector<const Variable<double>*>& rDoubleVariables,
+    std::vector<const Variable<Vector>*>& rVectorVariables)
+{
+    for (int i = 0; i < len(variables); ++i)
+    {
+        extract<Variable<double>&> double_variable(variables[i]);
+        extract<Variable<Vector>&> vector_variable(variables[i]);
+        if (double_variable.check())
+            rDoubleVariables.push_back(&double_variable());
+        else if (vector_variable.check())
+            rVectorVariables.push_back(&vector_variable());
+        else
+            KRATOS_THROW_ERROR(std::logic_error, "Only double and Vector variables can be transferred to nodes, item", i)
+    }
+}
+
+void BezierPostUtility_TransferIntegrationPointResults_Variables(BezierPostUtility& rDummy,
+    const boost::python::list& variables,
+    ModelPart& r_model_part, ModelPart& r_model_part_post,
+    BezierPostUtility::LinearSolverType::Pointer pSolver)
+{
+    std::vector<const Variable<double>*> double_variables;
+    std::vector<const Variable<Vector>*> vector_variables;
+    IsogeometricApplication_ExtractL2ProjectionVariables(variables, double_variables, vector_variables);
+    rDummy.TransferIntegrationPointResults(double_variables, vector_variables, r_model_part, r_model_part_post, pSolver);
+}
+
+void BezierPostUtility_TransferVariablesToNodes_Variables(BezierPostUtility& rDummy,
+    const boost::python::list& variables,
+    ModelPart& r_model_part,
+    BezierPostUtility::LinearSolverType::Pointer pSolver)
+{
+    std::vector<const Variable<double>*> double_variables;
+    std::vector<const Variable<Vector>*> vector_variables;
+    IsogeometricApplication_ExtractL2ProjectionVariables(variables, double_variables, vector_variables);
+    rDummy.TransferVariablesToNodes(double_variables, vector_variables, r_model_part, r_model_part.Elements(), pSolver);
+}
+
+void BezierClassicalPostUtility_TransferNodalResults_Variables(BezierClassicalPostUtility& rDummy,
+    const boost::python::list& variables,
+    ModelPart::Pointer pModelPartPost)
+{
+    std::vector<const Variable<double>*> double_variables;
+    std::vector<const Variable<Vector>*> vector_variables;
+    std::vector<const Variable<array_1d<double, 3> >*> array_1d_variables;
+    for (int i = 0; i < len(variables); ++i)
+    {
+        extract<Variable<double>&> double_variable(variables[i]);
+        extract<Variable<Vector>&> vector_variable(variables[i]);
+        extract<Variable<array_1d<double, 3> >&> array_1d_variable(variables[i]);
+        if (double_variable.check())
+            double_variables.push_back(&double_variable());
+        else if (vector_variable.check())
+            vector_variables.push_back(&vector_variable());
+        else if (array_1d_variable.check())
+            array_1d_variables.push_back(&array_1d_variable());
+        else
+            KRATOS_THROW_ERROR(std::logic_error, "Only double, Vector and array_1d variables can be transferred, item", i)
+    }
+    rDummy.TransferNodalResults(double_variables, vector_variables, array_1d_variables, pModelPartPost);
+}
+
+void BezierClassicalPostUtility_TransferIntegrationPointResults_Variables(BezierClassicalPostUtility& rDummy,
+    const boost::python::list& variables,
+    ModelPart::Pointer pModelPartPost,
+    BezierClassicalPostUtility::LinearSolverType::Pointer pSolver)
+{
+    std::vector<const Variable<double>*> double_variables;
+    std::vector<const Variable<Vector>*> vector_variables;
+    IsogeometricApplication_ExtractL2ProjectionVariables(variables, double_variables, vector_variables);
+    rDummy.TransferIntegrationPointResults(double_variables, vector_variables, pModelPartPost, pSolver);
+}
+
+void BezierClassicalPostUtility_TransferVariablesToNodes_Variables(BezierClassicalPostUtility& rDummy,
+    const boost::python::list& variables,
+    ModelPart::Pointer pModelPart,
+    BezierClassicalPostUtility::LinearSolverType::Pointer pSolver)
+{
+    std::vector<const Variable<double>*> double_variables;
+    std::vector<const Variable<Vector>*> vector_variables;
+    IsogeometricApplication_ExtractL2ProjectionVariables(variables, double_variables, vector_variables);
+    rDummy.TransferVariablesToNodes(double_variables, vector_variables, pModelPart, pSolver);
+}
+
 //////////////////////////////////////////////////////////
 
 void IsogeometricApplication_AddBackendUtilitiesToPython()
@@ -643,6 +765,12 @@ void IsogeometricApplication_AddBackendUtilitiesToPython()
     .value("Hexahedra", _HEXAHEDRA_)
     ;
 
+    enum_<L2ProjectionType>("L2ProjectionType")
+    .value("Consistent", _CONSISTENT_L2_PROJECTION_)
+    .value("Lumped", _LUMPED_L2_PROJECTION_)
+    .value("DiagonalScaled", _DIAGONAL_SCALED_L2_PROJECTION_)
+    ;
+
     class_<IsogeometricEcho, boost::noncopyable>("IsogeometricEcho", init<>())
     .def("SetEchoLevel", &IsogeometricEcho::SetEchoLevel)
     // .def("GetEchoLevel", IsogeometricEcho_GetEchoLevel)
@@ -660,6 +788,10 @@ void IsogeometricApplication_AddBackendUtilitiesToPython()
     .def("DumpShapeFunctionsIntegrationPointsValuesAndLocalGradients", BezierUtils_DumpShapeFunctionsIntegrationPointsValuesAndLocalGradients)
     .def("ComputeCentroid", BezierUtils_ComputeCentroid<Element>)
     .def("ComputeCentroid", BezierUtils_ComputeCentroid<Condition>)
+    .def("SetGeometryCache", BezierUtils_SetGeometryCache)
+    .def("GeometryCacheMemory", BezierUtils_GeometryCacheMemory)
+    .def("RegisterIntegrationRule", BezierUtils_RegisterIntegrationRule)
+    .def("NumberOfIntegrationRules", BezierUtils_NumberOfIntegrationRules)
 //    .def("compute_extended_knot_vector", &BezierUtils::compute_extended_knot_vector)
 //    .def("bezier_extraction_tsplines_1d", &BezierUtils::bezier_extraction_tsplines_1d)
     ;
@@ -694,13 +826,18 @@ void IsogeometricApplication_AddBackendUtilitiesToPython()
     .def("TransferNodalResults", &BezierClassicalPostUtility::TransferNodalResults<Variable<double> >)
     .def("TransferNodalResults", &BezierClassicalPostUtility::TransferNodalResults<Variable<Vector> >)
     .def("TransferNodalResults", &BezierClassicalPostUtility::TransferNodalResults<Variable<array_1d<double, 3> > >)
+    .def("TransferNodalResults", &BezierClassicalPostUtility_TransferNodalResults_Variables)
     .def("TransferIntegrationPointResults", &BezierClassicalPostUtility::TransferIntegrationPointResults<Variable<double> >)
     .def("TransferIntegrationPointResults", &BezierClassicalPostUtility::TransferIntegrationPointResults<Variable<Vector> >)
+    .def("TransferIntegrationPointResults", &BezierClassicalPostUtility_TransferIntegrationPointResults_Variables)
     .def("SynchronizeActivation", &BezierClassicalPostUtility::SynchronizeActivation)
     .def("TransferElementalData", &BezierClassicalPostUtility::TransferElementalData<Variable<bool> >)
     .def("TransferConditionalData", &BezierClassicalPostUtility::TransferConditionalData<Variable<bool> >)
     .def("TransferVariablesToNodes", &BezierClassicalPostUtility::TransferVariablesToNodes<Variable<double> >)
     .def("TransferVariablesToNodes", &BezierClassicalPostUtility::TransferVariablesToNodes<Variable<Vector> >)
+    .def("TransferVariablesToNodes", &BezierClassicalPostUtility_TransferVariablesToNodes_Variables)
+    .def("SetProjectionType", &BezierClassicalPostUtility::SetProjectionType)
+    .def("GetProjectionType", &BezierClassicalPostUtility::GetProjectionType)
     .def("GlobalNodalRenumbering", &BezierClassicalPostUtility::GlobalNodalRenumbering)
     ;
 
@@ -710,10 +847,14 @@ void IsogeometricApplication_AddBackendUtilitiesToPython()
     .def("TransferNodalResults", &BezierPostUtility::TransferNodalResults<Variable<array_1d<double, 3> > >)
     .def("TransferIntegrationPointResults", &BezierPostUtility::TransferIntegrationPointResults<Variable<double> >)
     .def("TransferIntegrationPointResults", &BezierPostUtility::TransferIntegrationPointResults<Variable<Vector> >)
+    .def("TransferIntegrationPointResults", &BezierPostUtility_TransferIntegrationPointResults_Variables)
     .def("TransferVariablesToNodes", &BezierPostUtility_TransferVariablesToNodes_ModelPart<Variable<double> >)
     .def("TransferVariablesToNodes", &BezierPostUtility_TransferVariablesToNodes_ModelPart<Variable<Vector> >)
     .def("TransferVariablesToNodes", &BezierPostUtility_TransferVariablesToNodes_Elements<Variable<double> >)
     .def("TransferVariablesToNodes", &BezierPostUtility_TransferVariablesToNodes_Elements<Variable<Vector> >)
+    .def("TransferVariablesToNodes", &BezierPostUtility_TransferVariablesToNodes_Variables)
+    .def("SetProjectionType", &BezierPostUtility::SetProjectionType)
+    .def("GetProjectionType", &BezierPostUtility::GetProjectionType)
     ;
 
     #ifdef ISOGEOMETRIC_USE_HDF5
@@ -728,6 +869,23 @@ void IsogeometricApplication_AddBackendUtilitiesToPython()
     .def("ReadNodalResults", &HDF5PostUtility::ReadNodalResults<array_1d<double, 3> >)
     .def("ReadNodalResults", &HDF5PostUtility::ReadNodalResults<Vector>)
     .def("ReadElementalData", &HDF5PostUtility::ReadElementalData<bool>)
+    .def("SetChunkSize", &HDF5PostUtility::SetChunkSize)
+    .def("SetCompression", &HDF5PostUtility::SetCompression)
+    .def("WriteNodeColumns", &HDF5PostUtility::WriteNodeColumns)
+    .def("BeginStep", &HDF5PostUtility::BeginStep)
+    .def("WriteNodalColumns", &HDF5PostUtility::WriteNodalColumns<double>)
+    .def("WriteNodalColumns", &HDF5PostUtility::WriteNodalColumns<array_1d<double, 3> >)
+    .def("WriteNodalColumns", &HDF5PostUtility::WriteNodalColumns<Vector>)
+    .def("WriteElementColumns", &HDF5PostUtility::WriteElementColumns)
+    .def("WriteElementalColumns", &HDF5PostUtility::WriteElementalColumns<bool>)
+    .def("WriteElementalColumns", &HDF5PostUtility::WriteElementalColumns<double>)
+    .def("WriteElementalColumns", &HDF5PostUtility::WriteElementalColumns<Vector>)
+    .def("WriteMultiPatch", &HDF5PostUtility::WriteMultiPatch<1>)
+    .def("WriteMultiPatch", &HDF5PostUtility::WriteMultiPatch<2>)
+    .def("WriteMultiPatch", &HDF5PostUtility::WriteMultiPatch<3>)
+    .def("ReadMultiPatch1D", &HDF5PostUtility::ReadMultiPatch<1>)
+    .def("ReadMultiPatch2D", &HDF5PostUtility::ReadMultiPatch<2>)
+    .def("ReadMultiPatch3D", &HDF5PostUtility::ReadMultiPatch<3>)
     ;
     #endif
 
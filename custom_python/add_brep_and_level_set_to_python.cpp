@@ -34,6 +34,7 @@ void IsogeometricApplication_AddBRepAndLevelSetToPython()
     .def("SetPredictionSampling", &MultiPatchZLevelSet::SetPredictionSampling)
     .def("SetTolerance", &MultiPatchZLevelSet::SetTolerance)
     .def("SetMaxIterations", &MultiPatchZLevelSet::SetMaxIterations)
+    .def("UpdateSpanTree", &MultiPatchZLevelSet::UpdateSpanTree)
     .def(self_ns::str(self))
     ;
 }
@@ -149,6 +149,32 @@ void HBSplinesRefinementUtility_RefineBf(HBSplinesRefinementUtility& rDummy,
     rDummy.Refine<TDim>(pPatch, p_bf, EchoLevel);
 }
 
+template<int TDim>
+void HBSplinesRefinementUtility_RefineBfs(HBSplinesRefinementUtility& rDummy,
+        typename Patch<TDim>::Pointer pPatch, boost::python::list& bf_ids, const int& EchoLevel)
+{
+    std::vector<std::size_t> ids;
+    typedef boost::python::stl_input_iterator<int> iterator_value_type;
+    BOOST_FOREACH(const iterator_value_type::value_type& v, std::make_pair(iterator_value_type(bf_ids), iterator_value_type() ) )
+    {
+        ids.push_back(static_cast<std::size_t>(v));
+    }
+    rDummy.RefineBfs<TDim>(pPatch, ids, EchoLevel);
+}
+
+template<int TDim>
+void HBSplinesRefinementUtility_RefineCells(HBSplinesRefinementUtility& rDummy,
+        typename Patch<TDim>::Pointer pPatch, boost::python::list& cell_ids, const int& EchoLevel)
+{
+    std::vector<std::size_t> ids;
+    typedef boost::python::stl_input_iterator<int> iterator_value_type;
+    BOOST_FOREACH(const iterator_value_type::value_type& v, std::make_pair(iterator_value_type(cell_ids), iterator_value_type() ) )
+    {
+        ids.push_back(static_cast<std::size_t>(v));
+    }
+    rDummy.RefineCells<TDim>(pPatch, ids, EchoLevel);
+}
+
 template<int TDim>
 void HBSplinesRefinementUtility_RefineWindow(HBSplinesRefinementUtility& rDummy,
         typename Patch<TDim>::Pointer pPatch, boost::python::list& window, const int& EchoLevel)
@@ -219,6 +245,7 @@ void IsogeometricApplication_AddHBSplinesSpaceToPython()
 //    .def("ConstructBoundaryFESpace", pointer_to_ConstructBoundaryFESpace1)
     // .def("ConstructBoundaryFESpace", pointer_to_ConstructBoundaryFESpace2)
     .def("UpdateCells", &HBSplinesFESpace<TDim>::UpdateCells)
+    .def("MarkAllCellsDirty", &HBSplinesFESpace<TDim>::MarkAllCellsDirty)
     .def("MaxLevel", &HBSplinesFESpace_MaxLevel<TDim>)
     .def("SetMaxLevel", &HBSplinesFESpace<TDim>::SetMaxLevel)
     .def("GetBfByEquationId", &HBSplinesFESpace<TDim>::pGetBfByEquationId)
@@ -307,6 +334,10 @@ void IsogeometricApplication_AddHBSplinesToPython()
     .def("Refine", &HBSplinesRefinementUtility_Refine<3>)
     .def("Refine", &HBSplinesRefinementUtility_RefineBf<2>)
     .def("Refine", &HBSplinesRefinementUtility_RefineBf<3>)
+    .def("RefineBfs", &HBSplinesRefinementUtility_RefineBfs<2>)
+    .def("RefineBfs", &HBSplinesRefinementUtility_RefineBfs<3>)
+    .def("RefineCells", &HBSplinesRefinementUtility_RefineCells<2>)
+    .def("RefineCells", &HBSplinesRefinementUtility_RefineCells<3>)
     .def("RefineWindow", &HBSplinesRefinementUtility_RefineWindow<2>)
     .def("RefineWindow", &HBSplinesRefinementUtility_RefineWindow<3>)
     .def("LinearDependencyRefine", &HBSplinesRefinementUtility_LinearDependencyRefine<2>)
@@ -39,7 +39,9 @@ void  IsogeometricApplication_AddIOToPython()
     ;
 
     class_<BezierModelPartIO, BezierModelPartIO::Pointer, bases<ModelPartIO>,  boost::noncopyable>(
-        "BezierModelPartIO",init<std::string const&>())
+        "BezierModelPartIO",init<std::string const&>())
+        .def("WriteBinary", &BezierModelPartIO::WriteBinary)
+        .def("SetParallelReading", &BezierModelPartIO::SetParallelReading)
 //        .def(init<std::string const&, const Flags>())
     ;
 }
@@ -234,6 +234,8 @@ void IsogeometricApplication_AddMeshToPython()
     .def("SetLastElemId", &NonConformingMultipatchLagrangeMesh<TDim>::SetLastElemId)
     .def("SetDivision", &NonConformingMultipatchLagrangeMesh<TDim>::SetDivision)
     .def("SetUniformDivision", &NonConformingMultipatchLagrangeMesh<TDim>::SetUniformDivision)
+    .def("SetAdaptiveDivision", &NonConformingMultipatchLagrangeMesh<TDim>::SetAdaptiveDivision)
+    .def("AddAdaptiveVariable", &NonConformingMultipatchLagrangeMesh<TDim>::AddAdaptiveVariable)
     .def("WriteModelPart", &NonConformingMultipatchLagrangeMesh<TDim>::WriteModelPart)
     .def(self_ns::str(self))
     ;
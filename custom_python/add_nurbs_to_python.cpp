@@ -449,6 +449,7 @@ void IsogeometricApplication_AddBSplinesFESpaceToPython()
     .add_property("KnotU", BSplinesFESpace_GetKnotVector<TDim, 0>, BSplinesFESpace_SetKnotVector<TDim, 0>)
     .add_property("KnotV", BSplinesFESpace_GetKnotVector<TDim, 1>, BSplinesFESpace_SetKnotVector<TDim, 1>)
     .add_property("KnotW", BSplinesFESpace_GetKnotVector<TDim, 2>, BSplinesFESpace_SetKnotVector<TDim, 2>)
+    .add_property("UseFlatCellManager", &BSplinesFESpace<TDim>::UseFlatCellManager, &BSplinesFESpace<TDim>::SetUseFlatCellManager)
     .def(self_ns::str(self))
     ;
 }
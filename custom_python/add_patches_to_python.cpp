@@ -30,6 +30,7 @@ LICENSE: see isogeometric_application/LICENSE.txt
 #include "custom_utilities/import_export/multi_nurbs_patch_geo_importer.h"
 #include "custom_utilities/import_export/multi_nurbs_patch_matlab_exporter.h"
 #include "custom_utilities/import_export/multi_nurbs_patch_glvis_exporter.h"
+#include "custom_utilities/import_export/multipatch_checkpoint.h"
 #include "custom_python/iga_define_python.h"
 #include "custom_python/add_import_export_to_python.h"
 #include "custom_python/add_patches_to_python.h"
@@ -290,6 +291,32 @@ std::size_t MultiPatch_Enumerate2(MultiPatch<TDim>& rDummy, const std::size_t& s
     return system_size;
 }
 
+template<int TDim>
+boost::python::list MultiPatchCheckpointReader_PatchIds(MultiPatchCheckpointReader<TDim>& rDummy)
+{
+    boost::python::list ids;
+    std::vector<std::size_t> patch_ids = rDummy.PatchIds();
+    for (std::size_t i = 0; i < patch_ids.size(); ++i)
+        ids.append(patch_ids[i]);
+    return ids;
+}
+
+template<int TDim>
+typename MultiPatch<TDim>::Pointer MultiPatchCheckpointReader_ReadMultiPatch1(MultiPatchCheckpointReader<TDim>& rDummy)
+{
+    return rDummy.pReadMultiPatch();
+}
+
+template<int TDim>
+typename MultiPatch<TDim>::Pointer MultiPatchCheckpointReader_ReadMultiPatch2(MultiPatchCheckpointReader<TDim>& rDummy, boost::python::list& list_ids)
+{
+    std::vector<std::size_t> patch_ids;
+    typedef boost::python::stl_input_iterator<int> iterator_index_type;
+    BOOST_FOREACH(const iterator_index_type::value_type& id, std::make_pair(iterator_index_type(list_ids), iterator_index_type() ) )
+        patch_ids.push_back(static_cast<std::size_t>(id));
+    return rDummy.pReadMultiPatch(patch_ids);
+}
+
 template<int TDim>
 typename Patch<TDim>::Pointer PatchInterface_pPatch1(PatchInterface<TDim>& rDummy)
 {
@@ -453,6 +480,14 @@ void IsogeometricApplication_AddExportToPython()
     .def(self_ns::str(self))
     ;
 
+    class_<MultiPatchCheckpointWriter, MultiPatchCheckpointWriter::Pointer, boost::noncopyable>
+    ("MultiPatchCheckpointWriter", init<>())
+    .def("Export", &MultiPatchExporter_Export<1, MultiPatchCheckpointWriter, MultiPatch<1> >)
+    .def("Export", &MultiPatchExporter_Export<2, MultiPatchCheckpointWriter, MultiPatch<2> >)
+    .def("Export", &MultiPatchExporter_Export<3, MultiPatchCheckpointWriter, MultiPatch<3> >)
+    .def(self_ns::str(self))
+    ;
+
 }
 
 template<int TDim>
@@ -469,6 +504,19 @@ void IsogeometricApplication_AddImportToPython()
     .def(self_ns::str(self))
     ;
 
+    ss.str(std::string());
+    ss << "MultiPatchCheckpointReader" << TDim << "D";
+    class_<MultiPatchCheckpointReader<TDim>, typename MultiPatchCheckpointReader<TDim>::Pointer, boost::noncopyable>
+    (ss.str().c_str(), init<const std::string&>())
+    .def("NumberOfPatches", &MultiPatchCheckpointReader<TDim>::NumberOfPatches)
+    .def("PatchIds", &MultiPatchCheckpointReader_PatchIds<TDim>)
+    .def("HasPatch", &MultiPatchCheckpointReader<TDim>::HasPatch)
+    .def("ReadPatch", &MultiPatchCheckpointReader<TDim>::pReadPatch)
+    .def("ReadMultiPatch", &MultiPatchCheckpointReader_ReadMultiPatch1<TDim>)
+    .def("ReadMultiPatch", &MultiPatchCheckpointReader_ReadMultiPatch2<TDim>)
+    .def(self_ns::str(self))
+    ;
+
 }
 
 void IsogeometricApplication_AddPatchesToPython()
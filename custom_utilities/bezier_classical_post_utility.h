@@ -34,11 +34,12 @@
 #include "spaces/ublas_space.h"
 #include "linear_solvers/linear_solver.h"
 #include "utilities/openmp_utils.h"
-#include "utilities/auto_collapse_spatial_binning.h"
 #include "custom_utilities/iga_define.h"
 #include "custom_geometries/isogeometric_geometry.h"
 #include "custom_utilities/isogeometric_utility.h"
 #include "custom_utilities/isogeometric_post_utility.h"
+#include "custom_utilities/l2_projection_system.h"
+#include "custom_utilities/node_welding_utility.h"
 #include "isogeometric_application/isogeometric_application.h"
 
 //#define DEBUG_LEVEL1
@@ -133,7 +134,8 @@ public:
 
     /// Default constructor.
     BezierClassicalPostUtility(ModelPart::Pointer pModelPart)
-    : mpModelPart(pModelPart)
+    : mpModelPart(pModelPart), mProjectionType(_CONSISTENT_L2_PROJECTION_)
+    , mpNodalTransferModelPartPost(NULL)
     {
     }
 
@@ -158,6 +160,8 @@ public:
         double start_compute = OpenMPUtils::GetCurrentTime();
         #endif
 
+        this->ResetNodalTransfer();
+
         #ifdef DEBUG_LEVEL1
         std::cout << typeid(*this).name() << "::GenerateModelPart" << std::endl;
         #endif
@@ -537,6 +541,8 @@ public:
         double start_compute = OpenMPUtils::GetCurrentTime();
         #endif
 
+        this->ResetNodalTransfer();
+
         #ifdef DEBUG_LEVEL1
         std::cout << typeid(*this).name() << "::GenerateModelPart" << std::endl;
         #endif
@@ -697,7 +703,9 @@ public:
     // Generate the post model_part from reference model_part
     // this is the improved version of GenerateModelPart
     // which uses template function to generate post Elements for both Element and Condition
-    // this version used a collapsing utility to collapse nodes automatically
+    // this version merges the coincident nodes automatically: the candidate nodes of all elements and conditions are
+    // generated concurrently and then welded in parallel with NodeWeldingUtility. The cell size of the welding is
+    // derived from the element sizes; dx, dy, dz are kept for compatibility and are not used anymore.
     void GenerateModelPart2AutoCollapse(ModelPart::Pointer pModelPartPost,
                                         double dx, double dy, double dz, double tol)
     {
@@ -705,38 +713,27 @@ public:
         double start_compute = OpenMPUtils::GetCurrentTime();
         #endif
 
+        this->ResetNodalTransfer();
+
         #ifdef DEBUG_LEVEL1
         std::cout << typeid(*this).name() << "::GenerateModelPart" << std::endl;
         #endif
 
-        AutoCollapseSpatialBinning collapse_util(0.0, 0.0, 0.0, dx, dy, dz, tol);
-
         ElementsArrayType& pElements = mpModelPart->Elements();
         ConditionsArrayType& pConditions = mpModelPart->Conditions();
 
         std::string NodeKey = std::string("Node");
 
-        IndexType NodeCounter = 0;
-        IndexType ElementCounter = 0;
-        boost::progress_display show_progress( pElements.size() );
-        VectorMap<IndexType, IndexType> MapToCollapseNode;
+        // collect the active elements and conditions and their post entity types
+        std::vector<Element::Pointer> pActiveElements;
+        std::vector<Element const*> pCloneElements;
         for (typename ElementsArrayType::ptr_iterator it = pElements.ptr_begin(); it != pElements.ptr_end(); ++it)
         {
             if((*it)->GetValue( IS_INACTIVE ))
-            {
-//                std::cout << "Element " << (*it)->Id() << " is inactive" << std::endl;
-                ++show_progress;
                 continue;
-            }
 
             int Dim = (*it)->GetGeometry().WorkingSpaceDimension(); // global dimension of the geometry that it works on
             int ReducedDim = (*it)->GetGeometry().Dimension(); // reduced dimension of the geometry
-            IndexType NodeCounter_old = NodeCounter;
-
-            #ifdef DEBUG_LEVEL1
-            KRATOS_WATCH(Dim)
-            KRATOS_WATCH(ReducedDim)
-            #endif
 
             //select the correct post element type
             std::string element_name;
@@ -762,39 +759,19 @@ public:
                 KRATOS_THROW_ERROR(std::runtime_error, buffer.str(), "");
             }
 
-            Element const& rCloneElement = KratosComponents<Element>::Get(element_name);
-
-            GenerateForOneEntityAutoCollapse<Element, ElementsArrayType, 1>(collapse_util,
-                *pModelPartPost, *(*it), rCloneElement, MapToCollapseNode, NodeCounter_old,
-                NodeCounter, ElementCounter, NodeKey);
-
-            ++show_progress;
+            pActiveElements.push_back(*it);
+            pCloneElements.push_back(&KratosComponents<Element>::Get(element_name));
         }
 
-        #ifdef DEBUG_LEVEL1
-        std::cout << "Done generating for elements" << std::endl;
-        #endif
-
-        IndexType ConditionCounter = 0;
-        boost::progress_display show_progress2( pConditions.size() );
+        std::vector<Condition::Pointer> pActiveConditions;
+        std::vector<Condition const*> pCloneConditions;
         for (typename ConditionsArrayType::ptr_iterator it = pConditions.ptr_begin(); it != pConditions.ptr_end(); ++it)
         {
             if((*it)->GetValue( IS_INACTIVE ))
-            {
-//                std::cout << "Condition " << (*it)->Id() << " is inactive" << std::endl;
-                ++show_progress2;
                 continue;
-            }
 
             int Dim = (*it)->GetGeometry().WorkingSpaceDimension(); // global dimension of the geometry that it works on
             int ReducedDim = (*it)->GetGeometry().Dimension(); // reduced dimension of the geometry
-            IndexType NodeCounter_old = NodeCounter;
-
-            #ifdef DEBUG_LEVEL1
-            KRATOS_WATCH(typeid((*it)->GetGeometry()).name())
-            KRATOS_WATCH(Dim)
-            KRATOS_WATCH(ReducedDim)
-            #endif
 
             //select the correct post condition type
             std::string condition_name;
@@ -820,22 +797,156 @@ public:
                 KRATOS_THROW_ERROR(std::runtime_error, buffer.str(), "");
             }
 
-            Condition const& rCloneCondition = KratosComponents<Condition>::Get(condition_name);
+            pActiveConditions.push_back(*it);
+            pCloneConditions.push_back(&KratosComponents<Condition>::Get(condition_name));
+        }
+
+        // the sampling divisions of each entity (elements first, then conditions) and the offsets of their candidate nodes
+        const IndexType NumberOfEntities = pActiveElements.size() + pActiveConditions.size();
+        std::vector<GeometryType*> pGeometries(NumberOfEntities);
+        std::vector<std::vector<IndexType> > Divisions(NumberOfEntities);
+        std::vector<IndexType> CandidatePtr(NumberOfEntities + 1);
+        CandidatePtr[0] = 0;
+        for(IndexType e = 0; e < NumberOfEntities; ++e)
+        {
+            if(e < pActiveElements.size())
+            {
+                pGeometries[e] = &pActiveElements[e]->GetGeometry();
+                GetSamplingDivisions(*pActiveElements[e], Divisions[e]);
+            }
+            else
+            {
+                pGeometries[e] = &pActiveConditions[e - pActiveElements.size()]->GetGeometry();
+                GetSamplingDivisions(*pActiveConditions[e - pActiveElements.size()], Divisions[e]);
+            }
+            CandidatePtr[e + 1] = CandidatePtr[e] + GetNumberOfSamplingPoints(Divisions[e]);
+        }
+
+        // phase 1: generate the candidate nodes of all entities concurrently
+        std::vector<double> CandidateCoordinates(3 * CandidatePtr[NumberOfEntities]);
+        std::vector<double> SamplingSpacings(NumberOfEntities, 0.0);
 
-            GenerateForOneEntityAutoCollapse<Condition, ConditionsArrayType, 2>(collapse_util,
-                *pModelPartPost, *(*it), rCloneCondition, MapToCollapseNode, NodeCounter_old,
-                NodeCounter, ConditionCounter, NodeKey);
+        int number_of_threads = omp_get_max_threads();
+        std::vector<unsigned int> entity_partition;
+        OpenMPUtils::CreatePartition(number_of_threads, NumberOfEntities, entity_partition);
 
-            ++show_progress2;
+        #pragma omp parallel for
+        for(int k = 0; k < number_of_threads; ++k)
+        {
+            CoordinatesArrayType p_ref;
+            CoordinatesArrayType p;
+            for(unsigned int e = entity_partition[k]; e < entity_partition[k + 1]; ++e)
+            {
+                double xmin[3] = {0.0, 0.0, 0.0}, xmax[3] = {0.0, 0.0, 0.0};
+                for(IndexType s = CandidatePtr[e]; s < CandidatePtr[e + 1]; ++s)
+                {
+                    GetSamplingPoint(Divisions[e], s - CandidatePtr[e], p_ref);
+                    p = GlobalCoordinates(*pGeometries[e], p, p_ref);
+                    for(int d = 0; d < 3; ++d)
+                    {
+                        CandidateCoordinates[3*s + d] = p[d];
+                        xmin[d] = (s == CandidatePtr[e]) ? p[d] : std::min(xmin[d], p[d]);
+                        xmax[d] = (s == CandidatePtr[e]) ? p[d] : std::max(xmax[d], p[d]);
+                    }
+                }
+
+                // approximated distance between two candidate nodes of the entity
+                IndexType max_division = 1;
+                for(IndexType d = 0; d < Divisions[e].size(); ++d)
+                    max_division = std::max(max_division, Divisions[e][d]);
+                SamplingSpacings[e] = sqrt(pow(xmax[0] - xmin[0], 2) + pow(xmax[1] - xmin[1], 2) + pow(xmax[2] - xmin[2], 2)) / max_division;
+            }
         }
 
         #ifdef ENABLE_PROFILING
         double end_compute = OpenMPUtils::GetCurrentTime();
+        std::cout << "Generate " << CandidatePtr[NumberOfEntities] << " candidate nodes completed: " << (end_compute - start_compute) << " s" << std::endl;
+        #endif
+
+        // phase 2: weld the candidate nodes. The cell size is half of the smallest spacing of the candidate nodes.
+        double characteristic_length = 0.0;
+        for(IndexType e = 0; e < NumberOfEntities; ++e)
+        {
+            if(SamplingSpacings[e] > 0.0 && (characteristic_length == 0.0 || SamplingSpacings[e] < characteristic_length))
+                characteristic_length = SamplingSpacings[e];
+        }
+        std::vector<IndexType> WeldedIndices;
+        IndexType NumberOfWeldedNodes = NodeWeldingUtility::Weld(CandidateCoordinates, tol, 0.5 * characteristic_length, WeldedIndices);
+
+        #ifdef ENABLE_PROFILING
+        std::cout << "Weld the candidate nodes completed: " << (OpenMPUtils::GetCurrentTime() - end_compute) << " s" << std::endl;
+        #endif
+
+        // phase 3: create the welded nodes, the id of a welded node is its index + 1. The node always points to the
+        // last local coordinates and element.
+        IndexType NodeCounter = 0;
+        CoordinatesArrayType p_ref;
+        for(IndexType e = 0; e < NumberOfEntities; ++e)
+        {
+            for(IndexType s = CandidatePtr[e]; s < CandidatePtr[e + 1]; ++s)
+            {
+                IndexType id = WeldedIndices[s] + 1;
+
+                if(WeldedIndices[s] == NodeCounter)
+                {
+                    ++NodeCounter;
+                    if(pModelPartPost->Nodes().find(id) == pModelPartPost->Nodes().end())
+                    {
+                        // this is a new node
+                        NodeType::Pointer pNewNode( new NodeType( id, CandidateCoordinates[3*s], CandidateCoordinates[3*s + 1], CandidateCoordinates[3*s + 2] ) );
+
+                        // Giving model part's variables list to the node
+                        pNewNode->SetSolutionStepVariablesList(&pModelPartPost->GetNodalSolutionStepVariablesList());
+
+                        //set buffer size
+                        pNewNode->SetBufferSize(pModelPartPost->GetBufferSize());
+
+                        pModelPartPost->AddNode(pNewNode);
+                    }
+                }
+
+                if(e < pActiveElements.size())
+                {
+                    GetSamplingPoint(Divisions[e], s - CandidatePtr[e], p_ref);
+                    mNodeToLocalCoordinates(id) = p_ref;
+                    mNodeToElement(id) = pActiveElements[e]->Id();
+                }
+            }
+        }
+
+        // phase 4: create the post elements and conditions on the welded nodes
+        IndexType ElementCounter = 0;
+        boost::progress_display show_progress( pActiveElements.size() );
+        for(IndexType e = 0; e < pActiveElements.size(); ++e)
+        {
+            GenerateForOneEntityWelded<Element, ElementsArrayType, 1>(*pModelPartPost, *pActiveElements[e], *pCloneElements[e],
+                Divisions[e], &WeldedIndices[CandidatePtr[e]], ElementCounter, NodeKey);
+            ++show_progress;
+        }
+        pModelPartPost->Elements().Unique();
+
+        #ifdef DEBUG_LEVEL1
+        std::cout << "Done generating for elements" << std::endl;
+        #endif
+
+        IndexType ConditionCounter = 0;
+        boost::progress_display show_progress2( pActiveConditions.size() );
+        for(IndexType c = 0; c < pActiveConditions.size(); ++c)
+        {
+            const IndexType e = pActiveElements.size() + c;
+            GenerateForOneEntityWelded<Condition, ConditionsArrayType, 2>(*pModelPartPost, *pActiveConditions[c], *pCloneConditions[c],
+                Divisions[e], &WeldedIndices[CandidatePtr[e]], ConditionCounter, NodeKey);
+            ++show_progress2;
+        }
+        pModelPartPost->Conditions().Unique();
+
+        #ifdef ENABLE_PROFILING
+        end_compute = OpenMPUtils::GetCurrentTime();
         std::cout << "Generate PostModelPart completed: " << (end_compute - start_compute) << " s" << std::endl;
         #else
         std::cout << "Generate PostModelPart completed" << std::endl;
         #endif
-        std::cout << NodeCounter << " nodes and " << ElementCounter << " elements" << ", " << ConditionCounter << " conditions are created" << std::endl;
+        std::cout << NumberOfWeldedNodes << " nodes and " << ElementCounter << " elements" << ", " << ConditionCounter << " conditions are created" << std::endl;
     }
 
     /**
@@ -855,6 +966,8 @@ public:
                               std::vector<std::size_t>& element_ids,
                               const bool& get_indices)
     {
+        this->ResetNodalTransfer();
+
 //        int ReducedDim = rE.GetGeometry().WorkingSpaceDimension();
         int ReducedDim = rE.GetGeometry().Dimension();
 
@@ -1231,23 +1344,73 @@ public:
     }
 
     /**
-     * Utility function to generate elements/conditions for element/condition.
-     * This uses a collapse utility to automatically merge the coincident nodes
+     * Get the number of divisions in each local direction to sample the post nodes of an element/condition.
+     * The 1D entities are not sampled.
+     */
+    template<class TEntityType>
+    static void GetSamplingDivisions(TEntityType& rE, std::vector<IndexType>& rDivisions)
+    {
+        int ReducedDim = rE.GetGeometry().Dimension();
+
+        rDivisions.clear();
+        if(ReducedDim == 2)
+        {
+            rDivisions.push_back(static_cast<IndexType>( rE.GetValue(NUM_DIVISION_1) ));
+            rDivisions.push_back(static_cast<IndexType>( rE.GetValue(NUM_DIVISION_2) ));
+        }
+        else if(ReducedDim == 3)
+        {
+            rDivisions.push_back(static_cast<IndexType>( rE.GetValue(NUM_DIVISION_1) ));
+            rDivisions.push_back(static_cast<IndexType>( rE.GetValue(NUM_DIVISION_2) ));
+            rDivisions.push_back(static_cast<IndexType>( rE.GetValue(NUM_DIVISION_3) ));
+        }
+    }
+
+    /**
+     * Get the number of sampling points for the given divisions
+     */
+    static IndexType GetNumberOfSamplingPoints(const std::vector<IndexType>& rDivisions)
+    {
+        if(rDivisions.size() == 0)
+            return 0;
+
+        IndexType n = 1;
+        for(IndexType d = 0; d < rDivisions.size(); ++d)
+            n *= (rDivisions[d] + 1);
+        return n;
+    }
+
+    /**
+     * Get the local coordinates of the s-th sampling point. The sampling points are ordered with the last direction
+     * running fastest, i.e. s = (i * (NumDivision2 + 1) + j) * (NumDivision3 + 1) + k.
+     */
+    static void GetSamplingPoint(const std::vector<IndexType>& rDivisions, IndexType s, CoordinatesArrayType& p_ref)
+    {
+        p_ref[0] = 0.0;
+        p_ref[1] = 0.0;
+        p_ref[2] = 0.0;
+        for(int d = static_cast<int>(rDivisions.size()) - 1; d >= 0; --d)
+        {
+            p_ref[d] = ((double) (s % (rDivisions[d] + 1))) / rDivisions[d];
+            s /= (rDivisions[d] + 1);
+        }
+    }
+
+    /**
+     * Utility function to generate elements/conditions for element/condition on the welded nodes.
+     * The id of the post node of the s-th sampling point of the entity is WeldedIndices[s] + 1.
      * if T==Element, type must be 1; otherwise type=2
      */
     template<class TEntityType, class TEntityContainerType, std::size_t type>
-    void GenerateForOneEntityAutoCollapse(AutoCollapseSpatialBinning& collapse_util,
-                                          ModelPart& rModelPart,
-                                          TEntityType& rE,
-                                          TEntityType const& rSample,
-                                          VectorMap<IndexType, IndexType>& rMapToCollapseNode,
-                                          IndexType NodeCounter_old,
-                                          IndexType& NodeCounter,
-                                          IndexType& EntityCounter,
-                                          const std::string& NodeKey)
+    void GenerateForOneEntityWelded(ModelPart& rModelPart,
+                                    TEntityType& rE,
+                                    TEntityType const& rSample,
+                                    const std::vector<IndexType>& rDivisions,
+                                    const IndexType* WeldedIndices,
+                                    IndexType& EntityCounter,
+                                    const std::string& NodeKey)
     {
-//        int ReducedDim = rE.GetGeometry().WorkingSpaceDimension();
-        int ReducedDim = rE.GetGeometry().Dimension();
+        this->ResetNodalTransfer();
 
         //get the properties
         Properties::Pointer pDummyProperties = rE.pGetProperties();
@@ -1260,348 +1423,105 @@ public:
         KRATOS_WATCH(*pDummyProperties)
         #endif
 
-        // generate list of nodes
-        if(ReducedDim == 1)
-        {
-            // TODO
-        }
-        else if(ReducedDim == 2)
-        {
-            IndexType NumDivision1 = static_cast<IndexType>( rE.GetValue(NUM_DIVISION_1) );
-            IndexType NumDivision2 = static_cast<IndexType>( rE.GetValue(NUM_DIVISION_2) );
-            IndexType i, j;
-            CoordinatesArrayType p_ref;
-            CoordinatesArrayType p;
+        std::vector<std::vector<IndexType> > connectivities;
 
-            #ifdef DEBUG_LEVEL1
-            KRATOS_WATCH(NumDivision1)
-            KRATOS_WATCH(NumDivision2)
-            std::cout << "Generating Nodes..." << std::endl;
-            #endif
+        if(rDivisions.size() == 2)
+        {
+            IndexType NumDivision1 = rDivisions[0];
+            IndexType NumDivision2 = rDivisions[1];
 
-            // create and add nodes
-            p_ref[2] = 0.0;
-            for(i = 0; i <= NumDivision1; ++i)
+            for(IndexType i = 0; i < NumDivision1; ++i)
             {
-                p_ref[0] = ((double) i) / NumDivision1;
-                for(j = 0; j <= NumDivision2; ++j)
+                for(IndexType j = 0; j < NumDivision2; ++j)
                 {
-                    p_ref[1] = ((double) j) / NumDivision2;
-
-                    p = GlobalCoordinates(rE.GetGeometry(), p, p_ref);
+                    IndexType Node1 = i * (NumDivision2 + 1) + j;
+                    IndexType Node2 = i * (NumDivision2 + 1) + j + 1;
+                    IndexType Node3 = (i + 1) * (NumDivision2 + 1) + j;
+                    IndexType Node4 = (i + 1) * (NumDivision2 + 1) + j + 1;
 
-                    IndexType id = static_cast<IndexType>( collapse_util.AddNode(p[0], p[1], p[2]) );
-                    ++NodeCounter;
-                    rMapToCollapseNode[NodeCounter] = id;
-
-                    if(rModelPart.Nodes().find(id) == rModelPart.Nodes().end())
-                    {
-                        // this is a new node
-                        NodeType::Pointer pNewNode( new NodeType( 0, p ) );
-                        pNewNode->SetId(id);
-
-                        // Giving model part's variables list to the node
-                        pNewNode->SetSolutionStepVariablesList(&rModelPart.GetNodalSolutionStepVariablesList());
-
-                        //set buffer size
-                        pNewNode->SetBufferSize(rModelPart.GetBufferSize());
+                    connectivities.push_back(std::vector<IndexType>{
+                        WeldedIndices[Node1] + 1,
+                        WeldedIndices[Node2] + 1,
+                        WeldedIndices[Node4] + 1,
+                        WeldedIndices[Node3] + 1});
+                }
+            }
+        }
+        else if(rDivisions.size() == 3)
+        {
+            IndexType NumDivision1 = rDivisions[0];
+            IndexType NumDivision2 = rDivisions[1];
+            IndexType NumDivision3 = rDivisions[2];
 
-                        rModelPart.AddNode(pNewNode);
-                    }
-                    else
+            for(IndexType i = 0; i < NumDivision1; ++i)
+            {
+                for(IndexType j = 0; j < NumDivision2; ++j)
+                {
+                    for(IndexType k = 0; k < NumDivision3; ++k)
                     {
-                        // this is an old node, not required to add to model_part
-                        // so do nothing
-                    }
+                        IndexType Node1 = (i * (NumDivision2 + 1) + j) * (NumDivision3 + 1) + k;
+                        IndexType Node2 = (i * (NumDivision2 + 1) + j + 1) * (NumDivision3 + 1) + k;
+                        IndexType Node3 = ((i + 1) * (NumDivision2 + 1) + j) * (NumDivision3 + 1) + k;
+                        IndexType Node4 = ((i + 1) * (NumDivision2 + 1) + j + 1) * (NumDivision3 + 1) + k;
+                        IndexType Node5 = Node1 + 1;
+                        IndexType Node6 = Node2 + 1;
+                        IndexType Node7 = Node3 + 1;
+                        IndexType Node8 = Node4 + 1;
 
-                    // in this way, the node will always point to the last local coodinates and element
-                    if(type == 1)
-                    {
-                        mNodeToLocalCoordinates(id) = p_ref;
-                        mNodeToElement(id) = rE.Id();
+                        connectivities.push_back(std::vector<IndexType>{
+                            WeldedIndices[Node1] + 1,
+                            WeldedIndices[Node2] + 1,
+                            WeldedIndices[Node4] + 1,
+                            WeldedIndices[Node3] + 1,
+                            WeldedIndices[Node5] + 1,
+                            WeldedIndices[Node6] + 1,
+                            WeldedIndices[Node8] + 1,
+                            WeldedIndices[Node7] + 1});
                     }
                 }
             }
+        }
+        else
+        {
+            // TODO
+            return;
+        }
 
-            //for correct mapping to element, the repetitive node is allowed.
-//            rModelPart.Nodes().Unique();
+        TEntityContainerType pNewEntities = IsogeometricPostUtility::CreateEntities<std::vector<std::vector<IndexType> >, TEntityType, TEntityContainerType>(
+            connectivities, rModelPart, rSample, EntityCounter, pDummyProperties, NodeKey);
 
-            #ifdef DEBUG_LEVEL1
-            KRATOS_WATCH(rModelPart.Nodes().size())
+        for (typename TEntityContainerType::ptr_iterator it2 = pNewEntities.ptr_begin(); it2 != pNewEntities.ptr_end(); ++it2)
+        {
+            AddToModelPart<TEntityType>(rModelPart, *it2);
             if(type == 1)
-                std::cout << "Generating Elements..." << std::endl;
-            else
-                std::cout << "Generating Conditions..." << std::endl;
-            #endif
-
-            // create and add element
-            // typename T::NodesArrayType temp_nodes;
-            // for(i = 0; i < NumDivision1; ++i)
-            // {
-            //     for(j = 0; j < NumDivision2; ++j)
-            //     {
-            //         int Node1 = NodeCounter_old + i * (NumDivision2 + 1) + j + 1;
-            //         int Node2 = NodeCounter_old + i * (NumDivision2 + 1) + j + 2;
-            //         int Node3 = NodeCounter_old + (i + 1) * (NumDivision2 + 1) + j + 1;
-            //         int Node4 = NodeCounter_old + (i + 1) * (NumDivision2 + 1) + j + 2;
-
-            //         // TODO: check if jacobian checking is necessary
-            //         temp_nodes.clear();
-            //         temp_nodes.push_back(*(FindKey(rModelPart.Nodes(), rMapToCollapseNode[Node1], NodeKey).base()));
-            //         temp_nodes.push_back(*(FindKey(rModelPart.Nodes(), rMapToCollapseNode[Node2], NodeKey).base()));
-            //         temp_nodes.push_back(*(FindKey(rModelPart.Nodes(), rMapToCollapseNode[Node4], NodeKey).base()));
-            //         temp_nodes.push_back(*(FindKey(rModelPart.Nodes(), rMapToCollapseNode[Node3], NodeKey).base()));
-
-            //         typename T::Pointer NewEntity = rSample.Create(++EntityCounter, temp_nodes, pDummyProperties);
-            //         AddToModelPart<T>(rModelPart, NewEntity);
-            //         if(type == 1)
-            //             mOldToNewElements[rE.Id()].insert(EntityCounter);
-            //         else if(type == 2)
-            //             mOldToNewConditions[rE.Id()].insert(EntityCounter);
-            //     }
-            // }
-
-            std::vector<std::vector<IndexType> > connectivities;
+                mOldToNewElements[rE.Id()].insert((*it2)->Id());
+            else if(type == 2)
+                mOldToNewConditions[rE.Id()].insert((*it2)->Id());
+        }
+    }
 
-            for(i = 0; i < NumDivision1; ++i)
+    // Synchronize the activation between model_parts
+    void SynchronizeActivation(ModelPart::Pointer pModelPartPost)
+    {
+        ElementsArrayType& pElements = mpModelPart->Elements();
+        for (typename ElementsArrayType::ptr_iterator it = pElements.ptr_begin(); it != pElements.ptr_end(); ++it)
+        {
+            std::set<IndexType> NewElements = mOldToNewElements[(*it)->Id()];
+            for(std::set<IndexType>::iterator it2 = NewElements.begin(); it2 != NewElements.end(); ++it2)
             {
-                for(j = 0; j < NumDivision2; ++j)
-                {
-                    IndexType Node1 = NodeCounter_old + i * (NumDivision2 + 1) + j + 1;
-                    IndexType Node2 = NodeCounter_old + i * (NumDivision2 + 1) + j + 2;
-                    IndexType Node3 = NodeCounter_old + (i + 1) * (NumDivision2 + 1) + j + 1;
-                    IndexType Node4 = NodeCounter_old + (i + 1) * (NumDivision2 + 1) + j + 2;
-
-                    connectivities.push_back(std::vector<IndexType>{
-                        rMapToCollapseNode[Node1],
-                        rMapToCollapseNode[Node2],
-                        rMapToCollapseNode[Node4],
-                        rMapToCollapseNode[Node3]});
-                }
+                pModelPartPost->GetElement(*it2).GetValue(IS_INACTIVE) = (*it)->GetValue( IS_INACTIVE );
             }
-
-            TEntityContainerType pNewEntities = IsogeometricPostUtility::CreateEntities<std::vector<std::vector<IndexType> >, TEntityType, TEntityContainerType>(
-                connectivities, rModelPart, rSample, EntityCounter, pDummyProperties, NodeKey);
-
-            for (typename TEntityContainerType::ptr_iterator it2 = pNewEntities.ptr_begin(); it2 != pNewEntities.ptr_end(); ++it2)
+        }
+        ConditionsArrayType& pConditions = mpModelPart->Conditions();
+        for (typename ConditionsArrayType::ptr_iterator it = pConditions.ptr_begin(); it != pConditions.ptr_end(); ++it)
+        {
+            std::set<IndexType> NewConditions = mOldToNewConditions[(*it)->Id()];
+            for(std::set<IndexType>::iterator it2 = NewConditions.begin(); it2 != NewConditions.end(); ++it2)
             {
-                AddToModelPart<TEntityType>(rModelPart, *it2);
-                if(type == 1)
-                    mOldToNewElements[rE.Id()].insert((*it2)->Id());
-                else if(type == 2)
-                    mOldToNewConditions[rE.Id()].insert((*it2)->Id());
+                pModelPartPost->GetCondition(*it2).GetValue(IS_INACTIVE) = (*it)->GetValue( IS_INACTIVE );
             }
-
-            if(type == 1)
-                rModelPart.Elements().Unique();
-            else if(type == 2)
-                rModelPart.Conditions().Unique();
-
-            #ifdef DEBUG_LEVEL1
-            if(type == 1)
-                KRATOS_WATCH(rModelPart.Elements().size())
-            else
-                KRATOS_WATCH(rModelPart.Conditions().size())
-            #endif
-        }
-        else if(ReducedDim == 3)
-        {
-            IndexType NumDivision1 = static_cast<IndexType>( rE.GetValue(NUM_DIVISION_1) );
-            IndexType NumDivision2 = static_cast<IndexType>( rE.GetValue(NUM_DIVISION_2) );
-            IndexType NumDivision3 = static_cast<IndexType>( rE.GetValue(NUM_DIVISION_3) );
-            IndexType i, j, k;
-            CoordinatesArrayType p_ref;
-            CoordinatesArrayType p;
-
-            #ifdef DEBUG_LEVEL1
-            KRATOS_WATCH(rE.Id())
-            KRATOS_WATCH(NumDivision1)
-            KRATOS_WATCH(NumDivision2)
-            KRATOS_WATCH(NumDivision3)
-            std::cout << "Generating Nodes..." << std::endl;
-            #endif
-
-            // create and add nodes
-            for(i = 0; i <= NumDivision1; ++i)
-            {
-                p_ref[0] = ((double) i) / NumDivision1;
-                for(j = 0; j <= NumDivision2; ++j)
-                {
-                    p_ref[1] = ((double) j) / NumDivision2;
-                    for(k = 0; k <= NumDivision3; ++k)
-                    {
-                        p_ref[2] = ((double) k) / NumDivision3;
-
-                        p = GlobalCoordinates(rE.GetGeometry(), p, p_ref);
-
-                        IndexType id = static_cast<IndexType>( collapse_util.AddNode(p[0], p[1], p[2]) );
-                        ++NodeCounter;
-                        rMapToCollapseNode[NodeCounter] = id;
-
-                        if(rModelPart.Nodes().find(id) == rModelPart.Nodes().end())
-                        {
-                            // this is a new node
-                            NodeType::Pointer pNewNode( new NodeType( 0, p ) );
-                            pNewNode->SetId(id);
-
-                            #ifdef DEBUG_GENERATE_MESH
-                            if(NodeCounter)
-                            {
-                                std::cout << "Node " << NodeCounter << " p_ref: " << p_ref << ", p: " << p << std::endl;
-                            }
-                            #endif
-
-                            // Giving model part's variables list to the node
-                            pNewNode->SetSolutionStepVariablesList(&rModelPart.GetNodalSolutionStepVariablesList());
-
-                            //set buffer size
-                            pNewNode->SetBufferSize(rModelPart.GetBufferSize());
-
-                            rModelPart.AddNode(pNewNode);
-                        }
-                        else
-                        {
-                            // this is an old node, not required to add to model_part
-                            // so do nothing
-                        }
-
-                        // in this way, the node will always point to the last local coodinates and element
-                        if(type == 1)
-                        {
-                            mNodeToLocalCoordinates(id) = p_ref;
-                            mNodeToElement(id) = rE.Id();
-                        }
-                    }
-                }
-            }
-
-            //for correct mapping to element, the repetitive node is allowed.
-//           rModelPart.Nodes().Unique();
-
-            #ifdef DEBUG_LEVEL1
-            KRATOS_WATCH(rModelPart.Nodes().size())
-            if(type == 1)
-                std::cout << "Generating Elements..." << std::endl;
-            else
-                std::cout << "Generating Conditions..." << std::endl;
-            #endif
-
-            // create and add element
-            // typename T::NodesArrayType temp_nodes;
-            // for(i = 0; i < NumDivision1; ++i)
-            // {
-            //     for(j = 0; j < NumDivision2; ++j)
-            //     {
-            //         for(k = 0; k < NumDivision3; ++k)
-            //         {
-            //             int Node1 = NodeCounter_old + (i * (NumDivision2 + 1) + j) * (NumDivision3 + 1) + k + 1;
-            //             int Node2 = NodeCounter_old + (i * (NumDivision2 + 1) + j + 1) * (NumDivision3 + 1) + k + 1;
-            //             int Node3 = NodeCounter_old + ((i + 1) * (NumDivision2 + 1) + j) * (NumDivision3 + 1) + k + 1;
-            //             int Node4 = NodeCounter_old + ((i + 1) * (NumDivision2 + 1) + j + 1) * (NumDivision3 + 1) + k + 1;
-            //             int Node5 = Node1 + 1;
-            //             int Node6 = Node2 + 1;
-            //             int Node7 = Node3 + 1;
-            //             int Node8 = Node4 + 1;
-
-            //             // TODO: check if jacobian checking is necessary
-            //             temp_nodes.clear();
-            //             temp_nodes.push_back(*(FindKey(rModelPart.Nodes(), rMapToCollapseNode[Node1], NodeKey).base()));
-            //             temp_nodes.push_back(*(FindKey(rModelPart.Nodes(), rMapToCollapseNode[Node2], NodeKey).base()));
-            //             temp_nodes.push_back(*(FindKey(rModelPart.Nodes(), rMapToCollapseNode[Node4], NodeKey).base()));
-            //             temp_nodes.push_back(*(FindKey(rModelPart.Nodes(), rMapToCollapseNode[Node3], NodeKey).base()));
-            //             temp_nodes.push_back(*(FindKey(rModelPart.Nodes(), rMapToCollapseNode[Node5], NodeKey).base()));
-            //             temp_nodes.push_back(*(FindKey(rModelPart.Nodes(), rMapToCollapseNode[Node6], NodeKey).base()));
-            //             temp_nodes.push_back(*(FindKey(rModelPart.Nodes(), rMapToCollapseNode[Node8], NodeKey).base()));
-            //             temp_nodes.push_back(*(FindKey(rModelPart.Nodes(), rMapToCollapseNode[Node7], NodeKey).base()));
-
-            //             typename T::Pointer NewEntity = rSample.Create(++EntityCounter, temp_nodes, pDummyProperties);
-            //             AddToModelPart<T>(rModelPart, NewEntity);
-            //             if(type == 1)
-            //                 mOldToNewElements[rE.Id()].insert(EntityCounter);
-            //             else if(type == 2)
-            //                 mOldToNewConditions[rE.Id()].insert(EntityCounter);
-            //         }
-            //     }
-            // }
-
-            std::vector<std::vector<IndexType> > connectivities;
-
-            for(i = 0; i < NumDivision1; ++i)
-            {
-                for(j = 0; j < NumDivision2; ++j)
-                {
-                    for(k = 0; k < NumDivision3; ++k)
-                    {
-                        IndexType Node1 = NodeCounter_old + (i * (NumDivision2 + 1) + j) * (NumDivision3 + 1) + k + 1;
-                        IndexType Node2 = NodeCounter_old + (i * (NumDivision2 + 1) + j + 1) * (NumDivision3 + 1) + k + 1;
-                        IndexType Node3 = NodeCounter_old + ((i + 1) * (NumDivision2 + 1) + j) * (NumDivision3 + 1) + k + 1;
-                        IndexType Node4 = NodeCounter_old + ((i + 1) * (NumDivision2 + 1) + j + 1) * (NumDivision3 + 1) + k + 1;
-                        IndexType Node5 = Node1 + 1;
-                        IndexType Node6 = Node2 + 1;
-                        IndexType Node7 = Node3 + 1;
-                        IndexType Node8 = Node4 + 1;
-
-                        connectivities.push_back(std::vector<IndexType>{
-                            rMapToCollapseNode[Node1],
-                            rMapToCollapseNode[Node2],
-                            rMapToCollapseNode[Node4],
-                            rMapToCollapseNode[Node3],
-                            rMapToCollapseNode[Node5],
-                            rMapToCollapseNode[Node6],
-                            rMapToCollapseNode[Node8],
-                            rMapToCollapseNode[Node7]});
-                    }
-                }
-            }
-
-            TEntityContainerType pNewEntities = IsogeometricPostUtility::CreateEntities<std::vector<std::vector<IndexType> >, TEntityType, TEntityContainerType>(
-                connectivities, rModelPart, rSample, EntityCounter, pDummyProperties, NodeKey);
-
-            for (typename TEntityContainerType::ptr_iterator it2 = pNewEntities.ptr_begin(); it2 != pNewEntities.ptr_end(); ++it2)
-            {
-                AddToModelPart<TEntityType>(rModelPart, *it2);
-                if(type == 1)
-                    mOldToNewElements[rE.Id()].insert((*it2)->Id());
-                else if(type == 2)
-                    mOldToNewConditions[rE.Id()].insert((*it2)->Id());
-            }
-
-            if(type == 1)
-                rModelPart.Elements().Unique();
-            else if(type == 2)
-                rModelPart.Conditions().Unique();
-
-            #ifdef DEBUG_LEVEL1
-            if(type == 1)
-                KRATOS_WATCH(rModelPart.Elements().size())
-            else
-                KRATOS_WATCH(rModelPart.Conditions().size())
-            #endif
-        }
-    }
-
-    // Synchronize the activation between model_parts
-    void SynchronizeActivation(ModelPart::Pointer pModelPartPost)
-    {
-        ElementsArrayType& pElements = mpModelPart->Elements();
-        for (typename ElementsArrayType::ptr_iterator it = pElements.ptr_begin(); it != pElements.ptr_end(); ++it)
-        {
-            std::set<IndexType> NewElements = mOldToNewElements[(*it)->Id()];
-            for(std::set<IndexType>::iterator it2 = NewElements.begin(); it2 != NewElements.end(); ++it2)
-            {
-                pModelPartPost->GetElement(*it2).GetValue(IS_INACTIVE) = (*it)->GetValue( IS_INACTIVE );
-            }
-        }
-        ConditionsArrayType& pConditions = mpModelPart->Conditions();
-        for (typename ConditionsArrayType::ptr_iterator it = pConditions.ptr_begin(); it != pConditions.ptr_end(); ++it)
-        {
-            std::set<IndexType> NewConditions = mOldToNewConditions[(*it)->Id()];
-            for(std::set<IndexType>::iterator it2 = NewConditions.begin(); it2 != NewConditions.end(); ++it2)
-            {
-                pModelPartPost->GetCondition(*it2).GetValue(IS_INACTIVE) = (*it)->GetValue( IS_INACTIVE );
-            }
-        }
-    }
+        }
+    }
 
     // transfer the elemental data
     template<class TVariableType>
@@ -1644,27 +1564,23 @@ public:
         double start_compute = OpenMPUtils::GetCurrentTime();
         #endif
 
-        NodesArrayType& pTargetNodes = pModelPartPost->Nodes();
-
-        ElementsArrayType& pElements = mpModelPart->Elements();
+        std::vector<int> is_active;
+        this->InitializeNodalTransfer(pModelPartPost, is_active);
 
-        typename TVariableType::Type Results;
-        CoordinatesArrayType LocalPos;
-        IndexType ElementId;
+        int number_of_threads = omp_get_max_threads();
+        std::vector<unsigned int> node_partition;
+        OpenMPUtils::CreatePartition(number_of_threads, mPostNodes.size(), node_partition);
 
-//        #pragma omp parallel for
-        //TODO: check this. This is not parallelized.
-        for(NodesArrayType::ptr_iterator it = pTargetNodes.ptr_begin(); it != pTargetNodes.ptr_end(); ++it)
+        #pragma omp parallel for
+        for(int k = 0; k < number_of_threads; ++k)
         {
-            IndexType key = (*it)->Id();
-            if(mNodeToElement.find(key) != mNodeToElement.end())
+            typename TVariableType::Type Results;
+            for(unsigned int i = node_partition[k]; i < node_partition[k + 1]; ++i)
             {
-                ElementId = mNodeToElement[key];
-                if( ! pElements(ElementId)->GetValue(IS_INACTIVE) ) // skip the inactive elements
+                if(is_active[mPostNodeElementIndices[i]]) // skip the inactive elements
                 {
-                    noalias(LocalPos) = mNodeToLocalCoordinates[key];
-                    Results = CalculateOnPoint(rThisVariable, Results, pElements(ElementId), LocalPos);
-                    (*it)->GetSolutionStepValue(rThisVariable) = Results;
+                    InterpolateOnPoint(rThisVariable, Results, i);
+                    mPostNodes[i]->GetSolutionStepValue(rThisVariable) = Results;
                 }
             }
         }
@@ -1675,6 +1591,63 @@ public:
         #endif
     }
 
+    // Synchronize post model_part with the reference model_part for several variables in one pass over the post nodes
+    void TransferNodalResults(
+        const std::vector<const Variable<double>*>& rDoubleVariables,
+        const std::vector<const Variable<Vector>*>& rVectorVariables,
+        const std::vector<const Variable<array_1d<double, 3> >*>& rArray1DVariables,
+        const ModelPart::Pointer pModelPartPost
+    )
+    {
+        #ifdef ENABLE_PROFILING
+        double start_compute = OpenMPUtils::GetCurrentTime();
+        #endif
+
+        std::vector<int> is_active;
+        this->InitializeNodalTransfer(pModelPartPost, is_active);
+
+        int number_of_threads = omp_get_max_threads();
+        std::vector<unsigned int> node_partition;
+        OpenMPUtils::CreatePartition(number_of_threads, mPostNodes.size(), node_partition);
+
+        #pragma omp parallel for
+        for(int k = 0; k < number_of_threads; ++k)
+        {
+            double DoubleResults;
+            Vector VectorResults;
+            array_1d<double, 3> Array1DResults;
+            for(unsigned int i = node_partition[k]; i < node_partition[k + 1]; ++i)
+            {
+                if(!is_active[mPostNodeElementIndices[i]]) // skip the inactive elements
+                    continue;
+
+                for(std::size_t v = 0; v < rDoubleVariables.size(); ++v)
+                {
+                    InterpolateOnPoint(*rDoubleVariables[v], DoubleResults, i);
+                    mPostNodes[i]->GetSolutionStepValue(*rDoubleVariables[v]) = DoubleResults;
+                }
+
+                for(std::size_t v = 0; v < rVectorVariables.size(); ++v)
+                {
+                    InterpolateOnPoint(*rVectorVariables[v], VectorResults, i);
+                    mPostNodes[i]->GetSolutionStepValue(*rVectorVariables[v]) = VectorResults;
+                }
+
+                for(std::size_t v = 0; v < rArray1DVariables.size(); ++v)
+                {
+                    InterpolateOnPoint(*rArray1DVariables[v], Array1DResults, i);
+                    mPostNodes[i]->GetSolutionStepValue(*rArray1DVariables[v]) = Array1DResults;
+                }
+            }
+        }
+
+        #ifdef ENABLE_PROFILING
+        double end_compute = OpenMPUtils::GetCurrentTime();
+        std::cout << "Transfer nodal point results for " << rDoubleVariables.size() + rVectorVariables.size() + rArray1DVariables.size()
+                  << " variables completed: " << end_compute - start_compute << " s" << std::endl;
+        #endif
+    }
+
     // Synchronize post model_part with the reference model_part
     template<class TVariableType>
     void TransferIntegrationPointResults(
@@ -1731,6 +1704,60 @@ public:
         #endif
     }
 
+    /// Set the type of the L2 projection used to transfer the integration point results to nodes
+    void SetProjectionType(const L2ProjectionType& Type)
+    {
+        mProjectionType = Type;
+    }
+
+    /// Get the type of the L2 projection used to transfer the integration point results to nodes
+    L2ProjectionType GetProjectionType() const
+    {
+        return mProjectionType;
+    }
+
+    // Synchronize post model_part with the reference model_part for several variables. The variables are projected
+    // to the nodes of the reference model_part together, with only one solve of the L2 projection system.
+    void TransferIntegrationPointResults(
+        const std::vector<const Variable<double>*>& rDoubleVariables,
+        const std::vector<const Variable<Vector>*>& rVectorVariables,
+        const ModelPart::Pointer pModelPartPost,
+        LinearSolverType::Pointer pSolver
+    )
+    {
+        #ifdef ENABLE_PROFILING
+        double start_compute = OpenMPUtils::GetCurrentTime();
+        std::cout << "########################################" << std::endl;
+        std::cout << "Transfer integration point results for "
+                  << rDoubleVariables.size() + rVectorVariables.size() << " variables starts" << std::endl;
+        #endif
+
+        // firstly transfer the variables from integration points of reference model_part to its nodes
+        TransferVariablesToNodes(pSolver, mpModelPart, rDoubleVariables, rVectorVariables);
+
+        // secondly transfer new nodal variables results to the post model_part
+        TransferNodalResults(rDoubleVariables, rVectorVariables, std::vector<const Variable<array_1d<double, 3> >*>(), pModelPartPost);
+
+        #ifdef ENABLE_PROFILING
+        double end_compute = OpenMPUtils::GetCurrentTime();
+        std::cout << "Transfer integration point results for "
+                  << rDoubleVariables.size() + rVectorVariables.size() << " variables completed: "
+                  << end_compute - start_compute << "s" << std::endl;
+        std::cout << "########################################" << std::endl;
+        #endif
+    }
+
+    // Transfer several variables to nodes for model_part, with only one solve of the L2 projection system
+    void TransferVariablesToNodes(
+        const std::vector<const Variable<double>*>& rDoubleVariables,
+        const std::vector<const Variable<Vector>*>& rVectorVariables,
+        ModelPart::Pointer pModelPart,
+        LinearSolverType::Pointer pSolver
+    )
+    {
+        TransferVariablesToNodes(pSolver, pModelPart, rDoubleVariables, rVectorVariables);
+    }
+
     /**
      * Utility function to renumber the nodes of the post model_part (for parallel merge)
      */
@@ -1845,6 +1872,15 @@ private:
     VectorMap<IndexType, IndexType> mNodeToElement; // vector map to store local coordinates of node on a NURBS entity
     std::map<IndexType, std::set<IndexType> > mOldToNewElements; // vector map to store id map from old element to new elements
     std::map<IndexType, std::set<IndexType> > mOldToNewConditions; // vector map to store id map from old condition to new conditions
+    L2ProjectionSystem mL2ProjectionSystem; // cached sparsity pattern, element coloring and mass matrix of the L2 projection
+    L2ProjectionType mProjectionType; // type of the L2 projection (consistent, lumped or diagonal scaled mass)
+
+    ModelPart* mpNodalTransferModelPartPost; // the post model_part of the cached node-element association, NULL if there is none
+    std::vector<NodeType::Pointer> mPostNodes; // post nodes associated with an element, indexed by position
+    std::vector<Element::Pointer> mPostElements; // unique elements of the post nodes
+    std::vector<IndexType> mPostNodeElementIndices; // index in mPostElements of the element of each post node
+    std::vector<IndexType> mPostNodeShapeFunctionsPtr; // offset of the shape function values of each post node
+    std::vector<double> mPostNodeShapeFunctionsValues; // shape function values at the local coordinates of the post nodes
 
     ///@}
     ///@name Private Operators
@@ -1877,222 +1913,234 @@ private:
         return rResult;
     }
 
+    /// Reset the cached association of the post nodes to the elements; it must be called whenever mNodeToElement or
+    /// mNodeToLocalCoordinates are written
+    void ResetNodalTransfer()
+    {
+        mpNodalTransferModelPartPost = NULL;
+    }
+
     /**
-     * Interpolation on element
+     * Initialize the association of the post nodes to the elements of the reference model_part. The post nodes, their
+     * elements and the shape function values at their local coordinates are stored in flat arrays indexed by the
+     * position of the post node, and are reused for the same post model_part until the node-element map is rebuilt by
+     * one of the GenerateModelPart* functions, which reset the cache. The activation of the elements is collected at
+     * each call, since it may change between the time steps.
+     *
+     * @param pModelPartPost    the post model_part
+     * @param is_active         the activation of the elements of the post nodes, indexed by mPostNodeElementIndices
      */
-    double CalculateOnPoint(
+    void InitializeNodalTransfer(const ModelPart::Pointer& pModelPartPost, std::vector<int>& is_active)
+    {
+        if(pModelPartPost.get() != mpNodalTransferModelPartPost)
+        {
+            mpNodalTransferModelPartPost = pModelPartPost.get();
+
+            mPostNodes.clear();
+            mPostElements.clear();
+            mPostNodeElementIndices.clear();
+            mPostNodeShapeFunctionsPtr.assign(1, 0);
+            mPostNodeShapeFunctionsValues.clear();
+
+            ElementsArrayType& pElements = mpModelPart->Elements();
+            std::map<IndexType, IndexType> element_indices;
+            Vector N;
+
+            // the map lookups and the shape function evaluations are done only once here
+            NodesArrayType& pTargetNodes = pModelPartPost->Nodes();
+            for(NodesArrayType::ptr_iterator it = pTargetNodes.ptr_begin(); it != pTargetNodes.ptr_end(); ++it)
+            {
+                IndexType key = (*it)->Id();
+                if(mNodeToElement.find(key) == mNodeToElement.end())
+                    continue;
+
+                IndexType ElementId = mNodeToElement[key];
+                std::map<IndexType, IndexType>::iterator it_e = element_indices.find(ElementId);
+                if(it_e == element_indices.end())
+                {
+                    it_e = element_indices.insert(std::make_pair(ElementId, mPostElements.size())).first;
+                    mPostElements.push_back(pElements(ElementId));
+                }
+
+                mPostElements[it_e->second]->GetGeometry().ShapeFunctionsValues(N, mNodeToLocalCoordinates[key]);
+
+                mPostNodes.push_back(*it);
+                mPostNodeElementIndices.push_back(it_e->second);
+                mPostNodeShapeFunctionsValues.insert(mPostNodeShapeFunctionsValues.end(), N.begin(), N.end());
+                mPostNodeShapeFunctionsPtr.push_back(mPostNodeShapeFunctionsValues.size());
+            }
+        }
+
+        is_active.resize(mPostElements.size());
+        for(std::size_t i = 0; i < mPostElements.size(); ++i)
+            is_active[i] = mPostElements[i]->GetValue(IS_INACTIVE) ? 0 : 1;
+    }
+
+    /**
+     * Interpolation on element at the i-th post node
+     */
+    double& InterpolateOnPoint(
         const Variable<double>& rVariable,
         double& rResult,
-        Element::Pointer& pElement,
-        const CoordinatesArrayType& rCoordinates
-    )
+        const std::size_t& i
+    ) const
     {
-        Vector N;
-        pElement->GetGeometry().ShapeFunctionsValues(N, rCoordinates);
+        const GeometryType& rGeometry = mPostElements[mPostNodeElementIndices[i]]->GetGeometry();
+        const double* N = &mPostNodeShapeFunctionsValues[mPostNodeShapeFunctionsPtr[i]];
 
         rResult = 0.0;
-        for(unsigned int i = 0; i < pElement->GetGeometry().size(); ++i)
-        {
-            double NodalValues = pElement->GetGeometry()[i].GetSolutionStepValue(rVariable);
-            rResult += N( i ) * NodalValues;
-        }
+        for(unsigned int j = 0; j < rGeometry.size(); ++j)
+            rResult += N[j] * rGeometry[j].GetSolutionStepValue(rVariable);
+
         return rResult;
     }
 
     /**
-     * Interpolation on element
+     * Interpolation on element at the i-th post node
      */
-    Vector& CalculateOnPoint(
+    Vector& InterpolateOnPoint(
         const Variable<Vector>& rVariable,
         Vector& rResult,
-        Element::Pointer& pElement,
-        const CoordinatesArrayType& rCoordinates
-    )
+        const std::size_t& i
+    ) const
     {
-        Vector N;
-        pElement->GetGeometry().ShapeFunctionsValues(N, rCoordinates);
+        const GeometryType& rGeometry = mPostElements[mPostNodeElementIndices[i]]->GetGeometry();
+        const double* N = &mPostNodeShapeFunctionsValues[mPostNodeShapeFunctionsPtr[i]];
 
-        for(unsigned int i = 0; i < pElement->GetGeometry().size(); ++i)
+        for(unsigned int j = 0; j < rGeometry.size(); ++j)
         {
-            Vector& NodalValues = pElement->GetGeometry()[i].GetSolutionStepValue(rVariable);
+            const Vector& NodalValues = rGeometry[j].GetSolutionStepValue(rVariable);
 
-            if(i == 0)
+            if(j == 0)
             {
-                rResult = N( i ) * NodalValues;
+                rResult = N[j] * NodalValues;
             }
             else
             {
-                noalias(rResult) += N( i ) * NodalValues;
+                noalias(rResult) += N[j] * NodalValues;
             }
         }
+
         return rResult;
     }
 
     /**
-     * Interpolation on element
+     * Interpolation on element at the i-th post node
      */
-    array_1d<double, 3>& CalculateOnPoint(
+    array_1d<double, 3>& InterpolateOnPoint(
         const Variable<array_1d<double, 3> >& rVariable,
         array_1d<double, 3>& rResult,
-        Element::Pointer& pElement,
-        const CoordinatesArrayType& rCoordinates
-    )
+        const std::size_t& i
+    ) const
     {
-        Vector N;
-        pElement->GetGeometry().ShapeFunctionsValues(N, rCoordinates);
+        const GeometryType& rGeometry = mPostElements[mPostNodeElementIndices[i]]->GetGeometry();
+        const double* N = &mPostNodeShapeFunctionsValues[mPostNodeShapeFunctionsPtr[i]];
 
         rResult[0] = 0.0;
         rResult[1] = 0.0;
         rResult[2] = 0.0;
-        for(unsigned int i = 0; i < pElement->GetGeometry().size(); ++i)
-        {
-            array_1d<double, 3> NodalValues = pElement->GetGeometry()[i].GetSolutionStepValue(rVariable);
-            rResult += N( i ) * NodalValues;
-        }
+        for(unsigned int j = 0; j < rGeometry.size(); ++j)
+            noalias(rResult) += N[j] * rGeometry[j].GetSolutionStepValue(rVariable);
 
         return rResult;
     }
 
     /**
-     * Transfer variable at integration points to nodes
+     * Initialize the L2 projection system of the model_part and assemble its mass matrix. The sparsity pattern, the
+     * coloring of the elements and the mass matrix are reused as long as the connectivities and the activation of the
+     * elements do not change, i.e. for all the variables and time steps on the same mesh.
      *
-     * @param pSolver       the solver used for solving the local system matrix
      * @param pModelPart    pointer to model_part that we wish to transfer the result from its integration points to its nodes
-     * @param rThisVariable the variable need to transfer the respected values
      */
-    void TransferVariablesToNodes(
-            LinearSolverType::Pointer& pSolver,
-            ModelPart::Pointer& pModelPart,
-            const Variable<double>& rThisVariable
-        )
+    void InitializeL2ProjectionSystem(ModelPart::Pointer& pModelPart)
     {
-        ElementsArrayType& ElementsArray= pModelPart->Elements();
+        ElementsArrayType& ElementsArray = pModelPart->Elements();
+        const std::size_t NumberOfNodes = pModelPart->NumberOfNodes();
+
+        // collect the connectivities and the activation of the elements
+        std::vector<std::size_t> element_ptr(ElementsArray.size() + 1);
+        std::vector<std::size_t> element_rows;
+        std::vector<int> element_status(ElementsArray.size());
+        element_ptr[0] = 0;
+        std::size_t cnt = 0;
+        for(ElementsArrayType::ptr_iterator it = ElementsArray.ptr_begin(); it != ElementsArray.ptr_end(); ++it, ++cnt)
+        {
+            for(unsigned int i = 0; i < (*it)->GetGeometry().size(); ++i)
+                element_rows.push_back((*it)->GetGeometry()[i].Id() - 1);
+            element_ptr[cnt + 1] = element_rows.size();
+            element_status[cnt] = (*it)->GetValue(IS_INACTIVE) ? 1 : 0;
+        }
 
-        //Initialize system of equations
-        int NumberOfNodes = pModelPart->NumberOfNodes();
-        SerialSparseSpaceType::MatrixType M(NumberOfNodes, NumberOfNodes);
-        noalias(M)= ZeroMatrix(NumberOfNodes, NumberOfNodes);
+        if(!mL2ProjectionSystem.IsCompatible(NumberOfNodes, element_ptr, element_rows, element_status))
+        {
+            #ifdef ENABLE_PROFILING
+            double start_compute = OpenMPUtils::GetCurrentTime();
+            #endif
 
-        SerialSparseSpaceType::VectorType g(NumberOfNodes);
-        noalias(g)= ZeroVector(NumberOfNodes);
+            mL2ProjectionSystem.Initialize(NumberOfNodes, element_ptr, element_rows, element_status);
 
-        SerialSparseSpaceType::VectorType b(NumberOfNodes);
-        noalias(b)= ZeroVector(NumberOfNodes);
+            #ifdef ENABLE_PROFILING
+            std::cout << "Initialize the L2 projection system completed: " << OpenMPUtils::GetCurrentTime() - start_compute << " s" << std::endl;
+            std::cout << mL2ProjectionSystem << std::endl;
+            #endif
+        }
 
-        // create the structure for M a priori
-        ConstructL2MatrixStructure<Element>(M, ElementsArray);
+        if(mL2ProjectionSystem.IsMassMatrixAssembled())
+            return;
+
+        #ifdef ENABLE_PROFILING
+        double start_compute = OpenMPUtils::GetCurrentTime();
+        #endif
 
         // Transfer of GaussianVariables to Nodal Variables via L_2-Minimization
         // see Jiao + Heath "Common-refinement-based data tranfer ..."
         // International Journal for numerical methods in engineering 61 (2004) 2402--2427
         // for general description of L_2-Minimization
-        // set up the system of equations
-
-        //create a partition of the element array
-        int number_of_threads = omp_get_max_threads();
-        std::vector<unsigned int> element_partition;
-        OpenMPUtils::CreatePartition(number_of_threads, ElementsArray.size(), element_partition);
+        AssembleL2ProjectionMassMatrix(mL2ProjectionSystem, ElementsArray.ptr_begin());
 
-        KRATOS_WATCH( number_of_threads )
-        std::cout << "element_partition:";
-        for (std::size_t i = 0; i < element_partition.size(); ++i)
-            std::cout << " " << element_partition[i];
-        std::cout << std::endl;
+        #ifdef ENABLE_PROFILING
+        std::cout << "Assemble the L2 projection mass matrix completed: " << OpenMPUtils::GetCurrentTime() - start_compute << " s" << std::endl;
+        #endif
+    }
 
-        //create the array of lock
-        std::vector< omp_lock_t > lock_array(NumberOfNodes);
-        for(unsigned int i = 0; i < NumberOfNodes; ++i)
-            omp_init_lock(&lock_array[i]);
+    /**
+     * Get the number of components of a Vector variable for the transfer to nodes
+     */
+    unsigned int GetVariableSize(ModelPart::Pointer& pModelPart, const Variable<Vector>& rThisVariable) const
+    {
+        ElementsArrayType& ElementsArray = pModelPart->Elements();
 
-        #pragma omp parallel for
-        for(int k = 0; k < number_of_threads; ++k)
+        const unsigned int& Dim = (*(ElementsArray.ptr_begin()))->GetGeometry().WorkingSpaceDimension();
+        if(rThisVariable.Name() == std::string("STRESSES")
+            || rThisVariable.Name() == std::string("PLASTIC_STRAIN_VECTOR")
+            || rThisVariable.Name() == std::string("PRESTRESS")
+            || rThisVariable.Name() == std::string("STRAIN")
+            // TODO: extend for more variables
+        )
         {
-            Matrix InvJ(3, 3);
-            double DetJ;
-            unsigned int row, col;
-
-            typename ElementsArrayType::ptr_iterator it_begin = ElementsArray.ptr_begin() + element_partition[k];
-            typename ElementsArrayType::ptr_iterator it_end = ElementsArray.ptr_begin() + element_partition[k + 1];
-
-            for( ElementsArrayType::ptr_iterator it = it_begin; it != it_end; ++it )
-            {
-                if(!(*it)->GetValue(IS_INACTIVE))
-                {
-                    const IntegrationPointsArrayType& integration_points
-                    = (*it)->GetGeometry().IntegrationPoints((*it)->GetIntegrationMethod());
-
-                    GeometryType::JacobiansType J(integration_points.size());
-
-    //                J = (*it)->GetGeometry().Jacobian(J, (*it)->GetIntegrationMethod());
-    //                const Matrix& Ncontainer = (*it)->GetGeometry().ShapeFunctionsValues((*it)->GetIntegrationMethod());
-
-                    IsogeometricGeometryType& rIsogeometricGeometry = dynamic_cast<IsogeometricGeometryType&>((*it)->GetGeometry());
-                    J = rIsogeometricGeometry.Jacobian0(J, (*it)->GetIntegrationMethod());
-
-                    GeometryType::ShapeFunctionsGradientsType DN_De;
-                    Matrix Ncontainer;
-                    rIsogeometricGeometry.CalculateShapeFunctionsIntegrationPointsValuesAndLocalGradients(
-                        Ncontainer,
-                        DN_De,
-                        (*it)->GetIntegrationMethod()
-                    );
-
-                    // get the values at the integration_points
-                    std::vector<double> ValuesOnIntPoint(integration_points.size());
-                    (*it)->GetValueOnIntegrationPoints(rThisVariable, ValuesOnIntPoint, pModelPart->GetProcessInfo());
-
-                    for(unsigned int point = 0; point< integration_points.size(); ++point)
-                    {
-                        MathUtils<double>::InvertMatrix(J[point], InvJ, DetJ);
-
-                        double dV = DetJ * integration_points[point].Weight();
-                        for(unsigned int prim = 0 ; prim < (*it)->GetGeometry().size(); ++prim)
-                        {
-                            row = (*it)->GetGeometry()[prim].Id()-1;
-                            omp_set_lock(&lock_array[row]);
-                            b(row) += (ValuesOnIntPoint[point]) * Ncontainer(point, prim) * dV;
-                            for(unsigned int sec = 0 ; sec < (*it)->GetGeometry().size(); ++sec)
-                            {
-                                col = (*it)->GetGeometry()[sec].Id()-1;
-                                M(row, col) += Ncontainer(point, prim) * Ncontainer(point, sec) * dV;
-                            }
-                            omp_unset_lock(&lock_array[row]);
-                        }
-                    }
-                }
-                else
-                {
-                    // for inactive elements the contribution to LHS is identity matrix and RHS is zero
-                    for(unsigned int prim = 0 ; prim < (*it)->GetGeometry().size(); ++prim)
-                    {
-                        row = (*it)->GetGeometry()[prim].Id()-1;
-                        omp_set_lock(&lock_array[row]);
-//                        b(row) += 0.0;
-                        for(unsigned int sec = 0 ; sec < (*it)->GetGeometry().size(); ++sec)
-                        {
-                            col = (*it)->GetGeometry()[sec].Id()-1;
-                            if(col == row)
-                                M(row, col) += 1.0;
-//                            else
-//                                M(row, col) += 0.0;
-                        }
-                        omp_unset_lock(&lock_array[row]);
-                    }
-                }
-            }
+            return Dim * (Dim + 1) / 2;
         }
+        else
+            KRATOS_THROW_ERROR(std::logic_error, rThisVariable.Name(), " is not a supported variable for TransferVariablesToNodes routine.")
 
-        for(unsigned int i = 0; i < NumberOfNodes; ++i)
-            omp_destroy_lock(&lock_array[i]);
-
-        // solver the system
-        pSolver->Solve(M, g, b);
+        return 0;
+    }
 
-        // transfer the solution to the nodal variables
-        for(ModelPart::NodeIterator it = pModelPart->NodesBegin(); it != pModelPart->NodesEnd(); ++it)
-        {
-            it->GetSolutionStepValue(rThisVariable) = g((it->Id()-1));
-        }
+    /**
+     * Transfer variable at integration points to nodes
+     *
+     * @param pSolver       the solver used for solving the local system matrix
+     * @param pModelPart    pointer to model_part that we wish to transfer the result from its integration points to its nodes
+     * @param rThisVariable the variable need to transfer the respected values
+     */
+    void TransferVariablesToNodes(
+            LinearSolverType::Pointer& pSolver,
+            ModelPart::Pointer& pModelPart,
+            const Variable<double>& rThisVariable
+        )
+    {
+        TransferVariablesToNodes(pSolver, pModelPart, std::vector<const Variable<double>*>(1, &rThisVariable),
+            std::vector<const Variable<Vector>*>());
     }
 
     /**
@@ -2120,21 +2168,31 @@ private:
             const Variable<Vector>& rThisVariable
         )
     {
-        ElementsArrayType& ElementsArray = pModelPart->Elements();
+        TransferVariablesToNodes(pSolver, pModelPart, std::vector<const Variable<double>*>(),
+            std::vector<const Variable<Vector>*>(1, &rThisVariable));
+    }
 
-        const unsigned int& Dim = (*(ElementsArray.ptr_begin()))->GetGeometry().WorkingSpaceDimension();
-        unsigned int VariableSize;
-        if(rThisVariable.Name() == std::string("STRESSES")
-            || rThisVariable.Name() == std::string("PLASTIC_STRAIN_VECTOR")
-            || rThisVariable.Name() == std::string("PRESTRESS")
-            || rThisVariable.Name() == std::string("STRAIN")
-            // TODO: extend for more variables
+    /**
+     * Transfer several variables at integration points to nodes with a single projection. The right hand sides of all
+     * the variables and their components are assembled in one pass over the elements and solved together, with the
+     * projection type set by SetProjectionType.
+     *
+     * @param pSolver           the solver used for solving the local system matrix; it must support multiple right hand
+     *                          sides for the consistent projection of more than one component
+     * @param pModelPart        pointer to model_part that we wish to transfer the result from its integration points to its nodes
+     * @param rDoubleVariables  the double variables need to transfer the respected values
+     * @param rVectorVariables  the Vector variables need to transfer the respected values
+     */
+    void TransferVariablesToNodes(
+            LinearSolverType::Pointer& pSolver,
+            ModelPart::Pointer& pModelPart,
+            const std::vector<const Variable<double>*>& rDoubleVariables,
+            const std::vector<const Variable<Vector>*>& rVectorVariables
         )
-        {
-            VariableSize = Dim * (Dim + 1) / 2;
-        }
-        else
-            KRATOS_THROW_ERROR(std::logic_error, rThisVariable.Name(), " is not a supported variable for TransferVariablesToNodes routine.")
+    {
+        std::vector<std::size_t> VectorSizes(rVectorVariables.size());
+        for(std::size_t i = 0; i < rVectorVariables.size(); ++i)
+            VectorSizes[i] = GetVariableSize(pModelPart, *rVectorVariables[i]);
 
         #ifdef ENABLE_PROFILING
         //profiling variables
@@ -2142,162 +2200,61 @@ private:
         start_compute = OpenMPUtils::GetCurrentTime();
         #endif
 
-        //Initialize system of equations
-        unsigned int NumberOfNodes = pModelPart->NumberOfNodes();
-        SerialSparseSpaceType::MatrixType M(NumberOfNodes, NumberOfNodes);
-        noalias(M)= ZeroMatrix(NumberOfNodes, NumberOfNodes);
-
-        // create the structure for M a priori
-        ConstructL2MatrixStructure<Element>(M, ElementsArray);
+        // initialize the system of equations; the mass matrix is assembled only once for the mesh
+        this->InitializeL2ProjectionSystem(pModelPart);
 
         #ifdef ENABLE_PROFILING
         end_compute = OpenMPUtils::GetCurrentTime();
-        std::cout << "ConstructMatrixStructure completed: " << end_compute - start_compute << " s" << std::endl;
+        std::cout << "InitializeL2ProjectionSystem completed: " << end_compute - start_compute << " s" << std::endl;
         start_compute = end_compute;
         #endif
 
-        SerialDenseSpaceType::MatrixType g(NumberOfNodes, VariableSize);
-        noalias(g)= ZeroMatrix(NumberOfNodes, VariableSize);
-        SerialDenseSpaceType::MatrixType b(NumberOfNodes, VariableSize);
-        noalias(b)= ZeroMatrix(NumberOfNodes, VariableSize);
-
-        std::vector< omp_lock_t > lock_array(NumberOfNodes);
-
-        for(unsigned int i = 0; i < NumberOfNodes; ++i)
-            omp_init_lock(&lock_array[i]);
-
-        //create a partition of the element array
-        int number_of_threads = omp_get_max_threads();
-        std::vector<unsigned int> element_partition;
-        OpenMPUtils::CreatePartition(number_of_threads, ElementsArray.size(), element_partition);
-
-        KRATOS_WATCH( number_of_threads )
-        std::cout << "element_partition:";
-        for (std::size_t i = 0; i < element_partition.size(); ++i)
-            std::cout << " " << element_partition[i];
-        std::cout << std::endl;
-
-        #pragma omp parallel for
-        for(int k = 0; k < number_of_threads; ++k)
-        {
-            Matrix InvJ(Dim, Dim);
-            double DetJ;
-            unsigned int row, col;
-
-            typename ElementsArrayType::ptr_iterator it_begin = ElementsArray.ptr_begin() + element_partition[k];
-            typename ElementsArrayType::ptr_iterator it_end = ElementsArray.ptr_begin() + element_partition[k + 1];
-
-            for( ElementsArrayType::ptr_iterator it = it_begin; it != it_end; ++it )
-            {
-                if(!(*it)->GetValue(IS_INACTIVE))
-                {
-                    const IntegrationPointsArrayType& integration_points
-                    = (*it)->GetGeometry().IntegrationPoints((*it)->GetIntegrationMethod());
-
-                    GeometryType::JacobiansType J(integration_points.size());
-
-    //                J = (*it)->GetGeometry().Jacobian(J, (*it)->GetIntegrationMethod());
-    //                const Matrix& Ncontainer = (*it)->GetGeometry().ShapeFunctionsValues((*it)->GetIntegrationMethod());
-
-                    IsogeometricGeometryType& rIsogeometricGeometry = dynamic_cast<IsogeometricGeometryType&>((*it)->GetGeometry());
-                    J = rIsogeometricGeometry.Jacobian0(J, (*it)->GetIntegrationMethod());
-
-                    GeometryType::ShapeFunctionsGradientsType DN_De;
-                    Matrix Ncontainer;
-                    rIsogeometricGeometry.CalculateShapeFunctionsIntegrationPointsValuesAndLocalGradients(
-                        Ncontainer,
-                        DN_De,
-                        (*it)->GetIntegrationMethod()
-                    );
-
-                    // get the values at the integration_points
-                    std::vector<Vector> ValuesOnIntPoint(integration_points.size());
-                    (*it)->GetValueOnIntegrationPoints(rThisVariable, ValuesOnIntPoint, pModelPart->GetProcessInfo());
-
-                    for(unsigned int point = 0; point < integration_points.size(); ++point)
-                    {
-                        MathUtils<double>::InvertMatrix(J[point], InvJ, DetJ);
-
-                        double dV = DetJ * integration_points[point].Weight();
-
-                        for(unsigned int prim = 0; prim < (*it)->GetGeometry().size(); ++prim)
-                        {
-                            row = (*it)->GetGeometry()[prim].Id() - 1;
-
-                            omp_set_lock(&lock_array[row]);
-
-                            for(unsigned int i = 0; i < VariableSize; ++i)
-                                b(row, i) += ValuesOnIntPoint[point][i] * Ncontainer(point, prim) * dV;
-
-                            for(unsigned int sec = 0; sec < (*it)->GetGeometry().size(); ++sec)
-                            {
-                                col = (*it)->GetGeometry()[sec].Id() - 1;
-                                M(row, col) += Ncontainer(point, prim) * Ncontainer(point, sec) * dV;
-                            }
-
-                            omp_unset_lock(&lock_array[row]);
-                        }
-                    }
-                }
-                else
-                {
-                    // for inactive elements the contribution to LHS is identity matrix and RHS is zero
-                    for(unsigned int prim = 0; prim < (*it)->GetGeometry().size(); ++prim)
-                    {
-                        row = (*it)->GetGeometry()[prim].Id() - 1;
-
-                        omp_set_lock(&lock_array[row]);
-
-//                        for(unsigned int i = 0; i < VariableSize; ++i)
-//                            b(row, i) += 0.0;
-
-                        for(unsigned int sec = 0; sec < (*it)->GetGeometry().size(); ++sec)
-                        {
-                            col = (*it)->GetGeometry()[sec].Id() - 1;
-                            if(col == row)
-                                M(row, col) += 1.0;
-//                            else
-//                                M(row, col) += 0.0;
-                        }
-
-                        omp_unset_lock(&lock_array[row]);
-                    }
-                }
-            }
-        }
-
-        for(unsigned int i = 0; i < NumberOfNodes; ++i)
-            omp_destroy_lock(&lock_array[i]);
+        // assemble the right hand sides
+        SerialDenseSpaceType::MatrixType b;
+        AssembleL2ProjectionRightHandSide(mL2ProjectionSystem, pModelPart->Elements().ptr_begin(),
+            rDoubleVariables, rVectorVariables, VectorSizes, pModelPart->GetProcessInfo(), b);
 
         #ifdef ENABLE_PROFILING
         end_compute = OpenMPUtils::GetCurrentTime();
-        std::cout << "Assemble the matrix completed: " << end_compute - start_compute << " s" << std::endl;
+        std::cout << "Assemble the right hand side completed: " << end_compute - start_compute << " s" << std::endl;
         start_compute = end_compute;
         #endif
 
         #ifdef DEBUG_MULTISOLVE
-        KRATOS_WATCH(M)
         KRATOS_WATCH(b)
         KRATOS_WATCH(*pSolver)
         #endif
 
         // solve the system
-        // solver must support the multisove method
-        pSolver->Solve(M, g, b);
+        SerialDenseSpaceType::MatrixType g;
+        mL2ProjectionSystem.Solve(pSolver, mProjectionType, g, b);
 
         #ifdef DEBUG_MULTISOLVE
         KRATOS_WATCH(g)
         #endif
 
+        #ifdef ENABLE_PROFILING
+        end_compute = OpenMPUtils::GetCurrentTime();
+        std::cout << "Solve the L2 projection system completed: " << end_compute - start_compute << " s" << std::endl;
+        #endif
+
         // transfer the solution to the nodal variables
         for(ModelPart::NodeIterator it = pModelPart->NodesBegin(); it != pModelPart->NodesEnd(); ++it)
         {
-            Vector tmp(VariableSize);
-            for(unsigned int i = 0; i < VariableSize; ++i)
+            std::size_t column = 0;
+            for(std::size_t v = 0; v < rDoubleVariables.size(); ++v, ++column)
+                it->GetSolutionStepValue(*rDoubleVariables[v]) = g((it->Id()-1), column);
+
+            for(std::size_t v = 0; v < rVectorVariables.size(); ++v)
             {
-                tmp(i) = g((it->Id()-1), i);
+                Vector tmp(VectorSizes[v]);
+                for(unsigned int i = 0; i < VectorSizes[v]; ++i)
+                {
+                    tmp(i) = g((it->Id()-1), column + i);
+                }
+                it->GetSolutionStepValue(*rVectorVariables[v]) = tmp;
+                column += VectorSizes[v];
             }
-            it->GetSolutionStepValue(rThisVariable) = tmp;
         }
     }
 
@@ -2321,6 +2278,8 @@ private:
 
     /// Copy constructor.
     BezierClassicalPostUtility(BezierClassicalPostUtility const& rOther)
+    : mProjectionType(rOther.mProjectionType)
+    , mpNodalTransferModelPartPost(NULL)
     {
     }
 
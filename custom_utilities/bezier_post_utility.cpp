@@ -73,189 +73,8 @@ namespace Kratos
 
     void BezierPostUtility::TransferVariablesToNodes(LinearSolverType::Pointer& pSolver,
         ModelPart& r_model_part, ElementsArrayType& ElementsArray,
-        const Variable<double>& rThisVariable, const bool& check_active) const
-    {
-        std::set<std::size_t> active_nodes;
-        for( ElementsArrayType::ptr_iterator it = ElementsArray.ptr_begin(); it != ElementsArray.ptr_end(); ++it )
-        {
-            bool is_active = true;
-            if (check_active)
-                is_active = ((*it)->GetValue(IS_INACTIVE) == false) || (*it)->Is(ACTIVE);
-
-            if( is_active )
-            {
-                for( std::size_t i = 0; i < (*it)->GetGeometry().size(); ++i )
-                {
-                    active_nodes.insert( (*it)->GetGeometry()[i].Id() );
-                }
-            }
-        }
-
-        #ifdef ENABLE_DEBUG
-        KRATOS_WATCH(active_nodes.size())
-        #endif
-
-        // assign each node an id. That id is the row of this node in the global L2 projection matrix
-        std::size_t cnt = 0;
-        std::map<std::size_t, std::size_t> node_row_id;
-        for( std::set<std::size_t>::iterator it = active_nodes.begin(); it != active_nodes.end(); ++it )
-        {
-            node_row_id[*it] = cnt++;
-        }
-
-        // create and initialize matrix and vectors
-        std::size_t NumberOfNodes = active_nodes.size();
-        SerialSparseSpaceType::MatrixType M(NumberOfNodes, NumberOfNodes);
-        noalias(M) = ZeroMatrix(NumberOfNodes, NumberOfNodes);
-
-        SerialSparseSpaceType::VectorType g(NumberOfNodes);
-        noalias(g) = ZeroVector(NumberOfNodes);
-
-        SerialSparseSpaceType::VectorType b(NumberOfNodes);
-        noalias(b) = ZeroVector(NumberOfNodes);
-
-        // create the structure for M a priori
-        ConstructL2MatrixStructure<Element>(M, ElementsArray, node_row_id);
-
-        // Transfer of GaussianVariables to Nodal Variables via L_2-Minimization
-        // see Jiao + Heath "Common-refinement-based data tranfer ..."
-        // International Journal for numerical methods in engineering 61 (2004) 2402--2427
-        // for general description of L_2-Minimization
-
-        // set up the system of equations
-        //create a partition of the element array
-        int number_of_threads = omp_get_max_threads();
-        std::vector<unsigned int> element_partition;
-        OpenMPUtils::CreatePartition(number_of_threads, ElementsArray.size(), element_partition);
-
-        #ifdef ENABLE_DEBUG
-        KRATOS_WATCH( number_of_threads )
-        std::cout << "element_partition:";
-        for (std::size_t i = 0; i < element_partition.size(); ++i)
-            std::cout << " " << element_partition[i];
-        std::cout << std::endl;
-        #endif
-
-        //create the array of lock for matrix/vector assembly
-        std::vector< omp_lock_t > lock_array(NumberOfNodes);
-        for(unsigned int i = 0; i < NumberOfNodes; ++i)
-            omp_init_lock(&lock_array[i]);
-
-        #pragma omp parallel for
-        for(int k = 0; k < number_of_threads; ++k)
-        {
-            Matrix InvJ(3, 3);
-            double DetJ;
-            unsigned int row, col;
-
-            typename ElementsArrayType::ptr_iterator it_begin = ElementsArray.ptr_begin() + element_partition[k];
-            typename ElementsArrayType::ptr_iterator it_end = ElementsArray.ptr_begin() + element_partition[k + 1];
-
-            for( ElementsArrayType::ptr_iterator it = it_begin; it != it_end; ++it )
-            {
-                if(!(*it)->GetValue(IS_INACTIVE))
-                {
-                    const IntegrationPointsArrayType& integration_points
-                    = (*it)->GetGeometry().IntegrationPoints((*it)->GetIntegrationMethod());
-
-                    GeometryType::JacobiansType J(integration_points.size());
-
-    //                J = (*it)->GetGeometry().Jacobian(J, (*it)->GetIntegrationMethod());
-    //                const Matrix& Ncontainer = (*it)->GetGeometry().ShapeFunctionsValues((*it)->GetIntegrationMethod());
-
-                    IsogeometricGeometryType& rIsogeometricGeometry = dynamic_cast<IsogeometricGeometryType&>((*it)->GetGeometry());
-                    J = rIsogeometricGeometry.Jacobian0(J, (*it)->GetIntegrationMethod());
-
-                    GeometryType::ShapeFunctionsGradientsType DN_De;
-                    Matrix Ncontainer;
-                    rIsogeometricGeometry.CalculateShapeFunctionsIntegrationPointsValuesAndLocalGradients(
-                        Ncontainer,
-                        DN_De,
-                        (*it)->GetIntegrationMethod()
-                    );
-
-                    // get the values at the integration_points
-                    std::vector<double> ValuesOnIntPoint(integration_points.size());
-                    (*it)->GetValueOnIntegrationPoints(rThisVariable, ValuesOnIntPoint, r_model_part.GetProcessInfo());
-
-                    for(unsigned int point = 0; point< integration_points.size(); ++point)
-                    {
-                        MathUtils<double>::InvertMatrix(J[point], InvJ, DetJ);
-
-                        double dV = DetJ * integration_points[point].Weight();
-                        for(unsigned int prim = 0 ; prim < (*it)->GetGeometry().size(); ++prim)
-                        {
-                            row = node_row_id[(*it)->GetGeometry()[prim].Id()];
-                            omp_set_lock(&lock_array[row]);
-                            b(row) += (ValuesOnIntPoint[point]) * Ncontainer(point, prim) * dV;
-                            for(unsigned int sec = 0 ; sec < (*it)->GetGeometry().size(); ++sec)
-                            {
-                                col = node_row_id[(*it)->GetGeometry()[sec].Id()];
-                                M(row, col) += Ncontainer(point, prim) * Ncontainer(point, sec) * dV;
-                            }
-                            omp_unset_lock(&lock_array[row]);
-                        }
-                    }
-                }
-                else
-                {
-                    // for inactive elements the contribution to LHS is identity matrix and RHS is zero
-                    for(unsigned int prim = 0 ; prim < (*it)->GetGeometry().size(); ++prim)
-                    {
-                        row = node_row_id[(*it)->GetGeometry()[prim].Id()];
-                        omp_set_lock(&lock_array[row]);
-//                        b(row) += 0.0;
-                        for(unsigned int sec = 0 ; sec < (*it)->GetGeometry().size(); ++sec)
-                        {
-                            col = node_row_id[(*it)->GetGeometry()[sec].Id()];
-                            if(col == row)
-                                M(row, col) += 1.0;
-//                            else
-//                                M(row, col) += 0.0;
-                        }
-                        omp_unset_lock(&lock_array[row]);
-                    }
-                }
-            }
-        }
-
-        for(unsigned int i = 0; i < NumberOfNodes; ++i)
-            omp_destroy_lock(&lock_array[i]);
-
-        // solver the system
-        pSolver->Solve(M, g, b);
-
-        // transfer the solution to the nodal variables
-        // for(ModelPart::NodeIterator it = r_model_part.NodesBegin(); it != r_model_part.NodesEnd(); ++it)
-        // {
-        //     unsigned int row = node_row_id[it->Id()];
-        //     std::map<std::size_t, std::size_t>::iterator it_r = node_row_id.find(it->Id());
-        //     if (it_r == node_row_id.end()) continue;
-        //     it->GetSolutionStepValue(rThisVariable) = g(*it_r);
-        // }
-
-        for( std::set<std::size_t>::iterator it = active_nodes.begin(); it != active_nodes.end(); ++it )
-        {
-            std::size_t row = node_row_id[*it];
-            NodeType& r_node = r_model_part.GetMesh().GetNode(*it);
-            r_node.GetSolutionStepValue(rThisVariable) = g(row);
-        }
-
-        #ifdef ENABLE_DEBUG
-        std::cout << "Transfer variable to node for " << rThisVariable.Name() << " completed" << std::endl;
-        #endif
-    }
-
-    void BezierPostUtility::TransferVariablesToNodes(LinearSolverType::Pointer& pSolver,
-        ModelPart& r_model_part,
-        const Variable<double>& rThisVariable, const bool& check_active) const
-    {
-        TransferVariablesToNodes(pSolver, r_model_part, r_model_part.Elements(), rThisVariable, check_active);
-    }
-
-    void BezierPostUtility::TransferVariablesToNodes(LinearSolverType::Pointer& pSolver,
-        ModelPart& r_model_part, ElementsArrayType& ElementsArray,
-        const Variable<Vector>& rThisVariable,
+        const std::vector<const Variable<double>*>& rDoubleVariables,
+        const std::vector<const Variable<Vector>*>& rVectorVariables,
         const std::size_t& ncomponents, const bool& check_active) const
     {
         #ifdef ENABLE_PROFILING
@@ -264,6 +83,9 @@ namespace Kratos
         start_compute = OpenMPUtils::GetCurrentTime();
         #endif
 
+        // collect the elements contributing to the projection. If the activeness is checked, the inactive elements
+        // are left out, otherwise they contribute the identity matrix to LHS.
+        std::vector<Element::Pointer> pElements;
         std::set<std::size_t> active_nodes;
         for( ElementsArrayType::ptr_iterator it = ElementsArray.ptr_begin(); it != ElementsArray.ptr_end(); ++it )
         {
@@ -273,6 +95,7 @@ namespace Kratos
 
             if( is_active )
             {
+                pElements.push_back(*it);
                 for( std::size_t i = 0; i < (*it)->GetGeometry().size(); ++i )
                 {
                     active_nodes.insert( (*it)->GetGeometry()[i].Id() );
@@ -282,10 +105,6 @@ namespace Kratos
 
         #ifdef ENABLE_DEBUG
         KRATOS_WATCH(active_nodes.size())
-        // std::cout << "active_nodes:";
-        // for( std::set<std::size_t>::iterator it = active_nodes.begin(); it != active_nodes.end(); ++it )
-        //     std::cout << " " << *it;
-        // std::cout << std::endl;
         #endif
 
         // assign each node an id. That id is the row of this node in the global L2 projection matrix
@@ -296,11 +115,22 @@ namespace Kratos
             node_row_id[*it] = cnt++;
         }
 
-        // create and initialize matrix
+        // create the structure of the L2 projection system
         std::size_t NumberOfNodes = active_nodes.size();
-        SerialSparseSpaceType::MatrixType M(NumberOfNodes, NumberOfNodes);
-        noalias(M) = ZeroMatrix(NumberOfNodes, NumberOfNodes);
-        ConstructL2MatrixStructure<Element>(M, ElementsArray, node_row_id);
+        std::vector<std::size_t> element_ptr(pElements.size() + 1);
+        std::vector<std::size_t> element_rows;
+        std::vector<int> element_status(pElements.size());
+        element_ptr[0] = 0;
+        for( std::size_t e = 0; e < pElements.size(); ++e )
+        {
+            for( std::size_t i = 0; i < pElements[e]->GetGeometry().size(); ++i )
+                element_rows.push_back( node_row_id[pElements[e]->GetGeometry()[i].Id()] );
+            element_ptr[e + 1] = element_rows.size();
+            element_status[e] = pElements[e]->GetValue(IS_INACTIVE) ? 1 : 0;
+        }
+
+        L2ProjectionSystem System;
+        System.Initialize(NumberOfNodes, element_ptr, element_rows, element_status);
 
         #ifdef ENABLE_PROFILING
         end_compute = OpenMPUtils::GetCurrentTime();
@@ -308,127 +138,17 @@ namespace Kratos
         start_compute = end_compute;
         #endif
 
-        // create and initialize vectors
-        SerialDenseSpaceType::MatrixType g(NumberOfNodes, ncomponents);
-        noalias(g)= ZeroMatrix(NumberOfNodes, ncomponents);
-        SerialDenseSpaceType::MatrixType b(NumberOfNodes, ncomponents);
-        noalias(b)= ZeroMatrix(NumberOfNodes, ncomponents);
-
-        //create a partition of the elements
-        int number_of_threads = omp_get_max_threads();
-        std::vector<unsigned int> element_partition;
-        OpenMPUtils::CreatePartition(number_of_threads, ElementsArray.size(), element_partition);
-
-        #ifdef ENABLE_DEBUG
-        KRATOS_WATCH( number_of_threads )
-        std::cout << "element_partition:";
-        for (std::size_t i = 0; i < element_partition.size(); ++i)
-            std::cout << " " << element_partition[i];
-        std::cout << std::endl;
-        #endif
-
-        // create a lock array for parallel matrix fill
-        std::vector< omp_lock_t > lock_array(NumberOfNodes);
-        for(unsigned int i = 0; i < NumberOfNodes; ++i)
-            omp_init_lock(&lock_array[i]);
-
-        const unsigned int& Dim = (*(ElementsArray.ptr_begin()))->GetGeometry().WorkingSpaceDimension();
-
-        #pragma omp parallel for
-        for(int k = 0; k < number_of_threads; ++k)
-        {
-            Matrix InvJ(Dim, Dim);
-            double DetJ;
-            unsigned int row, col;
-
-            typename ElementsArrayType::ptr_iterator it_begin = ElementsArray.ptr_begin() + element_partition[k];
-            typename ElementsArrayType::ptr_iterator it_end = ElementsArray.ptr_begin() + element_partition[k + 1];
-
-            for( ElementsArrayType::ptr_iterator it = it_begin; it != it_end; ++it )
-            {
-                bool is_active = true;
-                if (check_active)
-                    is_active = ((*it)->GetValue(IS_INACTIVE) == false) || (*it)->Is(ACTIVE);
-
-                if (is_active)
-                {
-                    const IntegrationPointsArrayType& integration_points
-                        = (*it)->GetGeometry().IntegrationPoints((*it)->GetIntegrationMethod());
-
-                    GeometryType::JacobiansType J(integration_points.size());
-
-    //                J = (*it)->GetGeometry().Jacobian(J, (*it)->GetIntegrationMethod());
-    //                const Matrix& Ncontainer = (*it)->GetGeometry().ShapeFunctionsValues((*it)->GetIntegrationMethod());
-
-                    IsogeometricGeometryType& rIsogeometricGeometry = dynamic_cast<IsogeometricGeometryType&>((*it)->GetGeometry());
-                    J = rIsogeometricGeometry.Jacobian0(J, (*it)->GetIntegrationMethod());
-
-                    GeometryType::ShapeFunctionsGradientsType DN_De;
-                    Matrix Ncontainer;
-                    rIsogeometricGeometry.CalculateShapeFunctionsIntegrationPointsValuesAndLocalGradients(
-                        Ncontainer,
-                        DN_De,
-                        (*it)->GetIntegrationMethod()
-                    );
-
-                    // get the values at the integration_points
-                    std::vector<Vector> ValuesOnIntPoint(integration_points.size());
-                    (*it)->GetValueOnIntegrationPoints(rThisVariable, ValuesOnIntPoint, r_model_part.GetProcessInfo());
-
-                    for(unsigned int point = 0; point < integration_points.size(); ++point)
-                    {
-                        MathUtils<double>::InvertMatrix(J[point], InvJ, DetJ);
-
-                        double dV = DetJ * integration_points[point].Weight();
-
-                        for(unsigned int prim = 0; prim < (*it)->GetGeometry().size(); ++prim)
-                        {
-                            row = node_row_id[(*it)->GetGeometry()[prim].Id()];
-
-                            omp_set_lock(&lock_array[row]);
-
-                            for(unsigned int i = 0; i < ncomponents; ++i)
-                                b(row, i) += ValuesOnIntPoint[point][i] * Ncontainer(point, prim) * dV;
-
-                            for(unsigned int sec = 0; sec < (*it)->GetGeometry().size(); ++sec)
-                            {
-                                col = node_row_id[(*it)->GetGeometry()[sec].Id()];
-                                M(row, col) += Ncontainer(point, prim) * Ncontainer(point, sec) * dV;
-                            }
-
-                            omp_unset_lock(&lock_array[row]);
-                        }
-                    }
-                }
-                else
-                {
-                    // for inactive elements the contribution to LHS is identity matrix and RHS is zero
-                    for(unsigned int prim = 0; prim < (*it)->GetGeometry().size(); ++prim)
-                    {
-                        row = node_row_id[(*it)->GetGeometry()[prim].Id()];
-
-                        omp_set_lock(&lock_array[row]);
-
-//                        for(unsigned int i = 0; i < ncomponents; ++i)
-//                            b(row, i) += 0.0;
-
-                        for(unsigned int sec = 0; sec < (*it)->GetGeometry().size(); ++sec)
-                        {
-                            col = node_row_id[(*it)->GetGeometry()[sec].Id()];
-                            if(col == row)
-                                M(row, col) += 1.0;
-//                            else
-//                                M(row, col) += 0.0;
-                        }
-
-                        omp_unset_lock(&lock_array[row]);
-                    }
-                }
-            }
-        }
+        // Transfer of GaussianVariables to Nodal Variables via L_2-Minimization
+        // see Jiao + Heath "Common-refinement-based data tranfer ..."
+        // International Journal for numerical methods in engineering 61 (2004) 2402--2427
+        // for general description of L_2-Minimization
+        // the mass matrix is assembled once for all the variables
+        AssembleL2ProjectionMassMatrix(System, pElements.begin());
 
-        for(unsigned int i = 0; i < NumberOfNodes; ++i)
-            omp_destroy_lock(&lock_array[i]);
+        std::vector<std::size_t> VectorSizes(rVectorVariables.size(), ncomponents);
+        SerialDenseSpaceType::MatrixType b;
+        AssembleL2ProjectionRightHandSide(System, pElements.begin(), rDoubleVariables, rVectorVariables,
+            VectorSizes, r_model_part.GetProcessInfo(), b);
 
         #ifdef ENABLE_PROFILING
         end_compute = OpenMPUtils::GetCurrentTime();
@@ -437,42 +157,68 @@ namespace Kratos
         #endif
 
         #ifdef DEBUG_MULTISOLVE
-        KRATOS_WATCH(M)
+        KRATOS_WATCH(System.MassMatrix())
         KRATOS_WATCH(b)
         KRATOS_WATCH(*pSolver)
         #endif
 
         // solve the system
-        // solver must support the multisove method
-        pSolver->Solve(M, g, b);
+        // for the consistent projection of more than one component, the solver must support the multisove method
+        SerialDenseSpaceType::MatrixType g;
+        System.Solve(pSolver, mProjectionType, g, b);
 
         #ifdef DEBUG_MULTISOLVE
         KRATOS_WATCH(g)
         #endif
 
         // transfer the solution to the nodal variables
-        Vector tmp(ncomponents);
-        // for(ModelPart::NodeIterator it = r_model_part.NodesBegin(); it != r_model_part.NodesEnd(); ++it)
-        // {
-        //     std::map<std::size_t, std::size_t>::iterator it_r = node_row_id.find(it->Id());
-        //     if (it_r == node_row_id.end()) continue;
-        //     noalias(tmp) = row(g, *it_r);
-        //     it->GetSolutionStepValue(rThisVariable) = tmp;
-        // }
-
         for( std::set<std::size_t>::iterator it = active_nodes.begin(); it != active_nodes.end(); ++it )
         {
             std::size_t this_row = node_row_id[*it];
             NodeType& r_node = r_model_part.GetMesh().GetNode(*it);
-            noalias(tmp) = row(g, this_row);
-            r_node.GetSolutionStepValue(rThisVariable) = tmp;
+
+            std::size_t this_column = 0;
+            for( std::size_t v = 0; v < rDoubleVariables.size(); ++v, ++this_column )
+                r_node.GetSolutionStepValue(*rDoubleVariables[v]) = g(this_row, this_column);
+
+            Vector tmp(ncomponents);
+            for( std::size_t v = 0; v < rVectorVariables.size(); ++v, this_column += ncomponents )
+            {
+                for( std::size_t i = 0; i < ncomponents; ++i )
+                    tmp(i) = g(this_row, this_column + i);
+                r_node.GetSolutionStepValue(*rVectorVariables[v]) = tmp;
+            }
         }
 
         #ifdef ENABLE_DEBUG
-        std::cout << "Transfer variable to node for " << rThisVariable.Name() << " completed" << std::endl;
+        std::cout << "Transfer variables to node for " << rDoubleVariables.size() + rVectorVariables.size() << " variables completed" << std::endl;
         #endif
     }
 
+    void BezierPostUtility::TransferVariablesToNodes(LinearSolverType::Pointer& pSolver,
+        ModelPart& r_model_part, ElementsArrayType& ElementsArray,
+        const Variable<double>& rThisVariable, const bool& check_active) const
+    {
+        TransferVariablesToNodes(pSolver, r_model_part, ElementsArray, std::vector<const Variable<double>*>(1, &rThisVariable),
+            std::vector<const Variable<Vector>*>(), 0, check_active);
+    }
+
+    void BezierPostUtility::TransferVariablesToNodes(LinearSolverType::Pointer& pSolver,
+        ModelPart& r_model_part,
+        const Variable<double>& rThisVariable, const bool& check_active) const
+    {
+        TransferVariablesToNodes(pSolver, r_model_part, r_model_part.Elements(), rThisVariable, check_active);
+    }
+
+    void BezierPostUtility::TransferVariablesToNodes(LinearSolverType::Pointer& pSolver,
+        ModelPart& r_model_part, ElementsArrayType& ElementsArray,
+        const Variable<Vector>& rThisVariable,
+        const std::size_t& ncomponents, const bool& check_active) const
+    {
+        TransferVariablesToNodes(pSolver, r_model_part, ElementsArray, std::vector<const Variable<double>*>(),
+            std::vector<const Variable<Vector>*>(1, &rThisVariable), ncomponents, check_active);
+    }
+
     void BezierPostUtility::TransferVariablesToNodes(LinearSolverType::Pointer& pSolver,
         ModelPart& r_model_part,
         const Variable<Vector>& rThisVariable,
@@ -133,7 +133,7 @@ public:
     ///@{
 
     /// Default constructor.
-    BezierPostUtility()
+    BezierPostUtility() : mProjectionType(_CONSISTENT_L2_PROJECTION_)
     {
     }
 
@@ -268,6 +268,63 @@ public:
         #endif
     }
 
+    /// Set the type of the L2 projection used to transfer the integration point results to nodes
+    void SetProjectionType(const L2ProjectionType& Type)
+    {
+        mProjectionType = Type;
+    }
+
+    /// Get the type of the L2 projection used to transfer the integration point results to nodes
+    L2ProjectionType GetProjectionType() const
+    {
+        return mProjectionType;
+    }
+
+    // Synchronize post model_part with the reference model_part for several variables. The variables are projected
+    // to the nodes of the reference model_part together, with only one assembly and one solve of the L2 projection system.
+    void TransferIntegrationPointResults(
+        const std::vector<const Variable<double>*>& rDoubleVariables,
+        const std::vector<const Variable<Vector>*>& rVectorVariables,
+        ModelPart& r_model_part,
+        ModelPart& r_model_part_post,
+        LinearSolverType::Pointer pSolver) const
+    {
+        #ifdef ENABLE_PROFILING
+        double start_compute = OpenMPUtils::GetCurrentTime();
+        std::cout << "########################################" << std::endl;
+        std::cout << "Transfer integration point results for "
+                  << rDoubleVariables.size() + rVectorVariables.size() << " variables starts" << std::endl;
+        #endif
+
+        // firstly transfer the variables from integration points of reference model_part to its nodes
+        TransferVariablesToNodes(pSolver, r_model_part, r_model_part.Elements(), rDoubleVariables, rVectorVariables);
+
+        // secondly transfer new nodal variables results to the post model_part
+        for(std::size_t i = 0; i < rDoubleVariables.size(); ++i)
+            TransferNodalResults(*rDoubleVariables[i], r_model_part, r_model_part_post);
+        for(std::size_t i = 0; i < rVectorVariables.size(); ++i)
+            TransferNodalResults(*rVectorVariables[i], r_model_part, r_model_part_post);
+
+        #ifdef ENABLE_PROFILING
+        double end_compute = OpenMPUtils::GetCurrentTime();
+        std::cout << "Transfer integration point results for "
+                  << rDoubleVariables.size() + rVectorVariables.size() << " variables completed: "
+                  << end_compute - start_compute << "s" << std::endl;
+        std::cout << "########################################" << std::endl;
+        #endif
+    }
+
+    // Transfer several variables to nodes for model_part, with only one assembly and one solve of the L2 projection system
+    void TransferVariablesToNodes(
+        const std::vector<const Variable<double>*>& rDoubleVariables,
+        const std::vector<const Variable<Vector>*>& rVectorVariables,
+        ModelPart& r_model_part,
+        ElementsArrayType& ElementsArray,
+        LinearSolverType::Pointer pSolver) const
+    {
+        TransferVariablesToNodes(pSolver, r_model_part, ElementsArray, rDoubleVariables, rVectorVariables);
+    }
+
     ///@}
     ///@name Access
     ///@{
@@ -342,6 +399,8 @@ private:
     ///@name Member Variables
     ///@{
 
+    L2ProjectionType mProjectionType; // type of the L2 projection (consistent, lumped or diagonal scaled mass)
+
     ///@}
     ///@name Private Operators
     ///@{
@@ -448,6 +507,28 @@ private:
                                   const std::size_t& ncomponents = 6,
                                   const bool& check_active = false) const;
 
+    /**
+     * Transfer of several variables defined on integration points to corresponding nodal values, with the L2 projection
+     * of the type set by SetProjectionType. The mass matrix is assembled once, the right hand sides of all the variables
+     * and their components are assembled in one pass over the elements and solved together.
+     * @param pSolver           the solver used for solving the local system matrix; it must support multiple right hand
+     *                          sides for the consistent projection of more than one component
+     * @param r_model_part      model_part that we wish to transfer the result from its integration points to its nodes
+     * @param ElementsArray     the elements defining the mesh of the projection
+     * @param rDoubleVariables  the double variables need to transfer the respected values
+     * @param rVectorVariables  the Vector variables need to transfer the respected values
+     * @param ncomponents       number of components of the nodal vectors
+     * @param check_active      if true the inactive elements are left out of the projection; otherwise they contribute
+     *                          identity to LHS and zero to RHS
+     * REMARKS: this subroutine will only transfer the variables to nodes connecting with the mesh defined by ElementsArray
+     */
+    void TransferVariablesToNodes(LinearSolverType::Pointer& pSolver,
+                                  ModelPart& r_model_part, ElementsArrayType& ElementsArray,
+                                  const std::vector<const Variable<double>*>& rDoubleVariables,
+                                  const std::vector<const Variable<Vector>*>& rVectorVariables,
+                                  const std::size_t& ncomponents = 6,
+                                  const bool& check_active = false) const;
+
     ///@}
     ///@name Private  Access
     ///@{
@@ -467,7 +548,7 @@ private:
     }
 
     /// Copy constructor.
-    BezierPostUtility(BezierPostUtility const& rOther)
+    BezierPostUtility(BezierPostUtility const& rOther) : mProjectionType(rOther.mProjectionType)
     {
     }
 
@@ -10,6 +10,8 @@
 #include <string>
 #include <vector>
 #include <iostream>
+#include <sstream>
+#include <set>
 
 // External includes
 
@@ -38,7 +40,14 @@ const int BezierUtils::msBernsteinCoefs[] = {
         , 16, 120, 560, 1820, 4368, 8008, 11440, 12870
     };
 
-BezierUtils::MapType BezierUtils::mIntegrationMethods;
+std::atomic<const BezierUtils::MapType*> BezierUtils::msIntegrationMethods(NULL);
+std::vector<boost::shared_ptr<BezierUtils::MapType> > BezierUtils::msIntegrationMethodsSnapshots;
+std::atomic<const BezierUtils::SumFactorizationMapType*> BezierUtils::msSumFactorizations(NULL);
+std::vector<boost::shared_ptr<BezierUtils::SumFactorizationMapType> > BezierUtils::msSumFactorizationsSnapshots;
+
+bool BezierUtils::msIsGeometryCacheEnabled = false;
+std::size_t BezierUtils::msGeometryCacheMemoryBudget = 0;
+std::size_t BezierUtils::msGeometryCacheMemory = 0;
 
 void BezierUtils::bezier_extraction_tsplines_1d(
         std::vector<Vector>& Crows,     // bezier extraction operator, each row of the operator contain the Bezier decomposition coefficients on each knot span (OUTPUT). The operator is of size nb x (p+1)
@@ -280,6 +289,63 @@ void BezierUtils::bezier_extraction_local_1d(std::vector<Vector>& Crows,
     }
 }
 
+void BezierUtils::bezier_extraction_local_row_1d(Vector& Crow,
+                                                 const std::vector<double>& Xi,
+                                                 const double& cmin,
+                                                 const double& cmax,
+                                                 const int p)
+{
+    // a priori check
+    for(std::size_t i = 0; i < Xi.size(); ++i)
+    {
+        if(Xi[i] > cmin && Xi[i] < cmax)
+        {
+            std::stringstream ss;
+            ss << "Error: the cell is not contained in one knot span of the basis function" << std::endl;
+            ss << "cmin: " << cmin << ", cmax: " << cmax << std::endl;
+            ss << "Xi:";
+            for(std::size_t j = 0; j < Xi.size(); ++j)
+                ss << " " << Xi[j];
+            KRATOS_THROW_ERROR(std::logic_error, ss.str(), "")
+        }
+    }
+
+    // compute the inserted knot vector
+    std::vector<double> U;
+    for(std::size_t i = 0; i < Xi.size() - 1; ++i)
+    {
+        if(cmin > Xi[i] && cmin < Xi[i+1])
+        {
+            U.push_back(cmin);
+            break;
+        }
+    }
+
+    for(std::size_t i = 0; i < Xi.size() - 1; ++i)
+    {
+        if(cmax > Xi[i] && cmax < Xi[i+1])
+        {
+            U.push_back(cmax);
+            break;
+        }
+    }
+
+    // compute the Bezier extraction operator
+    std::vector<Vector> Crows;
+    int nb;
+    Vector Ubar;
+    bezier_extraction_local_1d(Crows, nb, Ubar, Xi, U, p);
+
+    // extract the correct row
+    std::set<double> Ubar_unique(Ubar.begin(), Ubar.end());
+    std::vector<double> Ubar_unique_vector(Ubar_unique.begin(), Ubar_unique.end());
+    std::size_t span = BSplineUtils::FindSpanLocal(cmin, Ubar_unique_vector) - 1;
+
+    if(Crow.size() != Crows[span].size())
+        Crow.resize(Crows[span].size(), false);
+    noalias(Crow) = Crows[span];
+}
+
 void BezierUtils::bezier_extraction_local_2d(std::vector<Vector>& Crows,
                                              int& nb_xi,
                                              int& nb_eta,
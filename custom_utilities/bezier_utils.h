@@ -15,6 +15,7 @@
 #include <vector>
 #include <iostream>
 #include <fstream>
+#include <atomic>
 
 // External includes
 
@@ -26,6 +27,7 @@
 #include "utilities/math_utils.h"
 #include "custom_geometries/isogeometric_geometry.h"
 #include "custom_utilities/isogeometric_math_utils.h"
+#include "custom_utilities/compressed_extraction_operator.h"
 
 #define ENABLE_PROFILING
 #define USE_EQUAL_ORDER_INTEGRATION_IN_ALL_DIRECTION
@@ -497,8 +499,8 @@ public:
         //define the key
         BezierGeometryDataKey Key(NumberOfIntegrationMethod, Order, 0, 0, TDimension, TWorkingSpaceDimension, TLocalSpaceDimension);
 
-        //find the key in existing map
-        if(mIntegrationMethods.find(Key) != mIntegrationMethods.end())
+        //find the key in existing registry. The lookup is lock-free.
+        if(FindIntegrationRule(Key) != NULL)
         //found the key
         {
 //            std::cout << "Key " << Key << " existed and ready to be used" << std::endl;
@@ -536,10 +538,13 @@ public:
                 )
             );
 
-            //insert value to map
-            mIntegrationMethods.insert(PairType(Key, pNewGeometryData));
-
-            std::cout << "Registered BezierGeometryData " << Key << " successfully" << std::endl;
+            //insert value to registry. If another thread registered the same key in the meantime, its rule is kept.
+            if (InsertIntegrationRule(Key, pNewGeometryData))
+            {
+                #ifdef DEBUG_LEVEL1
+                std::cout << "Registered BezierGeometryData " << Key << " successfully" << std::endl;
+                #endif
+            }
         }
     }
 
@@ -553,8 +558,8 @@ public:
         //define the key
         BezierGeometryDataKey Key(NumberOfIntegrationMethod, Order1, Order2, 0, TDimension, TWorkingSpaceDimension, TLocalSpaceDimension);
 
-        //find the key in existing map
-        if(mIntegrationMethods.find(Key) != mIntegrationMethods.end())
+        //find the key in existing registry. The lookup is lock-free.
+        if(FindIntegrationRule(Key) != NULL)
         //found the key
         {
 //            std::cout << "Key " << Key << " existed and ready to be used" << std::endl;
@@ -590,10 +595,13 @@ public:
                 )
             );
 
-            //insert value to map
-            mIntegrationMethods.insert(PairType(Key, pNewGeometryData));
-
-            std::cout << "Registered BezierGeometryData " << Key << " successfully" << std::endl;
+            //insert value to registry. If another thread registered the same key in the meantime, its rule is kept.
+            if (InsertIntegrationRule(Key, pNewGeometryData))
+            {
+                #ifdef DEBUG_LEVEL1
+                std::cout << "Registered BezierGeometryData " << Key << " successfully" << std::endl;
+                #endif
+            }
         }
     }
 
@@ -608,8 +616,8 @@ public:
         //define the key
         BezierGeometryDataKey Key(NumberOfIntegrationMethod, Order1, Order2, Order3, TDimension, TWorkingSpaceDimension, TLocalSpaceDimension);
 
-        //find the key in existing map
-        if(mIntegrationMethods.find(Key) != mIntegrationMethods.end())
+        //find the key in existing registry. The lookup is lock-free.
+        if(FindIntegrationRule(Key) != NULL)
         //found the key
         {
 //            std::cout << "Key " << Key << " existed and ready to be used" << std::endl;
@@ -647,10 +655,13 @@ public:
                 )
             );
 
-            //insert value to map
-            mIntegrationMethods.insert(PairType(Key, pNewGeometryData));
-
-            std::cout << "Registered BezierGeometryData " << Key << " successfully" << std::endl;
+            //insert value to registry. If another thread registered the same key in the meantime, its rule is kept.
+            if (InsertIntegrationRule(Key, pNewGeometryData))
+            {
+                #ifdef DEBUG_LEVEL1
+                std::cout << "Registered BezierGeometryData " << Key << " successfully" << std::endl;
+                #endif
+            }
         }
     }
 
@@ -661,7 +672,7 @@ public:
     )
     {
         BezierGeometryDataKey Key(NumberOfIntegrationMethod, Order1, 0, 0, TDimension, TWorkingSpaceDimension, TLocalSpaceDimension);
-        return mIntegrationMethods[Key];
+        return FindIntegrationRule(Key);
     }
 
     template<std::size_t TDimension, std::size_t TWorkingSpaceDimension, std::size_t TLocalSpaceDimension>
@@ -672,7 +683,7 @@ public:
     )
     {
         BezierGeometryDataKey Key(NumberOfIntegrationMethod, Order1, Order2, 0, TDimension, TWorkingSpaceDimension, TLocalSpaceDimension);
-        return mIntegrationMethods[Key];
+        return FindIntegrationRule(Key);
     }
 
     template<std::size_t TDimension, std::size_t TWorkingSpaceDimension, std::size_t TLocalSpaceDimension>
@@ -684,7 +695,7 @@ public:
     )
     {
         BezierGeometryDataKey Key(NumberOfIntegrationMethod, Order1, Order2, Order3, TDimension, TWorkingSpaceDimension, TLocalSpaceDimension);
-        return mIntegrationMethods[Key];
+        return FindIntegrationRule(Key);
     }
 
     template<std::size_t TDimension, std::size_t TWorkingSpaceDimension, std::size_t TLocalSpaceDimension>
@@ -719,7 +730,9 @@ public:
             )
         );
 
+        #ifdef DEBUG_LEVEL1
         std::cout << "Create BezierGeometryData successfully for " << integration_points.size() << " integration points" << std::endl;
+        #endif
 
         return pNewGeometryData;
     }
@@ -758,7 +771,9 @@ public:
             )
         );
 
+        #ifdef DEBUG_LEVEL1
         std::cout << "Create BezierGeometryData successfully for " << integration_points.size() << " integration points" << std::endl;
+        #endif
 
         return pNewGeometryData;
     }
@@ -799,15 +814,238 @@ public:
             )
         );
 
+        #ifdef DEBUG_LEVEL1
         std::cout << "Create BezierGeometryData successfully for " << integration_points.size() << " integration points" << std::endl;
+        #endif
 
         return pNewGeometryData;
     }
 
+    /**
+     * Register the integration rule for a Bezier geometry type given at run time. The supported types are
+     * (Dimension, WorkingSpaceDimension) = (1, 3), (2, 2), (2, 3) and (3, 3). This allows to pre-register all the
+     * (degree, rule) combinations of a model before creating the geometries in parallel.
+     */
+    static void RegisterIntegrationRule(
+        unsigned int Dimension,
+        unsigned int WorkingSpaceDimension,
+        unsigned int NumberOfIntegrationMethod,
+        unsigned int Order1,
+        unsigned int Order2,
+        unsigned int Order3
+    )
+    {
+        if (Dimension == 1 && WorkingSpaceDimension == 3)
+            RegisterIntegrationRule<1, 3, 1>(NumberOfIntegrationMethod, Order1);
+        else if (Dimension == 2 && WorkingSpaceDimension == 2)
+            RegisterIntegrationRule<2, 2, 2>(NumberOfIntegrationMethod, Order1, Order2);
+        else if (Dimension == 2 && WorkingSpaceDimension == 3)
+            RegisterIntegrationRule<2, 3, 2>(NumberOfIntegrationMethod, Order1, Order2);
+        else if (Dimension == 3 && WorkingSpaceDimension == 3)
+            RegisterIntegrationRule<3, 3, 3>(NumberOfIntegrationMethod, Order1, Order2, Order3);
+        else
+            KRATOS_THROW_ERROR(std::logic_error, "Unsupported Bezier geometry dimension", Dimension)
+    }
+
+    /// Get the number of registered integration rules
+    static std::size_t NumberOfIntegrationRules()
+    {
+        const MapType* pIntegrationMethods = msIntegrationMethods.load(std::memory_order_acquire);
+        return (pIntegrationMethods == NULL) ? 0 : pIntegrationMethods->size();
+    }
+
     /********************************************************
             End of Bezier integration utilities
      ********************************************************/
 
+    /********************************************************
+            Bezier geometry cache settings
+     ********************************************************/
+
+    /// Enable/disable the caching of rational shape functions values and local gradients at the integration points in the Bezier geometries.
+    /// MemoryBudget is the maximum number of bytes that the caches of all Bezier geometries are allowed to occupy (0 means unlimited).
+    /// The setting only affects the geometries which are assigned data afterwards.
+    static void SetGeometryCache(bool Enable, std::size_t MemoryBudget = 0)
+    {
+        #pragma omp critical(bezier_geometry_cache)
+        {
+            msIsGeometryCacheEnabled = Enable;
+            msGeometryCacheMemoryBudget = MemoryBudget;
+        }
+    }
+
+    /// Check if the Bezier geometry cache is enabled
+    static bool IsGeometryCacheEnabled()
+    {
+        return msIsGeometryCacheEnabled;
+    }
+
+    /// Get the number of bytes currently occupied by the caches of all Bezier geometries
+    static std::size_t GeometryCacheMemory()
+    {
+        return msGeometryCacheMemory;
+    }
+
+    /// Reserve the memory for the cache of a Bezier geometry. Return false if the memory budget is exceeded.
+    static bool AcquireGeometryCacheMemory(std::size_t Size)
+    {
+        bool success = false;
+        #pragma omp critical(bezier_geometry_cache)
+        {
+            if (msIsGeometryCacheEnabled
+                && (msGeometryCacheMemoryBudget == 0 || msGeometryCacheMemory + Size <= msGeometryCacheMemoryBudget))
+            {
+                msGeometryCacheMemory += Size;
+                success = true;
+            }
+        }
+        return success;
+    }
+
+    /// Release the memory of the cache of a Bezier geometry
+    static void ReleaseGeometryCacheMemory(std::size_t Size)
+    {
+        #pragma omp critical(bezier_geometry_cache)
+        {
+            msGeometryCacheMemory = (Size > msGeometryCacheMemory) ? 0 : (msGeometryCacheMemory - Size);
+        }
+    }
+
+    /********************************************************
+            End of Bezier geometry cache settings
+     ********************************************************/
+
+    /********************************************************
+            Bezier sum factorization utilities
+     ********************************************************/
+
+    /**
+     * Check if the integration points form a tensor product rule, ordered as in AllIntegrationPoints, i.e. the last
+     * direction runs fastest. If it is the case, the 1D coordinates in each direction are extracted to rCoordinates.
+     */
+    static bool ExtractTensorProductIntegrationPoints(
+        const IntegrationPointsArrayType& rPoints,
+        const std::size_t& Dim,
+        std::vector<std::vector<double> >& rCoordinates
+    )
+    {
+        if (rPoints.size() == 0)
+            return false;
+
+        rCoordinates.resize(Dim);
+
+        // find the number of points in each direction, from the last (fastest) to the first direction
+        std::size_t stride = 1;
+        for (int d = Dim - 1; d >= 0; --d)
+        {
+            std::size_t n = 0;
+            for (IndexType q = 0; q < rPoints.size(); q += stride)
+            {
+                bool is_on_line = true;
+                for (int dd = 0; dd < d; ++dd)
+                    if (rPoints[q][dd] != rPoints[0][dd])
+                        is_on_line = false;
+                if (!is_on_line)
+                    break;
+                ++n;
+            }
+
+            rCoordinates[d].resize(n);
+            for (IndexType i = 0; i < n; ++i)
+                rCoordinates[d][i] = rPoints[i * stride][d];
+
+            stride *= n;
+        }
+
+        if (stride != rPoints.size())
+            return false;
+
+        // verify that every point is the tensor product of the 1D coordinates
+        for (IndexType q = 0; q < rPoints.size(); ++q)
+        {
+            std::size_t r = q;
+            for (int d = Dim - 1; d >= 0; --d)
+            {
+                const std::size_t n = rCoordinates[d].size();
+                if (rPoints[q][d] != rCoordinates[d][r % n])
+                    return false;
+                r /= n;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * Compute the values and local gradients of the rational shape functions N_A = w_A * (C * B)_A / W at all points of
+     * a tensor product integration rule by sum factorization. The Bernstein basis is evaluated once per 1D coordinate and
+     * each row of the extraction operator is contracted direction by direction with the univariate tables, hence the
+     * products of Bernstein functions are never formed. For a 3D element of order p with (p+1)^3 integration points this
+     * costs O((p+1)^4) per shape function instead of O((p+1)^6).
+     * rCoordinates are the 1D coordinates obtained from ExtractTensorProductIntegrationPoints. Dim must be 2 or 3.
+     * rBezierWeights must be trans(C) * rCtrlWeights.
+     * The results have the same layout as the Bezier geometries, i.e. rValues is (number of points x number of control points)
+     * and rLocalGradients[q] is (number of control points x Dim).
+     */
+    static void CalculateRationalShapeFunctionsValuesAndLocalGradients(
+        const std::size_t& Dim,
+        const std::vector<std::vector<double> >& rCoordinates,
+        const int& Order1,
+        const int& Order2,
+        const int& Order3,
+        const CompressedExtractionOperator& rExtractionOperator,
+        const VectorType& rCtrlWeights,
+        const VectorType& rBezierWeights,
+        MatrixType& rValues,
+        ShapeFunctionsGradientsType& rLocalGradients
+    )
+    {
+        SumFactorizationData Data;
+        InitializeSumFactorizationData(Data, Dim, rCoordinates, Order1, Order2, Order3);
+        SumFactorizeRationalShapeFunctions(Dim, Data, rExtractionOperator, rCtrlWeights, rBezierWeights, rValues, rLocalGradients);
+    }
+
+    /**
+     * Compute the values and local gradients of the rational shape functions at all points of an integration method of a
+     * registered Bezier geometry data by sum factorization. The 1D factorization of the integration rule, i.e. the tensor
+     * product check and the univariate Bernstein tables, is computed at the first call and kept in a registry next to the
+     * integration rules, hence the later calls only do the contractions. Return false if the integration points do not form
+     * a tensor product rule, in which case the outputs are untouched.
+     * rGeometryData must be obtained from RetrieveIntegrationRule with the same orders.
+     */
+    static bool CalculateRationalShapeFunctionsValuesAndLocalGradients(
+        const std::size_t& Dim,
+        const GeometryData& rGeometryData,
+        const IntegrationMethod& ThisMethod,
+        const int& Order1,
+        const int& Order2,
+        const int& Order3,
+        const CompressedExtractionOperator& rExtractionOperator,
+        const VectorType& rCtrlWeights,
+        const VectorType& rBezierWeights,
+        MatrixType& rValues,
+        ShapeFunctionsGradientsType& rLocalGradients
+    )
+    {
+        const SumFactorizationData* pData = GetSumFactorizationData(Dim, rGeometryData, ThisMethod, Order1, Order2, Order3);
+        if (pData == NULL)
+            return false;
+
+        SumFactorizeRationalShapeFunctions(Dim, *pData, rExtractionOperator, rCtrlWeights, rBezierWeights, rValues, rLocalGradients);
+        return true;
+    }
+
+    /// Get the number of integration methods whose 1D factorization is kept in the registry
+    static std::size_t NumberOfSumFactorizations()
+    {
+        const SumFactorizationMapType* pSumFactorizations = msSumFactorizations.load(std::memory_order_acquire);
+        return (pSumFactorizations == NULL) ? 0 : pSumFactorizations->size();
+    }
+
+    /********************************************************
+            End of Bezier sum factorization utilities
+     ********************************************************/
+
     ///@}
     ///@name Access
     ///@{
@@ -1179,7 +1417,9 @@ public:
 //            KRATOS_WATCH(BaseRule[offset2].size())
 //            KRATOS_WATCH(BaseRule[offset3].size())
 
+            #ifdef DEBUG_LEVEL1
             std::cout << BaseRule[offset1].size() * BaseRule[offset2].size() * BaseRule[offset3].size() << " integration points are generated" << std::endl;
+            #endif
         }
         return integration_points;
     }
@@ -1422,6 +1662,18 @@ public:
         const std::vector<double>& U,
         const int p);
 
+    /**
+        Compute the row of the Bezier extraction operator of the basis function with local knot vector Xi on the cell
+        [cmin, cmax]. The cell must be contained in one knot span of the local knot vector.
+        This is the 1D building block of the extraction on a cell of the point-based splines.
+     */
+    static void bezier_extraction_local_row_1d(
+        Vector& Crow,
+        const std::vector<double>& Xi,
+        const double& cmin,
+        const double& cmax,
+        const int p);
+
     /**
         Compute the Bezier extraction of T-splines basis function on knot spans
         This is 2D version of the code
@@ -1548,7 +1800,23 @@ private:
 
     static const int msBernsteinCoefs[];
 
-    static MapType mIntegrationMethods;
+    struct SumFactorizationData;
+    typedef std::pair<const GeometryData*, int> SumFactorizationKeyType;
+    typedef std::map<SumFactorizationKeyType, boost::shared_ptr<SumFactorizationData> > SumFactorizationMapType;
+
+    // The registry of integration rules is copy-on-write: the current map is published through an atomic pointer so
+    // that the lookup does not need any lock. A new map is created for each registration and the old ones are kept alive
+    // in msIntegrationMethodsSnapshots since concurrent readers may still use them. The number of rules is small.
+    static std::atomic<const MapType*> msIntegrationMethods;
+    static std::vector<boost::shared_ptr<MapType> > msIntegrationMethodsSnapshots;
+
+    // The registry of the sum factorization data of the integration methods, copy-on-write as the one of the integration rules
+    static std::atomic<const SumFactorizationMapType*> msSumFactorizations;
+    static std::vector<boost::shared_ptr<SumFactorizationMapType> > msSumFactorizationsSnapshots;
+
+    static bool msIsGeometryCacheEnabled;
+    static std::size_t msGeometryCacheMemoryBudget;
+    static std::size_t msGeometryCacheMemory;
 
     ///@}
     ///@name Member Variables
@@ -1562,6 +1830,348 @@ private:
     ///@name Private Operations
     ///@{
 
+    /**
+     * Data for the sum factorization: the number of Bernstein functions (m) and points (n) in each direction,
+     * and the univariate Bernstein values (B) and derivatives (D) stored as (n x m) row-major tables
+     */
+    struct SumFactorizationData
+    {
+        std::size_t m1, m2, m3;
+        std::size_t n1, n2, n3;
+        std::vector<double> B1, D1, B2, D2, B3, D3;
+    };
+
+    /**
+     * Evaluate the univariate Bernstein functions and derivatives of order p at a set of 1D coordinates
+     */
+    static void TabulateBernstein(
+        std::vector<double>& rValues,
+        std::vector<double>& rDerivatives,
+        const int& p,
+        const std::vector<double>& rCoordinates
+    )
+    {
+        const std::size_t m = p + 1;
+        rValues.resize(rCoordinates.size() * m);
+        rDerivatives.resize(rCoordinates.size() * m);
+        VectorType values(m), derivatives(m);
+        for (IndexType q = 0; q < rCoordinates.size(); ++q)
+        {
+            bernstein(values, derivatives, p, rCoordinates[q]);
+            for (IndexType i = 0; i < m; ++i)
+            {
+                rValues[q * m + i] = values(i);
+                rDerivatives[q * m + i] = derivatives(i);
+            }
+        }
+    }
+
+    /**
+     * Form the multivariate Bernstein functions values and local gradients at all points of a tensor product rule
+     * from the univariate tables. rValues is (number of points x number of Bernstein functions) and
+     * rLocalGradients[q] is (Dim x number of Bernstein functions).
+     */
+    static void TensorProductBernstein(
+        const std::size_t& Dim,
+        const SumFactorizationData& rData,
+        MatrixType& rValues,
+        ShapeFunctionsGradientsType& rLocalGradients
+    )
+    {
+        const std::size_t m1 = rData.m1, m2 = rData.m2, m3 = rData.m3;
+        const std::size_t n1 = rData.n1, n2 = rData.n2, n3 = rData.n3;
+
+        rValues.resize(n1 * n2 * n3, m1 * m2 * m3, false);
+        rLocalGradients.resize(n1 * n2 * n3);
+
+        for (IndexType q1 = 0; q1 < n1; ++q1)
+        {
+            for (IndexType q2 = 0; q2 < n2; ++q2)
+            {
+                for (IndexType q3 = 0; q3 < n3; ++q3)
+                {
+                    const IndexType q = q3 + (q2 + q1 * n2) * n3;
+                    rLocalGradients[q].resize(Dim, m1 * m2 * m3, false);
+
+                    for (IndexType i = 0; i < m1; ++i)
+                    {
+                        const double b1 = rData.B1[q1 * m1 + i];
+                        const double d1 = rData.D1[q1 * m1 + i];
+                        for (IndexType j = 0; j < m2; ++j)
+                        {
+                            const double b2 = rData.B2[q2 * m2 + j];
+                            const double d2 = rData.D2[q2 * m2 + j];
+                            for (IndexType k = 0; k < m3; ++k)
+                            {
+                                const double b3 = rData.B3[q3 * m3 + k];
+                                const IndexType index = k + (j + i * m2) * m3;
+                                rValues(q, index) = b1 * b2 * b3;
+                                rLocalGradients[q](0, index) = d1 * b2 * b3;
+                                rLocalGradients[q](1, index) = b1 * d2 * b3;
+                                if (Dim == 3)
+                                    rLocalGradients[q](2, index) = b1 * b2 * rData.D3[q3 * m3 + k];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * Contract the rows of the extraction operator and the Bezier weights with the univariate tables and form the rational
+     * shape functions N_A = w_A * (C * B)_A / W and their local gradients, see CalculateRationalShapeFunctionsValuesAndLocalGradients.
+     */
+    static void SumFactorizeRationalShapeFunctions(
+        const std::size_t& Dim,
+        const SumFactorizationData& rData,
+        const CompressedExtractionOperator& rExtractionOperator,
+        const VectorType& rCtrlWeights,
+        const VectorType& rBezierWeights,
+        MatrixType& rValues,
+        ShapeFunctionsGradientsType& rLocalGradients
+    )
+    {
+        const std::size_t nq = rData.n1 * rData.n2 * rData.n3;
+        const std::size_t np = rExtractionOperator.size1();
+
+        if (rExtractionOperator.size2() != rData.m1 * rData.m2 * rData.m3)
+            KRATOS_THROW_ERROR(std::logic_error, "The number of column of extraction operator is not compatible with the orders, error at", __FUNCTION__)
+
+        // the Bezier weight and its local derivatives at the integration points
+        std::vector<double> W(4 * nq);
+        SumFactorize(W, rBezierWeights, rData);
+
+        rValues.resize(nq, np, false);
+        if (rLocalGradients.size() != nq)
+            rLocalGradients.resize(nq);
+        for (IndexType q = 0; q < nq; ++q)
+            rLocalGradients[q].resize(np, Dim, false);
+
+        VectorType coefficients(rExtractionOperator.size2());
+        std::vector<double> T(4 * nq);
+        for (IndexType a = 0; a < np; ++a)
+        {
+            rExtractionOperator.ExtractRow(a, coefficients);
+            SumFactorize(T, coefficients, rData);
+
+            for (IndexType q = 0; q < nq; ++q)
+            {
+                const double inv_W = 1.0 / W[q];
+                const double N = T[q] * inv_W;
+                rValues(q, a) = rCtrlWeights(a) * N;
+                for (IndexType d = 0; d < Dim; ++d)
+                    rLocalGradients[q](a, d) = rCtrlWeights(a) * (T[(d + 1) * nq + q] - N * W[(d + 1) * nq + q]) * inv_W;
+            }
+        }
+    }
+
+    /**
+     * Fill the sum factorization data of the tensor product rule with the 1D coordinates rCoordinates. The 2D case is handled
+     * as 3D with one Bernstein function and one point in the third direction.
+     */
+    static void InitializeSumFactorizationData(
+        SumFactorizationData& rData,
+        const std::size_t& Dim,
+        const std::vector<std::vector<double> >& rCoordinates,
+        const int& Order1,
+        const int& Order2,
+        const int& Order3
+    )
+    {
+        rData.m1 = Order1 + 1;
+        rData.m2 = Order2 + 1;
+        rData.m3 = (Dim == 3) ? (Order3 + 1) : 1;
+        rData.n1 = rCoordinates[0].size();
+        rData.n2 = rCoordinates[1].size();
+        rData.n3 = (Dim == 3) ? rCoordinates[2].size() : 1;
+        TabulateBernstein(rData.B1, rData.D1, Order1, rCoordinates[0]);
+        TabulateBernstein(rData.B2, rData.D2, Order2, rCoordinates[1]);
+        if (Dim == 3)
+            TabulateBernstein(rData.B3, rData.D3, Order3, rCoordinates[2]);
+        else
+        {
+            rData.B3.assign(1, 1.0);
+            rData.D3.assign(1, 0.0);
+        }
+    }
+
+    /**
+     * Find the sum factorization data of an integration method of a registered Bezier geometry data, or compute and register
+     * it at the first call. Return NULL if the integration points do not form a tensor product rule. The registry is copy-on-write
+     * as the one of the integration rules and keyed by the address of the geometry data, which stays alive in the registry of
+     * the integration rules.
+     */
+    static const SumFactorizationData* GetSumFactorizationData(
+        const std::size_t& Dim,
+        const GeometryData& rGeometryData,
+        const IntegrationMethod& ThisMethod,
+        const int& Order1,
+        const int& Order2,
+        const int& Order3
+    )
+    {
+        const SumFactorizationKeyType Key(&rGeometryData, static_cast<int>(ThisMethod));
+
+        //find the key in existing registry. The lookup is lock-free.
+        const SumFactorizationMapType* pSumFactorizations = msSumFactorizations.load(std::memory_order_acquire);
+        if (pSumFactorizations != NULL)
+        {
+            SumFactorizationMapType::const_iterator it = pSumFactorizations->find(Key);
+            if (it != pSumFactorizations->end())
+                return it->second.get();
+        }
+
+        //compute the factorization; a null entry records that the rule is not a tensor product
+        boost::shared_ptr<SumFactorizationData> pNewData;
+        std::vector<std::vector<double> > tensor_coordinates;
+        if (ExtractTensorProductIntegrationPoints(rGeometryData.IntegrationPoints(ThisMethod), Dim, tensor_coordinates))
+        {
+            pNewData = boost::shared_ptr<SumFactorizationData>(new SumFactorizationData());
+            InitializeSumFactorizationData(*pNewData, Dim, tensor_coordinates, Order1, Order2, Order3);
+        }
+
+        //insert value to registry. If another thread registered the same key in the meantime, its data is kept.
+        const SumFactorizationData* pData = NULL;
+        #pragma omp critical(bezier_sum_factorization_registry)
+        {
+            pSumFactorizations = msSumFactorizations.load(std::memory_order_acquire);
+            SumFactorizationMapType::const_iterator it;
+            if (pSumFactorizations != NULL && (it = pSumFactorizations->find(Key)) != pSumFactorizations->end())
+                pData = it->second.get();
+            else
+            {
+                boost::shared_ptr<SumFactorizationMapType> pNewSumFactorizations(
+                    (pSumFactorizations == NULL) ? new SumFactorizationMapType() : new SumFactorizationMapType(*pSumFactorizations));
+                (*pNewSumFactorizations)[Key] = pNewData;
+                msSumFactorizationsSnapshots.push_back(pNewSumFactorizations);
+                msSumFactorizations.store(pNewSumFactorizations.get(), std::memory_order_release);
+                pData = pNewData.get();
+            }
+        }
+
+        return pData;
+    }
+
+    /**
+     * Contract the Bernstein coefficients (indexed as k + (j + i * m2) * m3) with the univariate tables, direction by direction.
+     * On output, rT holds the value and the derivatives w.r.t the three local coordinates at the points (indexed as q3 + (q2 + q1 * n2) * n3),
+     * stored in four consecutive blocks.
+     */
+    static void SumFactorize(
+        std::vector<double>& rT,
+        const VectorType& rCoefficients,
+        const SumFactorizationData& rData
+    )
+    {
+        const std::size_t m1 = rData.m1, m2 = rData.m2, m3 = rData.m3;
+        const std::size_t n1 = rData.n1, n2 = rData.n2, n3 = rData.n3;
+        const std::size_t nq = n1 * n2 * n3;
+
+        // contraction in the third direction
+        std::vector<double> U(m1 * m2 * n3), U3(m1 * m2 * n3);
+        for (IndexType ij = 0; ij < m1 * m2; ++ij)
+        {
+            for (IndexType q3 = 0; q3 < n3; ++q3)
+            {
+                double u = 0.0, u3 = 0.0;
+                for (IndexType k = 0; k < m3; ++k)
+                {
+                    const double c = rCoefficients(ij * m3 + k);
+                    u += c * rData.B3[q3 * m3 + k];
+                    u3 += c * rData.D3[q3 * m3 + k];
+                }
+                U[ij * n3 + q3] = u;
+                U3[ij * n3 + q3] = u3;
+            }
+        }
+
+        // contraction in the second direction
+        std::vector<double> V(m1 * n2 * n3), V2(m1 * n2 * n3), V3(m1 * n2 * n3);
+        for (IndexType i = 0; i < m1; ++i)
+        {
+            for (IndexType q2 = 0; q2 < n2; ++q2)
+            {
+                for (IndexType q3 = 0; q3 < n3; ++q3)
+                {
+                    double v = 0.0, v2 = 0.0, v3 = 0.0;
+                    for (IndexType j = 0; j < m2; ++j)
+                    {
+                        const IndexType ju = (i * m2 + j) * n3 + q3;
+                        v += U[ju] * rData.B2[q2 * m2 + j];
+                        v2 += U[ju] * rData.D2[q2 * m2 + j];
+                        v3 += U3[ju] * rData.B2[q2 * m2 + j];
+                    }
+                    const IndexType iv = (i * n2 + q2) * n3 + q3;
+                    V[iv] = v;
+                    V2[iv] = v2;
+                    V3[iv] = v3;
+                }
+            }
+        }
+
+        // contraction in the first direction
+        for (IndexType q1 = 0; q1 < n1; ++q1)
+        {
+            for (IndexType q23 = 0; q23 < n2 * n3; ++q23)
+            {
+                double t = 0.0, t1 = 0.0, t2 = 0.0, t3 = 0.0;
+                for (IndexType i = 0; i < m1; ++i)
+                {
+                    const IndexType iv = i * n2 * n3 + q23;
+                    const double b = rData.B1[q1 * m1 + i];
+                    t += V[iv] * b;
+                    t1 += V[iv] * rData.D1[q1 * m1 + i];
+                    t2 += V2[iv] * b;
+                    t3 += V3[iv] * b;
+                }
+                const IndexType q = q1 * n2 * n3 + q23;
+                rT[q] = t;
+                rT[nq + q] = t1;
+                rT[2 * nq + q] = t2;
+                rT[3 * nq + q] = t3;
+            }
+        }
+    }
+
+    /**
+     * Find a registered integration rule. Return NULL if the rule does not exist. It is safe to call concurrently with InsertIntegrationRule.
+     */
+    static GeometryData::Pointer FindIntegrationRule(const BezierGeometryDataKey& Key)
+    {
+        const MapType* pIntegrationMethods = msIntegrationMethods.load(std::memory_order_acquire);
+        if (pIntegrationMethods == NULL)
+            return GeometryData::Pointer();
+
+        MapType::const_iterator it = pIntegrationMethods->find(Key);
+        if (it == pIntegrationMethods->end())
+            return GeometryData::Pointer();
+
+        return it->second;
+    }
+
+    /**
+     * Insert a new integration rule to the registry. Return false if the key was already registered, in which case the existing rule is kept.
+     */
+    static bool InsertIntegrationRule(const BezierGeometryDataKey& Key, GeometryData::Pointer pGeometryData)
+    {
+        bool inserted = false;
+        #pragma omp critical(bezier_integration_rule_registry)
+        {
+            const MapType* pIntegrationMethods = msIntegrationMethods.load(std::memory_order_acquire);
+            if (pIntegrationMethods == NULL || pIntegrationMethods->find(Key) == pIntegrationMethods->end())
+            {
+                boost::shared_ptr<MapType> pNewIntegrationMethods(
+                    (pIntegrationMethods == NULL) ? new MapType() : new MapType(*pIntegrationMethods));
+                pNewIntegrationMethods->insert(PairType(Key, pGeometryData));
+                msIntegrationMethodsSnapshots.push_back(pNewIntegrationMethods);
+                msIntegrationMethods.store(pNewIntegrationMethods.get(), std::memory_order_release);
+                inserted = true;
+            }
+        }
+        return inserted;
+    }
+
     /**
      * Calculate global coodinates w.r.t initial configuration
      */
@@ -1647,6 +2257,16 @@ private:
         std::fill(shape_functions_local_gradients.begin(), shape_functions_local_gradients.end(), MatrixType());
         shape_functions_values.resize(integration_points.size(), (Order1 + 1) * (Order2 + 1));
 
+        // on tensor product rule the univariate Bernstein functions are evaluated once per 1D coordinate
+        std::vector<std::vector<double> > tensor_coordinates;
+        if (ExtractTensorProductIntegrationPoints(integration_points, 2, tensor_coordinates))
+        {
+            SumFactorizationData Data;
+            InitializeSumFactorizationData(Data, 2, tensor_coordinates, Order1, Order2, 0);
+            TensorProductBernstein(2, Data, shape_functions_values, shape_functions_local_gradients);
+            return;
+        }
+
         for (unsigned int it_gp = 0; it_gp < integration_points.size(); ++it_gp)
         {
             VectorType temp_values;
@@ -1725,6 +2345,16 @@ private:
         std::fill(shape_functions_local_gradients.begin(), shape_functions_local_gradients.end(), MatrixType());
         shape_functions_values.resize(integration_points.size(), (Order1 + 1) * (Order2 + 1) * (Order3 + 1));
 
+        // on tensor product rule the univariate Bernstein functions are evaluated once per 1D coordinate
+        std::vector<std::vector<double> > tensor_coordinates;
+        if (ExtractTensorProductIntegrationPoints(integration_points, 3, tensor_coordinates))
+        {
+            SumFactorizationData Data;
+            InitializeSumFactorizationData(Data, 3, tensor_coordinates, Order1, Order2, Order3);
+            TensorProductBernstein(3, Data, shape_functions_values, shape_functions_local_gradients);
+            return;
+        }
+
         for (unsigned int it_gp = 0; it_gp < integration_points.size(); ++it_gp)
         {
             VectorType temp_values;
@@ -0,0 +1,234 @@
+//
+//   Project Name:        Kratos
+//   Last Modified by:    $Author: hbui $
+//   Date:                $Date: 17 Oct 2026 $
+//   Revision:            $Revision: 1.0 $
+//
+//
+
+#if !defined(KRATOS_ISOGEOMETRIC_APPLICATION_BOUNDING_BOX_TREE_H_INCLUDED )
+#define  KRATOS_ISOGEOMETRIC_APPLICATION_BOUNDING_BOX_TREE_H_INCLUDED
+
+// System includes
+#include <vector>
+#include <algorithm>
+#include <iostream>
+
+// External includes
+
+// Project includes
+#include "includes/define.h"
+
+namespace Kratos
+{
+
+/**
+ * Bounding volume hierarchy over a set of axis-aligned boxes. The tree is built once by recursively splitting the boxes
+ * at the median of their centres along the longest extent, and is then queried for the boxes containing a point.
+ * The nodes are stored in a flat array, the two children of an internal node are adjacent.
+ */
+template<int TDim>
+class BoundingBoxTree
+{
+public:
+    /// Pointer definition
+    KRATOS_CLASS_POINTER_DEFINITION(BoundingBoxTree);
+
+    /// Type definitions
+    typedef std::size_t IndexType;
+
+    /// Default constructor
+    BoundingBoxTree()
+    {}
+
+    /// Destructor
+    virtual ~BoundingBoxTree()
+    {}
+
+    /**
+     * Build the tree.
+     * @param rBoxes    flat array of the box bounds (min_0, max_0, min_1, max_1, ...) of each box
+     * @param leaf_size the maximum number of boxes in a leaf
+     */
+    void Build(const std::vector<double>& rBoxes, const IndexType& leaf_size = 4)
+    {
+        mBoxes = rBoxes;
+        mLeafSize = std::max(leaf_size, static_cast<IndexType>(1));
+
+        const IndexType n = this->size();
+        mIndices.resize(n);
+        for (IndexType i = 0; i < n; ++i)
+            mIndices[i] = i;
+
+        mNodes.clear();
+        if (n == 0)
+            return;
+
+        mNodes.reserve(2 * (n / mLeafSize + 1));
+        mNodes.push_back(Node());
+        BuildNode(0, 0, n);
+    }
+
+    /**
+     * Search the boxes containing the point within the tolerance.
+     * @param Point     the point coordinates, at least TDim values
+     * @param tol       the tolerance, i.e. the boxes are enlarged by tol in each direction
+     * @param rResults  on output, the indices of the found boxes in ascending order
+     */
+    template<typename TPointType>
+    void Search(const TPointType& Point, const double& tol, std::vector<IndexType>& rResults) const
+    {
+        rResults.clear();
+        if (mNodes.empty())
+            return;
+
+        std::vector<IndexType> stack(1, 0);
+        while (!stack.empty())
+        {
+            const Node& r_node = mNodes[stack.back()];
+            stack.pop_back();
+
+            if (!IsInside(r_node.mBounds, Point, tol))
+                continue;
+
+            if (r_node.mCount > 0)
+            {
+                for (IndexType i = r_node.mFirst; i < r_node.mFirst + r_node.mCount; ++i)
+                    if (IsInside(&mBoxes[2*TDim*mIndices[i]], Point, tol))
+                        rResults.push_back(mIndices[i]);
+            }
+            else
+            {
+                stack.push_back(r_node.mFirst);
+                stack.push_back(r_node.mFirst + 1);
+            }
+        }
+
+        std::sort(rResults.begin(), rResults.end());
+    }
+
+    /// Get the number of boxes
+    IndexType size() const {return mBoxes.size() / (2*TDim);}
+
+    /// Get the number of nodes of the tree
+    IndexType NumberOfNodes() const {return mNodes.size();}
+
+    /// Get the bounds of the i-th box
+    const double* Box(const IndexType& i) const {return &mBoxes[2*TDim*i];}
+
+    /// Information
+    virtual void PrintInfo(std::ostream& rOStream) const
+    {
+        rOStream << "BoundingBoxTree" << TDim << "D";
+    }
+
+    virtual void PrintData(std::ostream& rOStream) const
+    {
+        rOStream << " number of boxes: " << this->size() << ", number of nodes: " << this->NumberOfNodes();
+    }
+
+private:
+
+    /// Node of the tree. A leaf refers to mCount boxes in mIndices starting from mFirst; an internal node has mCount = 0
+    /// and its children at mFirst and mFirst + 1.
+    struct Node
+    {
+        double mBounds[2*TDim];
+        IndexType mFirst;
+        IndexType mCount;
+    };
+
+    /// Compare two boxes by their centres along an axis
+    struct CentreLess
+    {
+        CentreLess(const std::vector<double>& rBoxes, const int& axis) : mrBoxes(rBoxes), mAxis(axis) {}
+
+        bool operator()(const IndexType& a, const IndexType& b) const
+        {
+            return mrBoxes[2*TDim*a + 2*mAxis] + mrBoxes[2*TDim*a + 2*mAxis + 1]
+                 < mrBoxes[2*TDim*b + 2*mAxis] + mrBoxes[2*TDim*b + 2*mAxis + 1];
+        }
+
+        const std::vector<double>& mrBoxes;
+        int mAxis;
+    };
+
+    std::vector<double> mBoxes;
+    std::vector<IndexType> mIndices;
+    std::vector<Node> mNodes;
+    IndexType mLeafSize;
+
+    void BuildNode(const IndexType& inode, const IndexType& begin, const IndexType& end)
+    {
+        // bounds of the boxes and of their centres
+        double bounds[2*TDim], cbounds[2*TDim];
+        for (int d = 0; d < TDim; ++d)
+        {
+            bounds[2*d] = cbounds[2*d] = 1.0e99;
+            bounds[2*d + 1] = cbounds[2*d + 1] = -1.0e99;
+        }
+        for (IndexType i = begin; i < end; ++i)
+        {
+            const double* box = &mBoxes[2*TDim*mIndices[i]];
+            for (int d = 0; d < TDim; ++d)
+            {
+                const double c = 0.5 * (box[2*d] + box[2*d + 1]);
+                bounds[2*d] = std::min(bounds[2*d], box[2*d]);
+                bounds[2*d + 1] = std::max(bounds[2*d + 1], box[2*d + 1]);
+                cbounds[2*d] = std::min(cbounds[2*d], c);
+                cbounds[2*d + 1] = std::max(cbounds[2*d + 1], c);
+            }
+        }
+        std::copy(bounds, bounds + 2*TDim, mNodes[inode].mBounds);
+
+        // split direction is the longest extent of the centres
+        int axis = 0;
+        for (int d = 1; d < TDim; ++d)
+            if (cbounds[2*d + 1] - cbounds[2*d] > cbounds[2*axis + 1] - cbounds[2*axis])
+                axis = d;
+
+        if (end - begin <= mLeafSize || cbounds[2*axis + 1] == cbounds[2*axis])
+        {
+            mNodes[inode].mFirst = begin;
+            mNodes[inode].mCount = end - begin;
+            return;
+        }
+
+        const IndexType mid = begin + (end - begin) / 2;
+        std::nth_element(mIndices.begin() + begin, mIndices.begin() + mid, mIndices.begin() + end,
+            CentreLess(mBoxes, axis));
+
+        const IndexType left = mNodes.size();
+        mNodes.push_back(Node());
+        mNodes.push_back(Node());
+        mNodes[inode].mFirst = left;
+        mNodes[inode].mCount = 0;
+
+        BuildNode(left, begin, mid);
+        BuildNode(left + 1, mid, end);
+    }
+
+    template<typename TPointType>
+    static bool IsInside(const double* bounds, const TPointType& Point, const double& tol)
+    {
+        for (int d = 0; d < TDim; ++d)
+            if (Point[d] < bounds[2*d] - tol || Point[d] > bounds[2*d + 1] + tol)
+                return false;
+        return true;
+    }
+
+}; // Class BoundingBoxTree
+
+/// output stream function
+template<int TDim>
+inline std::ostream& operator << (std::ostream& rOStream, const BoundingBoxTree<TDim>& rThis)
+{
+    rThis.PrintInfo(rOStream);
+    rOStream << std::endl;
+    rThis.PrintData(rOStream);
+    return rOStream;
+}
+
+}// namespace Kratos.
+
+#endif // KRATOS_ISOGEOMETRIC_APPLICATION_BOUNDING_BOX_TREE_H_INCLUDED
@@ -298,6 +298,54 @@ public:
     //N = 10000000: 8.18893
     //N = 100000000: 76.7523, 81.9167
 
+    /// Compute the non-zero basis functions and their first derivatives at span rI, i.e. rN[r] and rdN[r] are the value and derivative
+    /// of the function rI-rP+r, r=0..rP. It is the same as BasisFuns and BasisFunsDer with rD = 1, but the work arrays are of fixed size,
+    /// hence there is no memory allocation. rN and rdN must have at least rP+1 entries; rdN can be NULL if the derivatives are not needed.
+    template<class ValuesContainerType>
+    static void BasisFunsAndFirstDer(double* rN,
+                                     double* rdN,
+                                     const int& rI,
+                                     const double& rXi,
+                                     const int& rP,
+                                     const ValuesContainerType& rU)
+    {
+        if (rP > MaxLocalOrder)
+            KRATOS_THROW_ERROR(std::logic_error, "The degree exceeds the maximum degree supported by BasisFunsAndFirstDer:", rP)
+
+        double left[MaxLocalOrder+1], right[MaxLocalOrder+1];
+        double saved, temp, prev_temp;
+
+        rN[0] = 1.0;
+        if (rdN != NULL)
+            rdN[0] = 0.0;
+
+        for (int j = 1; j <= rP; ++j)
+        {
+            left[j] = rXi - rU[rI + 1 - j];
+            right[j] = rU[rI + j] - rXi;
+            saved = 0.0;
+            prev_temp = 0.0;
+
+            for (int r = 0; r < j; ++r)
+            {
+                temp = rN[r] / (right[r + 1] + left[j - r]);
+                rN[r] = saved + right[r + 1] * temp;
+                saved = left[j - r] * temp;
+
+                // at the last degree, temp is the function of degree p-1 divided by the knot difference
+                if ((j == rP) && (rdN != NULL))
+                {
+                    rdN[r] = rP * (prev_temp - temp);
+                    prev_temp = temp;
+                }
+            }
+
+            rN[j] = saved;
+            if ((j == rP) && (rdN != NULL))
+                rdN[j] = rP * prev_temp;
+        }
+    }
+
     struct MatrixOp
     {
         void InitZero(Matrix& S, const int& m, const int& n) const
@@ -584,6 +632,87 @@ public:
         return N[nt-s+p];
     }
 
+    /// Maximum degree supported by CoxDeBoorLocal
+    static const int MaxLocalOrder = 31;
+
+    /// Compute the value and the first derivative of the B-spline basis function defined by the local knot vector knots[0..p+1]
+    /// It gives the same value as CoxDeBoor3, i.e. the function is right-continuous inside the support and closed at the last knot,
+    /// but the triangular table is computed non-recursively in a fixed size array, hence there is no memory allocation.
+    //    % Input:
+    //    %   u       knot to be compute the function value
+    //    %   p       B-spline degree
+    //    %   knots   local knot vector, must be ascending and have (at least) p+2 entries
+    //    % Output: function value and derivative
+    template<class ValuesContainerType>
+    static void CoxDeBoorLocal(double& rValue, double& rDerivative, const double& u, const int& p, const ValuesContainerType& knots)
+    {
+        rValue = 0.0;
+        rDerivative = 0.0;
+
+        if ((u > knots[p+1]) || (u < knots[0]))
+            return;
+
+        if (p > MaxLocalOrder)
+            KRATOS_THROW_ERROR(std::logic_error, "The degree exceeds the maximum degree supported by CoxDeBoorLocal:", p)
+
+        // degree 0 functions; at the last knot the last non-empty span is taken
+        double N[MaxLocalOrder+1];
+        for (int j = 0; j <= p; ++j)
+            N[j] = ((knots[j] <= u) && (u < knots[j+1])) ? 1.0 : 0.0;
+
+        if (u == knots[p+1])
+        {
+            for (int j = p; j >= 0; --j)
+            {
+                if (knots[j] < knots[j+1])
+                {
+                    N[j] = 1.0;
+                    break;
+                }
+            }
+        }
+
+        // raise the degree, in place
+        double Nl = 0.0, Nr = 0.0; // functions of degree p-1
+        for (int q = 1; q <= p; ++q)
+        {
+            if (q == p)
+            {
+                Nl = N[0];
+                Nr = N[1];
+            }
+
+            for (int j = 0; j <= p-q; ++j)
+            {
+                double v = 0.0;
+                if (knots[j+q] != knots[j])
+                    v += (u - knots[j]) / (knots[j+q] - knots[j]) * N[j];
+                if (knots[j+q+1] != knots[j+1])
+                    v += (knots[j+q+1] - u) / (knots[j+q+1] - knots[j+1]) * N[j+1];
+                N[j] = v;
+            }
+        }
+
+        rValue = N[0];
+
+        if (p > 0)
+        {
+            if (knots[p] != knots[0])
+                rDerivative += p * Nl / (knots[p] - knots[0]);
+            if (knots[p+1] != knots[1])
+                rDerivative -= p * Nr / (knots[p+1] - knots[1]);
+        }
+    }
+
+    /// Compute the value of the B-spline basis function defined by the local knot vector knots[0..p+1]. See CoxDeBoorLocal above.
+    template<class ValuesContainerType>
+    static double CoxDeBoorLocal(const double& u, const int& p, const ValuesContainerType& knots)
+    {
+        double v, dv;
+        CoxDeBoorLocal(v, dv, u, p, knots);
+        return v;
+    }
+
     /// Compute the refinement coefficients for one knot insertion B-Splines refinement in 1D
     /// REF: Eq (5.10) the NURBS books
     template<class MatrixType, class ValuesContainerType>
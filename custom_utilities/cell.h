@@ -17,6 +17,7 @@
 // Project includes
 #include "includes/define.h"
 #include "includes/ublas_interface.h"
+#include "custom_utilities/compressed_extraction_operator.h"
 
 // External includes
 #include <boost/numeric/ublas/vector_sparse.hpp>
@@ -39,7 +40,7 @@ public:
     // typedef boost::numeric::ublas::vector<double> SparseVectorType;
 
     /// Default constructor
-    Cell(const std::size_t& Id) : mId(Id)
+    Cell(const std::size_t& Id) : mId(Id), mNumberOfBezierFunctions(0), mCrowPtr(1, 0)
     {}
 
     /// Destructor
@@ -60,24 +61,60 @@ public:
     {
         mSupportedAnchors.clear();
         mAnchorWeights.clear();
-        mCrows.clear();
+        mNumberOfBezierFunctions = 0;
+        mCrowPtr.assign(1, 0);
+        mCrowIndices.clear();
+        mCrowValues.clear();
+    }
+
+    /// Reserve the memory for the anchors and the non-zero entries of the extraction operator
+    void Reserve(const std::size_t& NumberOfAnchors, const std::size_t& NumberOfNonZeros)
+    {
+        mSupportedAnchors.reserve(NumberOfAnchors);
+        mAnchorWeights.reserve(NumberOfAnchors);
+        mCrowPtr.reserve(NumberOfAnchors + 1);
+        mCrowIndices.reserve(NumberOfNonZeros);
+        mCrowValues.reserve(NumberOfNonZeros);
     }
 
     /// Add supported anchor and the respective extraction operator of this cell to the anchor
-    void AddAnchor(const std::size_t& Id, const double& W, const Vector& Crow)
+    /// The row of the extraction operator is appended to the packed CSR storage of the cell, hence no allocation per anchor is needed.
+    template<class TVectorType>
+    void AddAnchor(const std::size_t& Id, const double& W, const TVectorType& Crow)
     {
         mSupportedAnchors.push_back(Id);
         mAnchorWeights.push_back(W);
 
-        std::vector<std::size_t> inz;
-        inz.reserve(Crow.size());
+        mNumberOfBezierFunctions = Crow.size();
         for (std::size_t i = 0; i < Crow.size(); ++i)
+        {
             if (Crow[i] != 0.0)
-                inz.push_back(i);
-        SparseVectorType Crow_sparse(Crow.size(), inz.size());
-        for (std::size_t i = 0; i < inz.size(); ++i)
-            Crow_sparse[inz[i]] = Crow[inz[i]];
-        mCrows.push_back(Crow_sparse);
+            {
+                mCrowIndices.push_back(i);
+                mCrowValues.push_back(Crow[i]);
+            }
+        }
+        mCrowPtr.push_back(mCrowIndices.size());
+    }
+
+    /// Add supported anchor and the respective row of the extraction operator given in sparse form. The indices must be sorted.
+    void AddAnchor(const std::size_t& Id, const double& W, const std::size_t& NumberOfBezierFunctions,
+            const std::vector<std::size_t>& rIndices, const std::vector<double>& rValues)
+    {
+        mSupportedAnchors.push_back(Id);
+        mAnchorWeights.push_back(W);
+
+        mNumberOfBezierFunctions = NumberOfBezierFunctions;
+        mCrowIndices.insert(mCrowIndices.end(), rIndices.begin(), rIndices.end());
+        mCrowValues.insert(mCrowValues.end(), rValues.begin(), rValues.end());
+        mCrowPtr.push_back(mCrowIndices.size());
+    }
+
+    /// Update the id and the weight of the i-th anchor, keeping its row of the extraction operator
+    void UpdateAnchor(const std::size_t& i, const std::size_t& Id, const double& W)
+    {
+        mSupportedAnchors[i] = Id;
+        mAnchorWeights[i] = W;
     }
 
     /// Absorb the information from the other cell
@@ -87,7 +124,16 @@ public:
         {
             if (std::find(mSupportedAnchors.begin(), mSupportedAnchors.end(), pOther->GetSupportedAnchors()[i]) == mSupportedAnchors.end())
             {
-                this->AddAnchor(pOther->GetSupportedAnchors()[i], pOther->GetAnchorWeights()[i], pOther->GetCrows()[i]);
+                mSupportedAnchors.push_back(pOther->GetSupportedAnchors()[i]);
+                mAnchorWeights.push_back(pOther->GetAnchorWeights()[i]);
+
+                mNumberOfBezierFunctions = pOther->NumberOfBezierFunctions();
+                for (std::size_t k = pOther->GetCrowPointers()[i]; k < pOther->GetCrowPointers()[i + 1]; ++k)
+                {
+                    mCrowIndices.push_back(pOther->GetCrowIndices()[k]);
+                    mCrowValues.push_back(pOther->GetCrowValues()[k]);
+                }
+                mCrowPtr.push_back(mCrowIndices.size());
             }
         }
     }
@@ -113,47 +159,75 @@ public:
         std::copy(mAnchorWeights.begin(), mAnchorWeights.end(), rWeights.begin());
     }
 
-    /// Get the internal data of row of the extraction operator
-    const std::vector<SparseVectorType>& GetCrows() const {return mCrows;}
+    /// Get the number of Bezier functions, i.e. the number of columns of the extraction operator
+    std::size_t NumberOfBezierFunctions() const {return mNumberOfBezierFunctions;}
+
+    /// Get the internal CSR data of the extraction operator
+    const std::vector<std::size_t>& GetCrowPointers() const {return mCrowPtr;}
+    const std::vector<std::size_t>& GetCrowIndices() const {return mCrowIndices;}
+    const std::vector<double>& GetCrowValues() const {return mCrowValues;}
+
+    /// Get the row of the extraction operator for the i-th anchor
+    Vector GetCrow(const std::size_t& i) const
+    {
+        Vector Crow(mNumberOfBezierFunctions);
+        noalias(Crow) = ZeroVector(mNumberOfBezierFunctions);
+        for (std::size_t k = mCrowPtr[i]; k < mCrowPtr[i + 1]; ++k)
+            Crow(mCrowIndices[k]) = mCrowValues[k];
+        return Crow;
+    }
+
+    /// Get the rows of the extraction operator as sparse vectors. The rows are built from the CSR data on every call,
+    /// hence GetCrowPointers/GetCrowIndices/GetCrowValues shall be preferred in the loops.
+    std::vector<SparseVectorType> GetCrows() const
+    {
+        std::vector<SparseVectorType> Crows;
+        Crows.reserve(this->NumberOfAnchors());
+        for (std::size_t i = 0; i < this->NumberOfAnchors(); ++i)
+        {
+            SparseVectorType Crow_sparse(mNumberOfBezierFunctions, mCrowPtr[i + 1] - mCrowPtr[i]);
+            for (std::size_t k = mCrowPtr[i]; k < mCrowPtr[i + 1]; ++k)
+                Crow_sparse[mCrowIndices[k]] = mCrowValues[k];
+            Crows.push_back(Crow_sparse);
+        }
+        return Crows;
+    }
 
     /// Get the extraction operator matrix
     Matrix GetExtractionOperator() const
     {
-        Matrix M(mCrows.size(), mCrows[0].size());
-        for(std::size_t i = 0; i < mCrows.size(); ++i)
-            noalias(row(M, i)) = mCrows[i];
+        Matrix M(this->NumberOfAnchors(), mNumberOfBezierFunctions);
+        noalias(M) = ZeroMatrix(this->NumberOfAnchors(), mNumberOfBezierFunctions);
+        for (std::size_t i = 0; i < this->NumberOfAnchors(); ++i)
+            for (std::size_t k = mCrowPtr[i]; k < mCrowPtr[i + 1]; ++k)
+                M(i, mCrowIndices[k]) = mCrowValues[k];
         return M;
     }
 
     /// Get the extraction as compressed matrix
     CompressedMatrix GetCompressedExtractionOperator() const
     {
-        CompressedMatrix M(mCrows.size(), mCrows[0].size());
-        // here we just naively copy the data. However we shall initialize the compressed matrix properly as in the kernel (TODO)
-        for(std::size_t i = 0; i < mCrows.size(); ++i)
-            noalias(row(M, i)) = mCrows[i];
+        // the entries are pushed in the row-major order, which is the native order of the compressed matrix
+        CompressedMatrix M(this->NumberOfAnchors(), mNumberOfBezierFunctions, mCrowValues.size());
+        for (std::size_t i = 0; i < this->NumberOfAnchors(); ++i)
+            for (std::size_t k = mCrowPtr[i]; k < mCrowPtr[i + 1]; ++k)
+                M.push_back(i, mCrowIndices[k], mCrowValues[k]);
         M.complete_index1_data();
         return M;
     }
 
+    /// Get the extraction operator in the compact CSR form
+    void GetExtractionOperator(CompressedExtractionOperator& rC) const
+    {
+        rC.Assign(this->NumberOfAnchors(), mNumberOfBezierFunctions, mCrowPtr, mCrowIndices, mCrowValues);
+    }
+
     /// Get the extraction operator as CSR triplet
     void GetExtractionOperator(std::vector<int>& rowPtr, std::vector<int>& colInd, std::vector<double>& values) const
     {
-        int cnt = 0;
-        rowPtr.push_back(cnt);
-        for(std::size_t i = 0; i < mCrows.size(); ++i)
-        {
-            for(std::size_t j = 0; j < mCrows[i].size(); ++j)
-            {
-                if(mCrows[i](j) != 0)
-                {
-                    colInd.push_back(j);
-                    values.push_back(mCrows[i](j));
-                    ++cnt;
-                }
-            }
-            rowPtr.push_back(cnt);
-        }
+        rowPtr.insert(rowPtr.end(), mCrowPtr.begin(), mCrowPtr.end());
+        colInd.insert(colInd.end(), mCrowIndices.begin(), mCrowIndices.end());
+        values.insert(values.end(), mCrowValues.begin(), mCrowValues.end());
     }
 
     /// Implement relational operator for automatic arrangement in container
@@ -187,7 +261,10 @@ protected:
     std::size_t mId;
     std::vector<std::size_t> mSupportedAnchors;
     std::vector<double> mAnchorWeights; // weight of the anchor
-    std::vector<SparseVectorType> mCrows; // bezier extraction operator row to each anchor
+    std::size_t mNumberOfBezierFunctions; // number of columns of the bezier extraction operator
+    std::vector<std::size_t> mCrowPtr; // bezier extraction operator rows to each anchor, packed in CSR format
+    std::vector<std::size_t> mCrowIndices;
+    std::vector<double> mCrowValues;
 };
 
 /// output stream function
@@ -0,0 +1,290 @@
+//
+//   Project Name:        Kratos
+//   Last Modified by:    $Author: hbui $
+//   Date:                $Date: 16 Oct 2026 $
+//   Revision:            $Revision: 1.0 $
+//
+//
+
+#if !defined(KRATOS_ISOGEOMETRIC_APPLICATION_COMPRESSED_EXTRACTION_OPERATOR_H_INCLUDED )
+#define  KRATOS_ISOGEOMETRIC_APPLICATION_COMPRESSED_EXTRACTION_OPERATOR_H_INCLUDED
+
+// System includes
+#include <vector>
+#include <iostream>
+#include <algorithm>
+
+// External includes
+
+// Project includes
+#include "includes/define.h"
+#include "includes/ublas_interface.h"
+
+namespace Kratos
+{
+
+/**
+ * Compact storage of the Bezier extraction operator of a Bezier element in CSR format.
+ * Each row corresponds to a control point (anchor) of the element and each column to a Bernstein function.
+ * The operator of a tensor product element of high order is very sparse, hence the kernels below only visit
+ * the non-zero entries. The kernels follow the data layout used in BezierUtils and the Bezier geometries, i.e.
+ * the Bezier functions derivatives are stored as (number of derivative components x number of Bezier functions),
+ * and the shape functions derivatives as (number of control points x number of derivative components).
+ */
+class CompressedExtractionOperator
+{
+public:
+    /// Type definitions
+    typedef std::size_t IndexType;
+    typedef std::size_t SizeType;
+
+    /// Default constructor
+    CompressedExtractionOperator() : mSize1(0), mSize2(0), mRowPtr(1, 0)
+    {}
+
+    /// Destructor
+    virtual ~CompressedExtractionOperator()
+    {}
+
+    /// Assign the extraction operator from a dense matrix. Only the non-zero entries are kept.
+    void Assign(const Matrix& rOther)
+    {
+        this->Clear(rOther.size1(), rOther.size2());
+        for (IndexType i = 0; i < rOther.size1(); ++i)
+        {
+            for (IndexType j = 0; j < rOther.size2(); ++j)
+            {
+                if (rOther(i, j) != 0.0)
+                {
+                    mColInd.push_back(j);
+                    mValues.push_back(rOther(i, j));
+                }
+            }
+            mRowPtr[i + 1] = mValues.size();
+        }
+    }
+
+    /// Assign the extraction operator from a compressed matrix. The dense form is never formed.
+    void Assign(const CompressedMatrix& rOther)
+    {
+        this->Clear(rOther.size1(), rOther.size2());
+        mColInd.reserve(rOther.nnz());
+        mValues.reserve(rOther.nnz());
+        for (CompressedMatrix::const_iterator1 it1 = rOther.begin1(); it1 != rOther.end1(); ++it1)
+        {
+            for (CompressedMatrix::const_iterator2 it2 = it1.begin(); it2 != it1.end(); ++it2)
+            {
+                if (*it2 != 0.0)
+                {
+                    mColInd.push_back(it2.index2());
+                    mValues.push_back(*it2);
+                }
+            }
+            mRowPtr[it1.index1() + 1] = mValues.size();
+        }
+
+        // fill the row pointers of the empty rows
+        for (IndexType i = 0; i < mSize1; ++i)
+            if (mRowPtr[i + 1] < mRowPtr[i])
+                mRowPtr[i + 1] = mRowPtr[i];
+    }
+
+    /// Assign the extraction operator from another one
+    void Assign(const CompressedExtractionOperator& rOther)
+    {
+        *this = rOther;
+    }
+
+    /// Assign the extraction operator from the CSR arrays. The column indices in each row must be sorted.
+    template<class TIndexContainerType, class TValueContainerType>
+    void Assign(const SizeType& Size1, const SizeType& Size2, const TIndexContainerType& rRowPtr,
+            const TIndexContainerType& rColInd, const TValueContainerType& rValues)
+    {
+        mSize1 = Size1;
+        mSize2 = Size2;
+        mRowPtr.assign(rRowPtr.begin(), rRowPtr.begin() + Size1 + 1);
+        mColInd.assign(rColInd.begin(), rColInd.begin() + mRowPtr[Size1]);
+        mValues.assign(rValues.begin(), rValues.begin() + mRowPtr[Size1]);
+    }
+
+    /// Assign the extraction operator from raw CSR arrays, e.g. a memory-mapped buffer. The row pointers must start at 0
+    /// and the column indices in each row must be sorted.
+    template<class TIndexType>
+    void Assign(const SizeType& Size1, const SizeType& Size2, const TIndexType* pRowPtr,
+            const TIndexType* pColInd, const double* pValues)
+    {
+        mSize1 = Size1;
+        mSize2 = Size2;
+        mRowPtr.assign(pRowPtr, pRowPtr + Size1 + 1);
+        mColInd.assign(pColInd, pColInd + mRowPtr[Size1]);
+        mValues.assign(pValues, pValues + mRowPtr[Size1]);
+    }
+
+    /// Get the number of rows, i.e. the number of control points
+    SizeType size1() const {return mSize1;}
+
+    /// Get the number of columns, i.e. the number of Bezier functions
+    SizeType size2() const {return mSize2;}
+
+    /// Get the number of non-zero entries
+    SizeType nnz() const {return mValues.size();}
+
+    /// Access the CSR data
+    const std::vector<IndexType>& index1_data() const {return mRowPtr;}
+    const std::vector<IndexType>& index2_data() const {return mColInd;}
+    const std::vector<double>& value_data() const {return mValues;}
+
+    /// Access an entry of the extraction operator. The column indices in each row are sorted, hence binary search is used.
+    double operator()(const IndexType& i, const IndexType& j) const
+    {
+        std::vector<IndexType>::const_iterator it_begin = mColInd.begin() + mRowPtr[i];
+        std::vector<IndexType>::const_iterator it_end = mColInd.begin() + mRowPtr[i + 1];
+        std::vector<IndexType>::const_iterator it = std::lower_bound(it_begin, it_end, j);
+        if (it != it_end && *it == j)
+            return mValues[it - mColInd.begin()];
+        return 0.0;
+    }
+
+    /// Convert the extraction operator to dense matrix
+    Matrix ToMatrix() const
+    {
+        Matrix M(mSize1, mSize2);
+        noalias(M) = ZeroMatrix(mSize1, mSize2);
+        for (IndexType i = 0; i < mSize1; ++i)
+            for (IndexType k = mRowPtr[i]; k < mRowPtr[i + 1]; ++k)
+                M(i, mColInd[k]) = mValues[k];
+        return M;
+    }
+
+    /// Extract the row i of the extraction operator to a dense vector. rRow must be sized to size2().
+    template<class TVectorType>
+    void ExtractRow(const IndexType& i, TVectorType& rRow) const
+    {
+        for (IndexType j = 0; j < mSize2; ++j)
+            rRow(j) = 0.0;
+        for (IndexType k = mRowPtr[i]; k < mRowPtr[i + 1]; ++k)
+            rRow(mColInd[k]) = mValues[k];
+    }
+
+    /// Compute rOut = C * rIn. rOut must be sized to size1().
+    template<class TOutType, class TInType>
+    void Prod(TOutType& rOut, const TInType& rIn) const
+    {
+        for (IndexType i = 0; i < mSize1; ++i)
+        {
+            double v = 0.0;
+            for (IndexType k = mRowPtr[i]; k < mRowPtr[i + 1]; ++k)
+                v += mValues[k] * rIn(mColInd[k]);
+            rOut(i) = v;
+        }
+    }
+
+    /// Compute rOut = trans(C) * rIn. rOut must be sized to size2().
+    template<class TOutType, class TInType>
+    void TransProd(TOutType& rOut, const TInType& rIn) const
+    {
+        for (IndexType j = 0; j < mSize2; ++j)
+            rOut(j) = 0.0;
+        for (IndexType i = 0; i < mSize1; ++i)
+        {
+            const double v = rIn(i);
+            for (IndexType k = mRowPtr[i]; k < mRowPtr[i + 1]; ++k)
+                rOut(mColInd[k]) += mValues[k] * v;
+        }
+    }
+
+    /// Kernel for the shape function values: rOut(i) = Factor * rWeights(i) * sum_j C(i, j) * rIn(j).
+    /// rIn are the Bezier functions values and rWeights are the control weights.
+    template<class TOutType, class TInType, class TWeightsType>
+    void ApplyValues(TOutType& rOut, const TInType& rIn, const TWeightsType& rWeights, const double& Factor) const
+    {
+        for (IndexType i = 0; i < mSize1; ++i)
+        {
+            double v = 0.0;
+            for (IndexType k = mRowPtr[i]; k < mRowPtr[i + 1]; ++k)
+                v += mValues[k] * rIn(mColInd[k]);
+            rOut(i) = Factor * rWeights(i) * v;
+        }
+    }
+
+    /// Kernel for the shape function derivatives of any order: rOut(i, d) = rWeights(i) * sum_j C(i, j) * rIn(d, j), d = 0..rIn.size1()-1.
+    /// rIn are the derivatives of the rational Bezier functions, stored row-wise per derivative component,
+    /// e.g. (dim x n) for the gradients, (dim*(dim+1)/2 x n) for the second derivatives. rOut must be sized to (size1() x rIn.size1()).
+    /// All components are computed in one sweep over the non-zero entries.
+    template<class TOutType, class TInType, class TWeightsType>
+    void ApplyDerivatives(TOutType& rOut, const TInType& rIn, const TWeightsType& rWeights) const
+    {
+        const SizeType ncomp = rIn.size1();
+        for (IndexType i = 0; i < mSize1; ++i)
+        {
+            for (IndexType d = 0; d < ncomp; ++d)
+                rOut(i, d) = 0.0;
+            for (IndexType k = mRowPtr[i]; k < mRowPtr[i + 1]; ++k)
+            {
+                const IndexType j = mColInd[k];
+                const double c = mValues[k];
+                for (IndexType d = 0; d < ncomp; ++d)
+                    rOut(i, d) += c * rIn(d, j);
+            }
+            for (IndexType d = 0; d < ncomp; ++d)
+                rOut(i, d) *= rWeights(i);
+        }
+    }
+
+    /// Information
+    virtual void PrintInfo(std::ostream& rOStream) const
+    {
+        rOStream << "CompressedExtractionOperator";
+    }
+
+    virtual void PrintData(std::ostream& rOStream) const
+    {
+        rOStream << "[" << mSize1 << "," << mSize2 << "](";
+        for (IndexType i = 0; i < mSize1; ++i)
+        {
+            rOStream << "(";
+            for (IndexType k = mRowPtr[i]; k < mRowPtr[i + 1]; ++k)
+                rOStream << " " << mColInd[k] << ":" << mValues[k];
+            rOStream << " )";
+        }
+        rOStream << ")";
+    }
+
+private:
+
+    SizeType mSize1;
+    SizeType mSize2;
+    std::vector<IndexType> mRowPtr;
+    std::vector<IndexType> mColInd;
+    std::vector<double> mValues;
+
+    void Clear(const SizeType& Size1, const SizeType& Size2)
+    {
+        mSize1 = Size1;
+        mSize2 = Size2;
+        mRowPtr.assign(Size1 + 1, 0);
+        mColInd.clear();
+        mValues.clear();
+    }
+};
+
+/// Sparse product of the extraction operator with a vector expression, i.e. C * v.
+/// It replaces the ublas prod in the Bezier geometries and only visits the non-zero entries of C.
+template<class TExpressionType>
+inline Vector prod(const CompressedExtractionOperator& rC, const boost::numeric::ublas::vector_expression<TExpressionType>& rV)
+{
+    Vector Result(rC.size1());
+    rC.Prod(Result, rV());
+    return Result;
+}
+
+/// output stream function
+inline std::ostream& operator <<(std::ostream& rOStream, const CompressedExtractionOperator& rThis)
+{
+    rThis.PrintData(rOStream);
+    return rOStream;
+}
+
+}// namespace Kratos.
+
+#endif // KRATOS_ISOGEOMETRIC_APPLICATION_COMPRESSED_EXTRACTION_OPERATOR_H_INCLUDED
@@ -11,6 +11,7 @@
 
 // System includes
 #include <vector>
+#include <algorithm>
 
 // External includes
 #include <boost/enable_shared_from_this.hpp>
@@ -166,6 +167,81 @@ public:
         KRATOS_THROW_ERROR(std::logic_error, "Calling base class function", __FUNCTION__)
     }
 
+    ///////////////
+
+    /// Get the values of the basis functions at a batch of points
+    /// rPoints contains the coordinates of the points contiguously, i.e. [xi_0, xi_1, ..] of point 0, then of point 1, ...
+    /// The output is in compressed row format: the non-zero values at point ip are rValues[k], k = rRowPtr[ip]..rRowPtr[ip+1]-1,
+    /// and rIndices[k] are the (local) indices of the corresponding basis functions. The buffers are only reallocated when they grow,
+    /// hence they can be reused across calls. The specialized implementations reuse the span search between consecutive points,
+    /// so it is beneficial to sort the points.
+    /// REMARK: This function only returns the unweighted basis function value. To obtain the correct one, use WeightedFESpace
+    virtual void GetValuesAtPoints(std::vector<std::size_t>& rRowPtr, std::vector<std::size_t>& rIndices,
+        std::vector<double>& rValues, const std::vector<double>& rPoints) const
+    {
+        const std::size_t npoints = rPoints.size() / TDim;
+        rRowPtr.resize(npoints + 1);
+        rRowPtr[0] = 0;
+        rIndices.clear();
+        rValues.clear();
+
+        // generic implementation based on the point-wise evaluation
+        std::vector<double> xi(TDim), values;
+        for (std::size_t ip = 0; ip < npoints; ++ip)
+        {
+            std::copy(rPoints.begin() + ip*TDim, rPoints.begin() + (ip+1)*TDim, xi.begin());
+            this->GetValues(values, xi);
+            for (std::size_t i = 0; i < values.size(); ++i)
+            {
+                if (values[i] != 0.0)
+                {
+                    rIndices.push_back(i);
+                    rValues.push_back(values[i]);
+                }
+            }
+            rRowPtr[ip + 1] = rValues.size();
+        }
+    }
+
+    /// Get the values and derivatives of the basis functions at a batch of points
+    /// The layout is the same as GetValuesAtPoints. In addition, rDerivatives[k*TDim + dim] is the derivative of the basis function
+    /// rIndices[k] w.r.t xi_dim.
+    /// REMARK: This function only returns the unweighted basis function derivatives. To obtain the correct one, use WeightedFESpace
+    virtual void GetValuesAndDerivativesAtPoints(std::vector<std::size_t>& rRowPtr, std::vector<std::size_t>& rIndices,
+        std::vector<double>& rValues, std::vector<double>& rDerivatives, const std::vector<double>& rPoints) const
+    {
+        const std::size_t npoints = rPoints.size() / TDim;
+        rRowPtr.resize(npoints + 1);
+        rRowPtr[0] = 0;
+        rIndices.clear();
+        rValues.clear();
+        rDerivatives.clear();
+
+        // generic implementation based on the point-wise evaluation
+        std::vector<double> xi(TDim), values;
+        std::vector<std::vector<double> > derivatives;
+        for (std::size_t ip = 0; ip < npoints; ++ip)
+        {
+            std::copy(rPoints.begin() + ip*TDim, rPoints.begin() + (ip+1)*TDim, xi.begin());
+            this->GetValuesAndDerivatives(values, derivatives, xi);
+            for (std::size_t i = 0; i < values.size(); ++i)
+            {
+                bool is_zero = (values[i] == 0.0);
+                for (int dim = 0; dim < TDim; ++dim)
+                    is_zero = is_zero && (derivatives[i][dim] == 0.0);
+
+                if (!is_zero)
+                {
+                    rIndices.push_back(i);
+                    rValues.push_back(values[i]);
+                    for (int dim = 0; dim < TDim; ++dim)
+                        rDerivatives.push_back(derivatives[i][dim]);
+                }
+            }
+            rRowPtr[ip + 1] = rValues.size();
+        }
+    }
+
     /////////////////////////////////////////////////////////////////////////////////////////////////////
 
     /// Check if a point lies inside the parametric domain of the FESpace
@@ -426,6 +502,12 @@ public:
     /// Destructor
     virtual ~FESpace() {}
 
+    /// Get the dimension of the FESpace
+    static constexpr int Dim()
+    {
+        return 0;
+    }
+
     /// Get the number of basis functions defined over the FESpace
     virtual std::size_t TotalNumber() const
     {
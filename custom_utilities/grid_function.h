@@ -331,6 +331,66 @@ public:
         return dv;
     }
 
+    /// Get the values of the grid at a batch of local coordinates
+    /// rPoints contains the local coordinates of the points contiguously, i.e. TDim values per point.
+    /// The basis functions at all the points are provided by one batched call to the FESpace.
+    void GetValues(std::vector<TDataType>& rValues, const std::vector<double>& rPoints) const
+    {
+        std::vector<std::size_t> row_ptr, indices;
+        std::vector<double> f_values;
+        pFESpace()->GetValuesAtPoints(row_ptr, indices, f_values, rPoints);
+
+        const ControlGridType& r_control_grid = *pControlGrid();
+        const std::size_t npoints = row_ptr.size() - 1;
+        if (rValues.size() != npoints)
+            rValues.resize(npoints);
+
+        for (std::size_t ip = 0; ip < npoints; ++ip)
+        {
+            if (row_ptr[ip] == row_ptr[ip + 1])
+            {
+                rValues[ip] = 0.0 * r_control_grid.GetData(0);
+                continue;
+            }
+
+            rValues[ip] = f_values[row_ptr[ip]] * r_control_grid.GetData(indices[row_ptr[ip]]);
+            for (std::size_t k = row_ptr[ip] + 1; k < row_ptr[ip + 1]; ++k)
+                rValues[ip] += f_values[k] * r_control_grid.GetData(indices[k]);
+        }
+    }
+
+    /// Get the derivatives of the grid at a batch of local coordinates
+    /// The output has the form rDerivatives[ip*TDim + dim] = d(values(xi_ip)) / d(xi_dim). See GetDerivative for the restriction on TDataType.
+    void GetDerivatives(std::vector<TDataType>& rDerivatives, const std::vector<double>& rPoints) const
+    {
+        std::vector<std::size_t> row_ptr, indices;
+        std::vector<double> f_values, f_derivatives;
+        pFESpace()->GetValuesAndDerivativesAtPoints(row_ptr, indices, f_values, f_derivatives, rPoints);
+
+        const ControlGridType& r_control_grid = *pControlGrid();
+        const std::size_t npoints = row_ptr.size() - 1;
+        if (rDerivatives.size() != npoints*TDim)
+            rDerivatives.resize(npoints*TDim);
+
+        for (std::size_t ip = 0; ip < npoints; ++ip)
+        {
+            for (int dim = 0; dim < TDim; ++dim)
+            {
+                TDataType& dv = rDerivatives[ip*TDim + dim];
+
+                if (row_ptr[ip] == row_ptr[ip + 1])
+                {
+                    dv = 0.0 * r_control_grid.GetData(0);
+                    continue;
+                }
+
+                dv = f_derivatives[row_ptr[ip]*TDim + dim] * r_control_grid.GetData(indices[row_ptr[ip]]);
+                for (std::size_t k = row_ptr[ip] + 1; k < row_ptr[ip + 1]; ++k)
+                    dv += f_derivatives[k*TDim + dim] * r_control_grid.GetData(indices[k]);
+            }
+        }
+    }
+
     /// Compute a prediction for LocalCoordinates algorithm. Because LocalCoordinates uses Newton-Raphson algorithm to compute
     /// the inversion, it requires a good initial starting point
     template<typename TCoordinatesType>
@@ -11,6 +11,7 @@
 
 // System includes
 #include <vector>
+#include <set>
 
 // External includes
 #include <boost/array.hpp>
@@ -64,7 +65,7 @@ public:
     typedef typename BaseType::function_map_t function_map_t;
 
     /// Default constructor
-    HBSplinesFESpace() : BaseType(), mLastLevel(1), mMaxLevel(10)
+    HBSplinesFESpace() : BaseType(), mLastLevel(1), mMaxLevel(10), mAllCellsDirty(true)
     {}
 
     /// Destructor
@@ -90,6 +91,13 @@ public:
             if((*it)->Contain(rpKnots))
                 return *it;
 
+        return this->CreateNewBf(Id, Level, rpKnots);
+    }
+
+    /// Create new bf and add to the list, without searching for the bf with the same local knot vectors.
+    /// This is used when the caller keeps its own look-up of the basis functions, e.g. in the batch refinement.
+    bf_t CreateNewBf(const std::size_t& Id, const std::size_t& Level, const std::vector<std::vector<knot_t> >& rpKnots)
+    {
         // create the new bf and add the knot
         bf_t p_bf = bf_t(new BasisFunctionType(Id, Level));
         for (int dim = 0; dim < TDim; ++dim)
@@ -97,30 +105,78 @@ public:
             p_bf->SetLocalKnotVectors(dim, rpKnots[dim]);
             p_bf->SetInfo(dim, this->Order(dim));
         }
-        BaseType::mpBasisFuncs.insert(p_bf);
-        BaseType::m_function_map_is_created = false;
+        BaseType::AddBf(p_bf);
 
         return p_bf;
     }
 
-    /// EtaMaxdate the basis functions for all cells. This function must be called before any operation on cell is required.
+    /// Update the basis functions for all cells. This function must be called before any operation on cell is required.
+    /// Only the cells marked as dirty since the last update, e.g. the cells touched by the last refinement, have their
+    /// extraction operators recomputed. The anchors of the other cells are refreshed with the current equation ids and
+    /// weights of their basis functions, since those may change by the enumeration or by the refinement.
     virtual void UpdateCells()
     {
-        this->ResetCells();
+        BaseType::m_span_index_is_created = false;
 
-        // for each cell compute the extraction operator and add to the anchor
-        Vector Crow;
-        for(typename cell_container_t::iterator it_cell = BaseType::mpCellManager->begin(); it_cell != BaseType::mpCellManager->end(); ++it_cell)
+        // collect the cells to recompute, and refresh the anchors of the others
+        std::vector<cell_t> cells;
+        if (mAllCellsDirty)
         {
-            for(typename CellType::bf_iterator it_bf = (*it_cell)->bf_begin(); it_bf != (*it_cell)->bf_end(); ++it_bf)
+            cells.assign(BaseType::mpCellManager->begin(), BaseType::mpCellManager->end());
+        }
+        else
+        {
+            for(typename cell_container_t::iterator it_cell = BaseType::mpCellManager->begin(); it_cell != BaseType::mpCellManager->end(); ++it_cell)
             {
-                BasisFunctionType& bf = *(it_bf->lock());
-                bf.ComputeExtractionOperator(Crow, *it_cell);
-                (*it_cell)->AddAnchor(bf.EquationId(), bf.GetValue(CONTROL_POINT).W(), Crow);
+                if ((mDirtyCells.find(*it_cell) != mDirtyCells.end()) || ((*it_cell)->NumberOfAnchors() != (*it_cell)->size()))
+                {
+                    cells.push_back(*it_cell);
+                    continue;
+                }
+
+                std::size_t i = 0;
+                for(typename CellType::bf_iterator it_bf = (*it_cell)->bf_begin(); it_bf != (*it_cell)->bf_end(); ++it_bf)
+                {
+                    BasisFunctionType& bf = *(it_bf->lock());
+                    (*it_cell)->UpdateAnchor(i++, bf.EquationId(), bf.GetValue(CONTROL_POINT).W());
+                }
             }
         }
+
+        // collect the basis functions and the weights of the cells in a cheap serial pass, so that the parallel extraction
+        // works on plain arrays; it only reads the local knots of the bfs, which are not modified during the update
+        std::vector<std::vector<bf_t> > cell_bfs(cells.size());
+        std::vector<std::vector<double> > cell_weights(cells.size());
+        for (std::size_t i = 0; i < cells.size(); ++i)
+        {
+            for(typename CellType::bf_iterator it_bf = cells[i]->bf_begin(); it_bf != cells[i]->bf_end(); ++it_bf)
+            {
+                bf_t p_bf = it_bf->lock();
+                cell_bfs[i].push_back(p_bf);
+                cell_weights[i].push_back(p_bf->GetValue(CONTROL_POINT).W());
+            }
+        }
+
+        // for each cell compute the extraction operator and add to the anchor
+        for (std::size_t i = 0; i < cells.size(); ++i)
+            cells[i]->Reset();
+        BaseType::ComputeExtractionOperators(cells, cell_bfs, cell_weights);
+
+        mDirtyCells.clear();
+        mAllCellsDirty = false;
     }
 
+    /// Mark the cell to be recomputed at the next call of UpdateCells. This shall be called when the basis functions
+    /// supported on the cell are changed.
+    void MarkDirtyCell(cell_t p_cell) {mDirtyCells.insert(p_cell);}
+
+    /// Unmark the cell, e.g. when it is removed from the cell manager
+    void UnmarkDirtyCell(cell_t p_cell) {mDirtyCells.erase(p_cell);}
+
+    /// Mark all the cells to be recomputed at the next call of UpdateCells. This shall be called when the cells are
+    /// modified directly through the cell manager.
+    void MarkAllCellsDirty() {mAllCellsDirty = true; mDirtyCells.clear();}
+
     /// Get the knot vector in i-direction, i=0..Dim
     /// User must be careful to use this function because it can modify the internal knot vectors
     knot_container_t& KnotVector(const std::size_t& i) {return mKnotVectors[i];}
@@ -437,6 +493,9 @@ private:
     std::size_t mLastLevel;
     std::size_t mMaxLevel;
 
+    bool mAllCellsDirty; // true if all the cells must be recomputed at the next UpdateCells
+    std::set<cell_t> mDirtyCells; // the cells to be recomputed at the next UpdateCells
+
     boost::array<knot_container_t, TDim> mKnotVectors;
 
     domain_container_t mSupportDomains; // this domain manager manages the support of all bfs in each level
@@ -96,8 +96,9 @@ public:
             if (pFESpace == NULL)
                 KRATOS_THROW_ERROR(std::runtime_error, "The cast to HBSplinesFESpace is failed.", "")
 
-            if (pFESpace->HasBfByEquationId(EquationId))
-                return pFESpace->pGetBfByEquationId(EquationId);
+            bf_t p_bf = pFESpace->FindBfByEquationId(EquationId);
+            if (p_bf != NULL)
+                return p_bf;
         }
 
         std::stringstream ss;
@@ -255,7 +256,7 @@ Patch<2>::Pointer HBSplinesPatchUtility_Helper<2>::CreatePatchFromBSplines(typen
 
             const std::size_t& func_id = func_indices[i_func];
             typename HBSplinesBasisFunction<2>::Pointer p_bf = pNewFESpace->CreateBf(++id, level, pLocalKnots);
-            p_bf->SetEquationId(func_id);
+            pNewFESpace->SetBfEquationId(p_bf, func_id);
 
             // set the boundary information
             if (i == 0) p_bf->AddBoundary(BOUNDARY_FLAG(_BLEFT_));
@@ -409,7 +410,7 @@ Patch<3>::Pointer HBSplinesPatchUtility_Helper<3>::CreatePatchFromBSplines(typen
 
                 const std::size_t& func_id = func_indices[i_func];
                 typename HBSplinesBasisFunction<3>::Pointer p_bf = pNewFESpace->CreateBf(++id, level, pLocalKnots);
-                p_bf->SetEquationId(func_id);
+                pNewFESpace->SetBfEquationId(p_bf, func_id);
 
                 // set the boundary information
                 if (i == 0) p_bf->AddBoundary(BOUNDARY_FLAG(_BLEFT_));
@@ -11,6 +11,10 @@
 
 // System includes
 #include <vector>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <cmath>
 #include <iomanip>
 
 // External includes
@@ -33,6 +37,158 @@
 namespace Kratos
 {
 
+/**
+ * Auxiliary look-up data shared by the refinement of a batch of basis functions. It keeps, for each patch, the basis
+ * functions indexed by their local knots, so that the children are found without scanning the whole basis function
+ * container. It also keeps the knot insertion coefficients of each distinct local knot configuration, and the patches
+ * to be finalized after the batch.
+ */
+template<int TDim>
+struct HBSplinesRefinementCache
+{
+    typedef typename HBSplinesFESpace<TDim>::knot_t knot_t;
+    typedef typename HBSplinesFESpace<TDim>::bf_t bf_t;
+    typedef typename HBSplinesFESpace<TDim>::bf_container_t bf_container_t;
+    typedef std::vector<const void*> knots_key_t;
+
+    HBSplinesRefinementCache() : mLastEquationIdIsInitialized(false)
+    {}
+
+    /// Build the look-up of the basis functions of the patch, if it is not yet built
+    void Initialize(const std::size_t& patch_id, typename HBSplinesFESpace<TDim>::Pointer pFESpace)
+    {
+        if (mBfsByKnots.find(patch_id) != mBfsByKnots.end())
+            return;
+
+        std::map<knots_key_t, bf_t>& rBfsByKnots = mBfsByKnots[patch_id];
+        for(typename bf_container_t::iterator it = pFESpace->bf_begin(); it != pFESpace->bf_end(); ++it)
+            rBfsByKnots[KnotsKey(*it)] = *it;
+    }
+
+    /// Return the bf with the same local knots if it exists; otherwise create the new bf. It has the same behaviour
+    /// as HBSplinesFESpace::CreateBf.
+    bf_t CreateBf(const std::size_t& patch_id, typename HBSplinesFESpace<TDim>::Pointer pFESpace,
+        const std::size_t& Id, const std::size_t& Level, const std::vector<std::vector<knot_t> >& rpKnots)
+    {
+        knots_key_t key;
+        for (int dim = 0; dim < TDim; ++dim)
+            for (std::size_t i = 0; i < rpKnots[dim].size(); ++i)
+                key.push_back(rpKnots[dim][i].get());
+
+        typename std::map<knots_key_t, bf_t>::iterator it = mBfsByKnots[patch_id].find(key);
+        if (it != mBfsByKnots[patch_id].end())
+            return it->second;
+
+        bf_t p_bf = pFESpace->CreateNewBf(Id, Level, rpKnots);
+        mBfsByKnots[patch_id][key] = p_bf;
+        return p_bf;
+    }
+
+    /// Remove the bf from the FESpace and from the look-up
+    void RemoveBf(const std::size_t& patch_id, typename HBSplinesFESpace<TDim>::Pointer pFESpace, bf_t p_bf)
+    {
+        mBfsByKnots[patch_id].erase(KnotsKey(p_bf));
+        mRemovedBfs.insert(p_bf);
+        pFESpace->RemoveBf(p_bf);
+    }
+
+    /// Check if the bf was removed during the batch
+    bool IsRemoved(bf_t p_bf) const
+    {
+        return mRemovedBfs.find(p_bf) != mRemovedBfs.end();
+    }
+
+    /// Compute the knot insertion coefficients of the bf with the local knots and the inserted knots. The
+    /// coefficients are invariant to an affine transformation of the knots, hence they are computed once for
+    /// each distinct configuration of the normalized local knots.
+    void ComputeRefinedCoefficients(Vector& RefinedCoeffs, const std::vector<std::size_t>& orders,
+        const std::vector<std::vector<double> >& local_knots, const std::vector<std::vector<double> >& ins_knots)
+    {
+        std::vector<long long> key;
+        for(std::size_t dim = 0; dim < TDim; ++dim)
+        {
+            const double xmin = local_knots[dim].front();
+            const double length = local_knots[dim].back() - xmin;
+            key.push_back(static_cast<long long>(orders[dim]));
+            key.push_back(static_cast<long long>(local_knots[dim].size()));
+            key.push_back(static_cast<long long>(ins_knots[dim].size()));
+            for (std::size_t i = 0; i < local_knots[dim].size(); ++i)
+                key.push_back(llround((local_knots[dim][i] - xmin) / length * 1.0e10));
+            for (std::size_t i = 0; i < ins_knots[dim].size(); ++i)
+                key.push_back(llround((ins_knots[dim][i] - xmin) / length * 1.0e10));
+        }
+
+        typename std::map<std::vector<long long>, Vector>::iterator it = mRefinedCoefficients.find(key);
+        if (it != mRefinedCoefficients.end())
+        {
+            RefinedCoeffs = it->second;
+            return;
+        }
+
+        std::vector<std::vector<double> > new_knots(TDim);
+        if (TDim == 2)
+        {
+            BSplineUtils::ComputeBsplinesKnotInsertionCoefficients2DLocal(RefinedCoeffs,
+                new_knots[0], new_knots[1],
+                orders[0], orders[1],
+                local_knots[0], local_knots[1],
+                ins_knots[0], ins_knots[1]);
+        }
+        else if (TDim == 3)
+        {
+            BSplineUtils::ComputeBsplinesKnotInsertionCoefficients3DLocal(RefinedCoeffs,
+                new_knots[0], new_knots[1], new_knots[2],
+                orders[0], orders[1], orders[2],
+                local_knots[0], local_knots[1], local_knots[2],
+                ins_knots[0], ins_knots[1], ins_knots[2]);
+        }
+
+        mRefinedCoefficients[key] = RefinedCoeffs;
+    }
+
+    /// Get the last equation id of the multipatch. It is computed once and then tracked during the batch.
+    std::size_t& LastEquationId(typename Patch<TDim>::Pointer pPatch)
+    {
+        if (!mLastEquationIdIsInitialized)
+        {
+            if (pPatch->pParentMultiPatch() != NULL)
+                mLastEquationId = pPatch->pParentMultiPatch()->GetLastEquationId();
+            else
+                mLastEquationId = pPatch->pFESpace()->GetLastEquationId();
+            mLastEquationIdIsInitialized = true;
+        }
+
+        return mLastEquationId;
+    }
+
+    /// Reset the last equation id, which is computed again at the next call of LastEquationId. This shall be called
+    /// after the multipatch is re-enumerated.
+    void ResetLastEquationId()
+    {
+        mLastEquationIdIsInitialized = false;
+    }
+
+    /// The patches modified in the batch, which must be finalized
+    std::map<std::size_t, typename Patch<TDim>::Pointer> mModifiedPatches;
+
+private:
+
+    static knots_key_t KnotsKey(bf_t p_bf)
+    {
+        knots_key_t key;
+        for (int dim = 0; dim < TDim; ++dim)
+            for (std::size_t i = 0; i < p_bf->LocalKnots(dim).size(); ++i)
+                key.push_back(p_bf->LocalKnots(dim)[i].get());
+        return key;
+    }
+
+    std::map<std::size_t, std::map<knots_key_t, bf_t> > mBfsByKnots;
+    std::map<std::vector<long long>, Vector> mRefinedCoefficients;
+    std::set<bf_t> mRemovedBfs; // the removed bfs are kept alive until the end of the batch
+    std::size_t mLastEquationId;
+    bool mLastEquationIdIsInitialized;
+};
+
 
 template<int TDim>
 struct HBSplinesRefinementUtility_Helper
@@ -49,6 +205,25 @@ struct HBSplinesRefinementUtility_Helper
     static std::pair<std::vector<std::size_t>, std::vector<bf_t> > Refine(typename Patch<TDim>::Pointer pPatch,
             typename HBSplinesFESpace<TDim>::bf_t p_bf, std::set<std::size_t>& refined_patches, const int& echo_level);
 
+    static std::pair<std::vector<std::size_t>, std::vector<bf_t> > Refine(typename Patch<TDim>::Pointer pPatch,
+            typename HBSplinesFESpace<TDim>::bf_t p_bf, std::set<std::size_t>& refined_patches,
+            HBSplinesRefinementCache<TDim>& rCache, const int& echo_level);
+
+    static void RefineBfs(typename Patch<TDim>::Pointer pPatch, const std::vector<std::size_t>& bf_ids, const int& echo_level);
+
+    static void RefineCells(typename Patch<TDim>::Pointer pPatch, const std::vector<std::size_t>& cell_ids, const int& echo_level);
+
+    static void Finalize(HBSplinesRefinementCache<TDim>& rCache);
+
+    static bool LevelCompare(const bf_t& p_bf1, const bf_t& p_bf2)
+    {
+        if(p_bf1->Level() != p_bf2->Level())
+            return p_bf1->Level() < p_bf2->Level();
+        return p_bf1->Id() < p_bf2->Id();
+    }
+
+    static void UpdateWeights(typename Patch<TDim>::Pointer pPatch);
+
     static void RefineWindow(typename Patch<TDim>::Pointer pPatch, const std::vector<std::vector<double> >& window, const int& echo_level);
 
     static void LinearDependencyRefine(typename Patch<TDim>::Pointer pPatch, const std::size_t& refine_cycle, const int& echo_level);
@@ -84,6 +259,20 @@ public:
         HBSplinesRefinementUtility_Helper<TDim>::Refine(pPatch, p_bf, echo_level);
     }
 
+    /// Refine a set of basis functions, e.g. marked by an error estimator, in one pass
+    template<int TDim>
+    static void RefineBfs(typename Patch<TDim>::Pointer pPatch, const std::vector<std::size_t>& bf_ids, const int& echo_level)
+    {
+        HBSplinesRefinementUtility_Helper<TDim>::RefineBfs(pPatch, bf_ids, echo_level);
+    }
+
+    /// Refine all basis functions supported on a set of cells in one pass
+    template<int TDim>
+    static void RefineCells(typename Patch<TDim>::Pointer pPatch, const std::vector<std::size_t>& cell_ids, const int& echo_level)
+    {
+        HBSplinesRefinementUtility_Helper<TDim>::RefineCells(pPatch, cell_ids, echo_level);
+    }
+
     /// Refine all basis functions in a region
     template<int TDim>
     static void RefineWindow(typename Patch<TDim>::Pointer pPatch, const std::vector<std::vector<double> >& window, const int& echo_level)
@@ -162,22 +351,12 @@ inline void HBSplinesRefinementUtility_Helper<TDim>::Refine(typename Patch<TDim>
         KRATOS_THROW_ERROR(std::runtime_error, "The cast to HBSplinesFESpace is failed.", "")
 
     // get the correct basis function
-    bf_t p_bf;
-    bool found = false;
-    for(typename bf_container_t::iterator it = pFESpace->bf_begin(); it != pFESpace->bf_end(); ++it)
-    {
-        if((*it)->Id() == Id)
-        {
-            p_bf = *it;
-            found = true;
-        }
-    }
-
-    if(!found)
+    if(!pFESpace->HasBfById(Id))
     {
         std::cout << "Basis function " << Id << " is not found, skipped." << std::endl;
         return;
     }
+    bf_t p_bf = (*pFESpace)(Id);
 
     // does not refine if maximum level is reached
     if(p_bf->Level() >= pFESpace->MaxLevel())
@@ -195,6 +374,17 @@ template<int TDim>
 std::pair<std::vector<std::size_t>, std::vector<typename HBSplinesFESpace<TDim>::bf_t> > HBSplinesRefinementUtility_Helper<TDim>::Refine(
         typename Patch<TDim>::Pointer pPatch, typename HBSplinesFESpace<TDim>::bf_t p_bf,
         std::set<std::size_t>& refined_patches, const int& echo_level)
+{
+    HBSplinesRefinementCache<TDim> Cache;
+    std::pair<std::vector<std::size_t>, std::vector<bf_t> > results = Refine(pPatch, p_bf, refined_patches, Cache, echo_level);
+    Finalize(Cache);
+    return results;
+}
+
+template<int TDim>
+std::pair<std::vector<std::size_t>, std::vector<typename HBSplinesFESpace<TDim>::bf_t> > HBSplinesRefinementUtility_Helper<TDim>::Refine(
+        typename Patch<TDim>::Pointer pPatch, typename HBSplinesFESpace<TDim>::bf_t p_bf,
+        std::set<std::size_t>& refined_patches, HBSplinesRefinementCache<TDim>& rCache, const int& echo_level)
 {
     // Type definitions
     typedef typename HBSplinesFESpace<TDim>::bf_t bf_t;
@@ -235,6 +425,9 @@ std::pair<std::vector<std::size_t>, std::vector<typename HBSplinesFESpace<TDim>:
     if (pFESpace == NULL)
         KRATOS_THROW_ERROR(std::runtime_error, "The cast to HBSplinesFESpace is failed.", "")
 
+    rCache.Initialize(pPatch->Id(), pFESpace);
+    rCache.mModifiedPatches[pPatch->Id()] = pPatch;
+
     // get the list of variables in the patch
     std::vector<Variable<double>*> double_variables = pPatch->template ExtractVariables<Variable<double> >();
     std::vector<Variable<array_1d<double, 3> >*> array_1d_variables = pPatch->template ExtractVariables<Variable<array_1d<double, 3> > >();
@@ -276,23 +469,11 @@ std::pair<std::vector<std::size_t>, std::vector<typename HBSplinesFESpace<TDim>:
     for(std::size_t dim = 0; dim < TDim; ++dim)
         p_bf->LocalKnots(dim, local_knots[dim]);
 
-    std::vector<std::vector<double> > new_knots(TDim);
-    if (TDim == 2)
-    {
-        BSplineUtils::ComputeBsplinesKnotInsertionCoefficients2DLocal(RefinedCoeffs,
-            new_knots[0], new_knots[1],
-            pFESpace->Order(0), pFESpace->Order(1),
-            local_knots[0], local_knots[1],
-            ins_knots[0], ins_knots[1]);
-    }
-    else if (TDim == 3)
-    {
-        BSplineUtils::ComputeBsplinesKnotInsertionCoefficients3DLocal(RefinedCoeffs,
-            new_knots[0], new_knots[1], new_knots[2],
-            pFESpace->Order(0), pFESpace->Order(1), pFESpace->Order(2),
-            local_knots[0], local_knots[1], local_knots[2],
-            ins_knots[0], ins_knots[1], ins_knots[2]);
-    }
+    std::vector<std::size_t> orders(TDim);
+    for(std::size_t dim = 0; dim < TDim; ++dim)
+        orders[dim] = pFESpace->Order(dim);
+
+    rCache.ComputeRefinedCoefficients(RefinedCoeffs, orders, local_knots, ins_knots);
 
     if (echo_refinement)
     {
@@ -316,15 +497,7 @@ std::pair<std::vector<std::size_t>, std::vector<typename HBSplinesFESpace<TDim>:
 
     // start to enumerate from the last equation id in the multipatch
     // we always assign an incremental equation_id for the new refined bfs, so that the bfs on the boundary will automatically match
-    std::size_t starting_id;
-    if (pPatch->pParentMultiPatch() != NULL)
-    {
-        starting_id = pPatch->pParentMultiPatch()->GetLastEquationId();
-    }
-    else
-    {
-        starting_id = pPatch->pFESpace()->GetLastEquationId();
-    }
+    std::size_t& starting_id = rCache.LastEquationId(pPatch);
 
     pnew_cells = typename cell_container_t::Pointer(new BCellManager<TDim, CellType>());
 
@@ -366,7 +539,7 @@ std::pair<std::vector<std::size_t>, std::vector<typename HBSplinesFESpace<TDim>:
 
                 // create the basis function object
                 std::vector<std::vector<knot_t> > pLocalKnots = {pLocalKnots1, pLocalKnots2};
-                bf_t pnew_bf = pFESpace->CreateBf(last_id+1, next_level, pLocalKnots);
+                bf_t pnew_bf = rCache.CreateBf(pPatch->Id(), pFESpace, last_id+1, next_level, pLocalKnots);
 
                 // and initialize its value
                 for (std::size_t i = 0; i < double_variables.size(); ++i)
@@ -405,7 +578,7 @@ std::pair<std::vector<std::size_t>, std::vector<typename HBSplinesFESpace<TDim>:
                 if (knot_container_t::IsOnRight(pLocalKnots2, pFESpace->Order(1))) pnew_bf->AddBoundary(BOUNDARY_FLAG(_BTOP_));
 
                 // assign new equation id
-                pnew_bf->SetEquationId(++starting_id);
+                pFESpace->SetBfEquationId(pnew_bf, ++starting_id);
                 if (echo_refinement)
                     std::cout << "new bf " << pnew_bf->Id() << " is assigned eq_id = " << pnew_bf->EquationId() << std::endl;
 
@@ -473,6 +646,7 @@ std::pair<std::vector<std::size_t>, std::vector<typename HBSplinesFESpace<TDim>:
                             pnew_bf->AddCell(pnew_cell);
                             pnew_cell->AddBf(pnew_bf);
                             pnew_cells->insert(pnew_cell);
+                            pFESpace->MarkDirtyCell(pnew_cell);
                         }
                     }
                 }
@@ -508,7 +682,7 @@ std::pair<std::vector<std::size_t>, std::vector<typename HBSplinesFESpace<TDim>:
 
                     // create the basis function object
                     std::vector<std::vector<knot_t> > pLocalKnots = {pLocalKnots1, pLocalKnots2, pLocalKnots3};
-                    bf_t pnew_bf = pFESpace->CreateBf(last_id+1, next_level, pLocalKnots);
+                    bf_t pnew_bf = rCache.CreateBf(pPatch->Id(), pFESpace, last_id+1, next_level, pLocalKnots);
 
                     // and initialize its value
                     for (std::size_t i = 0; i < double_variables.size(); ++i)
@@ -557,7 +731,7 @@ std::pair<std::vector<std::size_t>, std::vector<typename HBSplinesFESpace<TDim>:
                     if (knot_container_t::IsOnRight(pLocalKnots3, pFESpace->Order(2))) pnew_bf->AddBoundary(BOUNDARY_FLAG(_BTOP_));
 
                     // assign new equation id
-                    pnew_bf->SetEquationId(++starting_id);
+                    pFESpace->SetBfEquationId(pnew_bf, ++starting_id);
                     if (echo_refinement)
                         std::cout << "new bf " << pnew_bf->Id() << " is assigned eq_id = " << pnew_bf->EquationId() << std::endl;
 
@@ -619,6 +793,7 @@ std::pair<std::vector<std::size_t>, std::vector<typename HBSplinesFESpace<TDim>:
                                     pnew_bf->AddCell(pnew_cell);
                                     pnew_cell->AddBf(pnew_bf);
                                     pnew_cells->insert(pnew_cell);
+                                    pFESpace->MarkDirtyCell(pnew_cell);
                                 }
                             }
                         }
@@ -707,24 +882,30 @@ std::pair<std::vector<std::size_t>, std::vector<typename HBSplinesFESpace<TDim>:
                     p_cells[i]->AddBf(it_bf->lock());
                     it_bf->lock()->AddCell(p_cells[i]);
                 }
+                pFESpace->MarkDirtyCell(p_cells[i]);
             }
         }
     }
 
     /* remove the cells from the previous step */
+    // the cell and its bfs always refer to each other, hence only the bfs of the cell need to be visited
     for(typename cell_container_t::iterator it_cell = pcells_to_remove->begin(); it_cell != pcells_to_remove->end(); ++it_cell)
     {
         pFESpace->pCellManager()->erase(*it_cell);
-        for(typename bf_container_t::iterator it_bf = pFESpace->bf_begin(); it_bf != pFESpace->bf_end(); ++it_bf)
-            (*it_bf)->RemoveCell(*it_cell);
+        pFESpace->UnmarkDirtyCell(*it_cell);
+        for(typename CellType::bf_iterator it_bf = (*it_cell)->bf_begin(); it_bf != (*it_cell)->bf_end(); ++it_bf)
+            it_bf->lock()->RemoveCell(*it_cell);
     }
 
-    /* remove the basis function from all the cells */
-    for(typename cell_container_t::iterator it_cell = pFESpace->pCellManager()->begin(); it_cell != pFESpace->pCellManager()->end(); ++it_cell)
+    /* remove the basis function from all its cells */
+    for(typename HBSplinesFESpace<TDim>::BasisFunctionType::cell_iterator it_cell = p_bf->cell_begin(); it_cell != p_bf->cell_end(); ++it_cell)
+    {
         (*it_cell)->RemoveBf(p_bf);
+        pFESpace->MarkDirtyCell(*it_cell);
+    }
 
     /* remove the old basis function */
-    pFESpace->RemoveBf(p_bf);
+    rCache.RemoveBf(pPatch->Id(), pFESpace, p_bf);
 
     // TODO check if pFESpace->pCellManager()->CollapseCells() can help to further remove the overlapping cells
 
@@ -751,39 +932,7 @@ std::pair<std::vector<std::size_t>, std::vector<typename HBSplinesFESpace<TDim>:
     }
     */
 
-    // update the weight information for all the grid functions (except the control point grid function)
-    std::vector<double> Weights = pFESpace->GetWeights();
-    std::cout << "weights size at refinement: " << Weights.size() << std::endl;
-
-    typename Patch<TDim>::DoubleGridFunctionContainerType DoubleGridFunctions_ = pPatch->DoubleGridFunctions();
-    for (typename Patch<TDim>::DoubleGridFunctionContainerType::iterator it = DoubleGridFunctions_.begin();
-            it != DoubleGridFunctions_.end(); ++it)
-    {
-        typename WeightedFESpace<TDim>::Pointer pThisFESpace = boost::dynamic_pointer_cast<WeightedFESpace<TDim> >((*it)->pFESpace());
-        if (pThisFESpace == NULL)
-            KRATOS_THROW_ERROR(std::runtime_error, "The cast to WeightedFESpace is failed.", "")
-        pThisFESpace->SetWeights(Weights);
-    }
-
-    typename Patch<TDim>::Array1DGridFunctionContainerType Array1DGridFunctions_ = pPatch->Array1DGridFunctions();
-    for (typename Patch<TDim>::Array1DGridFunctionContainerType::iterator it = Array1DGridFunctions_.begin();
-            it != Array1DGridFunctions_.end(); ++it)
-    {
-        typename WeightedFESpace<TDim>::Pointer pThisFESpace = boost::dynamic_pointer_cast<WeightedFESpace<TDim> >((*it)->pFESpace());
-        if (pThisFESpace == NULL)
-            KRATOS_THROW_ERROR(std::runtime_error, "The cast to WeightedFESpace is failed.", "")
-        pThisFESpace->SetWeights(Weights);
-    }
-
-    typename Patch<TDim>::VectorGridFunctionContainerType VectorGridFunctions_ = pPatch->VectorGridFunctions();
-    for (typename Patch<TDim>::VectorGridFunctionContainerType::iterator it = VectorGridFunctions_.begin();
-            it != VectorGridFunctions_.end(); ++it)
-    {
-        typename WeightedFESpace<TDim>::Pointer pThisFESpace = boost::dynamic_pointer_cast<WeightedFESpace<TDim> >((*it)->pFESpace());
-        if (pThisFESpace == NULL)
-            KRATOS_THROW_ERROR(std::runtime_error, "The cast to WeightedFESpace is failed.", "")
-        pThisFESpace->SetWeights(Weights);
-    }
+    // the weight information of the grid functions is updated when the refinement is finalized
 
     // record the refinement history
     pFESpace->RecordRefinementHistory(p_bf->Id());
@@ -813,18 +962,9 @@ std::pair<std::vector<std::size_t>, std::vector<typename HBSplinesFESpace<TDim>:
             KRATOS_THROW_ERROR(std::runtime_error, "The cast to HBSplinesFESpace is failed.", "")
 
         // get the correct basis function
-        bf_t p_neighbor_bf;
-        bool found = false;
-        for(typename bf_container_t::iterator it = pNeighborFESpace->bf_begin(); it != pNeighborFESpace->bf_end(); ++it)
-        {
-            if ((*it)->EquationId() == equation_id)
-            {
-                p_neighbor_bf = *it;
-                found = true;
-            }
-        }
+        bf_t p_neighbor_bf = pNeighborFESpace->FindBfByEquationId(equation_id);
 
-        if (found)
+        if (p_neighbor_bf != NULL)
         {
             if(echo_refinement)
             {
@@ -832,7 +972,7 @@ std::pair<std::vector<std::size_t>, std::vector<typename HBSplinesFESpace<TDim>:
                 std::cout << "Neighbor patch " << pNeighborPatch->Id() << " of patch " << pPatch->Id() << " will be refined" << std::endl;
             }
 
-            Refine(pNeighborPatch, p_neighbor_bf, refined_patches, echo_level);
+            Refine(pNeighborPatch, p_neighbor_bf, refined_patches, rCache, echo_level);
 
             if(echo_refinement)
             {
@@ -845,6 +985,154 @@ std::pair<std::vector<std::size_t>, std::vector<typename HBSplinesFESpace<TDim>:
     return std::make_pair(numbers, pnew_bfs);
 }
 
+template<int TDim>
+inline void HBSplinesRefinementUtility_Helper<TDim>::RefineBfs(typename Patch<TDim>::Pointer pPatch,
+        const std::vector<std::size_t>& bf_ids, const int& echo_level)
+{
+    typedef typename HBSplinesFESpace<TDim>::bf_t bf_t;
+    typedef typename HBSplinesFESpace<TDim>::bf_container_t bf_container_t;
+
+    if (pPatch->pFESpace()->Type() != HBSplinesFESpace<TDim>::StaticType())
+        KRATOS_THROW_ERROR(std::logic_error, __FUNCTION__, "only support the hierarchical B-Splines patch")
+
+    // extract the hierarchical B-Splines space
+    typename HBSplinesFESpace<TDim>::Pointer pFESpace = boost::dynamic_pointer_cast<HBSplinesFESpace<TDim> >(pPatch->pFESpace());
+    if (pFESpace == NULL)
+        KRATOS_THROW_ERROR(std::runtime_error, "The cast to HBSplinesFESpace is failed.", "")
+
+    // get the basis functions, the repeated ids are removed
+    std::set<std::size_t> marked_ids(bf_ids.begin(), bf_ids.end());
+    std::vector<bf_t> marked_bfs;
+    marked_bfs.reserve(marked_ids.size());
+    for(std::set<std::size_t>::iterator it = marked_ids.begin(); it != marked_ids.end(); ++it)
+    {
+        if(pFESpace->HasBfById(*it))
+            marked_bfs.push_back((*pFESpace)(*it));
+        else
+            std::cout << "Basis function " << *it << " is not found, skipped." << std::endl;
+    }
+
+    // refine level by level, starting from the coarsest level
+    std::sort(marked_bfs.begin(), marked_bfs.end(), HBSplinesRefinementUtility_Helper<TDim>::LevelCompare);
+
+    HBSplinesRefinementCache<TDim> Cache;
+    for(std::size_t i = 0; i < marked_bfs.size(); ++i)
+    {
+        const bf_t& p_bf = marked_bfs[i];
+
+        // the bfs created or reused by the refinement of the previous level receive new equation ids, which differ on
+        // the two sides of an interface. The multipatch is enumerated again before refining the next level, so that the
+        // neighbour bfs are found by their equation ids, the same as refining the bfs one by one.
+        if((i > 0) && (p_bf->Level() != marked_bfs[i-1]->Level()) && (pPatch->pParentMultiPatch() != NULL))
+        {
+            pPatch->pParentMultiPatch()->Enumerate();
+            Cache.ResetLastEquationId();
+        }
+
+        // the basis function may have been refined already via the refinement of the neighbour patch
+        if(Cache.IsRemoved(p_bf))
+            continue;
+
+        // does not refine if maximum level is reached
+        if(p_bf->Level() >= pFESpace->MaxLevel())
+        {
+            std::cout << "Maximum level is reached, basis function " << p_bf->Id() << " of patch " << pPatch->Id() << " is skipped." << std::endl;
+            continue;
+        }
+
+        std::set<std::size_t> refined_patches;
+        Refine(pPatch, p_bf, refined_patches, Cache, echo_level);
+    }
+
+    Finalize(Cache);
+
+    if(pPatch->pParentMultiPatch() != NULL)
+        pPatch->pParentMultiPatch()->Enumerate();
+}
+
+template<int TDim>
+inline void HBSplinesRefinementUtility_Helper<TDim>::RefineCells(typename Patch<TDim>::Pointer pPatch,
+        const std::vector<std::size_t>& cell_ids, const int& echo_level)
+{
+    typedef typename HBSplinesFESpace<TDim>::cell_container_t cell_container_t;
+    typedef typename HBSplinesFESpace<TDim>::CellType CellType;
+
+    if (pPatch->pFESpace()->Type() != HBSplinesFESpace<TDim>::StaticType())
+        KRATOS_THROW_ERROR(std::logic_error, __FUNCTION__, "only support the hierarchical B-Splines patch")
+
+    // extract the hierarchical B-Splines space
+    typename HBSplinesFESpace<TDim>::Pointer pFESpace = boost::dynamic_pointer_cast<HBSplinesFESpace<TDim> >(pPatch->pFESpace());
+    if (pFESpace == NULL)
+        KRATOS_THROW_ERROR(std::runtime_error, "The cast to HBSplinesFESpace is failed.", "")
+
+    // collect the basis functions supported on the marked cells
+    std::set<std::size_t> marked_cells(cell_ids.begin(), cell_ids.end());
+    std::vector<std::size_t> bf_ids;
+    for(typename cell_container_t::iterator it_cell = pFESpace->pCellManager()->begin(); it_cell != pFESpace->pCellManager()->end(); ++it_cell)
+    {
+        if(marked_cells.find((*it_cell)->Id()) == marked_cells.end())
+            continue;
+
+        for(typename CellType::bf_iterator it_bf = (*it_cell)->bf_begin(); it_bf != (*it_cell)->bf_end(); ++it_bf)
+            bf_ids.push_back(it_bf->lock()->Id());
+    }
+
+    RefineBfs(pPatch, bf_ids, echo_level);
+}
+
+template<int TDim>
+inline void HBSplinesRefinementUtility_Helper<TDim>::Finalize(HBSplinesRefinementCache<TDim>& rCache)
+{
+    for(typename std::map<std::size_t, typename Patch<TDim>::Pointer>::iterator it = rCache.mModifiedPatches.begin();
+            it != rCache.mModifiedPatches.end(); ++it)
+    {
+        UpdateWeights(it->second);
+    }
+    rCache.mModifiedPatches.clear();
+}
+
+template<int TDim>
+inline void HBSplinesRefinementUtility_Helper<TDim>::UpdateWeights(typename Patch<TDim>::Pointer pPatch)
+{
+    // extract the hierarchical B-Splines space
+    typename HBSplinesFESpace<TDim>::Pointer pFESpace = boost::dynamic_pointer_cast<HBSplinesFESpace<TDim> >(pPatch->pFESpace());
+    if (pFESpace == NULL)
+        KRATOS_THROW_ERROR(std::runtime_error, "The cast to HBSplinesFESpace is failed.", "")
+
+    // update the weight information for all the grid functions (except the control point grid function)
+    std::vector<double> Weights = pFESpace->GetWeights();
+
+    typename Patch<TDim>::DoubleGridFunctionContainerType DoubleGridFunctions_ = pPatch->DoubleGridFunctions();
+    for (typename Patch<TDim>::DoubleGridFunctionContainerType::iterator it = DoubleGridFunctions_.begin();
+            it != DoubleGridFunctions_.end(); ++it)
+    {
+        typename WeightedFESpace<TDim>::Pointer pThisFESpace = boost::dynamic_pointer_cast<WeightedFESpace<TDim> >((*it)->pFESpace());
+        if (pThisFESpace == NULL)
+            KRATOS_THROW_ERROR(std::runtime_error, "The cast to WeightedFESpace is failed.", "")
+        pThisFESpace->SetWeights(Weights);
+    }
+
+    typename Patch<TDim>::Array1DGridFunctionContainerType Array1DGridFunctions_ = pPatch->Array1DGridFunctions();
+    for (typename Patch<TDim>::Array1DGridFunctionContainerType::iterator it = Array1DGridFunctions_.begin();
+            it != Array1DGridFunctions_.end(); ++it)
+    {
+        typename WeightedFESpace<TDim>::Pointer pThisFESpace = boost::dynamic_pointer_cast<WeightedFESpace<TDim> >((*it)->pFESpace());
+        if (pThisFESpace == NULL)
+            KRATOS_THROW_ERROR(std::runtime_error, "The cast to WeightedFESpace is failed.", "")
+        pThisFESpace->SetWeights(Weights);
+    }
+
+    typename Patch<TDim>::VectorGridFunctionContainerType VectorGridFunctions_ = pPatch->VectorGridFunctions();
+    for (typename Patch<TDim>::VectorGridFunctionContainerType::iterator it = VectorGridFunctions_.begin();
+            it != VectorGridFunctions_.end(); ++it)
+    {
+        typename WeightedFESpace<TDim>::Pointer pThisFESpace = boost::dynamic_pointer_cast<WeightedFESpace<TDim> >((*it)->pFESpace());
+        if (pThisFESpace == NULL)
+            KRATOS_THROW_ERROR(std::runtime_error, "The cast to WeightedFESpace is failed.", "")
+        pThisFESpace->SetWeights(Weights);
+    }
+}
+
 template<int TDim>
 inline void HBSplinesRefinementUtility_Helper<TDim>::RefineWindow(typename Patch<TDim>::Pointer pPatch,
         const std::vector<std::vector<double> >& window, const int& echo_level)
@@ -891,12 +1179,7 @@ inline void HBSplinesRefinementUtility_Helper<TDim>::RefineWindow(typename Patch
     }
 
     // refine
-    for(std::size_t i = 0; i < bf_list.size(); ++i)
-    {
-        Refine(pPatch, bf_list[i], echo_level);
-    }
-
-    pPatch->pParentMultiPatch()->Enumerate();
+    RefineBfs(pPatch, bf_list, echo_level);
 }
 
 template<int TDim>
@@ -1030,11 +1313,7 @@ inline void HBSplinesRefinementUtility_Helper<TDim>::LinearDependencyRefine(type
                 std::cout << " of level " << level << " will be refined to maintain the linear independence ..." << std::endl;
             }
 
-            for(std::size_t i = 0; i < refined_bfs.size(); ++i)
-            {
-                Refine(pPatch, refined_bfs[i], echo_level);
-                pPatch->pParentMultiPatch()->Enumerate();
-            }
+            RefineBfs(pPatch, refined_bfs, echo_level);
 
             // perform another round to make sure all bfs has support domain in the domain manager of each level
             LinearDependencyRefine(pPatch, refine_cycle + 1, echo_level);
@@ -12,12 +12,19 @@
 // System includes
 #include <string>
 #include <vector>
+#include <map>
+#include <typeinfo>
 #include <iostream>
+#include <algorithm>
 
 // External includes 
 #include <omp.h>
 #include "boost/progress.hpp"
 #include "H5Cpp.h"
+#if defined(ISOGEOMETRIC_USE_MPI) && defined(H5_HAVE_PARALLEL)
+#define ISOGEOMETRIC_USE_PARALLEL_HDF5
+#include "mpi.h"
+#endif
 
 // Project includes
 #include "includes/define.h"
@@ -29,6 +36,12 @@
 #include "spaces/ublas_space.h"
 #include "linear_solvers/linear_solver.h"
 #include "utilities/openmp_utils.h"
+#include "includes/kratos_components.h"
+#include "custom_utilities/multipatch.h"
+#include "custom_utilities/patch_interface.h"
+#include "custom_utilities/nurbs/bsplines_fespace.h"
+#include "custom_utilities/nurbs/bsplines_patch_interface.h"
+#include "custom_utilities/nurbs/structured_control_grid.h"
 
 
 //#define DEBUG_LEVEL1
@@ -61,6 +74,38 @@ namespace Kratos
 ///@name Kratos Classes
 ///@{
 
+/// Helper to create the B-Splines interface read from the file, since its constructor depends on the dimension
+template<int TDim>
+struct HDF5MultiPatchInterface_Helper
+{
+    static typename PatchInterface<TDim>::Pointer Create(typename Patch<TDim>::Pointer pPatch1, const BoundarySide& side1,
+        typename Patch<TDim>::Pointer pPatch2, const BoundarySide& side2, const int& local_parameter_map,
+        const int& dir1, const int& dir2);
+};
+
+template<>
+inline typename PatchInterface<1>::Pointer HDF5MultiPatchInterface_Helper<1>::Create(typename Patch<1>::Pointer pPatch1, const BoundarySide& side1,
+    typename Patch<1>::Pointer pPatch2, const BoundarySide& side2, const int& local_parameter_map, const int& dir1, const int& dir2)
+{
+    return typename PatchInterface<1>::Pointer(new BSplinesPatchInterface<1>(pPatch1, side1, pPatch2, side2));
+}
+
+template<>
+inline typename PatchInterface<2>::Pointer HDF5MultiPatchInterface_Helper<2>::Create(typename Patch<2>::Pointer pPatch1, const BoundarySide& side1,
+    typename Patch<2>::Pointer pPatch2, const BoundarySide& side2, const int& local_parameter_map, const int& dir1, const int& dir2)
+{
+    return typename PatchInterface<2>::Pointer(new BSplinesPatchInterface<2>(pPatch1, side1, pPatch2, side2,
+        static_cast<BoundaryDirection>(dir1)));
+}
+
+template<>
+inline typename PatchInterface<3>::Pointer HDF5MultiPatchInterface_Helper<3>::Create(typename Patch<3>::Pointer pPatch1, const BoundarySide& side1,
+    typename Patch<3>::Pointer pPatch2, const BoundarySide& side2, const int& local_parameter_map, const int& dir1, const int& dir2)
+{
+    return typename PatchInterface<3>::Pointer(new BSplinesPatchInterface<3>(pPatch1, side1, pPatch2, side2,
+        (local_parameter_map == 0), static_cast<BoundaryDirection>(dir1), static_cast<BoundaryDirection>(dir2)));
+}
+
 /// Short class definition.
 /*** Detail class definition.
  */
@@ -109,31 +154,60 @@ public:
 
     /// Default constructor.
     HDF5PostUtility(const std::string h5_filename)
+    : mChunkSize(65536), mCompression(NO_COMPRESSION), mCompressionLevel(0), mNumberOfSteps(0)
+    , mParallel(false), mRank(0), mSize(1)
     {
         mpFile = boost::shared_ptr<H5::H5File>(new H5::H5File(h5_filename, H5F_ACC_TRUNC));
     }
 
     /// Constructor with access mode
     HDF5PostUtility(const std::string h5_filename, const std::string AccessMode)
+    : mChunkSize(65536), mCompression(NO_COMPRESSION), mCompressionLevel(0), mNumberOfSteps(0)
+    , mParallel(false), mRank(0), mSize(1)
     {
         unsigned int mode = H5F_ACC_TRUNC;
-        
-        if(AccessMode == std::string("Truncation"))
+        std::string access_mode = AccessMode;
+
+        // the parallel modes open the same file on all processes with the MPI-IO driver
+        if(access_mode.compare(0, 9, "Parallel-") == 0)
+        {
+            mParallel = true;
+            access_mode = access_mode.substr(9);
+        }
+
+        if(access_mode == std::string("Truncation"))
         {
             mode = H5F_ACC_TRUNC;
         }
-        else if(AccessMode == std::string("Read-Only"))
+        else if(access_mode == std::string("Read-Only"))
         {
             mode = H5F_ACC_RDONLY;
         }
-        else if(AccessMode == std::string("Read-Write"))
+        else if(access_mode == std::string("Read-Write"))
         {
             mode = H5F_ACC_RDWR;
         }
         else
             KRATOS_THROW_ERROR(std::logic_error, "This access mode is not supported:", AccessMode)
 
-        mpFile = boost::shared_ptr<H5::H5File>(new H5::H5File(h5_filename, mode));
+        if(mParallel)
+        {
+            #ifdef ISOGEOMETRIC_USE_PARALLEL_HDF5
+            MPI_Comm_rank(MPI_COMM_WORLD, &mRank);
+            MPI_Comm_size(MPI_COMM_WORLD, &mSize);
+
+            H5::FileAccPropList access_plist;
+            H5Pset_fapl_mpio(access_plist.getId(), MPI_COMM_WORLD, MPI_INFO_NULL);
+            mpFile = boost::shared_ptr<H5::H5File>(new H5::H5File(h5_filename, mode, H5::FileCreatPropList::DEFAULT, access_plist));
+
+            // all processes take part in each write
+            H5Pset_dxpl_mpio(mTransferPropList.getId(), H5FD_MPIO_COLLECTIVE);
+            #else
+            KRATOS_THROW_ERROR(std::logic_error, "The parallel access mode requires MPI and a parallel HDF5 library:", AccessMode)
+            #endif
+        }
+        else
+            mpFile = boost::shared_ptr<H5::H5File>(new H5::H5File(h5_filename, mode));
     }
     
     /// Destructor.
@@ -234,7 +308,310 @@ public:
     {
         ReadElementalData_(rThisVariable, pModelPart, allow_unequal);
     }
-    
+
+    /*****************************************************
+       STREAMING OUTPUT IN COLUMNS AND TIME-STEP GROUPS
+    *****************************************************/
+
+    /**
+     * Set the number of nodes per chunk of the column datasets. The data is also gathered and written in pieces of
+     * this size, hence it bounds the memory used for the output.
+     */
+    void SetChunkSize(const std::size_t ChunkSize)
+    {
+        if(ChunkSize == 0)
+            KRATOS_THROW_ERROR(std::logic_error, "The chunk size must be positive", "")
+        mChunkSize = ChunkSize;
+    }
+
+    /**
+     * Set the compression filter of the column datasets:
+     *   + "None"
+     *   + "Deflate": Level is the gzip level in [0, 9]
+     *   + "SZip": Level is the number of pixels per block, even and not larger than 32
+     */
+    void SetCompression(const std::string Filter, const int Level)
+    {
+        if(Filter == std::string("None"))
+        {
+            mCompression = NO_COMPRESSION;
+        }
+        else if(Filter == std::string("Deflate"))
+        {
+            if(H5Zfilter_avail(H5Z_FILTER_DEFLATE) <= 0)
+                KRATOS_THROW_ERROR(std::runtime_error, "The deflate filter is not available in this HDF5 library", "")
+            if(Level < 0 || Level > 9)
+                KRATOS_THROW_ERROR(std::logic_error, "The deflate level must be in [0, 9], given", Level)
+            mCompression = DEFLATE_COMPRESSION;
+        }
+        else if(Filter == std::string("SZip"))
+        {
+            if(H5Zfilter_avail(H5Z_FILTER_SZIP) <= 0)
+                KRATOS_THROW_ERROR(std::runtime_error, "The szip filter is not available in this HDF5 library", "")
+            if(Level <= 0 || Level > 32 || Level % 2 != 0)
+                KRATOS_THROW_ERROR(std::logic_error, "The szip pixels per block must be even and not larger than 32, given", Level)
+            mCompression = SZIP_COMPRESSION;
+        }
+        else
+            KRATOS_THROW_ERROR(std::logic_error, "This compression filter is not supported:", Filter)
+        mCompressionLevel = Level;
+    }
+
+    /**
+     * Write the nodes in column layout, i.e. the datasets /Mesh/NodeId [1 x n] and /Mesh/Coordinates [3 x n].
+     * The nodal results written by WriteNodalColumns follow the same order of nodes. In parallel mode, each process
+     * writes its owned nodes (PARTITION_INDEX equal to the rank) to consecutive columns, ordered by rank.
+     */
+    void WriteNodeColumns(ModelPart::Pointer pModelPart)
+    {
+        std::vector<Node<3>::Pointer> pNodes;
+        GetOwnedNodes(pModelPart, pNodes);
+
+        H5::Group group = OpenOrCreateGroup(*mpFile, "Mesh");
+        WriteColumns(group, "NodeId", pNodes, EntityIdGetter<Node<3> >());
+        WriteColumns(group, "Coordinates", pNodes, NodeCoordinatesGetter());
+    }
+
+    /**
+     * Write the ids of the elements in column layout, i.e. the dataset /Mesh/ElementId [1 x n].
+     * The elemental data written by WriteElementalColumns follow the same order of elements.
+     */
+    void WriteElementColumns(ModelPart::Pointer pModelPart)
+    {
+        std::vector<Element::Pointer> pElements;
+        GetOwnedElements(pModelPart, pElements);
+
+        H5::Group group = OpenOrCreateGroup(*mpFile, "Mesh");
+        WriteColumns(group, "ElementId", pElements, EntityIdGetter<Element>());
+    }
+
+    /**
+     * Start a new time step. The following calls of WriteNodalColumns write to the group /Step_<k>, which has the
+     * attribute TIME. The time is also appended to the extendible dataset /Time, hence the steps can be appended in
+     * subsequent runs by opening the file in "Read-Write" mode.
+     * @return the index of the new step
+     */
+    int BeginStep(const double Time)
+    {
+        if(!mpTimeDataSet)
+        {
+            if(H5Lexists(mpFile->getId(), "/Time", H5P_DEFAULT) > 0)
+            {
+                mpTimeDataSet = boost::shared_ptr<H5::DataSet>(new H5::DataSet(mpFile->openDataSet("/Time")));
+                hsize_t dims[2];
+                mpTimeDataSet->getSpace().getSimpleExtentDims(dims, NULL);
+                mNumberOfSteps = dims[1];
+            }
+            else
+            {
+                H5::Group root = mpFile->openGroup("/");
+                mpTimeDataSet = boost::shared_ptr<H5::DataSet>(new H5::DataSet(CreateColumnDataSet(root, "Time", H5::PredType::NATIVE_DOUBLE, 1, 0)));
+                mNumberOfSteps = 0;
+            }
+        }
+
+        // the time is written by the master process only
+        hsize_t new_dims[2] = {1, mNumberOfSteps + 1};
+        mpTimeDataSet->extend(new_dims);
+        WriteColumns(*mpTimeDataSet, H5::PredType::NATIVE_DOUBLE, 1, mNumberOfSteps, (mRank == 0) ? 1 : 0, &Time);
+
+        std::stringstream group_name;
+        group_name << "/Step_" << mNumberOfSteps;
+        mpStepGroup = boost::shared_ptr<H5::Group>(new H5::Group(mpFile->createGroup(group_name.str())));
+        WriteAttribute(*mpStepGroup, "TIME", H5::PredType::NATIVE_DOUBLE, Time);
+
+        return mNumberOfSteps++;
+    }
+
+    /**
+     * Write the nodal values of a variable to the current step group, as a chunked dataset of size
+     * [number of components x number of nodes]. Each component is stored contiguously.
+     */
+    template<class TDataType>
+    void WriteNodalColumns(const Variable<TDataType>& rThisVariable, ModelPart::Pointer pModelPart)
+    {
+        if(!mpStepGroup)
+            KRATOS_THROW_ERROR(std::logic_error, "BeginStep must be called before writing", rThisVariable.Name())
+
+        std::vector<Node<3>::Pointer> pNodes;
+        GetOwnedNodes(pModelPart, pNodes);
+
+        WriteColumns(*mpStepGroup, rThisVariable.Name(), pNodes, NodalValueGetter<TDataType>(rThisVariable));
+    }
+
+    /**
+     * Write the elemental values of a variable to the subgroup Elemental of the current step group, as a chunked
+     * dataset of size [number of components x number of elements].
+     */
+    template<class TDataType>
+    void WriteElementalColumns(const Variable<TDataType>& rThisVariable, ModelPart::Pointer pModelPart)
+    {
+        if(!mpStepGroup)
+            KRATOS_THROW_ERROR(std::logic_error, "BeginStep must be called before writing", rThisVariable.Name())
+
+        std::vector<Element::Pointer> pElements;
+        GetOwnedElements(pModelPart, pElements);
+
+        H5::Group group = OpenOrCreateGroup(*mpStepGroup, "Elemental");
+        WriteColumns(group, rThisVariable.Name(), pElements, ElementalValueGetter<TDataType>(rThisVariable));
+    }
+
+    /*****************************************************
+                 MULTIPATCH LAYOUT
+    *****************************************************/
+
+    /**
+     * Write the multipatch to the group /MultiPatch. Each patch is written to the subgroup Patch_<id>, which
+     * contains the attributes ID and FESPACE, and the datasets Order [1 x dim], Number [1 x dim],
+     * Knots_<d> [1 x number of knots] and ControlPoints [4 x number of control points] (X, Y, Z, W).
+     * The other grid functions are written to the subgroup GridFunctions of the patch, one dataset
+     * [number of components x number of control points] per variable, with the attribute TYPE.
+     * The interfaces are written to the dataset Interfaces [9 x number of interfaces] of /MultiPatch, see
+     * WriteInterfaces. Only the B-Splines patches are supported.
+     * The multipatch is assumed to be the same on all processes; the master process writes the data.
+     */
+    template<int TDim>
+    void WriteMultiPatch(typename MultiPatch<TDim>::Pointer pMultiPatch)
+    {
+        typedef typename Patch<TDim>::ControlPointType ControlPointType;
+
+        H5::Group multipatch_group = mpFile->createGroup("/MultiPatch");
+        WriteAttribute(multipatch_group, "DIM", H5::PredType::NATIVE_INT, TDim);
+
+        for(typename MultiPatch<TDim>::patch_ptr_iterator it = pMultiPatch->Patches().ptr_begin();
+                it != pMultiPatch->Patches().ptr_end(); ++it)
+        {
+            typename BSplinesFESpace<TDim>::Pointer pFESpace = boost::dynamic_pointer_cast<BSplinesFESpace<TDim> >((*it)->pFESpace());
+            if(pFESpace == NULL)
+                KRATOS_THROW_ERROR(std::logic_error, "Only the B-Splines patch is supported, patch type:", (*it)->pFESpace()->Type())
+
+            std::stringstream patch_name;
+            patch_name << "Patch_" << (*it)->Id();
+            H5::Group group = multipatch_group.createGroup(patch_name.str());
+            WriteAttribute(group, "ID", H5::PredType::NATIVE_INT, static_cast<int>((*it)->Id()));
+            WriteAttribute(group, "FESPACE", pFESpace->Type());
+
+            std::vector<int> orders(TDim), numbers(TDim);
+            for(int dim = 0; dim < TDim; ++dim)
+            {
+                orders[dim] = pFESpace->Order(dim);
+                numbers[dim] = pFESpace->Number(dim);
+
+                std::vector<double> knots(pFESpace->KnotVector(dim).size());
+                for(std::size_t i = 0; i < knots.size(); ++i)
+                    knots[i] = pFESpace->KnotVector(dim).pKnotAt(i)->Value();
+
+                std::stringstream knots_name;
+                knots_name << "Knots_" << dim;
+                WriteArray(group, knots_name.str(), H5::PredType::NATIVE_DOUBLE, 1, knots);
+            }
+            WriteArray(group, "Order", H5::PredType::NATIVE_INT, 1, orders);
+            WriteArray(group, "Number", H5::PredType::NATIVE_INT, 1, numbers);
+
+            typename ControlGrid<ControlPointType>::ConstPointer pControlPointGrid = (*it)->pControlPointGridFunction()->pControlGrid();
+            const std::size_t n = pControlPointGrid->size();
+            std::vector<double> control_points(4 * n);
+            for(std::size_t i = 0; i < n; ++i)
+            {
+                const ControlPointType c = pControlPointGrid->GetData(i);
+                control_points[i] = c.X();
+                control_points[n + i] = c.Y();
+                control_points[2 * n + i] = c.Z();
+                control_points[3 * n + i] = c.W();
+            }
+            WriteArray(group, "ControlPoints", H5::PredType::NATIVE_DOUBLE, 4, control_points);
+
+            WriteGridFunctions<TDim>(group, *it);
+        }
+
+        WriteInterfaces<TDim>(multipatch_group, pMultiPatch);
+    }
+
+    /**
+     * Read the multipatch written by WriteMultiPatch, including the grid functions and the interfaces.
+     * The variables of the grid functions must be registered. All processes read the whole multipatch.
+     * The multipatch is not enumerated.
+     */
+    template<int TDim>
+    typename MultiPatch<TDim>::Pointer ReadMultiPatch()
+    {
+        typedef typename Patch<TDim>::ControlPointType ControlPointType;
+
+        H5::Group multipatch_group = mpFile->openGroup("/MultiPatch");
+        int dim_read;
+        multipatch_group.openAttribute("DIM").read(H5::PredType::NATIVE_INT, &dim_read);
+        if(dim_read != TDim)
+            KRATOS_THROW_ERROR(std::logic_error, "The dimension of the multipatch in file is", dim_read)
+
+        typename MultiPatch<TDim>::Pointer pNewMultiPatch = typename MultiPatch<TDim>::Pointer(new MultiPatch<TDim>());
+
+        std::map<int, typename Patch<TDim>::Pointer> patches;
+        for(hsize_t ip = 0; ip < multipatch_group.getNumObjs(); ++ip)
+        {
+            // the interface table is a dataset beside the patch groups
+            if(multipatch_group.getObjTypeByIdx(ip) != H5G_GROUP)
+                continue;
+
+            H5::Group group = multipatch_group.openGroup(multipatch_group.getObjnameByIdx(ip));
+
+            int id;
+            group.openAttribute("ID").read(H5::PredType::NATIVE_INT, &id);
+
+            H5::Attribute fespace_attribute = group.openAttribute("FESPACE");
+            std::string fespace_type;
+            fespace_attribute.read(fespace_attribute.getStrType(), fespace_type);
+            if(fespace_type != BSplinesFESpace<TDim>::StaticType())
+                KRATOS_THROW_ERROR(std::logic_error, "Only the B-Splines patch is supported, patch type:", fespace_type)
+
+            std::vector<int> orders, numbers;
+            ReadArray(group, "Order", H5::PredType::NATIVE_INT, orders);
+            ReadArray(group, "Number", H5::PredType::NATIVE_INT, numbers);
+
+            typename BSplinesFESpace<TDim>::Pointer pNewFESpace = BSplinesFESpace<TDim>::Create();
+            std::vector<std::size_t> sizes(TDim);
+            for(int dim = 0; dim < TDim; ++dim)
+            {
+                std::stringstream knots_name;
+                knots_name << "Knots_" << dim;
+                std::vector<double> knots;
+                ReadArray(group, knots_name.str(), H5::PredType::NATIVE_DOUBLE, knots);
+
+                pNewFESpace->SetKnotVector(dim, knots);
+                pNewFESpace->SetInfo(dim, numbers[dim], orders[dim]);
+                sizes[dim] = numbers[dim];
+            }
+            pNewFESpace->ResetFunctionIndices();
+
+            typename Patch<TDim>::Pointer pNewPatch = Patch<TDim>::Create(id, pNewFESpace);
+
+            std::vector<double> control_points;
+            ReadArray(group, "ControlPoints", H5::PredType::NATIVE_DOUBLE, control_points);
+            typename StructuredControlGrid<TDim, ControlPointType>::Pointer pControlPointGrid = StructuredControlGrid<TDim, ControlPointType>::Create(sizes);
+            const std::size_t n = control_points.size() / 4;
+            if(n != pControlPointGrid->size())
+                KRATOS_THROW_ERROR(std::logic_error, "The number of control points is not consistent at patch", id)
+            for(std::size_t i = 0; i < n; ++i)
+            {
+                ControlPointType c;
+                c.SetCoordinates(control_points[i], control_points[n + i], control_points[2 * n + i], control_points[3 * n + i]);
+                pControlPointGrid->SetData(i, c);
+            }
+            pControlPointGrid->SetName("CONTROL_POINT");
+            pNewPatch->CreateControlPointGridFunction(pControlPointGrid);
+
+            if(H5Lexists(group.getId(), "GridFunctions", H5P_DEFAULT) > 0)
+                ReadGridFunctions<TDim>(group, pNewPatch, sizes);
+
+            pNewMultiPatch->AddPatch(pNewPatch);
+            patches[id] = pNewPatch;
+        }
+
+        if(H5Lexists(multipatch_group.getId(), "Interfaces", H5P_DEFAULT) > 0)
+            ReadInterfaces<TDim>(multipatch_group, patches);
+
+        return pNewMultiPatch;
+    }
+
     ///@}
     ///@name Access
     ///@{
@@ -310,6 +687,20 @@ private:
     ///@{
     boost::shared_ptr<H5::H5File> mpFile;
 
+    enum CompressionType {NO_COMPRESSION = 0, DEFLATE_COMPRESSION = 1, SZIP_COMPRESSION = 2};
+
+    std::size_t mChunkSize;
+    CompressionType mCompression;
+    int mCompressionLevel;
+    hsize_t mNumberOfSteps;
+    boost::shared_ptr<H5::DataSet> mpTimeDataSet;
+    boost::shared_ptr<H5::Group> mpStepGroup;
+
+    bool mParallel;
+    int mRank;
+    int mSize;
+    H5::DSetMemXferPropList mTransferPropList;
+
     ///@}
     ///@name Private Operators
     ///@{
@@ -318,6 +709,450 @@ private:
     ///@name Private Operations
     ///@{
 
+    /*****************************************************
+           FUNCTIONS TO WRITE DATA IN COLUMNS
+    *****************************************************/
+
+    /// Accessors of the values written by WriteColumns
+    template<class TEntityType>
+    struct EntityIdGetter
+    {
+        typedef int ValueType;
+        static const H5::PredType& DataType() {return H5::PredType::NATIVE_INT;}
+        std::size_t NumberOfComponents(const TEntityType&) const {return 1;}
+        ValueType Get(const TEntityType& rEntity, const std::size_t&) const {return rEntity.Id();}
+    };
+
+    struct NodeCoordinatesGetter
+    {
+        typedef double ValueType;
+        static const H5::PredType& DataType() {return H5::PredType::NATIVE_DOUBLE;}
+        std::size_t NumberOfComponents(const Node<3>&) const {return 3;}
+        ValueType Get(const Node<3>& rNode, const std::size_t& c) const
+        {
+            return (c == 0) ? rNode.X0() : ((c == 1) ? rNode.Y0() : rNode.Z0());
+        }
+    };
+
+    template<class TDataType>
+    struct NodalValueGetter
+    {
+        typedef double ValueType;
+        static const H5::PredType& DataType() {return H5::PredType::NATIVE_DOUBLE;}
+        NodalValueGetter(const Variable<TDataType>& rThisVariable) : mrVariable(rThisVariable) {}
+        std::size_t NumberOfComponents(const Node<3>& rNode) const
+        {
+            return HDF5PostUtility::NumberOfComponents(rNode.GetSolutionStepValue(mrVariable));
+        }
+        ValueType Get(const Node<3>& rNode, const std::size_t& c) const
+        {
+            return HDF5PostUtility::Component(rNode.GetSolutionStepValue(mrVariable), c);
+        }
+        const Variable<TDataType>& mrVariable;
+    };
+
+    template<class TDataType>
+    struct ElementalValueGetter
+    {
+        typedef double ValueType;
+        static const H5::PredType& DataType() {return H5::PredType::NATIVE_DOUBLE;}
+        ElementalValueGetter(const Variable<TDataType>& rThisVariable) : mrVariable(rThisVariable) {}
+        std::size_t NumberOfComponents(const Element& rElement) const
+        {
+            return HDF5PostUtility::NumberOfComponents(rElement.GetValue(mrVariable));
+        }
+        ValueType Get(const Element& rElement, const std::size_t& c) const
+        {
+            return HDF5PostUtility::Component(rElement.GetValue(mrVariable), c);
+        }
+        const Variable<TDataType>& mrVariable;
+    };
+
+    /// Get the nodes owned by this process, i.e. all the nodes in serial mode
+    void GetOwnedNodes(ModelPart::Pointer pModelPart, std::vector<Node<3>::Pointer>& pNodes) const
+    {
+        pNodes.reserve(pModelPart->NumberOfNodes());
+        for(typename NodesArrayType::ptr_iterator it = pModelPart->Nodes().ptr_begin(); it != pModelPart->Nodes().ptr_end(); ++it)
+        {
+            if(mParallel && (*it)->SolutionStepsDataHas(PARTITION_INDEX))
+                if((*it)->FastGetSolutionStepValue(PARTITION_INDEX) != mRank)
+                    continue;
+            pNodes.push_back(*it);
+        }
+    }
+
+    /// Get the elements owned by this process. The elements are not duplicated across processes.
+    void GetOwnedElements(ModelPart::Pointer pModelPart, std::vector<Element::Pointer>& pElements) const
+    {
+        pElements.assign(pModelPart->Elements().ptr_begin(), pModelPart->Elements().ptr_end());
+    }
+
+    /// Compute the position of the local columns and the total number of columns over all processes. The number of
+    /// components is made consistent, hence the processes without data do not need to know it.
+    void ComputeColumnLayout(const hsize_t n, hsize_t& ncomp, hsize_t& offset, hsize_t& total, hsize_t& nchunks) const
+    {
+        offset = 0;
+        total = n;
+        nchunks = (n + mChunkSize - 1) / mChunkSize;
+
+        #ifdef ISOGEOMETRIC_USE_PARALLEL_HDF5
+        if(mParallel)
+        {
+            unsigned long long local[3] = {n, ncomp, nchunks};
+            unsigned long long global[3];
+            unsigned long long start = 0;
+            MPI_Exscan(&local[0], &start, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+            MPI_Allreduce(&local[0], &global[0], 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+            MPI_Allreduce(&local[1], &global[1], 2, MPI_UNSIGNED_LONG_LONG, MPI_MAX, MPI_COMM_WORLD);
+            offset = (mRank == 0) ? 0 : start;
+            total = global[0];
+            ncomp = global[1];
+            nchunks = global[2];
+        }
+        #endif
+    }
+
+    /// Write the values of the entities as a chunked dataset of size [ncomp x total number of entities]. The values are
+    /// gathered in pieces of mChunkSize entities. In parallel mode, all processes take part in the same number of writes.
+    template<class TEntityPointerType, class TGetterType>
+    void WriteColumns(H5::Group& rGroup, const std::string& Name, const std::vector<TEntityPointerType>& pEntities, const TGetterType& rGetter)
+    {
+        typedef typename TGetterType::ValueType ValueType;
+
+        const hsize_t n = pEntities.size();
+        hsize_t ncomp = (n == 0) ? 1 : rGetter.NumberOfComponents(*pEntities[0]);
+        hsize_t offset, total, nchunks;
+        ComputeColumnLayout(n, ncomp, offset, total, nchunks);
+
+        H5::DataSet dataset = CreateColumnDataSet(rGroup, Name, TGetterType::DataType(), ncomp, total);
+
+        std::vector<ValueType> values(ncomp * mChunkSize);
+        for(hsize_t k = 0; k < nchunks; ++k)
+        {
+            const hsize_t begin = std::min(k * mChunkSize, n);
+            const hsize_t count = std::min(static_cast<hsize_t>(mChunkSize), n - begin);
+            for(hsize_t i = 0; i < count; ++i)
+            {
+                const typename TEntityPointerType::element_type& rEntity = *pEntities[begin + i];
+                if(rGetter.NumberOfComponents(rEntity) != ncomp)
+                    KRATOS_THROW_ERROR(std::logic_error, "The number of components is not the same at entity", rEntity.Id())
+                for(hsize_t c = 0; c < ncomp; ++c)
+                    values[c * count + i] = rGetter.Get(rEntity, c);
+            }
+            WriteColumns(dataset, TGetterType::DataType(), ncomp, offset + begin, count, &values[0]);
+        }
+    }
+
+    /// Create a chunked dataset of size [ncomp x n], extendible in the second dimension, with the selected compression filter
+    H5::DataSet CreateColumnDataSet(H5::Group& rLocation, const std::string& Name, const H5::PredType& rType, const hsize_t ncomp, const hsize_t n)
+    {
+        hsize_t dims[2] = {ncomp, n};
+        hsize_t maxdims[2] = {ncomp, H5S_UNLIMITED};
+        H5::DataSpace space(2, dims, maxdims);
+
+        H5::DSetCreatPropList plist;
+        hsize_t chunk_dims[2] = {1, mChunkSize};
+        plist.setChunk(2, chunk_dims);
+        if(mCompression == DEFLATE_COMPRESSION)
+            plist.setDeflate(mCompressionLevel);
+        else if(mCompression == SZIP_COMPRESSION)
+            plist.setSzip(H5_SZIP_NN_OPTION_MASK, mCompressionLevel);
+
+        return rLocation.createDataSet(Name, rType, space, plist);
+    }
+
+    /// Write the data [ncomp x count], stored row-wise, to the columns [offset, offset + count) of the dataset.
+    /// A process without data (count == 0) selects nothing, which is required for the collective writes.
+    template<class TValueType>
+    void WriteColumns(H5::DataSet& rDataSet, const H5::PredType& rType, const hsize_t ncomp,
+            const hsize_t offset, const hsize_t count, const TValueType* pData)
+    {
+        H5::DataSpace filespace = rDataSet.getSpace();
+        hsize_t start[2] = {0, offset};
+        hsize_t block[2] = {ncomp, std::max(count, static_cast<hsize_t>(1))};
+        H5::DataSpace memspace(2, block);
+        if(count != 0)
+        {
+            filespace.selectHyperslab(H5S_SELECT_SET, block, start);
+        }
+        else
+        {
+            filespace.selectNone();
+            memspace.selectNone();
+        }
+
+        rDataSet.write(pData, rType, memspace, filespace, mTransferPropList);
+    }
+
+    /// Write a small array [ncomp x n], which is the same on all processes, as a contiguous dataset
+    template<class TValueType>
+    void WriteArray(H5::Group& rGroup, const std::string& Name, const H5::PredType& rType, const hsize_t ncomp,
+            const std::vector<TValueType>& rValues)
+    {
+        const hsize_t n = rValues.size() / ncomp;
+        hsize_t dims[2] = {ncomp, n};
+        H5::DataSpace space(2, dims);
+        H5::DataSet dataset = rGroup.createDataSet(Name, rType, space);
+        if(n != 0)
+            WriteColumns(dataset, rType, ncomp, 0, (mRank == 0) ? n : 0, &rValues[0]);
+    }
+
+    /// Read an array written by WriteArray or WriteColumns, stored row-wise
+    template<class TValueType>
+    void ReadArray(H5::Group& rGroup, const std::string& Name, const H5::PredType& rType, std::vector<TValueType>& rValues)
+    {
+        H5::DataSet dataset = rGroup.openDataSet(Name);
+        hsize_t dims[2];
+        dataset.getSpace().getSimpleExtentDims(dims, NULL);
+        rValues.resize(dims[0] * dims[1]);
+        if(rValues.size() != 0)
+            dataset.read(&rValues[0], rType);
+    }
+
+    /// Open a subgroup, create it if it does not exist
+    template<class TLocationType>
+    H5::Group OpenOrCreateGroup(TLocationType& rLocation, const std::string& Name)
+    {
+        if(H5Lexists(rLocation.getId(), Name.c_str(), H5P_DEFAULT) > 0)
+            return rLocation.openGroup(Name);
+        return rLocation.createGroup(Name);
+    }
+
+    /// Write a scalar attribute. In parallel mode all processes write the same value.
+    template<class TLocationType, class TValueType>
+    void WriteAttribute(TLocationType& rLocation, const std::string& Name, const H5::PredType& rType, const TValueType& rValue)
+    {
+        H5::DataSpace attr_dataspace(H5S_SCALAR);
+        H5::Attribute attribute = rLocation.createAttribute(Name, rType, attr_dataspace);
+        attribute.write(rType, &rValue);
+    }
+
+    template<class TLocationType>
+    void WriteAttribute(TLocationType& rLocation, const std::string& Name, const std::string& rValue)
+    {
+        H5::StrType str_type(H5::PredType::C_S1, rValue.size());
+        H5::DataSpace attr_dataspace(H5S_SCALAR);
+        H5::Attribute attribute = rLocation.createAttribute(Name, str_type, attr_dataspace);
+        attribute.write(str_type, rValue);
+    }
+
+    static std::size_t NumberOfComponents(const bool&) {return 1;}
+    static std::size_t NumberOfComponents(const double&) {return 1;}
+    static std::size_t NumberOfComponents(const array_1d<double, 3>&) {return 3;}
+    static std::size_t NumberOfComponents(const Vector& rValue) {return rValue.size();}
+
+    /// Write the grid functions of the patch other than the control point grid, in the order of the structured grid
+    template<int TDim>
+    void WriteGridFunctions(H5::Group& rPatchGroup, typename Patch<TDim>::Pointer pPatch)
+    {
+        H5::Group group = rPatchGroup.createGroup("GridFunctions");
+
+        std::vector<Variable<double>*> double_var_list = pPatch->template ExtractVariables<Variable<double> >();
+        for(std::size_t i = 0; i < double_var_list.size(); ++i)
+            WriteGridFunction<TDim>(group, pPatch, *double_var_list[i], "double");
+
+        // the control point coordinates grid is derived from the control point grid
+        std::vector<Variable<array_1d<double, 3> >*> array1d_var_list = pPatch->template ExtractVariables<Variable<array_1d<double, 3> > >();
+        for(std::size_t i = 0; i < array1d_var_list.size(); ++i)
+        {
+            if(*array1d_var_list[i] == CONTROL_POINT_COORDINATES) continue;
+            WriteGridFunction<TDim>(group, pPatch, *array1d_var_list[i], "array_1d");
+        }
+
+        std::vector<Variable<Vector>*> vector_var_list = pPatch->template ExtractVariables<Variable<Vector> >();
+        for(std::size_t i = 0; i < vector_var_list.size(); ++i)
+            WriteGridFunction<TDim>(group, pPatch, *vector_var_list[i], "vector");
+    }
+
+    template<int TDim, class TVariableType>
+    void WriteGridFunction(H5::Group& rGroup, typename Patch<TDim>::Pointer pPatch, const TVariableType& rVariable,
+            const std::string& type)
+    {
+        typename ControlGrid<typename TVariableType::Type>::Pointer pControlGrid = pPatch->pGetGridFunction(rVariable)->pControlGrid();
+        const std::size_t n = pControlGrid->size();
+        const std::size_t ncomp = (n != 0) ? NumberOfComponents(pControlGrid->GetData(0)) : 1;
+
+        std::vector<double> values(ncomp * n);
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            const typename TVariableType::Type v = pControlGrid->GetData(i);
+            if(NumberOfComponents(v) != ncomp)
+                KRATOS_THROW_ERROR(std::logic_error, "The values of the grid function have different sizes:", rVariable.Name())
+            for(std::size_t c = 0; c < ncomp; ++c)
+                values[c * n + i] = Component(v, c);
+        }
+        WriteArray(rGroup, rVariable.Name(), H5::PredType::NATIVE_DOUBLE, ncomp, values);
+
+        H5::DataSet dataset = rGroup.openDataSet(rVariable.Name());
+        WriteAttribute(dataset, "TYPE", type);
+    }
+
+    template<int TDim>
+    void ReadGridFunctions(H5::Group& rPatchGroup, typename Patch<TDim>::Pointer pPatch, const std::vector<std::size_t>& sizes)
+    {
+        H5::Group group = rPatchGroup.openGroup("GridFunctions");
+        for(hsize_t i = 0; i < group.getNumObjs(); ++i)
+        {
+            const std::string var_name = group.getObjnameByIdx(i);
+            if(!KratosComponents<VariableData>::Has(var_name))
+                KRATOS_THROW_ERROR(std::logic_error, "The variable of the grid function is not registered:", var_name)
+
+            H5::Attribute type_attribute = group.openDataSet(var_name).openAttribute("TYPE");
+            std::string type;
+            type_attribute.read(type_attribute.getStrType(), type);
+
+            if(type == "double")
+                ReadGridFunction<TDim, Variable<double> >(group, pPatch, var_name, sizes);
+            else if(type == "array_1d")
+                ReadGridFunction<TDim, Variable<array_1d<double, 3> > >(group, pPatch, var_name, sizes);
+            else if(type == "vector")
+                ReadGridFunction<TDim, Variable<Vector> >(group, pPatch, var_name, sizes);
+            else
+                KRATOS_THROW_ERROR(std::logic_error, "Unknown grid function type:", type)
+        }
+    }
+
+    template<int TDim, class TVariableType>
+    void ReadGridFunction(H5::Group& rGroup, typename Patch<TDim>::Pointer pPatch, const std::string& var_name,
+            const std::vector<std::size_t>& sizes)
+    {
+        typedef typename TVariableType::Type DataType;
+
+        const TVariableType* pVariable = dynamic_cast<const TVariableType*>(&KratosComponents<VariableData>::Get(var_name));
+        if(pVariable == NULL)
+            KRATOS_THROW_ERROR(std::logic_error, "The variable of the grid function has a different type:", var_name)
+
+        H5::DataSet dataset = rGroup.openDataSet(var_name);
+        hsize_t dims[2];
+        dataset.getSpace().getSimpleExtentDims(dims, NULL);
+        const std::size_t ncomp = dims[0], n = dims[1];
+
+        std::vector<double> values;
+        ReadArray(rGroup, var_name, H5::PredType::NATIVE_DOUBLE, values);
+
+        typename StructuredControlGrid<TDim, DataType>::Pointer pControlGrid = StructuredControlGrid<TDim, DataType>::Create(sizes);
+        if(n != pControlGrid->size())
+            KRATOS_THROW_ERROR(std::logic_error, "The size of the grid function is not consistent:", var_name)
+        DataType v;
+        Resize(v, ncomp);
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            for(std::size_t c = 0; c < ncomp; ++c)
+                SetComponent(v, c, values[c * n + i]);
+            pControlGrid->SetData(i, v);
+        }
+        pControlGrid->SetName(var_name);
+        pPatch->CreateGridFunction(*pVariable, pControlGrid);
+    }
+
+    /**
+     * Write the interfaces of all patches to the dataset Interfaces [9 x number of interfaces]. The rows are
+     * patch 1 id, side 1, patch 2 id, side 2, kind (1: B-Splines interface, 0: generic interface),
+     * local parameter map, direction 1, direction 2 and the index of the other half of the interface (-1 if none).
+     */
+    template<int TDim>
+    void WriteInterfaces(H5::Group& rMultiPatchGroup, typename MultiPatch<TDim>::Pointer pMultiPatch)
+    {
+        std::vector<const PatchInterface<TDim>*> pInterfaces;
+        std::map<const PatchInterface<TDim>*, int> interface_index;
+        for(typename MultiPatch<TDim>::patch_ptr_iterator it = pMultiPatch->Patches().ptr_begin();
+                it != pMultiPatch->Patches().ptr_end(); ++it)
+        {
+            for(typename Patch<TDim>::interface_iterator it2 = (*it)->InterfaceBegin(); it2 != (*it)->InterfaceEnd(); ++it2)
+            {
+                interface_index[&(*(*it2))] = pInterfaces.size();
+                pInterfaces.push_back(&(*(*it2)));
+            }
+        }
+
+        const std::size_t n = pInterfaces.size();
+        std::vector<int> table(9 * n);
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            const PatchInterface<TDim>& rInterface = *pInterfaces[i];
+            table[i] = rInterface.pPatch1()->Id();
+            table[n + i] = static_cast<int>(rInterface.Side1());
+            table[2 * n + i] = rInterface.pPatch2()->Id();
+            table[3 * n + i] = static_cast<int>(rInterface.Side2());
+
+            if(typeid(rInterface) == typeid(BSplinesPatchInterface<TDim>))
+            {
+                const BSplinesPatchInterface<TDim>& rBInterface = dynamic_cast<const BSplinesPatchInterface<TDim>&>(rInterface);
+                table[4 * n + i] = 1;
+                table[5 * n + i] = rBInterface.LocalParameterMapping(0);
+                table[6 * n + i] = static_cast<int>(rBInterface.Direction(0));
+                table[7 * n + i] = static_cast<int>(rBInterface.Direction(1));
+            }
+            else if(typeid(rInterface) == typeid(PatchInterface<TDim>))
+            {
+                table[4 * n + i] = 0;
+                table[5 * n + i] = 0;
+                table[6 * n + i] = 0;
+                table[7 * n + i] = 0;
+            }
+            else
+                KRATOS_THROW_ERROR(std::logic_error, "The interface type is not supported:", typeid(rInterface).name())
+
+            table[8 * n + i] = -1;
+            typename PatchInterface<TDim>::Pointer pOther = rInterface.pOtherInterface();
+            if(pOther != NULL)
+            {
+                typename std::map<const PatchInterface<TDim>*, int>::const_iterator it = interface_index.find(&(*pOther));
+                if(it != interface_index.end())
+                    table[8 * n + i] = it->second;
+            }
+        }
+
+        WriteArray(rMultiPatchGroup, "Interfaces", H5::PredType::NATIVE_INT, 9, table);
+    }
+
+    /// Read the interfaces written by WriteInterfaces and add them to the patches
+    template<int TDim>
+    void ReadInterfaces(H5::Group& rMultiPatchGroup, const std::map<int, typename Patch<TDim>::Pointer>& rPatches)
+    {
+        std::vector<int> table;
+        ReadArray(rMultiPatchGroup, "Interfaces", H5::PredType::NATIVE_INT, table);
+        const std::size_t n = table.size() / 9;
+
+        std::vector<typename PatchInterface<TDim>::Pointer> pInterfaces(n);
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            typename std::map<int, typename Patch<TDim>::Pointer>::const_iterator it1 = rPatches.find(table[i]);
+            typename std::map<int, typename Patch<TDim>::Pointer>::const_iterator it2 = rPatches.find(table[2 * n + i]);
+            if((it1 == rPatches.end()) || (it2 == rPatches.end()))
+                KRATOS_THROW_ERROR(std::logic_error, "The interface refers to a missing patch, interface", i)
+
+            const BoundarySide side1 = static_cast<BoundarySide>(table[n + i]);
+            const BoundarySide side2 = static_cast<BoundarySide>(table[3 * n + i]);
+            if(table[4 * n + i] == 1)
+                pInterfaces[i] = HDF5MultiPatchInterface_Helper<TDim>::Create(it1->second, side1, it2->second, side2,
+                    table[5 * n + i], table[6 * n + i], table[7 * n + i]);
+            else
+                pInterfaces[i] = typename PatchInterface<TDim>::Pointer(new PatchInterface<TDim>(it1->second, side1, it2->second, side2));
+        }
+
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            const int other = table[8 * n + i];
+            if(other >= 0)
+                pInterfaces[i]->SetOtherInterface(pInterfaces[other]);
+            pInterfaces[i]->pPatch1()->AddInterface(pInterfaces[i]);
+        }
+    }
+
+    static void Resize(double& rValue, const std::size_t&) {}
+    static void Resize(array_1d<double, 3>& rValue, const std::size_t&) {}
+    static void Resize(Vector& rValue, const std::size_t& n) {rValue.resize(n, false);}
+
+    static void SetComponent(double& rValue, const std::size_t&, const double& v) {rValue = v;}
+    static void SetComponent(array_1d<double, 3>& rValue, const std::size_t& c, const double& v) {rValue[c] = v;}
+    static void SetComponent(Vector& rValue, const std::size_t& c, const double& v) {rValue[c] = v;}
+
+    static double Component(const bool& rValue, const std::size_t&) {return rValue ? 1.0 : 0.0;}
+    static double Component(const double& rValue, const std::size_t&) {return rValue;}
+    static double Component(const array_1d<double, 3>& rValue, const std::size_t& c) {return rValue[c];}
+    static double Component(const Vector& rValue, const std::size_t& c) {return rValue[c];}
+
     /*****************************************************
            FUNCTIONS TO WRITE DATA TO NODES
     *****************************************************/
@@ -203,6 +203,13 @@ enum PostElementType
     _HEXAHEDRA_ = 3
 };
 
+enum L2ProjectionType
+{
+    _CONSISTENT_L2_PROJECTION_ = 0,
+    _LUMPED_L2_PROJECTION_ = 1,
+    _DIAGONAL_SCALED_L2_PROJECTION_ = 2
+};
+
 /**
  * Helper struct to extract the pointer type
  * One case use typename Isogeometric_Pointer_Helper<TType>::Pointer as replacement for typename TType::Pointer
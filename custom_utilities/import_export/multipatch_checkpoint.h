@@ -0,0 +1,1185 @@
+//
+//   Project Name:        Kratos
+//   Last Modified by:    $Author: hbui $
+//   Date:                $Date: 17 Oct 2026 $
+//   Revision:            $Revision: 1.0 $
+//
+//
+
+#if !defined(KRATOS_ISOGEOMETRIC_APPLICATION_MULTIPATCH_CHECKPOINT_H_INCLUDED)
+#define  KRATOS_ISOGEOMETRIC_APPLICATION_MULTIPATCH_CHECKPOINT_H_INCLUDED
+
+// System includes
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <fstream>
+#include <cstring>
+#include <stdint.h>
+
+// External includes
+
+// Project includes
+#include "includes/define.h"
+#include "containers/array_1d.h"
+#include "custom_utilities/control_point.h"
+#include "custom_utilities/control_grid_utility.h"
+#include "custom_utilities/patch.h"
+#include "custom_utilities/multipatch.h"
+#include "custom_utilities/patch_interface.h"
+#include "custom_utilities/nurbs/bsplines_fespace.h"
+#include "custom_utilities/nurbs/bsplines_patch_interface.h"
+#include "custom_utilities/nurbs/structured_control_grid.h"
+#include "custom_utilities/hbsplines/hbsplines_fespace.h"
+#include "custom_utilities/nurbs/pbbsplines_basis_function.h"
+#include "custom_utilities/tsplines/tcell.h"
+#include "custom_utilities/tsplines/tsplines_fespace.h"
+#include "isogeometric_application/isogeometric_application.h"
+
+namespace Kratos
+{
+
+/**
+ * Binary layout of the MultiPatch checkpoint. The file is organized as:
+ *      Header | patch records | patch index | interface table
+ * Each patch record is self-contained (FESpace, grid functions values), hence a single patch can be read by seeking
+ * to its offset in the patch index without touching the other records. The interface table stores both halves of
+ * every interface with the link to the other half.
+ * The point-based patches (hierarchical B-Splines and T-Splines) store their cells and basis functions with their ids,
+ * levels and the indices of their knots in the knot tables of the patch. For the hierarchical B-Splines patch the knot
+ * tables are the global knot vectors, and the refinement history is stored, so that the refined patch is restored directly
+ * without replaying the refinement. For the T-Splines patch the knot tables are the sorted knot values of the cells and
+ * the basis functions, and the faces of the T-mesh are stored as a second cell list.
+ */
+struct MultiPatchCheckpointLayout
+{
+    typedef uint64_t WordType;
+
+    static const WordType Version = 1;
+    static const WordType ByteOrderMark = 0x0102030405060708ULL;
+
+    enum FESpaceKind {BSPLINES = 0, HBSPLINES = 1, TSPLINES = 2};
+    enum InterfaceKind {GENERIC_INTERFACE = 0, BSPLINES_INTERFACE = 1};
+    enum GridKind {DOUBLE_GRID = 0, ARRAY_1D_GRID = 1, VECTOR_GRID = 2};
+
+    struct Header
+    {
+        char Magic[8];
+        WordType Version;
+        WordType ByteOrder;
+        WordType Dimension;
+        WordType NumberOfPatches;
+        WordType NumberOfInterfaces;
+        WordType IndexOffset; // byte offset of the patch index, the interface table follows it
+        WordType IsEnumerated;
+        WordType FirstEquationId;
+    };
+
+    struct PatchIndexRecord
+    {
+        WordType Id;
+        WordType Offset;
+        WordType Size;
+    };
+
+    struct InterfaceRecord
+    {
+        WordType Patch1;
+        WordType Side1;
+        WordType Patch2;
+        WordType Side2;
+        WordType Kind;
+        WordType LocalParameterMap;
+        int64_t Direction1;
+        int64_t Direction2;
+        int64_t OtherInterface; // index of the other half in the interface table, -1 if there is none
+    };
+
+    static const char* Magic() {return "KRMPCHKP";}
+
+    template<typename TDataType>
+    static void Write(std::ostream& rOStream, const TDataType& rValue)
+    {
+        rOStream.write(reinterpret_cast<const char*>(&rValue), sizeof(TDataType));
+    }
+
+    template<typename TDataType>
+    static void WriteArray(std::ostream& rOStream, const std::vector<TDataType>& rArray)
+    {
+        Write(rOStream, static_cast<WordType>(rArray.size()));
+        if (rArray.size() != 0)
+            rOStream.write(reinterpret_cast<const char*>(&rArray[0]), rArray.size() * sizeof(TDataType));
+    }
+
+    static void WriteString(std::ostream& rOStream, const std::string& rString)
+    {
+        Write(rOStream, static_cast<WordType>(rString.size()));
+        rOStream.write(rString.data(), rString.size());
+    }
+
+    template<typename TDataType>
+    static void Read(std::istream& rIStream, TDataType& rValue)
+    {
+        rIStream.read(reinterpret_cast<char*>(&rValue), sizeof(TDataType));
+        if (!rIStream)
+            KRATOS_THROW_ERROR(std::runtime_error, "Unexpected end of the MultiPatch checkpoint", "")
+    }
+
+    static WordType ReadWord(std::istream& rIStream)
+    {
+        WordType v;
+        Read(rIStream, v);
+        return v;
+    }
+
+    template<typename TDataType>
+    static void ReadArray(std::istream& rIStream, std::vector<TDataType>& rArray)
+    {
+        rArray.resize(ReadWord(rIStream));
+        if (rArray.size() != 0)
+            rIStream.read(reinterpret_cast<char*>(&rArray[0]), rArray.size() * sizeof(TDataType));
+        if (!rIStream)
+            KRATOS_THROW_ERROR(std::runtime_error, "Unexpected end of the MultiPatch checkpoint", "")
+    }
+
+    static std::string ReadString(std::istream& rIStream)
+    {
+        std::string s(ReadWord(rIStream), ' ');
+        if (s.size() != 0)
+            rIStream.read(&s[0], s.size());
+        if (!rIStream)
+            KRATOS_THROW_ERROR(std::runtime_error, "Unexpected end of the MultiPatch checkpoint", "")
+        return s;
+    }
+
+    /// Values of the grid functions. The control point is stored with its weighted coordinates and weight as it is kept internally.
+    static void WriteValue(std::ostream& rOStream, const double& v) {Write(rOStream, v);}
+
+    static void WriteValue(std::ostream& rOStream, const array_1d<double, 3>& v)
+    {
+        for (std::size_t i = 0; i < 3; ++i)
+            Write(rOStream, v[i]);
+    }
+
+    static void WriteValue(std::ostream& rOStream, const Vector& v)
+    {
+        Write(rOStream, static_cast<WordType>(v.size()));
+        for (std::size_t i = 0; i < v.size(); ++i)
+            Write(rOStream, v[i]);
+    }
+
+    static void WriteValue(std::ostream& rOStream, const ControlPoint<double>& v)
+    {
+        for (int i = 0; i < 4; ++i)
+            Write(rOStream, v[i]);
+    }
+
+    static void ReadValue(std::istream& rIStream, double& v) {Read(rIStream, v);}
+
+    static void ReadValue(std::istream& rIStream, array_1d<double, 3>& v)
+    {
+        for (std::size_t i = 0; i < 3; ++i)
+            Read(rIStream, v[i]);
+    }
+
+    static void ReadValue(std::istream& rIStream, Vector& v)
+    {
+        v.resize(ReadWord(rIStream), false);
+        for (std::size_t i = 0; i < v.size(); ++i)
+            Read(rIStream, v[i]);
+    }
+
+    static void ReadValue(std::istream& rIStream, ControlPoint<double>& v)
+    {
+        for (int i = 0; i < 4; ++i)
+            Read(rIStream, v[i]);
+    }
+};
+
+/// Helper to create the B-Splines interface from the record, since its constructor depends on the dimension
+template<int TDim>
+struct MultiPatchCheckpointInterfaceHelper
+{
+    static typename PatchInterface<TDim>::Pointer Create(typename Patch<TDim>::Pointer pPatch1, const BoundarySide& side1,
+        typename Patch<TDim>::Pointer pPatch2, const BoundarySide& side2, const MultiPatchCheckpointLayout::InterfaceRecord& rRecord);
+};
+
+template<>
+inline typename PatchInterface<1>::Pointer MultiPatchCheckpointInterfaceHelper<1>::Create(typename Patch<1>::Pointer pPatch1, const BoundarySide& side1,
+    typename Patch<1>::Pointer pPatch2, const BoundarySide& side2, const MultiPatchCheckpointLayout::InterfaceRecord& rRecord)
+{
+    return typename PatchInterface<1>::Pointer(new BSplinesPatchInterface<1>(pPatch1, side1, pPatch2, side2));
+}
+
+template<>
+inline typename PatchInterface<2>::Pointer MultiPatchCheckpointInterfaceHelper<2>::Create(typename Patch<2>::Pointer pPatch1, const BoundarySide& side1,
+    typename Patch<2>::Pointer pPatch2, const BoundarySide& side2, const MultiPatchCheckpointLayout::InterfaceRecord& rRecord)
+{
+    return typename PatchInterface<2>::Pointer(new BSplinesPatchInterface<2>(pPatch1, side1, pPatch2, side2,
+        static_cast<BoundaryDirection>(rRecord.Direction1)));
+}
+
+template<>
+inline typename PatchInterface<3>::Pointer MultiPatchCheckpointInterfaceHelper<3>::Create(typename Patch<3>::Pointer pPatch1, const BoundarySide& side1,
+    typename Patch<3>::Pointer pPatch2, const BoundarySide& side2, const MultiPatchCheckpointLayout::InterfaceRecord& rRecord)
+{
+    return typename PatchInterface<3>::Pointer(new BSplinesPatchInterface<3>(pPatch1, side1, pPatch2, side2,
+        (rRecord.LocalParameterMap == 0), static_cast<BoundaryDirection>(rRecord.Direction1), static_cast<BoundaryDirection>(rRecord.Direction2)));
+}
+
+/// The T-Splines FESpace which is stored in the checkpoint, i.e. the one created by the T-Splines importers
+template<int TDim>
+struct MultiPatchCheckpointTSplinesFESpace
+{
+    typedef TSplinesFESpace<TDim, PBBSplinesBasisFunction<TDim, TCell>, BCellManager<TDim, TCell> > Type;
+};
+
+/// Helper to store the cells and basis functions of the point-based B-Splines FESpace. The primary template is for the FESpace
+/// whose knots are plain values (T-Splines); the knots are identified by their values and the cells and basis functions have no level.
+template<class TFESpaceType>
+struct MultiPatchCheckpointPBBSplinesHelper
+{
+    typedef typename TFESpaceType::knot_t knot_t;
+    typedef typename TFESpaceType::bf_t bf_t;
+    typedef typename TFESpaceType::cell_t cell_t;
+    typedef typename TFESpaceType::BasisFunctionType BasisFunctionType;
+    typedef std::map<double, MultiPatchCheckpointLayout::WordType> knot_index_t;
+
+    static void AddKnot(knot_index_t& rKnotIndex, const knot_t& knot, const MultiPatchCheckpointLayout::WordType& i) {rKnotIndex[knot] = i;}
+
+    static MultiPatchCheckpointLayout::WordType GetKnotIndex(const knot_index_t& rKnotIndex, const knot_t& knot)
+    {
+        typename knot_index_t::const_iterator it = rKnotIndex.find(knot);
+        if (it == rKnotIndex.end())
+            KRATOS_THROW_ERROR(std::logic_error, "The knot does not belong to the knot table of the FESpace:", knot)
+        return it->second;
+    }
+
+    static std::size_t Level(const bf_t& p_bf) {return 1;}
+
+    static bf_t CreateBf(const std::size_t& Id, const std::size_t& Level) {return bf_t(new BasisFunctionType(Id));}
+
+    static void SetLevel(const cell_t& p_cell, const std::size_t& Level) {}
+
+    static void LinkCell(const cell_t& p_cell, const bf_t& p_bf) {}
+};
+
+/// Helper to store the cells and basis functions of the hierarchical B-Splines FESpace. The knots are the shared objects of the
+/// global knot vectors, hence they are identified by their addresses; the cells keep the links to their basis functions.
+template<int TDim>
+struct MultiPatchCheckpointPBBSplinesHelper<HBSplinesFESpace<TDim> >
+{
+    typedef typename HBSplinesFESpace<TDim>::knot_t knot_t;
+    typedef typename HBSplinesFESpace<TDim>::bf_t bf_t;
+    typedef typename HBSplinesFESpace<TDim>::cell_t cell_t;
+    typedef typename HBSplinesFESpace<TDim>::BasisFunctionType BasisFunctionType;
+    typedef std::map<const void*, MultiPatchCheckpointLayout::WordType> knot_index_t;
+
+    static void AddKnot(knot_index_t& rKnotIndex, const knot_t& pKnot, const MultiPatchCheckpointLayout::WordType& i) {rKnotIndex[&(*pKnot)] = i;}
+
+    static MultiPatchCheckpointLayout::WordType GetKnotIndex(const knot_index_t& rKnotIndex, const knot_t& pKnot)
+    {
+        typename knot_index_t::const_iterator it = rKnotIndex.find(&(*pKnot));
+        if (it == rKnotIndex.end())
+            KRATOS_THROW_ERROR(std::logic_error, "The knot does not belong to the knot vector of the FESpace:", pKnot->Value())
+        return it->second;
+    }
+
+    static std::size_t Level(const bf_t& p_bf) {return p_bf->Level();}
+
+    static bf_t CreateBf(const std::size_t& Id, const std::size_t& Level) {return bf_t(new BasisFunctionType(Id, Level));}
+
+    static void SetLevel(const cell_t& p_cell, const std::size_t& Level) {p_cell->SetLevel(Level);}
+
+    static void LinkCell(const cell_t& p_cell, const bf_t& p_bf) {p_cell->AddBf(p_bf);}
+};
+
+/**
+Write the MultiPatch to a binary checkpoint, which can be restored by MultiPatchCheckpointReader.
+Supported FESpaces are B-Splines, hierarchical B-Splines and T-Splines; the grid functions of double, array_1d and Vector
+variables are stored by variable name.
+ */
+class MultiPatchCheckpointWriter
+{
+public:
+    /// Pointer definition
+    KRATOS_CLASS_POINTER_DEFINITION(MultiPatchCheckpointWriter);
+
+    /// Type definitions
+    typedef MultiPatchCheckpointLayout LayoutType;
+    typedef LayoutType::WordType WordType;
+    typedef ControlPoint<double> ControlPointType;
+
+    /// Default constructor
+    MultiPatchCheckpointWriter() {}
+
+    /// Destructor
+    virtual ~MultiPatchCheckpointWriter() {}
+
+    /// Export the multipatch to the checkpoint file
+    template<int TDim>
+    void Export(typename MultiPatch<TDim>::Pointer pMultiPatch, const std::string& filename) const
+    {
+        std::ofstream outfile(filename.c_str(), std::ios::out | std::ios::binary);
+        if (!outfile)
+            KRATOS_THROW_ERROR(std::logic_error, "Error open file", filename)
+
+        LayoutType::Header header;
+        std::memcpy(header.Magic, LayoutType::Magic(), 8);
+        header.Version = LayoutType::Version;
+        header.ByteOrder = LayoutType::ByteOrderMark;
+        header.Dimension = TDim;
+        header.NumberOfPatches = pMultiPatch->size();
+        header.NumberOfInterfaces = 0;
+        header.IndexOffset = 0;
+        header.IsEnumerated = pMultiPatch->IsEnumerated() ? 1 : 0;
+        header.FirstEquationId = header.IsEnumerated ? pMultiPatch->GetFirstEquationId() : 0;
+        LayoutType::Write(outfile, header);
+
+        // patch records
+        std::vector<LayoutType::PatchIndexRecord> index;
+        typedef typename MultiPatch<TDim>::patch_ptr_iterator patch_ptr_iterator;
+        for (patch_ptr_iterator it = pMultiPatch->Patches().ptr_begin(); it != pMultiPatch->Patches().ptr_end(); ++it)
+        {
+            LayoutType::PatchIndexRecord record;
+            record.Id = (*it)->Id();
+            record.Offset = static_cast<WordType>(outfile.tellp());
+            WritePatch<TDim>(outfile, *it);
+            record.Size = static_cast<WordType>(outfile.tellp()) - record.Offset;
+            index.push_back(record);
+        }
+
+        // interface table
+        std::vector<LayoutType::InterfaceRecord> interfaces;
+        std::map<const PatchInterface<TDim>*, int64_t> interface_index;
+        std::vector<const PatchInterface<TDim>*> others;
+        typedef typename Patch<TDim>::interface_iterator interface_iterator;
+        for (patch_ptr_iterator it = pMultiPatch->Patches().ptr_begin(); it != pMultiPatch->Patches().ptr_end(); ++it)
+        {
+            for (interface_iterator it2 = (*it)->InterfaceBegin(); it2 != (*it)->InterfaceEnd(); ++it2)
+            {
+                const PatchInterface<TDim>& rInterface = *(*it2);
+
+                LayoutType::InterfaceRecord record;
+                record.Patch1 = rInterface.pPatch1()->Id();
+                record.Side1 = static_cast<WordType>(rInterface.Side1());
+                record.Patch2 = rInterface.pPatch2()->Id();
+                record.Side2 = static_cast<WordType>(rInterface.Side2());
+                record.LocalParameterMap = 0;
+                record.Direction1 = static_cast<int64_t>(_UNDEFINED_DIR_);
+                record.Direction2 = static_cast<int64_t>(_UNDEFINED_DIR_);
+                record.OtherInterface = -1;
+
+                if (typeid(rInterface) == typeid(BSplinesPatchInterface<TDim>))
+                {
+                    const BSplinesPatchInterface<TDim>& rBInterface = dynamic_cast<const BSplinesPatchInterface<TDim>&>(rInterface);
+                    record.Kind = LayoutType::BSPLINES_INTERFACE;
+                    record.LocalParameterMap = rBInterface.LocalParameterMapping(0);
+                    record.Direction1 = static_cast<int64_t>(rBInterface.Direction(0));
+                    record.Direction2 = static_cast<int64_t>(rBInterface.Direction(1));
+                }
+                else if (typeid(rInterface) == typeid(PatchInterface<TDim>))
+                {
+                    record.Kind = LayoutType::GENERIC_INTERFACE;
+                }
+                else
+                    KRATOS_THROW_ERROR(std::logic_error, "The checkpoint does not support the interface type", typeid(rInterface).name())
+
+                interface_index[&rInterface] = interfaces.size();
+                typename PatchInterface<TDim>::Pointer pOther = rInterface.pOtherInterface();
+                others.push_back(pOther ? &(*pOther) : NULL);
+                interfaces.push_back(record);
+            }
+        }
+
+        for (std::size_t i = 0; i < interfaces.size(); ++i)
+        {
+            if (others[i] == NULL) continue;
+            typename std::map<const PatchInterface<TDim>*, int64_t>::const_iterator it = interface_index.find(others[i]);
+            if (it != interface_index.end())
+                interfaces[i].OtherInterface = it->second;
+        }
+
+        header.NumberOfInterfaces = interfaces.size();
+        header.IndexOffset = static_cast<WordType>(outfile.tellp());
+        for (std::size_t i = 0; i < index.size(); ++i)
+            LayoutType::Write(outfile, index[i]);
+        for (std::size_t i = 0; i < interfaces.size(); ++i)
+            LayoutType::Write(outfile, interfaces[i]);
+
+        // rewrite the header with the final offsets
+        outfile.seekp(0);
+        LayoutType::Write(outfile, header);
+
+        if (!outfile)
+            KRATOS_THROW_ERROR(std::runtime_error, "Error writing the MultiPatch checkpoint", filename)
+        outfile.close();
+
+        std::cout << __FUNCTION__ << ": Write " << index.size() << " patches and " << interfaces.size()
+                  << " interfaces to " << filename << " completed" << std::endl;
+    }
+
+    /// Information
+    virtual void PrintInfo(std::ostream& rOStream) const
+    {
+        rOStream << "MultiPatchCheckpointWriter";
+    }
+
+    virtual void PrintData(std::ostream& rOStream) const
+    {
+    }
+
+private:
+
+    template<int TDim>
+    static void WritePatch(std::ostream& rOStream, typename Patch<TDim>::Pointer pPatch)
+    {
+        LayoutType::Write(rOStream, static_cast<WordType>(pPatch->Id()));
+        LayoutType::Write(rOStream, static_cast<int64_t>(pPatch->LayerIndex()));
+        LayoutType::WriteString(rOStream, pPatch->Prefix());
+
+        if (pPatch->pFESpace()->Type() == BSplinesFESpace<TDim>::StaticType())
+        {
+            LayoutType::Write(rOStream, static_cast<WordType>(LayoutType::BSPLINES));
+
+            typename BSplinesFESpace<TDim>::Pointer pFESpace = boost::dynamic_pointer_cast<BSplinesFESpace<TDim> >(pPatch->pFESpace());
+            for (std::size_t dim = 0; dim < TDim; ++dim)
+            {
+                LayoutType::Write(rOStream, static_cast<WordType>(pFESpace->Order(dim)));
+                LayoutType::Write(rOStream, static_cast<WordType>(pFESpace->Number(dim)));
+                std::vector<double> knots(pFESpace->KnotVector(dim).size());
+                for (std::size_t i = 0; i < knots.size(); ++i)
+                    knots[i] = pFESpace->KnotVector(dim).pKnotAt(i)->Value();
+                LayoutType::WriteArray(rOStream, knots);
+            }
+
+            std::vector<std::size_t> func_indices = pFESpace->FunctionIndices();
+            LayoutType::WriteArray(rOStream, std::vector<WordType>(func_indices.begin(), func_indices.end()));
+
+            WriteGridFunctions<TDim, BSplinesFESpace<TDim> >(rOStream, pPatch, pFESpace);
+        }
+        else if (pPatch->pFESpace()->Type() == HBSplinesFESpace<TDim>::StaticType())
+        {
+            LayoutType::Write(rOStream, static_cast<WordType>(LayoutType::HBSPLINES));
+
+            typename HBSplinesFESpace<TDim>::Pointer pFESpace = boost::dynamic_pointer_cast<HBSplinesFESpace<TDim> >(pPatch->pFESpace());
+            WriteHBSplinesFESpace<TDim>(rOStream, pFESpace);
+
+            WriteGridFunctions<TDim, HBSplinesFESpace<TDim> >(rOStream, pPatch, pFESpace);
+        }
+        else if (pPatch->pFESpace()->Type() == MultiPatchCheckpointTSplinesFESpace<TDim>::Type::StaticType())
+        {
+            typedef typename MultiPatchCheckpointTSplinesFESpace<TDim>::Type TSplinesFESpaceType;
+
+            LayoutType::Write(rOStream, static_cast<WordType>(LayoutType::TSPLINES));
+
+            typename TSplinesFESpaceType::Pointer pFESpace = boost::dynamic_pointer_cast<TSplinesFESpaceType>(pPatch->pFESpace());
+            if (pFESpace == NULL)
+                KRATOS_THROW_ERROR(std::logic_error, "The checkpoint does not support the T-Splines FESpace with the cell type of", pPatch->pFESpace()->Type())
+            WriteTSplinesFESpace<TDim>(rOStream, pFESpace);
+
+            WriteGridFunctions<TDim, TSplinesFESpaceType>(rOStream, pPatch, pFESpace);
+        }
+        else
+            KRATOS_THROW_ERROR(std::logic_error, "The checkpoint does not support the FESpace", pPatch->pFESpace()->Type())
+    }
+
+    template<int TDim>
+    static void WriteHBSplinesFESpace(std::ostream& rOStream, typename HBSplinesFESpace<TDim>::Pointer pFESpace)
+    {
+        typedef MultiPatchCheckpointPBBSplinesHelper<HBSplinesFESpace<TDim> > HelperType;
+        typedef typename HBSplinesFESpace<TDim>::knot_t knot_t;
+
+        // global knot vectors. The knots of the cells and basis functions are referred by their position in these vectors.
+        std::vector<typename HelperType::knot_index_t> knot_index(TDim);
+        for (std::size_t dim = 0; dim < TDim; ++dim)
+        {
+            LayoutType::Write(rOStream, static_cast<WordType>(pFESpace->Order(dim)));
+            std::vector<double> knots(pFESpace->KnotVector(dim).size());
+            for (std::size_t i = 0; i < knots.size(); ++i)
+            {
+                knot_t pKnot = pFESpace->KnotVector(dim).pKnotAt(i);
+                knots[i] = pKnot->Value();
+                HelperType::AddKnot(knot_index[dim], pKnot, i);
+            }
+            LayoutType::WriteArray(rOStream, knots);
+        }
+
+        LayoutType::Write(rOStream, static_cast<WordType>(pFESpace->LastLevel()));
+        LayoutType::Write(rOStream, static_cast<WordType>(pFESpace->MaxLevel()));
+        const std::vector<std::size_t>& history = pFESpace->RefinementHistory();
+        LayoutType::WriteArray(rOStream, std::vector<WordType>(history.begin(), history.end()));
+
+        WritePBBSplinesTopology<TDim, HBSplinesFESpace<TDim> >(rOStream, pFESpace, knot_index);
+    }
+
+    template<int TDim>
+    static void WriteTSplinesFESpace(std::ostream& rOStream, typename MultiPatchCheckpointTSplinesFESpace<TDim>::Type::Pointer pFESpace)
+    {
+        typedef typename MultiPatchCheckpointTSplinesFESpace<TDim>::Type TSplinesFESpaceType;
+        typedef MultiPatchCheckpointPBBSplinesHelper<TSplinesFESpaceType> HelperType;
+        typedef typename TSplinesFESpaceType::cell_container_t cell_container_t;
+        typedef typename TSplinesFESpaceType::bf_iterator bf_iterator;
+
+        // knot tables, which are the sorted values of all the knots of the cells, faces and basis functions
+        std::vector<std::set<double> > knot_values(TDim);
+        for (bf_iterator it = pFESpace->bf_begin(); it != pFESpace->bf_end(); ++it)
+            for (std::size_t dim = 0; dim < TDim; ++dim)
+                knot_values[dim].insert((*it)->LocalKnots(dim).begin(), (*it)->LocalKnots(dim).end());
+        const cell_container_t* pCellManagers[] = {&(*pFESpace->pCellManager()), &(*pFESpace->pFaceManager())};
+        for (std::size_t k = 0; k < 2; ++k)
+        {
+            for (typename cell_container_t::const_iterator it = pCellManagers[k]->begin(); it != pCellManagers[k]->end(); ++it)
+            {
+                const double bounds[] = {(*it)->XiMin(), (*it)->XiMax(), (*it)->EtaMin(), (*it)->EtaMax(), (*it)->ZetaMin(), (*it)->ZetaMax()};
+                for (std::size_t i = 0; i < 2*TDim; ++i)
+                    knot_values[i/2].insert(bounds[i]);
+            }
+        }
+
+        std::vector<typename HelperType::knot_index_t> knot_index(TDim);
+        for (std::size_t dim = 0; dim < TDim; ++dim)
+        {
+            LayoutType::Write(rOStream, static_cast<WordType>(pFESpace->Order(dim)));
+            std::vector<double> knots(knot_values[dim].begin(), knot_values[dim].end());
+            for (std::size_t i = 0; i < knots.size(); ++i)
+                HelperType::AddKnot(knot_index[dim], knots[i], i);
+            LayoutType::WriteArray(rOStream, knots);
+        }
+
+        WritePBBSplinesTopology<TDim, TSplinesFESpaceType>(rOStream, pFESpace, knot_index);
+        WriteCells<TDim, TSplinesFESpaceType>(rOStream, *(pFESpace->pFaceManager()), knot_index);
+    }
+
+    /// Write the cells and the basis functions of the point-based B-Splines FESpace. The knots are written by their positions
+    /// in the knot tables.
+    template<int TDim, class TFESpaceType>
+    static void WritePBBSplinesTopology(std::ostream& rOStream, typename TFESpaceType::Pointer pFESpace,
+            const std::vector<typename MultiPatchCheckpointPBBSplinesHelper<TFESpaceType>::knot_index_t>& knot_index)
+    {
+        typedef MultiPatchCheckpointPBBSplinesHelper<TFESpaceType> HelperType;
+        typedef typename TFESpaceType::knot_t knot_t;
+        typedef typename TFESpaceType::bf_iterator bf_iterator;
+        typedef typename TFESpaceType::BasisFunctionType::cell_iterator bf_cell_iterator;
+
+        // cells
+        WriteCells<TDim, TFESpaceType>(rOStream, *(pFESpace->pCellManager()), knot_index);
+
+        // basis functions
+        LayoutType::Write(rOStream, static_cast<WordType>(pFESpace->TotalNumber()));
+        std::vector<WordType> indices;
+        for (bf_iterator it = pFESpace->bf_begin(); it != pFESpace->bf_end(); ++it)
+        {
+            LayoutType::Write(rOStream, static_cast<WordType>((*it)->Id()));
+            LayoutType::Write(rOStream, static_cast<WordType>(HelperType::Level(*it)));
+            LayoutType::Write(rOStream, static_cast<WordType>((*it)->EquationId()));
+            LayoutType::Write(rOStream, static_cast<WordType>((*it)->BoundaryId()));
+
+            for (std::size_t dim = 0; dim < TDim; ++dim)
+            {
+                const std::vector<knot_t>& pLocalKnots = (*it)->LocalKnots(dim);
+                indices.resize(pLocalKnots.size());
+                for (std::size_t i = 0; i < pLocalKnots.size(); ++i)
+                    indices[i] = HelperType::GetKnotIndex(knot_index[dim], pLocalKnots[i]);
+                LayoutType::WriteArray(rOStream, indices);
+            }
+
+            indices.clear();
+            for (bf_cell_iterator it_cell = (*it)->cell_begin(); it_cell != (*it)->cell_end(); ++it_cell)
+                indices.push_back((*it_cell)->Id());
+            LayoutType::WriteArray(rOStream, indices);
+        }
+    }
+
+    /// Write the cells with their ids, levels and the positions of their bounding knots in the knot tables
+    template<int TDim, class TFESpaceType>
+    static void WriteCells(std::ostream& rOStream, const typename TFESpaceType::cell_container_t& rCells,
+            const std::vector<typename MultiPatchCheckpointPBBSplinesHelper<TFESpaceType>::knot_index_t>& knot_index)
+    {
+        typedef MultiPatchCheckpointPBBSplinesHelper<TFESpaceType> HelperType;
+        typedef typename TFESpaceType::knot_t knot_t;
+        typedef typename TFESpaceType::cell_container_t cell_container_t;
+
+        LayoutType::Write(rOStream, static_cast<WordType>(rCells.size()));
+        for (typename cell_container_t::const_iterator it = rCells.begin(); it != rCells.end(); ++it)
+        {
+            LayoutType::Write(rOStream, static_cast<WordType>((*it)->Id()));
+            LayoutType::Write(rOStream, static_cast<WordType>((*it)->Level()));
+            const knot_t pKnots[] = {(*it)->XiMin(), (*it)->XiMax(), (*it)->EtaMin(), (*it)->EtaMax(), (*it)->ZetaMin(), (*it)->ZetaMax()};
+            for (std::size_t i = 0; i < 2*TDim; ++i)
+                LayoutType::Write(rOStream, HelperType::GetKnotIndex(knot_index[i/2], pKnots[i]));
+        }
+    }
+
+    template<int TDim, class TFESpaceType>
+    static void WriteGridFunctions(std::ostream& rOStream, typename Patch<TDim>::Pointer pPatch, typename TFESpaceType::Pointer pFESpace)
+    {
+        WriteGridValues<TDim, TFESpaceType>(rOStream, pPatch, pFESpace, CONTROL_POINT);
+
+        std::vector<Variable<double>*> double_var_list = pPatch->template ExtractVariables<Variable<double> >();
+        std::vector<Variable<array_1d<double, 3> >*> array1d_var_list = pPatch->template ExtractVariables<Variable<array_1d<double, 3> > >();
+        std::vector<Variable<Vector>*> vector_var_list = pPatch->template ExtractVariables<Variable<Vector> >();
+
+        // the control point coordinates grid is derived from the control point grid
+        std::size_t ngrids = double_var_list.size() + array1d_var_list.size() + vector_var_list.size();
+        for (std::size_t i = 0; i < array1d_var_list.size(); ++i)
+            if (*array1d_var_list[i] == CONTROL_POINT_COORDINATES)
+                --ngrids;
+        LayoutType::Write(rOStream, static_cast<WordType>(ngrids));
+
+        for (std::size_t i = 0; i < double_var_list.size(); ++i)
+        {
+            LayoutType::Write(rOStream, static_cast<WordType>(LayoutType::DOUBLE_GRID));
+            WriteGridValues<TDim, TFESpaceType>(rOStream, pPatch, pFESpace, *double_var_list[i]);
+        }
+
+        for (std::size_t i = 0; i < array1d_var_list.size(); ++i)
+        {
+            if (*array1d_var_list[i] == CONTROL_POINT_COORDINATES) continue;
+            LayoutType::Write(rOStream, static_cast<WordType>(LayoutType::ARRAY_1D_GRID));
+            WriteGridValues<TDim, TFESpaceType>(rOStream, pPatch, pFESpace, *array1d_var_list[i]);
+        }
+
+        for (std::size_t i = 0; i < vector_var_list.size(); ++i)
+        {
+            LayoutType::Write(rOStream, static_cast<WordType>(LayoutType::VECTOR_GRID));
+            WriteGridValues<TDim, TFESpaceType>(rOStream, pPatch, pFESpace, *vector_var_list[i]);
+        }
+    }
+
+    /// Write the values of the grid function in the order of the basis functions of the FESpace
+    template<int TDim, class TFESpaceType, class TVariableType>
+    static void WriteGridValues(std::ostream& rOStream, typename Patch<TDim>::Pointer pPatch, typename TFESpaceType::Pointer pFESpace,
+            const TVariableType& rVariable)
+    {
+        LayoutType::WriteString(rOStream, rVariable.Name());
+        LayoutType::Write(rOStream, static_cast<WordType>(pFESpace->TotalNumber()));
+        GridValuesWriter<TDim, TFESpaceType, TVariableType>::Execute(rOStream, pPatch, pFESpace, rVariable);
+    }
+
+    template<int TDim, class TFESpaceType, class TVariableType>
+    struct GridValuesWriter
+    {
+        /// The values of the structured grid are accessed directly by index
+        static void Execute(std::ostream& rOStream, typename Patch<TDim>::Pointer pPatch, typename TFESpaceType::Pointer pFESpace,
+                const TVariableType& rVariable)
+        {
+            typename ControlGrid<typename TVariableType::Type>::Pointer pControlGrid = pPatch->pGetGridFunction(rVariable)->pControlGrid();
+            const ControlGrid<typename TVariableType::Type>& rControlGrid = *pControlGrid;
+            for (std::size_t i = 0; i < rControlGrid.size(); ++i)
+                LayoutType::WriteValue(rOStream, rControlGrid[i]);
+        }
+    };
+
+    template<int TDim, class TFESpaceType, class TVariableType>
+    struct PointBasedGridValuesWriter
+    {
+        /// The point-based grid accesses the basis function by index in linear time, hence the basis functions are visited directly
+        static void Execute(std::ostream& rOStream, typename Patch<TDim>::Pointer pPatch, typename TFESpaceType::Pointer pFESpace,
+                const TVariableType& rVariable)
+        {
+            for (typename TFESpaceType::bf_iterator it = pFESpace->bf_begin(); it != pFESpace->bf_end(); ++it)
+                LayoutType::WriteValue(rOStream, (*it)->GetValue(rVariable));
+        }
+    };
+
+    template<int TDim, class TVariableType>
+    struct GridValuesWriter<TDim, HBSplinesFESpace<TDim>, TVariableType>
+    : public PointBasedGridValuesWriter<TDim, HBSplinesFESpace<TDim>, TVariableType>
+    {};
+
+    template<int TDim, class TVariableType>
+    struct GridValuesWriter<TDim, TSplinesFESpace<TDim, PBBSplinesBasisFunction<TDim, TCell>, BCellManager<TDim, TCell> >, TVariableType>
+    : public PointBasedGridValuesWriter<TDim, TSplinesFESpace<TDim, PBBSplinesBasisFunction<TDim, TCell>, BCellManager<TDim, TCell> >, TVariableType>
+    {};
+
+}; // end class MultiPatchCheckpointWriter
+
+/**
+Read the MultiPatch checkpoint written by MultiPatchCheckpointWriter. Only the header, the patch index and the interface
+table are read at construction; the patches are read on demand, either one by one or as a (sub-)multipatch.
+The hierarchical B-Splines patch is restored with its cells, basis functions and refinement history, and the T-Splines
+patch with its cells, faces and basis functions. As after the refinement, UpdateCells shall be called before the
+extraction operators of the cells are used.
+ */
+template<int TDim>
+class MultiPatchCheckpointReader
+{
+public:
+    /// Pointer definition
+    KRATOS_CLASS_POINTER_DEFINITION(MultiPatchCheckpointReader);
+
+    /// Type definitions
+    typedef MultiPatchCheckpointLayout LayoutType;
+    typedef LayoutType::WordType WordType;
+    typedef ControlPoint<double> ControlPointType;
+    typedef typename MultiPatchCheckpointTSplinesFESpace<TDim>::Type TSplinesFESpaceType;
+
+    /// Constructor with the checkpoint file
+    MultiPatchCheckpointReader(const std::string& filename) : mFileName(filename)
+    {
+        std::ifstream infile(filename.c_str(), std::ios::in | std::ios::binary);
+        if (!infile)
+            KRATOS_THROW_ERROR(std::logic_error, "Error open file", filename)
+
+        LayoutType::Read(infile, mHeader);
+        if (std::strncmp(mHeader.Magic, LayoutType::Magic(), 8) != 0)
+            KRATOS_THROW_ERROR(std::logic_error, "The file is not a MultiPatch checkpoint:", filename)
+        if (mHeader.Version != LayoutType::Version)
+            KRATOS_THROW_ERROR(std::logic_error, "Unsupported MultiPatch checkpoint version", mHeader.Version)
+        if (mHeader.ByteOrder != LayoutType::ByteOrderMark)
+            KRATOS_THROW_ERROR(std::logic_error, "The MultiPatch checkpoint was written with a different byte order:", filename)
+        if (mHeader.Dimension != TDim)
+        {
+            std::stringstream ss;
+            ss << "The MultiPatch checkpoint " << filename << " has dimension " << mHeader.Dimension << ", expected " << TDim;
+            KRATOS_THROW_ERROR(std::logic_error, ss.str(), "")
+        }
+
+        infile.seekg(mHeader.IndexOffset);
+        mIndex.resize(mHeader.NumberOfPatches);
+        for (std::size_t i = 0; i < mIndex.size(); ++i)
+            LayoutType::Read(infile, mIndex[i]);
+        mInterfaces.resize(mHeader.NumberOfInterfaces);
+        for (std::size_t i = 0; i < mInterfaces.size(); ++i)
+            LayoutType::Read(infile, mInterfaces[i]);
+
+        infile.close();
+    }
+
+    /// Destructor
+    virtual ~MultiPatchCheckpointReader() {}
+
+    /// Get the number of patches in the checkpoint
+    std::size_t NumberOfPatches() const {return mIndex.size();}
+
+    /// Get the ids of the patches in the checkpoint
+    std::vector<std::size_t> PatchIds() const
+    {
+        std::vector<std::size_t> ids(mIndex.size());
+        for (std::size_t i = 0; i < mIndex.size(); ++i)
+            ids[i] = mIndex[i].Id;
+        return ids;
+    }
+
+    /// Check if the patch is in the checkpoint
+    bool HasPatch(const std::size_t& Id) const
+    {
+        for (std::size_t i = 0; i < mIndex.size(); ++i)
+            if (mIndex[i].Id == Id)
+                return true;
+        return false;
+    }
+
+    /// Read a single patch. The interfaces are not restored.
+    typename Patch<TDim>::Pointer pReadPatch(const std::size_t& Id) const
+    {
+        std::ifstream infile(mFileName.c_str(), std::ios::in | std::ios::binary);
+        if (!infile)
+            KRATOS_THROW_ERROR(std::logic_error, "Error open file", mFileName)
+        return this->ReadPatch(infile, this->GetIndexRecord(Id));
+    }
+
+    /// Read all the patches and the interfaces
+    typename MultiPatch<TDim>::Pointer pReadMultiPatch() const
+    {
+        return this->pReadMultiPatch(this->PatchIds());
+    }
+
+    /// Read the given patches and the interfaces between them. The multipatch is enumerated as in the checkpoint only
+    /// if all the patches are read.
+    typename MultiPatch<TDim>::Pointer pReadMultiPatch(const std::vector<std::size_t>& patch_ids) const
+    {
+        std::ifstream infile(mFileName.c_str(), std::ios::in | std::ios::binary);
+        if (!infile)
+            KRATOS_THROW_ERROR(std::logic_error, "Error open file", mFileName)
+
+        typename MultiPatch<TDim>::Pointer pNewMultiPatch = typename MultiPatch<TDim>::Pointer(new MultiPatch<TDim>());
+        std::map<std::size_t, typename Patch<TDim>::Pointer> patches;
+        for (std::size_t i = 0; i < patch_ids.size(); ++i)
+        {
+            typename Patch<TDim>::Pointer pNewPatch = this->ReadPatch(infile, this->GetIndexRecord(patch_ids[i]));
+            patches[patch_ids[i]] = pNewPatch;
+            pNewMultiPatch->AddPatch(pNewPatch);
+        }
+        infile.close();
+
+        // restore the interfaces between the read patches
+        std::vector<typename PatchInterface<TDim>::Pointer> pInterfaces(mInterfaces.size());
+        for (std::size_t i = 0; i < mInterfaces.size(); ++i)
+        {
+            const LayoutType::InterfaceRecord& rRecord = mInterfaces[i];
+
+            typename std::map<std::size_t, typename Patch<TDim>::Pointer>::iterator it1 = patches.find(rRecord.Patch1);
+            typename std::map<std::size_t, typename Patch<TDim>::Pointer>::iterator it2 = patches.find(rRecord.Patch2);
+            if ((it1 == patches.end()) || (it2 == patches.end()))
+                continue;
+
+            const BoundarySide side1 = static_cast<BoundarySide>(rRecord.Side1);
+            const BoundarySide side2 = static_cast<BoundarySide>(rRecord.Side2);
+            if (rRecord.Kind == LayoutType::BSPLINES_INTERFACE)
+                pInterfaces[i] = MultiPatchCheckpointInterfaceHelper<TDim>::Create(it1->second, side1, it2->second, side2, rRecord);
+            else
+                pInterfaces[i] = typename PatchInterface<TDim>::Pointer(new PatchInterface<TDim>(it1->second, side1, it2->second, side2));
+        }
+
+        for (std::size_t i = 0; i < mInterfaces.size(); ++i)
+        {
+            if (!pInterfaces[i]) continue;
+
+            const int64_t& other = mInterfaces[i].OtherInterface;
+            if ((other >= 0) && pInterfaces[other])
+                pInterfaces[i]->SetOtherInterface(pInterfaces[other]);
+            pInterfaces[i]->pPatch1()->AddInterface(pInterfaces[i]);
+        }
+
+        if (mHeader.IsEnumerated && (patch_ids.size() == mIndex.size()))
+            pNewMultiPatch->Enumerate(mHeader.FirstEquationId);
+
+        return pNewMultiPatch;
+    }
+
+    /// Information
+    virtual void PrintInfo(std::ostream& rOStream) const
+    {
+        rOStream << "MultiPatchCheckpointReader" << TDim << "D";
+    }
+
+    virtual void PrintData(std::ostream& rOStream) const
+    {
+        rOStream << " File: " << mFileName << std::endl;
+        rOStream << " Number of patches: " << mIndex.size() << std::endl;
+        rOStream << " Number of interfaces: " << mInterfaces.size() << std::endl;
+    }
+
+private:
+
+    std::string mFileName;
+    LayoutType::Header mHeader;
+    std::vector<LayoutType::PatchIndexRecord> mIndex;
+    std::vector<LayoutType::InterfaceRecord> mInterfaces;
+
+    const LayoutType::PatchIndexRecord& GetIndexRecord(const std::size_t& Id) const
+    {
+        for (std::size_t i = 0; i < mIndex.size(); ++i)
+            if (mIndex[i].Id == Id)
+                return mIndex[i];
+        std::stringstream ss;
+        ss << "The patch " << Id << " does not exist in the MultiPatch checkpoint " << mFileName;
+        KRATOS_THROW_ERROR(std::logic_error, ss.str(), "")
+    }
+
+    typename Patch<TDim>::Pointer ReadPatch(std::istream& rIStream, const LayoutType::PatchIndexRecord& rRecord) const
+    {
+        rIStream.seekg(rRecord.Offset);
+
+        const std::size_t Id = LayoutType::ReadWord(rIStream);
+        int64_t layer_index;
+        LayoutType::Read(rIStream, layer_index);
+        const std::string prefix = LayoutType::ReadString(rIStream);
+
+        typename Patch<TDim>::Pointer pNewPatch;
+        const WordType kind = LayoutType::ReadWord(rIStream);
+        if (kind == LayoutType::BSPLINES)
+            pNewPatch = this->ReadBSplinesPatch(rIStream, Id);
+        else if (kind == LayoutType::HBSPLINES)
+            pNewPatch = this->ReadHBSplinesPatch(rIStream, Id);
+        else if (kind == LayoutType::TSPLINES)
+            pNewPatch = this->ReadTSplinesPatch(rIStream, Id);
+        else
+            KRATOS_THROW_ERROR(std::logic_error, "Unknown FESpace in the MultiPatch checkpoint:", kind)
+
+        pNewPatch->SetPrefix(prefix);
+        pNewPatch->SetLayerIndex(static_cast<int>(layer_index));
+
+        if (static_cast<WordType>(rIStream.tellg()) - rRecord.Offset != rRecord.Size)
+            KRATOS_THROW_ERROR(std::runtime_error, "The MultiPatch checkpoint is corrupted at patch", Id)
+
+        return pNewPatch;
+    }
+
+    typename Patch<TDim>::Pointer ReadBSplinesPatch(std::istream& rIStream, const std::size_t& Id) const
+    {
+        typename BSplinesFESpace<TDim>::Pointer pNewFESpace = BSplinesFESpace<TDim>::Create();
+        std::vector<std::size_t> numbers(TDim);
+        std::vector<double> knots;
+        for (std::size_t dim = 0; dim < TDim; ++dim)
+        {
+            const std::size_t order = LayoutType::ReadWord(rIStream);
+            numbers[dim] = LayoutType::ReadWord(rIStream);
+            LayoutType::ReadArray(rIStream, knots);
+            pNewFESpace->SetKnotVector(dim, knots);
+            pNewFESpace->SetInfo(dim, numbers[dim], order);
+        }
+
+        std::vector<WordType> func_indices;
+        LayoutType::ReadArray(rIStream, func_indices);
+        pNewFESpace->ResetFunctionIndices(std::vector<std::size_t>(func_indices.begin(), func_indices.end()));
+
+        typename Patch<TDim>::Pointer pNewPatch = Patch<TDim>::Create(Id, pNewFESpace);
+        this->ReadGridFunctions<BSplinesFESpace<TDim> >(rIStream, pNewPatch, pNewFESpace, numbers);
+
+        return pNewPatch;
+    }
+
+    typename Patch<TDim>::Pointer ReadHBSplinesPatch(std::istream& rIStream, const std::size_t& Id) const
+    {
+        typedef typename HBSplinesFESpace<TDim>::knot_t knot_t;
+
+        typename HBSplinesFESpace<TDim>::Pointer pNewFESpace = HBSplinesFESpace<TDim>::Create();
+
+        std::vector<double> knots;
+        std::vector<std::vector<knot_t> > knot_tables(TDim);
+        for (std::size_t dim = 0; dim < TDim; ++dim)
+        {
+            pNewFESpace->SetInfo(dim, LayoutType::ReadWord(rIStream));
+            LayoutType::ReadArray(rIStream, knots);
+            pNewFESpace->KnotVector(dim).clear();
+            for (std::size_t i = 0; i < knots.size(); ++i)
+                knot_tables[dim].push_back(pNewFESpace->KnotVector(dim).pCreateKnot(knots[i]));
+        }
+
+        pNewFESpace->SetLastLevel(LayoutType::ReadWord(rIStream));
+        pNewFESpace->SetMaxLevel(LayoutType::ReadWord(rIStream));
+        std::vector<WordType> history;
+        LayoutType::ReadArray(rIStream, history);
+        pNewFESpace->ClearRefinementHistory();
+        for (std::size_t i = 0; i < history.size(); ++i)
+            pNewFESpace->RecordRefinementHistory(history[i]);
+
+        this->ReadPBBSplinesTopology<HBSplinesFESpace<TDim> >(rIStream, pNewFESpace, knot_tables);
+
+        typename Patch<TDim>::Pointer pNewPatch = Patch<TDim>::Create(Id, pNewFESpace);
+        this->ReadGridFunctions<HBSplinesFESpace<TDim> >(rIStream, pNewPatch, pNewFESpace, std::vector<std::size_t>());
+
+        return pNewPatch;
+    }
+
+    typename Patch<TDim>::Pointer ReadTSplinesPatch(std::istream& rIStream, const std::size_t& Id) const
+    {
+        typename TSplinesFESpaceType::Pointer pNewFESpace = TSplinesFESpaceType::Create();
+
+        std::vector<std::vector<double> > knot_tables(TDim);
+        for (std::size_t dim = 0; dim < TDim; ++dim)
+        {
+            pNewFESpace->SetInfo(dim, LayoutType::ReadWord(rIStream));
+            LayoutType::ReadArray(rIStream, knot_tables[dim]);
+        }
+
+        this->ReadPBBSplinesTopology<TSplinesFESpaceType>(rIStream, pNewFESpace, knot_tables);
+
+        std::map<std::size_t, typename TSplinesFESpaceType::cell_t> face_map;
+        this->ReadCells<TSplinesFESpaceType>(rIStream, *(pNewFESpace->pFaceManager()), knot_tables, face_map);
+
+        typename Patch<TDim>::Pointer pNewPatch = Patch<TDim>::Create(Id, pNewFESpace);
+        this->ReadGridFunctions<TSplinesFESpaceType>(rIStream, pNewPatch, pNewFESpace, std::vector<std::size_t>());
+
+        return pNewPatch;
+    }
+
+    /// Read the cells and the basis functions of the point-based B-Splines FESpace, whose knots are given by the knot tables
+    template<class TFESpaceType>
+    void ReadPBBSplinesTopology(std::istream& rIStream, typename TFESpaceType::Pointer pNewFESpace,
+            const std::vector<std::vector<typename TFESpaceType::knot_t> >& knot_tables) const
+    {
+        typedef MultiPatchCheckpointPBBSplinesHelper<TFESpaceType> HelperType;
+        typedef typename TFESpaceType::knot_t knot_t;
+        typedef typename TFESpaceType::cell_t cell_t;
+        typedef typename TFESpaceType::bf_t bf_t;
+
+        std::map<std::size_t, cell_t> cell_map;
+        this->ReadCells<TFESpaceType>(rIStream, *(pNewFESpace->pCellManager()), knot_tables, cell_map);
+
+        // basis functions
+        const std::size_t nbfs = LayoutType::ReadWord(rIStream);
+        std::vector<WordType> indices;
+        std::vector<knot_t> pLocalKnots;
+        std::vector<std::size_t> func_indices(nbfs);
+        for (std::size_t i = 0; i < nbfs; ++i)
+        {
+            const std::size_t bf_id = LayoutType::ReadWord(rIStream);
+            const std::size_t level = LayoutType::ReadWord(rIStream);
+            func_indices[i] = LayoutType::ReadWord(rIStream);
+            const std::size_t boundary_id = LayoutType::ReadWord(rIStream);
+
+            bf_t p_bf = HelperType::CreateBf(bf_id, level);
+            for (std::size_t dim = 0; dim < TDim; ++dim)
+            {
+                LayoutType::ReadArray(rIStream, indices);
+                pLocalKnots.resize(indices.size());
+                for (std::size_t j = 0; j < indices.size(); ++j)
+                    pLocalKnots[j] = knot_tables[dim].at(indices[j]);
+                p_bf->SetLocalKnotVectors(dim, pLocalKnots);
+                p_bf->SetInfo(dim, pNewFESpace->Order(dim));
+            }
+            p_bf->AddBoundary(boundary_id);
+
+            LayoutType::ReadArray(rIStream, indices);
+            for (std::size_t j = 0; j < indices.size(); ++j)
+            {
+                typename std::map<std::size_t, cell_t>::iterator it = cell_map.find(indices[j]);
+                if (it == cell_map.end())
+                    KRATOS_THROW_ERROR(std::runtime_error, "The cell does not exist in the MultiPatch checkpoint:", indices[j])
+                p_bf->AddCell(it->second);
+                HelperType::LinkCell(it->second, p_bf);
+            }
+
+            pNewFESpace->AddBf(p_bf);
+        }
+        pNewFESpace->ResetFunctionIndices(func_indices);
+    }
+
+    /// Read the cells into the cell manager. The cells are stored in increasing order of ids, hence they can be inserted
+    /// at once without searching.
+    template<class TFESpaceType>
+    void ReadCells(std::istream& rIStream, typename TFESpaceType::cell_container_t& rCells,
+            const std::vector<std::vector<typename TFESpaceType::knot_t> >& knot_tables,
+            std::map<std::size_t, typename TFESpaceType::cell_t>& cell_map) const
+    {
+        typedef MultiPatchCheckpointPBBSplinesHelper<TFESpaceType> HelperType;
+        typedef typename TFESpaceType::knot_t knot_t;
+        typedef typename TFESpaceType::cell_t cell_t;
+        typedef typename TFESpaceType::CellType CellType;
+
+        const std::size_t ncells = LayoutType::ReadWord(rIStream);
+        std::vector<cell_t> pCells(ncells);
+        knot_t pKnots[6];
+        for (std::size_t i = 0; i < ncells; ++i)
+        {
+            const std::size_t cell_id = LayoutType::ReadWord(rIStream);
+            const std::size_t level = LayoutType::ReadWord(rIStream);
+            for (std::size_t j = 0; j < 2*TDim; ++j)
+                pKnots[j] = knot_tables[j/2].at(LayoutType::ReadWord(rIStream));
+
+            if (TDim == 1)
+                pCells[i] = cell_t(new CellType(cell_id, pKnots[0], pKnots[1]));
+            else if (TDim == 2)
+                pCells[i] = cell_t(new CellType(cell_id, pKnots[0], pKnots[1], pKnots[2], pKnots[3]));
+            else if (TDim == 3)
+                pCells[i] = cell_t(new CellType(cell_id, pKnots[0], pKnots[1], pKnots[2], pKnots[3], pKnots[4], pKnots[5]));
+            HelperType::SetLevel(pCells[i], level);
+            cell_map[cell_id] = pCells[i];
+        }
+        rCells.insert(pCells);
+    }
+
+    template<class TFESpaceType>
+    void ReadGridFunctions(std::istream& rIStream, typename Patch<TDim>::Pointer pPatch, typename TFESpaceType::Pointer pFESpace,
+            const std::vector<std::size_t>& numbers) const
+    {
+        // the control point grid comes first since the other grid functions are weighted by its weights
+        const std::string name = LayoutType::ReadString(rIStream);
+        if (name != CONTROL_POINT.Name())
+            KRATOS_THROW_ERROR(std::runtime_error, "The MultiPatch checkpoint is corrupted, the control point grid is expected instead of", name)
+        typename ControlGrid<ControlPointType>::Pointer pControlPointGrid = GridValuesReader<TFESpaceType, Variable<ControlPointType> >::Execute(rIStream, pFESpace, CONTROL_POINT, numbers);
+        pPatch->CreateControlPointGridFunction(pControlPointGrid);
+
+        const std::size_t ngrids = LayoutType::ReadWord(rIStream);
+        for (std::size_t i = 0; i < ngrids; ++i)
+        {
+            const WordType kind = LayoutType::ReadWord(rIStream);
+            const std::string var_name = LayoutType::ReadString(rIStream);
+            if (!KratosComponents<VariableData>::Has(var_name))
+                KRATOS_THROW_ERROR(std::logic_error, "The variable in the MultiPatch checkpoint is not registered:", var_name)
+
+            if (kind == LayoutType::DOUBLE_GRID)
+                this->ReadGridFunction<TFESpaceType, Variable<double> >(rIStream, pPatch, pFESpace, var_name, numbers);
+            else if (kind == LayoutType::ARRAY_1D_GRID)
+                this->ReadGridFunction<TFESpaceType, Variable<array_1d<double, 3> > >(rIStream, pPatch, pFESpace, var_name, numbers);
+            else if (kind == LayoutType::VECTOR_GRID)
+                this->ReadGridFunction<TFESpaceType, Variable<Vector> >(rIStream, pPatch, pFESpace, var_name, numbers);
+            else
+                KRATOS_THROW_ERROR(std::logic_error, "Unknown grid function type in the MultiPatch checkpoint:", kind)
+        }
+    }
+
+    template<class TFESpaceType, class TVariableType>
+    void ReadGridFunction(std::istream& rIStream, typename Patch<TDim>::Pointer pPatch, typename TFESpaceType::Pointer pFESpace,
+            const std::string& var_name, const std::vector<std::size_t>& numbers) const
+    {
+        const TVariableType* pVariable = dynamic_cast<const TVariableType*>(&KratosComponents<VariableData>::Get(var_name));
+        if (pVariable == NULL)
+            KRATOS_THROW_ERROR(std::logic_error, "The variable in the MultiPatch checkpoint has a different type:", var_name)
+        typename ControlGrid<typename TVariableType::Type>::Pointer pControlGrid = GridValuesReader<TFESpaceType, TVariableType>::Execute(rIStream, pFESpace, *pVariable, numbers);
+        pPatch->CreateGridFunction(*pVariable, pControlGrid);
+    }
+
+    template<class TFESpaceType, class TVariableType>
+    struct GridValuesReader
+    {
+        static typename ControlGrid<typename TVariableType::Type>::Pointer Execute(std::istream& rIStream, typename TFESpaceType::Pointer pFESpace,
+                const TVariableType& rVariable, const std::vector<std::size_t>& numbers)
+        {
+            typedef typename TVariableType::Type DataType;
+            const std::size_t n = LayoutType::ReadWord(rIStream);
+            typename StructuredControlGrid<TDim, DataType>::Pointer pControlGrid = StructuredControlGrid<TDim, DataType>::Create(numbers);
+            if (n != pControlGrid->size())
+                KRATOS_THROW_ERROR(std::runtime_error, "The MultiPatch checkpoint is corrupted, the grid size is not compatible:", rVariable.Name())
+            DataType v;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                LayoutType::ReadValue(rIStream, v);
+                pControlGrid->SetData(i, v);
+            }
+            pControlGrid->SetName(rVariable.Name());
+            return pControlGrid;
+        }
+    };
+
+    template<class TFESpaceType, class TVariableType>
+    struct PointBasedGridValuesReader
+    {
+        static typename ControlGrid<typename TVariableType::Type>::Pointer Execute(std::istream& rIStream, typename TFESpaceType::Pointer pFESpace,
+                const TVariableType& rVariable, const std::vector<std::size_t>& numbers)
+        {
+            typedef typename TVariableType::Type DataType;
+            const std::size_t n = LayoutType::ReadWord(rIStream);
+            if (n != pFESpace->TotalNumber())
+                KRATOS_THROW_ERROR(std::runtime_error, "The MultiPatch checkpoint is corrupted, the grid size is not compatible:", rVariable.Name())
+            DataType v;
+            for (typename TFESpaceType::bf_iterator it = pFESpace->bf_begin(); it != pFESpace->bf_end(); ++it)
+            {
+                LayoutType::ReadValue(rIStream, v);
+                (*it)->SetValue(rVariable, v);
+            }
+            typename ControlGrid<DataType>::Pointer pControlGrid = ControlGridUtility::CreatePointBasedControlGrid<DataType, TFESpaceType>(rVariable, pFESpace);
+            pControlGrid->SetName(rVariable.Name());
+            return pControlGrid;
+        }
+    };
+
+    template<class TVariableType>
+    struct GridValuesReader<HBSplinesFESpace<TDim>, TVariableType>
+    : public PointBasedGridValuesReader<HBSplinesFESpace<TDim>, TVariableType>
+    {};
+
+    template<class TVariableType>
+    struct GridValuesReader<TSplinesFESpaceType, TVariableType>
+    : public PointBasedGridValuesReader<TSplinesFESpaceType, TVariableType>
+    {};
+
+}; // end class MultiPatchCheckpointReader
+
+/// output stream function
+inline std::ostream& operator <<(std::ostream& rOStream, const MultiPatchCheckpointWriter& rThis)
+{
+    rThis.PrintInfo(rOStream);
+    rOStream << std::endl;
+    rThis.PrintData(rOStream);
+    return rOStream;
+}
+
+/// output stream function
+template<int TDim>
+inline std::ostream& operator <<(std::ostream& rOStream, const MultiPatchCheckpointReader<TDim>& rThis)
+{
+    rThis.PrintInfo(rOStream);
+    rOStream << std::endl;
+    rThis.PrintData(rOStream);
+    return rOStream;
+}
+
+}// namespace Kratos.
+
+#endif // KRATOS_ISOGEOMETRIC_APPLICATION_MULTIPATCH_CHECKPOINT_H_INCLUDED
@@ -26,8 +26,11 @@
 #include "includes/element.h"
 #include "includes/properties.h"
 #include "utilities/openmp_utils.h"
+#include "utilities/math_utils.h"
 #include "custom_utilities/iga_define.h"
 #include "custom_utilities/isogeometric_utility.h"
+#include "custom_utilities/l2_projection_system.h"
+#include "custom_geometries/isogeometric_geometry.h"
 
 #define USE_TRIANGULATION_UTILS_FOR_TRIANGULATION
 
@@ -130,6 +133,33 @@ public:
         return pNewNode;
     }
 
+    /// Create the nodes for a model_part with incremental Ids starting from NodeCounter and transfer the values
+    /// The nodes are created in the order of the points. On output NodeCounter is advanced by the number of points.
+    /// All the grid functions of the patch are evaluated in batch over the points, hence the span search is shared.
+    template<class TPatchType, typename TCoordinatesType, typename TIndexType>
+    static void CreateNodesAndTransferValues(const std::vector<TCoordinatesType>& points_ref, const TPatchType& rPatch,
+        ModelPart& r_model_part, TIndexType& NodeCounter)
+    {
+        const int Dim = TPatchType::FESpaceType::Dim();
+
+        // collect the local coordinates contiguously
+        std::vector<double> xi(points_ref.size() * Dim);
+        for (std::size_t i = 0; i < points_ref.size(); ++i)
+            for (int dim = 0; dim < Dim; ++dim)
+                xi[i*Dim + dim] = points_ref[i][dim];
+
+        // create the nodes
+        std::vector<typename TPatchType::ControlPointType> points;
+        rPatch.pControlPointGridFunction()->GetValues(points, xi);
+
+        std::vector<typename NodeType::Pointer> pNewNodes(points.size());
+        for (std::size_t i = 0; i < points.size(); ++i)
+            pNewNodes[i] = r_model_part.CreateNewNode(NodeCounter++, points[i].X(), points[i].Y(), points[i].Z());
+
+        // transfer the control values
+        TransferValuesToNodes(pNewNodes, xi, rPatch);
+    }
+
     /// Create a node for a model_part with a specific Id
     template<class TPatchType, typename TCoordinatesType, typename TIndexType>
     static typename NodeType::Pointer CreateNode(const TCoordinatesType& p_ref, const TPatchType& rPatch,
@@ -213,6 +243,72 @@ public:
         }
     }
 
+    /// Transfer the control values from patch to a list of nodes
+    /// xi contains the local coordinates of the nodes in patch contiguously, i.e. Dim values per node
+    template<class TPatchType>
+    static void TransferValuesToNodes(std::vector<typename NodeType::Pointer>& pNodes, const std::vector<double>& xi, const TPatchType& rPatch)
+    {
+        typedef typename TPatchType::DoubleGridFunctionContainerType DoubleGridFunctionContainerType;
+        typedef typename TPatchType::Array1DGridFunctionContainerType Array1DGridFunctionContainerType;
+        typedef typename TPatchType::VectorGridFunctionContainerType VectorGridFunctionContainerType;
+
+        // transfer the control values
+        DoubleGridFunctionContainerType DoubleGridFunctions_ = rPatch.DoubleGridFunctions();
+        for (typename DoubleGridFunctionContainerType::const_iterator it_gf = DoubleGridFunctions_.begin();
+                it_gf != DoubleGridFunctions_.end(); ++it_gf)
+        {
+            typedef double DataType;
+            typedef Variable<DataType> VariableType;
+            const std::string& var_name = (*it_gf)->pControlGrid()->Name();
+            if (KratosComponents<VariableData>::Has(var_name))
+            {
+                VariableType* pVariable = dynamic_cast<VariableType*>(&KratosComponents<VariableData>::Get(var_name));
+                std::vector<DataType> values;
+                (*it_gf)->GetValues(values, xi);
+                for (std::size_t i = 0; i < pNodes.size(); ++i)
+                    if (pNodes[i]->SolutionStepsDataHas(*pVariable))
+                        pNodes[i]->GetSolutionStepValue(*pVariable) = values[i];
+            }
+        }
+
+        Array1DGridFunctionContainerType Array1DGridFunctions_ = rPatch.Array1DGridFunctions();
+        for (typename Array1DGridFunctionContainerType::const_iterator it_gf = Array1DGridFunctions_.begin();
+                it_gf != Array1DGridFunctions_.end(); ++it_gf)
+        {
+            typedef array_1d<double, 3> DataType;
+            typedef Variable<DataType> VariableType;
+            const std::string& var_name = (*it_gf)->pControlGrid()->Name();
+            if (var_name == "CONTROL_POINT_COORDINATES") continue;
+            if (KratosComponents<VariableData>::Has(var_name))
+            {
+                VariableType* pVariable = dynamic_cast<VariableType*>(&KratosComponents<VariableData>::Get(var_name));
+                std::vector<DataType> values;
+                (*it_gf)->GetValues(values, xi);
+                for (std::size_t i = 0; i < pNodes.size(); ++i)
+                    if (pNodes[i]->SolutionStepsDataHas(*pVariable))
+                        pNodes[i]->GetSolutionStepValue(*pVariable) = values[i];
+            }
+        }
+
+        VectorGridFunctionContainerType VectorGridFunctions_ = rPatch.VectorGridFunctions();
+        for (typename VectorGridFunctionContainerType::const_iterator it_gf = VectorGridFunctions_.begin();
+                it_gf != VectorGridFunctions_.end(); ++it_gf)
+        {
+            typedef Vector DataType;
+            typedef Variable<DataType> VariableType;
+            const std::string& var_name = (*it_gf)->pControlGrid()->Name();
+            if (KratosComponents<VariableData>::Has(var_name))
+            {
+                VariableType* pVariable = dynamic_cast<VariableType*>(&KratosComponents<VariableData>::Get(var_name));
+                std::vector<DataType> values;
+                (*it_gf)->GetValues(values, xi);
+                for (std::size_t i = 0; i < pNodes.size(); ++i)
+                    if (pNodes[i]->SolutionStepsDataHas(*pVariable))
+                        pNodes[i]->GetSolutionStepValue(*pVariable) = values[i];
+            }
+        }
+    }
+
     /// Transfer the control values from patch to Gauss points
     template<class TEntityType, typename TVariableType, class TPatchType>
     static void TransferValuesToGaussPoints(TEntityType& rElement, const TVariableType& rVariable,
@@ -572,6 +668,106 @@ public:
         return std::make_pair(points, connectivities);
     }
 
+    /// Generate the quadrilateral grid on the tensor product of the given (non-uniform) parameter values.
+    /// The points and the connectivities are ordered the same as GenerateQuadGrid.
+    template<typename TCoordinatesType, typename TIndexType>
+    static std::pair<std::vector<TCoordinatesType>, std::vector<std::vector<TIndexType> > >
+    GenerateQuadGrid(const std::vector<double>& xi_values, const std::vector<double>& eta_values,
+        const TIndexType& starting_node_id)
+    {
+        TCoordinatesType p;
+
+        std::vector<TCoordinatesType> points;
+        std::vector<std::vector<TIndexType> > connectivities;
+
+        const std::size_t num_div_1 = xi_values.size() - 1;
+        const std::size_t num_div_2 = eta_values.size() - 1;
+
+        std::size_t i, j;
+        for (i = 0; i <= num_div_1; ++i)
+        {
+            for (j = 0; j <= num_div_2; ++j)
+            {
+                p[0] = xi_values[i];
+                p[1] = eta_values[j];
+                p[2] = 0.0;
+
+                points.push_back(p);
+            }
+        }
+
+        TIndexType n1, n2, n3, n4;
+        for (i = 0; i < num_div_1; ++i)
+        {
+            for(j = 0; j < num_div_2; ++j)
+            {
+                n1 = starting_node_id + i * (num_div_2 + 1) + j;
+                n2 = starting_node_id + i * (num_div_2 + 1) + j + 1;
+                n3 = starting_node_id + (i + 1) * (num_div_2 + 1) + j;
+                n4 = starting_node_id + (i + 1) * (num_div_2 + 1) + j + 1;
+
+                connectivities.push_back(std::vector<TIndexType>{n1, n2, n4, n3});
+            }
+        }
+
+        return std::make_pair(points, connectivities);
+    }
+
+    /// Generate the hexahedral grid on the tensor product of the given (non-uniform) parameter values.
+    /// The points and the connectivities are ordered the same as GenerateHexGrid.
+    template<typename TCoordinatesType, typename TIndexType>
+    static std::pair<std::vector<TCoordinatesType>, std::vector<std::vector<TIndexType> > >
+    GenerateHexGrid(const std::vector<double>& xi_values, const std::vector<double>& eta_values,
+        const std::vector<double>& zeta_values, const TIndexType& starting_node_id)
+    {
+        TCoordinatesType p;
+
+        std::vector<TCoordinatesType> points;
+        std::vector<std::vector<TIndexType> > connectivities;
+
+        const std::size_t num_div_1 = xi_values.size() - 1;
+        const std::size_t num_div_2 = eta_values.size() - 1;
+        const std::size_t num_div_3 = zeta_values.size() - 1;
+
+        std::size_t i, j, k;
+        for (i = 0; i <= num_div_1; ++i)
+        {
+            for (j = 0; j <= num_div_2; ++j)
+            {
+                for (k = 0; k <= num_div_3; ++k)
+                {
+                    p[0] = xi_values[i];
+                    p[1] = eta_values[j];
+                    p[2] = zeta_values[k];
+
+                    points.push_back(p);
+                }
+            }
+        }
+
+        for (i = 0; i < num_div_1; ++i)
+        {
+            for (j = 0; j < num_div_2; ++j)
+            {
+                for (k = 0; k < num_div_3; ++k)
+                {
+                    TIndexType n1 = starting_node_id + (i * (num_div_2 + 1) + j) * (num_div_3 + 1) + k;
+                    TIndexType n2 = starting_node_id + (i * (num_div_2 + 1) + j + 1) * (num_div_3 + 1) + k;
+                    TIndexType n3 = starting_node_id + ((i + 1) * (num_div_2 + 1) + j) * (num_div_3 + 1) + k;
+                    TIndexType n4 = starting_node_id + ((i + 1) * (num_div_2 + 1) + j + 1) * (num_div_3 + 1) + k;
+                    TIndexType n5 = n1 + 1;
+                    TIndexType n6 = n2 + 1;
+                    TIndexType n7 = n3 + 1;
+                    TIndexType n8 = n4 + 1;
+
+                    connectivities.push_back(std::vector<TIndexType>{n1, n2, n4, n3, n5, n6, n8, n7});
+                }
+            }
+        }
+
+        return std::make_pair(points, connectivities);
+    }
+
     /// Refine a triangle grid by sub-divide a triangle into 4 sub-triangles.
     template<typename TIndexType = std::size_t,
         typename TCoordinatesType = std::vector<double>,
@@ -986,6 +1182,204 @@ public:
         }
     }
 
+    //**********AUXILIARY FUNCTION**************************************************************
+    // Compute the shape function values and the integration weights dV = DetJ * w at the
+    // integration points of an isogeometric element, w.r.t the initial configuration
+    //******************************************************************************************
+    template<typename TElementType>
+    static void CalculateL2ProjectionWeights(TElementType& rElement, Matrix& Ncontainer, std::vector<double>& dV)
+    {
+        typedef IsogeometricGeometry<NodeType> IsogeometricGeometryType;
+
+        const IntegrationPointsArrayType& integration_points
+            = rElement.GetGeometry().IntegrationPoints(rElement.GetIntegrationMethod());
+
+        GeometryType::JacobiansType J(integration_points.size());
+
+        IsogeometricGeometryType& rIsogeometricGeometry = dynamic_cast<IsogeometricGeometryType&>(rElement.GetGeometry());
+        J = rIsogeometricGeometry.Jacobian0(J, rElement.GetIntegrationMethod());
+
+        GeometryType::ShapeFunctionsGradientsType DN_De;
+        rIsogeometricGeometry.CalculateShapeFunctionsIntegrationPointsValuesAndLocalGradients(
+            Ncontainer,
+            DN_De,
+            rElement.GetIntegrationMethod()
+        );
+
+        dV.resize(integration_points.size());
+        Matrix InvJ;
+        double DetJ;
+        for(unsigned int point = 0; point < integration_points.size(); ++point)
+        {
+            InvJ.resize(J[point].size1(), J[point].size2(), false);
+            MathUtils<double>::InvertMatrix(J[point], InvJ, DetJ);
+            dV[point] = DetJ * integration_points[point].Weight();
+        }
+    }
+
+    //**********AUXILIARY FUNCTION**************************************************************
+    // Assemble the consistent, the row-sum lumped and the diagonal scaled mass of the L2
+    // projection system. The e-th element of the system is *(it_elements_begin + e). The
+    // elements with non-zero status are inactive: their contribution to LHS is identity matrix.
+    // The elements of the same color do not share any row, hence no lock is needed.
+    //******************************************************************************************
+    template<typename TElementPointerIteratorType>
+    static void AssembleL2ProjectionMassMatrix(L2ProjectionSystem& rSystem, TElementPointerIteratorType it_elements_begin)
+    {
+        rSystem.ResetMassMatrix();
+
+        int number_of_threads = omp_get_max_threads();
+        for(std::size_t c = 0; c < rSystem.NumberOfColors(); ++c)
+        {
+            const std::vector<std::size_t>& color = rSystem.Color(c);
+
+            std::vector<unsigned int> element_partition;
+            OpenMPUtils::CreatePartition(number_of_threads, color.size(), element_partition);
+
+            #pragma omp parallel for
+            for(int k = 0; k < number_of_threads; ++k)
+            {
+                for(unsigned int i = element_partition[k]; i < element_partition[k+1]; ++i)
+                    AddL2ProjectionElementMass(rSystem, color[i], **(it_elements_begin + color[i]));
+            }
+        }
+
+        rSystem.FinalizeMassMatrix();
+    }
+
+    //**********AUXILIARY FUNCTION**************************************************************
+    // Add the mass contribution of the e-th element to the L2 projection system
+    //******************************************************************************************
+    static void AddL2ProjectionElementMass(L2ProjectionSystem& rSystem, const std::size_t& e, Element& rElement)
+    {
+        const std::size_t n = rSystem.NumberOfElementRows(e);
+
+        if(rSystem.ElementStatus(e) == 0)
+        {
+            Matrix Ncontainer;
+            std::vector<double> dV;
+            CalculateL2ProjectionWeights(rElement, Ncontainer, dV);
+
+            // the element diagonal is scaled to preserve the element mass (Hinton-Rock-Zienkiewicz)
+            Vector diagonal(n);
+            noalias(diagonal) = ZeroVector(n);
+            double element_mass = 0.0;
+            for(unsigned int point = 0; point < dV.size(); ++point)
+            {
+                for(unsigned int prim = 0; prim < n; ++prim)
+                {
+                    const std::size_t row = rSystem.ElementRow(e, prim);
+                    for(unsigned int sec = 0; sec < n; ++sec)
+                    {
+                        const double aux = Ncontainer(point, prim) * Ncontainer(point, sec) * dV[point];
+                        rSystem.AddToMassMatrix(row, rSystem.ElementRow(e, sec), aux);
+                        element_mass += aux;
+                    }
+                    diagonal(prim) += Ncontainer(point, prim) * Ncontainer(point, prim) * dV[point];
+                }
+            }
+
+            const double diagonal_mass = sum(diagonal);
+            const double scale = (diagonal_mass != 0.0) ? element_mass / diagonal_mass : 0.0;
+            for(unsigned int prim = 0; prim < n; ++prim)
+                rSystem.AddToScaledDiagonalMass(rSystem.ElementRow(e, prim), scale * diagonal(prim));
+        }
+        else
+        {
+            for(unsigned int prim = 0; prim < n; ++prim)
+            {
+                const std::size_t row = rSystem.ElementRow(e, prim);
+                rSystem.AddToMassMatrix(row, row, 1.0);
+                rSystem.AddToScaledDiagonalMass(row, 1.0);
+            }
+        }
+    }
+
+    //**********AUXILIARY FUNCTION**************************************************************
+    // Assemble the right hand sides of the L2 projection system for several variables at once.
+    // The columns of B are the double variables, followed by the components of the vector
+    // variables (rVectorSizes[i] components for the i-th vector variable). The shape functions
+    // and the integration weights are computed only once per element for all the variables.
+    //******************************************************************************************
+    template<typename TElementPointerIteratorType>
+    static void AssembleL2ProjectionRightHandSide(const L2ProjectionSystem& rSystem, TElementPointerIteratorType it_elements_begin,
+        const std::vector<const Variable<double>*>& rDoubleVariables,
+        const std::vector<const Variable<Vector>*>& rVectorVariables,
+        const std::vector<std::size_t>& rVectorSizes,
+        const ProcessInfo& rProcessInfo,
+        Matrix& B)
+    {
+        std::size_t ncolumns = rDoubleVariables.size();
+        for(std::size_t i = 0; i < rVectorSizes.size(); ++i)
+            ncolumns += rVectorSizes[i];
+
+        B.resize(rSystem.NumberOfRows(), ncolumns, false);
+        noalias(B) = ZeroMatrix(rSystem.NumberOfRows(), ncolumns);
+
+        int number_of_threads = omp_get_max_threads();
+        for(std::size_t c = 0; c < rSystem.NumberOfColors(); ++c)
+        {
+            const std::vector<std::size_t>& color = rSystem.Color(c);
+
+            std::vector<unsigned int> element_partition;
+            OpenMPUtils::CreatePartition(number_of_threads, color.size(), element_partition);
+
+            #pragma omp parallel for
+            for(int k = 0; k < number_of_threads; ++k)
+            {
+                for(unsigned int i = element_partition[k]; i < element_partition[k+1]; ++i)
+                    AddL2ProjectionElementRightHandSide(rSystem, color[i], **(it_elements_begin + color[i]),
+                        rDoubleVariables, rVectorVariables, rVectorSizes, rProcessInfo, B);
+            }
+        }
+    }
+
+    //**********AUXILIARY FUNCTION**************************************************************
+    // Add the right hand side contribution of the e-th element to the columns of B
+    //******************************************************************************************
+    static void AddL2ProjectionElementRightHandSide(const L2ProjectionSystem& rSystem, const std::size_t& e, Element& rElement,
+        const std::vector<const Variable<double>*>& rDoubleVariables,
+        const std::vector<const Variable<Vector>*>& rVectorVariables,
+        const std::vector<std::size_t>& rVectorSizes,
+        const ProcessInfo& rProcessInfo,
+        Matrix& B)
+    {
+        // for inactive elements the contribution to RHS is zero
+        if(rSystem.ElementStatus(e) != 0)
+            return;
+
+        Matrix Ncontainer;
+        std::vector<double> dV;
+        CalculateL2ProjectionWeights(rElement, Ncontainer, dV);
+
+        std::size_t column = 0;
+
+        std::vector<double> DoubleValuesOnIntPoint(dV.size());
+        for(std::size_t v = 0; v < rDoubleVariables.size(); ++v, ++column)
+        {
+            rElement.GetValueOnIntegrationPoints(*rDoubleVariables[v], DoubleValuesOnIntPoint, rProcessInfo);
+            for(unsigned int point = 0; point < dV.size(); ++point)
+                for(unsigned int prim = 0; prim < rSystem.NumberOfElementRows(e); ++prim)
+                    B(rSystem.ElementRow(e, prim), column) += DoubleValuesOnIntPoint[point] * Ncontainer(point, prim) * dV[point];
+        }
+
+        std::vector<Vector> VectorValuesOnIntPoint(dV.size());
+        for(std::size_t v = 0; v < rVectorVariables.size(); ++v)
+        {
+            rElement.GetValueOnIntegrationPoints(*rVectorVariables[v], VectorValuesOnIntPoint, rProcessInfo);
+            for(unsigned int point = 0; point < dV.size(); ++point)
+            {
+                for(unsigned int prim = 0; prim < rSystem.NumberOfElementRows(e); ++prim)
+                {
+                    const std::size_t row = rSystem.ElementRow(e, prim);
+                    for(std::size_t i = 0; i < rVectorSizes[v]; ++i)
+                        B(row, column + i) += VectorValuesOnIntPoint[point][i] * Ncontainer(point, prim) * dV[point];
+                }
+            }
+            column += rVectorSizes[v];
+        }
+    }
+
     //**********AUXILIARY FUNCTION**************************************************************
     //******************************************************************************************
     static inline double CoordinateScaling(const double& x, const int& Type)
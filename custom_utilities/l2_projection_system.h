@@ -0,0 +1,403 @@
+//
+//   Project Name:        Kratos
+//   Last Modified by:    $Author: hbui $
+//   Date:                $Date: 17 Oct 2026 $
+//   Revision:            $Revision: 1.0 $
+//
+//
+
+#if !defined(KRATOS_ISOGEOMETRIC_APPLICATION_L2_PROJECTION_SYSTEM_H_INCLUDED )
+#define  KRATOS_ISOGEOMETRIC_APPLICATION_L2_PROJECTION_SYSTEM_H_INCLUDED
+
+// System includes
+#include <vector>
+#include <algorithm>
+#include <iostream>
+
+// External includes
+#include <omp.h>
+
+// Project includes
+#include "includes/define.h"
+#include "includes/ublas_interface.h"
+#include "utilities/openmp_utils.h"
+#include "custom_utilities/iga_define.h"
+
+namespace Kratos
+{
+
+/**
+ * System of equations of the L2 projection of the integration point values to the nodes.
+ * The elements are colored such that the elements of the same color do not share any row, hence the element
+ * contributions of one color can be assembled in parallel without locking. The sparsity pattern, the coloring and
+ * the mass matrix are kept and reused as long as the connectivities and the activation of the elements do not change,
+ * i.e. for all the variables and all the time steps on the same mesh.
+ * The element connectivities are given in CSR format: the rows of element e are rElementRows[rElementPtr[e]..rElementPtr[e+1]).
+ * Beside the consistent mass matrix, the row-sum lumped mass and the diagonal scaled (HRZ) mass are kept, which allow
+ * to solve the projection without any linear solver.
+ */
+class L2ProjectionSystem
+{
+public:
+    /// Pointer definition
+    KRATOS_CLASS_POINTER_DEFINITION(L2ProjectionSystem);
+
+    /// Type definitions
+    typedef std::size_t IndexType;
+    typedef std::size_t SizeType;
+    typedef CompressedMatrix MatrixType;
+
+    /// Default constructor
+    L2ProjectionSystem() : mNumberOfRows(0), mIsMassMatrixAssembled(false)
+    {}
+
+    /// Destructor
+    virtual ~L2ProjectionSystem()
+    {}
+
+    /// Check if the system was initialized with the same connectivities and element status (e.g. active/inactive)
+    bool IsCompatible(const SizeType& NumberOfRows, const std::vector<IndexType>& rElementPtr,
+            const std::vector<IndexType>& rElementRows, const std::vector<int>& rElementStatus) const
+    {
+        return (mNumberOfRows == NumberOfRows) && (mElementPtr == rElementPtr)
+            && (mElementRows == rElementRows) && (mElementStatus == rElementStatus);
+    }
+
+    /// Initialize the sparsity pattern of the mass matrix and the coloring of the elements.
+    /// The mass matrix is set to zero and must be assembled again.
+    void Initialize(const SizeType& NumberOfRows, const std::vector<IndexType>& rElementPtr,
+            const std::vector<IndexType>& rElementRows, const std::vector<int>& rElementStatus)
+    {
+        mNumberOfRows = NumberOfRows;
+        mElementPtr = rElementPtr;
+        mElementRows = rElementRows;
+        mElementStatus = rElementStatus;
+
+        for (IndexType k = 0; k < mElementRows.size(); ++k)
+            if (mElementRows[k] >= mNumberOfRows)
+                KRATOS_THROW_ERROR(std::logic_error, "The row index exceeds the number of rows:", mElementRows[k])
+
+        this->ConstructMatrixStructure();
+        this->ConstructColors();
+
+        mIsMassMatrixAssembled = false;
+    }
+
+    /// Clear the system. The next call to IsCompatible will return false.
+    void Clear()
+    {
+        mNumberOfRows = 0;
+        mElementPtr.clear();
+        mElementRows.clear();
+        mElementStatus.clear();
+        mRowPtr.clear();
+        mColInd.clear();
+        mColors.clear();
+        mIsolatedRows.clear();
+        mMassMatrix.resize(0, 0, false);
+        mLumpedMass.clear();
+        mScaledDiagonalMass.clear();
+        mIsMassMatrixAssembled = false;
+    }
+
+    /// Get the number of rows
+    SizeType NumberOfRows() const {return mNumberOfRows;}
+
+    /// Get the number of elements
+    SizeType NumberOfElements() const {return (mElementPtr.size() == 0) ? 0 : mElementPtr.size() - 1;}
+
+    /// Get the number of rows of an element
+    SizeType NumberOfElementRows(const IndexType& e) const {return mElementPtr[e + 1] - mElementPtr[e];}
+
+    /// Get the i-th row of an element
+    IndexType ElementRow(const IndexType& e, const IndexType& i) const {return mElementRows[mElementPtr[e] + i];}
+
+    /// Get the status of an element, given at initialization (0 for active elements)
+    int ElementStatus(const IndexType& e) const {return mElementStatus[e];}
+
+    /// Get the number of colors
+    SizeType NumberOfColors() const {return mColors.size();}
+
+    /// Get the elements of a color
+    const std::vector<IndexType>& Color(const IndexType& c) const {return mColors[c];}
+
+    /// Add the value to the entry (row, col) of the mass matrix. The entry must be in the sparsity pattern.
+    void AddToMassMatrix(const IndexType& row, const IndexType& col, const double& value)
+    {
+        mMassMatrix.value_data()[this->Position(row, col)] += value;
+    }
+
+    /// Add the value to the diagonal scaled mass of a row. The element contributions shall be the diagonal of the element
+    /// mass matrix scaled to preserve the element mass (Hinton-Rock-Zienkiewicz lumping).
+    void AddToScaledDiagonalMass(const IndexType& row, const double& value)
+    {
+        mScaledDiagonalMass[row] += value;
+    }
+
+    /// Reset the mass matrix to zero, keeping the sparsity pattern
+    void ResetMassMatrix()
+    {
+        std::fill(mMassMatrix.value_data().begin(), mMassMatrix.value_data().end(), 0.0);
+        mLumpedMass.assign(mNumberOfRows, 0.0);
+        mScaledDiagonalMass.assign(mNumberOfRows, 0.0);
+        mIsMassMatrixAssembled = false;
+    }
+
+    /// Finish the assembly of the mass matrix. The rows which are not connected to any element receive a unit diagonal.
+    /// The row-sum lumped mass is computed from the consistent mass matrix.
+    void FinalizeMassMatrix()
+    {
+        for (IndexType i = 0; i < mIsolatedRows.size(); ++i)
+        {
+            mMassMatrix.value_data()[this->Position(mIsolatedRows[i], mIsolatedRows[i])] = 1.0;
+            mScaledDiagonalMass[mIsolatedRows[i]] = 1.0;
+        }
+
+        for (IndexType i = 0; i < mNumberOfRows; ++i)
+        {
+            mLumpedMass[i] = 0.0;
+            for (IndexType k = mRowPtr[i]; k < mRowPtr[i + 1]; ++k)
+                mLumpedMass[i] += mMassMatrix.value_data()[k];
+        }
+
+        mIsMassMatrixAssembled = true;
+    }
+
+    /// Check if the mass matrix is assembled
+    bool IsMassMatrixAssembled() const {return mIsMassMatrixAssembled;}
+
+    /// Get the mass matrix
+    MatrixType& MassMatrix() {return mMassMatrix;}
+
+    /// Get the mass matrix
+    const MatrixType& MassMatrix() const {return mMassMatrix;}
+
+    /// Get the row-sum lumped mass
+    const std::vector<double>& LumpedMass() const {return mLumpedMass;}
+
+    /// Get the diagonal scaled mass
+    const std::vector<double>& ScaledDiagonalMass() const {return mScaledDiagonalMass;}
+
+    /// Solve the projection for multiple right hand sides, given as the columns of rB. The consistent projection solves
+    /// all the columns with the given linear solver at once, which must support multiple right hand sides if there are
+    /// more than one column, and throws if the solver does not converge; the lumped and diagonal scaled projections are
+    /// solved directly.
+    template<class TLinearSolverPointerType>
+    void Solve(TLinearSolverPointerType& pSolver, const L2ProjectionType& Type, Matrix& rX, Matrix& rB) const
+    {
+        if (!mIsMassMatrixAssembled)
+            KRATOS_THROW_ERROR(std::logic_error, "The mass matrix of the L2 projection system is not assembled", "")
+
+        if (rX.size1() != mNumberOfRows || rX.size2() != rB.size2())
+            rX.resize(mNumberOfRows, rB.size2(), false);
+
+        if (Type == _CONSISTENT_L2_PROJECTION_)
+        {
+            // a copy of the mass matrix is given since the solver may modify it (e.g. scaling)
+            MatrixType M = mMassMatrix;
+            if (rB.size2() == 1)
+            {
+                Vector x(mNumberOfRows), b(column(rB, 0));
+                noalias(x) = ZeroVector(mNumberOfRows);
+                if (!pSolver->Solve(M, x, b))
+                    KRATOS_THROW_ERROR(std::runtime_error, "The linear solver failed to solve the L2 projection system", "")
+                noalias(column(rX, 0)) = x;
+            }
+            else
+            {
+                noalias(rX) = ZeroMatrix(mNumberOfRows, rB.size2());
+                if (!pSolver->Solve(M, rX, rB))
+                    KRATOS_THROW_ERROR(std::runtime_error, "The linear solver failed to solve the L2 projection system", "")
+            }
+        }
+        else if (Type == _LUMPED_L2_PROJECTION_)
+            this->SolveDiagonal(mLumpedMass, rX, rB);
+        else if (Type == _DIAGONAL_SCALED_L2_PROJECTION_)
+            this->SolveDiagonal(mScaledDiagonalMass, rX, rB);
+        else
+            KRATOS_THROW_ERROR(std::logic_error, "Unknown L2 projection type", int(Type))
+    }
+
+    /// Information
+    virtual void PrintInfo(std::ostream& rOStream) const
+    {
+        rOStream << "L2ProjectionSystem";
+    }
+
+    virtual void PrintData(std::ostream& rOStream) const
+    {
+        rOStream << " Number of rows: " << mNumberOfRows << std::endl;
+        rOStream << " Number of elements: " << this->NumberOfElements() << std::endl;
+        rOStream << " Number of non-zeros: " << mColInd.size() << std::endl;
+        rOStream << " Number of colors: " << mColors.size() << std::endl;
+    }
+
+private:
+
+    SizeType mNumberOfRows;
+    std::vector<IndexType> mElementPtr;
+    std::vector<IndexType> mElementRows;
+    std::vector<int> mElementStatus;
+
+    std::vector<IndexType> mRowPtr;
+    std::vector<IndexType> mColInd;
+    std::vector<std::vector<IndexType> > mColors;
+    std::vector<IndexType> mIsolatedRows;
+
+    MatrixType mMassMatrix;
+    std::vector<double> mLumpedMass;
+    std::vector<double> mScaledDiagonalMass;
+    bool mIsMassMatrixAssembled;
+
+    /// Solve the diagonal system, in parallel over the rows
+    void SolveDiagonal(const std::vector<double>& rMass, Matrix& rX, const Matrix& rB) const
+    {
+        int number_of_threads = omp_get_max_threads();
+        std::vector<unsigned int> row_partition;
+        OpenMPUtils::CreatePartition(number_of_threads, mNumberOfRows, row_partition);
+
+        #pragma omp parallel for
+        for (int k = 0; k < number_of_threads; ++k)
+        {
+            for (unsigned int i = row_partition[k]; i < row_partition[k + 1]; ++i)
+            {
+                const double inv_mass = (rMass[i] != 0.0) ? 1.0 / rMass[i] : 0.0;
+                for (IndexType j = 0; j < rB.size2(); ++j)
+                    rX(i, j) = rB(i, j) * inv_mass;
+            }
+        }
+    }
+
+    /// Position of the entry (row, col) in the values array. The column indices in each row are sorted.
+    IndexType Position(const IndexType& row, const IndexType& col) const
+    {
+        std::vector<IndexType>::const_iterator it_begin = mColInd.begin() + mRowPtr[row];
+        std::vector<IndexType>::const_iterator it_end = mColInd.begin() + mRowPtr[row + 1];
+        std::vector<IndexType>::const_iterator it = std::lower_bound(it_begin, it_end, col);
+        if (it == it_end || *it != col)
+            KRATOS_THROW_ERROR(std::logic_error, "The entry is not in the sparsity pattern of the L2 projection matrix, row =", row)
+        return it - mColInd.begin();
+    }
+
+    /// Construct the sparsity pattern from the element connectivities. Every row contains its diagonal entry.
+    void ConstructMatrixStructure()
+    {
+        // invert the element connectivities: for each row, the elements connected to it
+        std::vector<IndexType> row_elements_ptr(mNumberOfRows + 1, 0);
+        for (IndexType k = 0; k < mElementRows.size(); ++k)
+            ++row_elements_ptr[mElementRows[k] + 1];
+        for (IndexType i = 0; i < mNumberOfRows; ++i)
+            row_elements_ptr[i + 1] += row_elements_ptr[i];
+
+        std::vector<IndexType> row_elements(mElementRows.size());
+        std::vector<IndexType> row_fill(row_elements_ptr.begin(), row_elements_ptr.end() - 1);
+        for (IndexType e = 0; e + 1 < mElementPtr.size(); ++e)
+            for (IndexType k = mElementPtr[e]; k < mElementPtr[e + 1]; ++k)
+                row_elements[row_fill[mElementRows[k]]++] = e;
+
+        // collect the columns of each row, in parallel over the rows
+        std::vector<std::vector<IndexType> > indices(mNumberOfRows);
+        mIsolatedRows.clear();
+
+        int number_of_threads = omp_get_max_threads();
+        std::vector<unsigned int> row_partition;
+        OpenMPUtils::CreatePartition(number_of_threads, mNumberOfRows, row_partition);
+
+        #pragma omp parallel for
+        for (int k = 0; k < number_of_threads; ++k)
+        {
+            for (unsigned int i = row_partition[k]; i < row_partition[k + 1]; ++i)
+            {
+                std::vector<IndexType>& row_indices = indices[i];
+                row_indices.push_back(i);
+                for (IndexType j = row_elements_ptr[i]; j < row_elements_ptr[i + 1]; ++j)
+                {
+                    const IndexType& e = row_elements[j];
+                    row_indices.insert(row_indices.end(), mElementRows.begin() + mElementPtr[e], mElementRows.begin() + mElementPtr[e + 1]);
+                }
+                std::sort(row_indices.begin(), row_indices.end());
+                row_indices.erase(std::unique(row_indices.begin(), row_indices.end()), row_indices.end());
+            }
+        }
+
+        for (IndexType i = 0; i < mNumberOfRows; ++i)
+            if (row_elements_ptr[i] == row_elements_ptr[i + 1])
+                mIsolatedRows.push_back(i);
+
+        // fill the CSR structure and the matrix
+        mRowPtr.resize(mNumberOfRows + 1);
+        mRowPtr[0] = 0;
+        for (IndexType i = 0; i < mNumberOfRows; ++i)
+            mRowPtr[i + 1] = mRowPtr[i] + indices[i].size();
+
+        mColInd.resize(mRowPtr[mNumberOfRows]);
+        for (IndexType i = 0; i < mNumberOfRows; ++i)
+        {
+            std::copy(indices[i].begin(), indices[i].end(), mColInd.begin() + mRowPtr[i]);
+            std::vector<IndexType>().swap(indices[i]);
+        }
+
+        mMassMatrix.resize(mNumberOfRows, mNumberOfRows, false);
+        mMassMatrix.reserve(mColInd.size(), false);
+        for (IndexType i = 0; i < mNumberOfRows; ++i)
+            for (IndexType k = mRowPtr[i]; k < mRowPtr[i + 1]; ++k)
+                mMassMatrix.push_back(i, mColInd[k], 0.0);
+    }
+
+    /// Greedy coloring of the elements: each element receives the smallest color not used by any element sharing a row with it
+    void ConstructColors()
+    {
+        const SizeType NumberOfElements = this->NumberOfElements();
+
+        std::vector<std::vector<int> > row_colors(mNumberOfRows); // colors already touching each row
+        std::vector<IndexType> forbidden; // forbidden[c] == e + 1 if color c is forbidden for element e
+        std::vector<int> element_colors(NumberOfElements);
+        int number_of_colors = 0;
+
+        for (IndexType e = 0; e < NumberOfElements; ++e)
+        {
+            for (IndexType k = mElementPtr[e]; k < mElementPtr[e + 1]; ++k)
+            {
+                const std::vector<int>& colors = row_colors[mElementRows[k]];
+                for (IndexType j = 0; j < colors.size(); ++j)
+                    forbidden[colors[j]] = e + 1;
+            }
+
+            int c = 0;
+            while (c < number_of_colors && forbidden[c] == e + 1)
+                ++c;
+            if (c == number_of_colors)
+            {
+                ++number_of_colors;
+                forbidden.push_back(0);
+            }
+
+            element_colors[e] = c;
+            for (IndexType k = mElementPtr[e]; k < mElementPtr[e + 1]; ++k)
+            {
+                std::vector<int>& colors = row_colors[mElementRows[k]];
+                if (std::find(colors.begin(), colors.end(), c) == colors.end())
+                    colors.push_back(c);
+            }
+        }
+
+        mColors.clear();
+        mColors.resize(number_of_colors);
+        for (IndexType e = 0; e < NumberOfElements; ++e)
+            mColors[element_colors[e]].push_back(e);
+    }
+
+}; // Class L2ProjectionSystem
+
+/// output stream function
+inline std::ostream& operator << (std::ostream& rOStream, const L2ProjectionSystem& rThis)
+{
+    rThis.PrintInfo(rOStream);
+    rOStream << std::endl;
+    rThis.PrintData(rOStream);
+    return rOStream;
+}
+
+}// namespace Kratos.
+
+#endif // KRATOS_ISOGEOMETRIC_APPLICATION_L2_PROJECTION_SYSTEM_H_INCLUDED
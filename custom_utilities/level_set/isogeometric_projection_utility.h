@@ -11,6 +11,8 @@
 
 // System includes
 #include <iostream>
+#include <vector>
+#include <algorithm>
 
 // External includes
 
@@ -21,6 +23,7 @@
 #include "custom_utilities/iga_define.h"
 #include "custom_utilities/patch.h"
 #include "custom_utilities/multipatch_utility.h"
+#include "custom_utilities/level_set/multipatch_span_tree.h"
 
 
 namespace Kratos
@@ -124,6 +127,8 @@ public:
                 }
             }
         }
+
+        return 0;
     }
 
     /// Compute the vertical projection of a point on patch
@@ -282,6 +287,75 @@ public:
         return 1; // can't find the projection point
     }
 
+    /// Compute the vertical projection of a point on multipatch, using the span tree to visit only the spans whose
+    /// XY-projected bounding box contains the point. The Newton iteration on each candidate is seeded from the span
+    /// centre; the spans covering a whole patch are seeded by the sampling prediction. If none of the candidates
+    /// converges, the candidate patches are tried again with the sampling prediction.
+    static int ComputeVerticalProjection(const PointType& rPoint,
+        std::vector<double>& rLocalPoint, PointType& rGlobalPoint, int& patch_id,
+        const MultiPatchSpanTree& rSpanTree,
+        const double& TOL, const int& max_iters,
+        const int& nsampling1, const int& nsampling2,
+        const int& echo_level)
+    {
+        typedef Patch<2> PatchType;
+
+        std::vector<std::size_t> spans;
+        rSpanTree.Search(rPoint, TOL, spans);
+
+        if (echo_level > 0)
+            std::cout << "Number of candidate spans: " << spans.size() << std::endl;
+
+        for (std::size_t i = 0; i < spans.size(); ++i)
+        {
+            typename PatchType::Pointer pPatch = rSpanTree.pPatch(spans[i]);
+
+            // compute the prediction
+            if (rSpanTree.IsWholePatch(spans[i]))
+                PredictVerticalProjection(rPoint, rLocalPoint, pPatch, nsampling1, nsampling2);
+            else
+                rSpanTree.Center(spans[i], rLocalPoint);
+
+            if (echo_level > 0)
+                std::cout << "Prediction local point for span " << spans[i] << " of patch " << pPatch->Id() << ": " << rLocalPoint[0] << ", " << rLocalPoint[1] << std::endl;
+
+            // compute the vertical projection
+            int error_code = ComputeVerticalProjection(rPoint, rLocalPoint, rGlobalPoint, pPatch, TOL, max_iters, echo_level);
+
+            if (error_code == 0)
+            {
+                patch_id = pPatch->Id();
+                return 0;
+            }
+        }
+
+        // fall back to the sampling prediction on the candidate patches, which were not tried with it yet
+        std::vector<typename PatchType::Pointer> patches;
+        for (std::size_t i = 0; i < spans.size(); ++i)
+        {
+            if (rSpanTree.IsWholePatch(spans[i]))
+                continue;
+
+            typename PatchType::Pointer pPatch = rSpanTree.pPatch(spans[i]);
+            if (std::find(patches.begin(), patches.end(), pPatch) != patches.end())
+                continue;
+            patches.push_back(pPatch);
+
+            PredictVerticalProjection(rPoint, rLocalPoint, pPatch, nsampling1, nsampling2);
+
+            int error_code = ComputeVerticalProjection(rPoint, rLocalPoint, rGlobalPoint, pPatch, TOL, max_iters, echo_level);
+
+            if (error_code == 0)
+            {
+                patch_id = pPatch->Id();
+                return 0;
+            }
+        }
+
+        patch_id = -1;
+        return 1; // can't find the projection point
+    }
+
     ///@}
     ///@name Access
     ///@{
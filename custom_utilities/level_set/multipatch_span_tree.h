@@ -0,0 +1,200 @@
+//
+//   Project Name:        Kratos
+//   Last Modified by:    $Author: hbui $
+//   Date:                $Date: 17 Oct 2026 $
+//   Revision:            $Revision: 1.0 $
+//
+//
+
+#if !defined(KRATOS_ISOGEOMETRIC_APPLICATION_MULTIPATCH_SPAN_TREE_H_INCLUDED )
+#define  KRATOS_ISOGEOMETRIC_APPLICATION_MULTIPATCH_SPAN_TREE_H_INCLUDED
+
+// System includes
+#include <vector>
+#include <algorithm>
+#include <iostream>
+
+// External includes
+
+// Project includes
+#include "includes/define.h"
+#include "custom_utilities/iga_define.h"
+#include "custom_utilities/multipatch.h"
+#include "custom_utilities/bounding_box_tree.h"
+#include "custom_utilities/nurbs/bsplines_fespace.h"
+
+namespace Kratos
+{
+
+/**
+ * Spatial index of the knot spans of a surface multipatch, to search the spans which may contain the vertical projection
+ * of a point. Each span is bounded by the XY box of its supporting control points, which contains the XY projection of
+ * the surface over the span by the convex hull property. The boxes are arranged in a BoundingBoxTree.
+ * The B-Splines/NURBS patches are split into their knot spans. The other patches (e.g. hierarchical B-Splines or
+ * T-Splines) contribute one span covering the whole patch, bounded by all of its control points.
+ * The index is built once and must be rebuilt when the geometry of the multipatch changes.
+ */
+class MultiPatchSpanTree
+{
+public:
+    /// Pointer definition
+    KRATOS_CLASS_POINTER_DEFINITION(MultiPatchSpanTree);
+
+    /// Type definitions
+    typedef std::size_t IndexType;
+    typedef MultiPatch<2> MultiPatchType;
+    typedef Patch<2> PatchType;
+
+    /// Constructor
+    MultiPatchSpanTree(typename MultiPatchType::Pointer pMultiPatch)
+    {
+        this->Build(pMultiPatch);
+    }
+
+    /// Destructor
+    virtual ~MultiPatchSpanTree()
+    {}
+
+    /// Build the index from the patches of the multipatch
+    void Build(typename MultiPatchType::Pointer pMultiPatch)
+    {
+        mpPatches.clear();
+        mSpanPatches.clear();
+        mSpanBounds.clear();
+        mIsWholePatch.clear();
+
+        std::vector<double> boxes;
+        for (typename MultiPatchType::patch_ptr_iterator it = pMultiPatch->Patches().ptr_begin(); it != pMultiPatch->Patches().ptr_end(); ++it)
+        {
+            const IndexType ipatch = mpPatches.size();
+            mpPatches.push_back(*it);
+
+            typename GridFunction<2, array_1d<double, 3> >::ConstPointer pControlGridFunc = (*it)->pGetGridFunction(CONTROL_POINT_COORDINATES);
+            typename ControlGrid<array_1d<double, 3> >::ConstPointer pControlGrid = pControlGridFunc->pControlGrid();
+
+            if ((*it)->pFESpace()->Type() == BSplinesFESpace<2>::StaticType())
+            {
+                typename BSplinesFESpace<2>::ConstPointer pFESpace = boost::dynamic_pointer_cast<const BSplinesFESpace<2> >((*it)->pFESpace());
+                if (pFESpace == NULL)
+                    KRATOS_THROW_ERROR(std::runtime_error, "The cast to BSplinesFESpace is failed.", "")
+
+                const std::size_t n1 = pFESpace->Number(0), n2 = pFESpace->Number(1);
+                const std::size_t p1 = pFESpace->Order(0), p2 = pFESpace->Order(1);
+                const std::vector<double> U = pFESpace->KnotVector(0).GetValues();
+                const std::vector<double> V = pFESpace->KnotVector(1).GetValues();
+
+                // the non-empty spans U[k] < U[k+1] in the domain [U[p], U[n]], supported by the functions k-p..k
+                for (std::size_t k2 = p2; k2 < n2; ++k2)
+                {
+                    if (!(V[k2] < V[k2 + 1]))
+                        continue;
+
+                    for (std::size_t k1 = p1; k1 < n1; ++k1)
+                    {
+                        if (!(U[k1] < U[k1 + 1]))
+                            continue;
+
+                        double box[4] = {1.0e99, -1.0e99, 1.0e99, -1.0e99};
+                        for (std::size_t i2 = k2 - p2; i2 <= k2; ++i2)
+                            for (std::size_t i1 = k1 - p1; i1 <= k1; ++i1)
+                                ExtendBox(box, pControlGrid->GetData(i1 + i2 * n1));
+
+                        AddSpan(boxes, ipatch, box, U[k1], U[k1 + 1], V[k2], V[k2 + 1], false);
+                    }
+                }
+            }
+            else
+            {
+                double box[4] = {1.0e99, -1.0e99, 1.0e99, -1.0e99};
+                for (std::size_t i = 0; i < pControlGrid->size(); ++i)
+                    ExtendBox(box, pControlGrid->GetData(i));
+
+                AddSpan(boxes, ipatch, box, 0.0, 1.0, 0.0, 1.0, true);
+            }
+        }
+
+        mTree.Build(boxes);
+    }
+
+    /// Search the spans whose XY-projected box contains the XY-projection of the point within the tolerance. The spans
+    /// are returned in ascending order, i.e. in the order of the patches of the multipatch.
+    template<typename TPointType>
+    void Search(const TPointType& rPoint, const double& tol, std::vector<IndexType>& rSpans) const
+    {
+        mTree.Search(rPoint, tol, rSpans);
+    }
+
+    /// Get the number of spans
+    IndexType NumberOfSpans() const {return mSpanPatches.size();}
+
+    /// Get the patch of the span
+    typename PatchType::Pointer pPatch(const IndexType& ispan) const {return mpPatches[mSpanPatches[ispan]];}
+
+    /// Get the local coordinates of the centre of the span
+    void Center(const IndexType& ispan, std::vector<double>& rLocalPoint) const
+    {
+        if (rLocalPoint.size() != 2)
+            rLocalPoint.resize(2);
+        rLocalPoint[0] = 0.5 * (mSpanBounds[4*ispan] + mSpanBounds[4*ispan + 1]);
+        rLocalPoint[1] = 0.5 * (mSpanBounds[4*ispan + 2] + mSpanBounds[4*ispan + 3]);
+    }
+
+    /// Check if the span covers the whole patch, i.e. the patch is not split into knot spans
+    bool IsWholePatch(const IndexType& ispan) const {return mIsWholePatch[ispan];}
+
+    /// Information
+    virtual void PrintInfo(std::ostream& rOStream) const
+    {
+        rOStream << "MultiPatchSpanTree";
+    }
+
+    virtual void PrintData(std::ostream& rOStream) const
+    {
+        rOStream << " number of patches: " << mpPatches.size() << ", number of spans: " << this->NumberOfSpans() << std::endl;
+        rOStream << mTree;
+    }
+
+private:
+
+    std::vector<typename PatchType::Pointer> mpPatches;
+    std::vector<IndexType> mSpanPatches;
+    std::vector<double> mSpanBounds; // parametric bounds (xi_min, xi_max, eta_min, eta_max) of each span
+    std::vector<bool> mIsWholePatch;
+    BoundingBoxTree<2> mTree;
+
+    static void ExtendBox(double* box, const array_1d<double, 3>& P)
+    {
+        for (int d = 0; d < 2; ++d)
+        {
+            box[2*d] = std::min(box[2*d], P[d]);
+            box[2*d + 1] = std::max(box[2*d + 1], P[d]);
+        }
+    }
+
+    void AddSpan(std::vector<double>& rBoxes, const IndexType& ipatch, const double* box,
+        const double& xi_min, const double& xi_max, const double& eta_min, const double& eta_max,
+        const bool& is_whole_patch)
+    {
+        mSpanPatches.push_back(ipatch);
+        mSpanBounds.push_back(xi_min);
+        mSpanBounds.push_back(xi_max);
+        mSpanBounds.push_back(eta_min);
+        mSpanBounds.push_back(eta_max);
+        mIsWholePatch.push_back(is_whole_patch);
+        rBoxes.insert(rBoxes.end(), box, box + 4);
+    }
+
+}; // Class MultiPatchSpanTree
+
+/// output stream function
+inline std::ostream& operator << (std::ostream& rOStream, const MultiPatchSpanTree& rThis)
+{
+    rThis.PrintInfo(rOStream);
+    rOStream << std::endl;
+    rThis.PrintData(rOStream);
+    return rOStream;
+}
+
+}// namespace Kratos.
+
+#endif // KRATOS_ISOGEOMETRIC_APPLICATION_MULTIPATCH_SPAN_TREE_H_INCLUDED
@@ -30,6 +30,7 @@
 #include "custom_utilities/iga_define.h"
 #include "custom_utilities/multipatch.h"
 #include "custom_utilities/level_set/isogeometric_projection_utility.h"
+#include "custom_utilities/level_set/multipatch_span_tree.h"
 #include "custom_algebra/level_set/level_set.h"
 
 
@@ -60,6 +61,8 @@ namespace Kratos
 /// MultiPatch Z level set
 /** A level set using multi-patch as level boundary
 level_set > 0 if the vertical projection on the multipatch is below the point, and vice versa
+The knot spans of the multipatch are indexed once in a MultiPatchSpanTree, so that each evaluation only projects on
+the spans above or below the point. The index must be updated if the multipatch geometry is changed.
 */
 class MultiPatchZLevelSet : public LevelSet, public IsogeometricEcho
 {
@@ -86,6 +89,7 @@ public:
     , mnsampling1(5), mnsampling2(5), mTolerance(1.0e-10), mMaxIterations(30)
     {
         this->SetEchoLevel(1);
+        this->UpdateSpanTree();
     }
 
     /// Copy constructor.
@@ -94,6 +98,9 @@ public:
     , mpMultiPatch(rOther.mpMultiPatch)
     , mnsampling1(rOther.mnsampling1)
     , mnsampling2(rOther.mnsampling2)
+    , mTolerance(rOther.mTolerance)
+    , mMaxIterations(rOther.mMaxIterations)
+    , mpSpanTree(rOther.mpSpanTree)
     {}
 
     /// Destructor.
@@ -129,6 +136,13 @@ public:
     }
 
 
+    /// Rebuild the span index, e.g. after the control points of the multipatch are moved
+    void UpdateSpanTree()
+    {
+        mpSpanTree = MultiPatchSpanTree::Pointer(new MultiPatchSpanTree(mpMultiPatch));
+    }
+
+
     virtual LevelSet::Pointer CloneLevelSet() const
     {
         return LevelSet::Pointer(new MultiPatchZLevelSet(*this));
@@ -148,7 +162,7 @@ public:
         int target_patch_id;
         int error_code = IsogeometricProjectionUtility::ComputeVerticalProjection(P,
             local_point, global_point, target_patch_id,
-            mpMultiPatch, mTolerance, mMaxIterations,
+            *mpSpanTree, mTolerance, mMaxIterations,
             mnsampling1, mnsampling2,
             this->GetEchoLevel()-2);
         if (this->GetEchoLevel() > 1)
@@ -263,6 +277,7 @@ private:
     std::size_t mnsampling1, mnsampling2;
     double mTolerance;
     int mMaxIterations;
+    MultiPatchSpanTree::Pointer mpSpanTree; // shared by the clones, since it is not modified after construction
 
 
     ///@}
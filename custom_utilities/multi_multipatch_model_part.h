@@ -449,81 +449,131 @@ private:
 
         TEntityType const& r_clone_element = KratosComponents<TEntityType>::Get(element_name);
 
-        // loop through each cell in the space
-        typename TEntityType::NodesArrayType temp_element_nodes;
-        std::size_t cnt = starting_id;
         Vector dummy;
         int max_integration_method = 1;
         if (p_temp_properties->Has(NUM_IGA_INTEGRATION_METHOD))
             max_integration_method = (*p_temp_properties)[NUM_IGA_INTEGRATION_METHOD];
 
-        std::size_t ic = 0; // this is to mark the location of the iterator
-        for (typename cell_container_t::iterator it_dummy = pCellManagers[0]->begin(); it_dummy != pCellManagers[0]->end(); ++it_dummy)
+        // pre-resolve the node pointers into a dense table indexed by node id, to avoid the search in the node container for every anchor
+        typedef typename TEntityType::NodeType::Pointer NodePointerType;
+        std::size_t max_node_id = 0;
+        for (typename TNodeContainerType::ptr_iterator it = rNodes.ptr_begin(); it != rNodes.ptr_end(); ++it)
+            if ((*it)->Id() > max_node_id)
+                max_node_id = (*it)->Id();
+        std::vector<NodePointerType> node_table(max_node_id + 1);
+        for (typename TNodeContainerType::ptr_iterator it = rNodes.ptr_begin(); it != rNodes.ptr_end(); ++it)
+            node_table[(*it)->Id()] = *it;
+
+        // collect the cells of all cell managers to allow for random access
+        const std::size_t number_of_cells = pCellManagers[0]->size();
+        std::vector<std::vector<typename cell_container_t::cell_t> > cells(pFESpaces.size());
+        for (std::size_t ip = 0; ip < pFESpaces.size(); ++ip)
         {
-            std::vector<Element::GeometryType::Pointer> p_temp_geometries;
-
-            // fill the vector of geometries
-            for (std::size_t ip = 0; ip < pFESpaces.size(); ++ip)
-            {
-                typename cell_container_t::iterator it_cell = pCellManagers[ip]->begin();
-                std::advance(it_cell, ic);
-                typename cell_container_t::cell_t pcell = *it_cell;
-                // KRATOS_WATCH(*pcell)
+            cells[ip].reserve(number_of_cells);
+            for (typename cell_container_t::iterator it_cell = pCellManagers[ip]->begin(); it_cell != pCellManagers[ip]->end(); ++it_cell)
+                cells[ip].push_back(*it_cell);
+        }
 
-                // get new nodes
-                temp_element_nodes.clear();
+        // create the entities in parallel. The id of the entity created from the i-th cell is starting_id + i, which is the same as the serial loop.
+        // In debug mode (echo_level > 1) only one thread is used to keep the output readable.
+        std::vector<typename TEntityType::Pointer> new_entities(number_of_cells);
+        int number_of_threads = (echo_level > 1) ? 1 : OpenMPUtils::GetNumThreads();
+        std::vector<unsigned int> cell_partition;
+        OpenMPUtils::CreatePartition(number_of_threads, number_of_cells, cell_partition);
+        std::vector<std::string> error_messages(number_of_threads);
 
-                const std::vector<std::size_t>& anchors = pcell->GetSupportedAnchors();
-                Vector weights(anchors.size());
-                for (std::size_t i = 0; i < anchors.size(); ++i)
-                {
-                    temp_element_nodes.push_back(( *(MultiPatchUtility::FindKey(rNodes, CONVERT_INDEX_IGA_TO_KRATOS(anchors[i]), "Node").base())));
-                    weights[i] = pControlGrids[ip]->GetData(pFESpaces[ip]->LocalId(anchors[i])).W();
-                }
+        #pragma omp parallel for
+        for (int k = 0; k < number_of_threads; ++k)
+        {
+            try
+            {
+                typename TEntityType::NodesArrayType temp_element_nodes;
 
-                if (echo_level > 1)
+                for (std::size_t ic = cell_partition[k]; ic < cell_partition[k + 1]; ++ic)
                 {
-                    std::cout << "anchors:";
-                    for (std::size_t i = 0; i < anchors.size(); ++i)
-                        std::cout << " " << CONVERT_INDEX_IGA_TO_KRATOS(anchors[i]);
-                    std::cout << std::endl;
-                    KRATOS_WATCH(weights)
-                    // KRATOS_WATCH(pcell->GetExtractionOperator())
-                    KRATOS_WATCH(pcell->GetCompressedExtractionOperator())
-                    KRATOS_WATCH(pFESpaces[ip]->Order(0))
-                    KRATOS_WATCH(pFESpaces[ip]->Order(1))
-                    KRATOS_WATCH(pFESpaces[ip]->Order(2))
+                    std::vector<Element::GeometryType::Pointer> p_temp_geometries;
+
+                    // fill the vector of geometries
+                    for (std::size_t ip = 0; ip < pFESpaces.size(); ++ip)
+                    {
+                        typename cell_container_t::cell_t pcell = cells[ip][ic];
+                        // KRATOS_WATCH(*pcell)
+
+                        // get new nodes
+                        temp_element_nodes.clear();
+
+                        const std::vector<std::size_t>& anchors = pcell->GetSupportedAnchors();
+                        Vector weights(anchors.size());
+                        for (std::size_t i = 0; i < anchors.size(); ++i)
+                        {
+                            std::size_t node_id = CONVERT_INDEX_IGA_TO_KRATOS(anchors[i]);
+                            if (node_id > max_node_id || node_table[node_id] == NULL)
+                            {
+                                std::stringstream buffer;
+                                buffer << "Node #" << node_id << " is not found.";
+                                KRATOS_THROW_ERROR(std::invalid_argument, buffer.str(), "");
+                            }
+                            temp_element_nodes.push_back(node_table[node_id]);
+                            weights[i] = pControlGrids[ip]->GetData(pFESpaces[ip]->LocalId(anchors[i])).W();
+                        }
+
+                        if (echo_level > 1)
+                        {
+                            std::cout << "anchors:";
+                            for (std::size_t i = 0; i < anchors.size(); ++i)
+                                std::cout << " " << CONVERT_INDEX_IGA_TO_KRATOS(anchors[i]);
+                            std::cout << std::endl;
+                            KRATOS_WATCH(weights)
+                            // KRATOS_WATCH(pcell->GetExtractionOperator())
+                            KRATOS_WATCH(pcell->GetCompressedExtractionOperator())
+                            KRATOS_WATCH(pFESpaces[ip]->Order(0))
+                            KRATOS_WATCH(pFESpaces[ip]->Order(1))
+                            KRATOS_WATCH(pFESpaces[ip]->Order(2))
+                        }
+
+                        // create the geometry
+                        typename IsogeometricGeometryType::Pointer p_temp_geometry
+                            = boost::dynamic_pointer_cast<IsogeometricGeometryType>(r_clone_element.GetGeometry().Create(temp_element_nodes));
+                        if (p_temp_geometry == NULL)
+                            KRATOS_THROW_ERROR(std::runtime_error, "The cast to IsogeometricGeometry is failed.", "")
+
+                        p_temp_geometry->AssignGeometryData(dummy,
+                                                            dummy,
+                                                            dummy,
+                                                            weights,
+                                                            // pcell->GetExtractionOperator(),
+                                                            pcell->GetCompressedExtractionOperator(),
+                                                            static_cast<int>(pFESpaces[ip]->Order(0)),
+                                                            static_cast<int>(pFESpaces[ip]->Order(1)),
+                                                            static_cast<int>(pFESpaces[ip]->Order(2)),
+                                                            max_integration_method);
+
+                        p_temp_geometries.push_back(p_temp_geometry);
+                    }
+
+                    // create the element
+                    typename TEntityType::Pointer pNewElement = r_clone_element.Create(starting_id + ic, p_temp_geometries, p_temp_properties);
+                    pNewElement->SetValue(ACTIVATION_LEVEL, 0);
+                    pNewElement->SetValue(IS_INACTIVE, false);
+                    pNewElement->Set(ACTIVE, true);
+                    new_entities[ic] = pNewElement;
                 }
-
-                // create the geometry
-                typename IsogeometricGeometryType::Pointer p_temp_geometry
-                    = boost::dynamic_pointer_cast<IsogeometricGeometryType>(r_clone_element.GetGeometry().Create(temp_element_nodes));
-                if (p_temp_geometry == NULL)
-                    KRATOS_THROW_ERROR(std::runtime_error, "The cast to IsogeometricGeometry is failed.", "")
-
-                p_temp_geometry->AssignGeometryData(dummy,
-                                                    dummy,
-                                                    dummy,
-                                                    weights,
-                                                    // pcell->GetExtractionOperator(),
-                                                    pcell->GetCompressedExtractionOperator(),
-                                                    static_cast<int>(pFESpaces[ip]->Order(0)),
-                                                    static_cast<int>(pFESpaces[ip]->Order(1)),
-                                                    static_cast<int>(pFESpaces[ip]->Order(2)),
-                                                    max_integration_method);
-
-                p_temp_geometries.push_back(p_temp_geometry);
             }
+            catch (std::exception& e)
+            {
+                // the exception must not escape the parallel region; it is re-thrown below
+                error_messages[k] = e.what();
+            }
+        }
 
-            ++ic;
+        for (int k = 0; k < number_of_threads; ++k)
+            if (!error_messages[k].empty())
+                KRATOS_THROW_ERROR(std::runtime_error, error_messages[k], "")
 
-            // create the element and add to the list
-            typename TEntityType::Pointer pNewElement = r_clone_element.Create(cnt++, p_temp_geometries, p_temp_properties);
-            pNewElement->SetValue(ACTIVATION_LEVEL, 0);
-            pNewElement->SetValue(IS_INACTIVE, false);
-            pNewElement->Set(ACTIVE, true);
-            pNewElements.push_back(pNewElement);
-        }
+        // add the entities to the list, in the order of the cells
+        pNewElements.reserve(new_entities.size());
+        for (std::size_t ic = 0; ic < new_entities.size(); ++ic)
+            pNewElements.push_back(new_entities[ic]);
 
         if (echo_level > 0)
         {
@@ -44,7 +44,7 @@ public:
     typedef typename Patch<TDim>::interface_const_iterator interface_const_iterator;
 
     /// Default constructor
-    MultiPatch() : mEquationSystemSize(0) {}
+    MultiPatch() : mEquationSystemSize(0), mGlobalIdOffset(0) {}
 
     /// Destructor
     virtual ~MultiPatch() {}
@@ -77,13 +77,14 @@ public:
         // remove the patch
         mpPatches.erase(pPatch->Id());
 
-        // modify the global to patch map data
-        for (std::map<std::size_t, std::size_t>::iterator it = mGlobalIdToPatchId.begin(); it != mGlobalIdToPatchId.end();)
+        // modify the global to patch data
+        for (std::size_t i = 0; i < mGlobalIdToPatchId.size(); ++i)
         {
-            if (it->second == pPatch->Id())
-                mGlobalIdToPatchId.erase(it++);
-            else
-                ++it;
+            if (mGlobalIdToPatchId[i] == pPatch->Id())
+            {
+                mGlobalIdToPatchId[i] = -1;
+                mGlobalIdToLocalId[i] = -1;
+            }
         }
     }
 
@@ -110,23 +111,31 @@ public:
     /// IMPORTANT: user must make sure that the multipatch is fully enumerated by checking IsEnumerated()
     std::tuple<std::size_t, std::size_t> EquationIdLocation(const std::size_t& global_id) const
     {
-        std::map<std::size_t, std::size_t>::const_iterator it = mGlobalIdToPatchId.find(global_id);
-        if (it == mGlobalIdToPatchId.end())
+        const std::size_t i = global_id - mGlobalIdOffset;
+        if ((global_id < mGlobalIdOffset) || (i >= mGlobalIdToPatchId.size()) || (mGlobalIdToPatchId[i] == static_cast<std::size_t>(-1)))
         {
             KRATOS_WATCH(global_id)
             KRATOS_WATCH(mEquationSystemSize)
             std::cout << "global_to_patch map:" << std::endl;
-            for (std::map<std::size_t, std::size_t>::const_iterator it2 = mGlobalIdToPatchId.begin(); it2 != mGlobalIdToPatchId.end(); ++it2)
-                std::cout << " " << it2->first << ": " << it2->second << std::endl;
+            for (std::size_t j = 0; j < mGlobalIdToPatchId.size(); ++j)
+                if (mGlobalIdToPatchId[j] != static_cast<std::size_t>(-1))
+                    std::cout << " " << j + mGlobalIdOffset << ": " << mGlobalIdToPatchId[j] << std::endl;
             KRATOS_THROW_ERROR(std::logic_error, "The global id does not exist in the global_to_patch map.", "")
         }
 
-        const std::size_t& patch_id = it->second;
-        const std::size_t& local_id = pGetPatch(it->second)->pFESpace()->LocalId(global_id);
-
-        return std::make_tuple(patch_id, local_id);
+        return std::make_tuple(mGlobalIdToPatchId[i], mGlobalIdToLocalId[i]);
     }
 
+    /// Get the first global id of the global to patch arrays, i.e. the starting id of the last enumeration
+    std::size_t GlobalIdOffset() const {return mGlobalIdOffset;}
+
+    /// Get the patch id of each global id, i.e. GlobalIdToPatchId()[global_id - GlobalIdOffset()]. The id is -1 if the global id is not owned by any patch.
+    /// These arrays are to be used in the tight loops over all the equation ids, i.e. the synchronization between multipatch and model_part.
+    const std::vector<std::size_t>& GlobalIdToPatchId() const {return mGlobalIdToPatchId;}
+
+    /// Get the local id in the patch of each global id, i.e. GlobalIdToLocalId()[global_id - GlobalIdOffset()]
+    const std::vector<std::size_t>& GlobalIdToLocalId() const {return mGlobalIdToLocalId;}
+
     /// Validate the MultiPatch
     virtual bool Validate() const
     {
@@ -314,13 +323,20 @@ public:
             (*it)->pFESpace()->UpdateFunctionIndices(new_indices);
         }
 
-        // rebuild the global to patch map
-        mGlobalIdToPatchId.clear();
+        // rebuild the global to patch arrays. The indices are consecutive, hence dense arrays are used.
+        // If a global id is shared by several patches, the last patch is kept.
+        mGlobalIdOffset = start;
+        mGlobalIdToPatchId.assign(mEquationSystemSize, -1);
+        mGlobalIdToLocalId.assign(mEquationSystemSize, -1);
         for (patch_ptr_iterator it = Patches().ptr_begin(); it != Patches().ptr_end(); ++it)
         {
             std::vector<std::size_t> global_indices = (*it)->pFESpace()->FunctionIndices();
             for (std::size_t i = 0; i < global_indices.size(); ++i)
-                mGlobalIdToPatchId[global_indices[i]] = (*it)->Id();
+            {
+                const std::size_t j = global_indices[i] - start;
+                mGlobalIdToPatchId[j] = (*it)->Id();
+                mGlobalIdToLocalId[j] = (*it)->pFESpace()->LocalId(global_indices[i]);
+            }
         }
 
         return start + mEquationSystemSize;
@@ -343,7 +359,9 @@ private:
 
     PatchContainerType mpPatches; // container for all the patches
     std::size_t mEquationSystemSize; // this is the number of equation id in this multipatch
-    std::map<std::size_t, std::size_t> mGlobalIdToPatchId; // this is to map each global id to a patch id
+    std::size_t mGlobalIdOffset; // this is the first global id of the enumeration
+    std::vector<std::size_t> mGlobalIdToPatchId; // this is to map each global id (shifted by the offset) to a patch id
+    std::vector<std::size_t> mGlobalIdToLocalId; // this is to map each global id (shifted by the offset) to the local id in the patch
 
 };
 
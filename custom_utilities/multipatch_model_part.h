@@ -25,6 +25,7 @@
 #include "custom_utilities/control_grid_utility.h"
 #include "custom_utilities/multipatch_utility.h"
 #include "custom_utilities/nurbs/bcell.h"
+#include "custom_utilities/nurbs/bsplines_fespace.h"
 #include "custom_utilities/tsplines/tcell.h"
 #include "custom_geometries/isogeometric_geometry.h"
 #include "isogeometric_application/isogeometric_application.h"
@@ -103,6 +104,10 @@ public:
         if (!mpMultiPatch->IsEnumerated())
             KRATOS_THROW_ERROR(std::logic_error, "The multipatch is not enumerated", "")
 
+        // get the control point grids of all patches
+        std::vector<typename ControlGrid<ControlPointType>::ConstPointer> grids;
+        this->GetControlGrids(CONTROL_POINT, grids);
+
         // create new nodes from control points
         for (std::size_t idof = 0; idof < mpMultiPatch->EquationSystemSize(); ++idof)
         {
@@ -113,7 +118,7 @@ public:
             // KRATOS_WATCH(patch_id)
             // KRATOS_WATCH(local_id)
 
-            const ControlPointType& point = mpMultiPatch->pGetPatch(patch_id)->pControlPointGridFunction()->pControlGrid()->GetData(local_id);
+            const ControlPointType& point = grids[patch_id]->GetData(local_id);
 //            std::cout << "dof " << idof << ": point " << point << ", patch " << patch_id << std::endl;
 
             ModelPart::NodeType::Pointer pNewNode = mpModelPart->CreateNewNode(CONVERT_INDEX_IGA_TO_KRATOS(idof), point.X(), point.Y(), point.Z());
@@ -285,22 +290,42 @@ public:
         if (!mpMultiPatch->IsEnumerated())
             KRATOS_THROW_ERROR(std::logic_error, "The multipatch is not enumerated", "")
 
-        // transfer data from from control points to nodes
+        std::vector<NodeType::Pointer> node_table;
+        this->BuildNodeTable(node_table);
+
+        // check the global ids and the nodes before the parallel loop. The equation ids of the nodes start from 0,
+        // hence the ids before the offset of the enumeration are not owned by any patch, and EquationIdLocation throws.
+        const std::size_t offset = mpMultiPatch->GlobalIdOffset();
+        const std::vector<std::size_t>& patch_ids = mpMultiPatch->GlobalIdToPatchId();
+        const std::vector<std::size_t>& local_ids = mpMultiPatch->GlobalIdToLocalId();
         for (std::size_t idof = 0; idof < mpMultiPatch->EquationSystemSize(); ++idof)
         {
-            std::tuple<std::size_t, std::size_t> loc = mpMultiPatch->EquationIdLocation(idof);
+            if ((idof < offset) || (idof - offset >= patch_ids.size()) || (patch_ids[idof - offset] == static_cast<std::size_t>(-1)))
+                mpMultiPatch->EquationIdLocation(idof);
 
-            const std::size_t& patch_id = std::get<0>(loc);
-            const std::size_t& local_id = std::get<1>(loc);
-            // KRATOS_WATCH(patch_id)
-            // KRATOS_WATCH(local_id)
+            if (node_table[idof] == NULL)
+            {
+                std::stringstream ss;
+                ss << "Node " << CONVERT_INDEX_IGA_TO_KRATOS(idof) << " does not exist in the model_part " << mpModelPart->Name();
+                KRATOS_THROW_ERROR(std::logic_error, ss.str(), "")
+            }
+        }
 
-            const typename TVariableType::Type& value = mpMultiPatch->pGetPatch(patch_id)->pGetGridFunction(rVariable)->pControlGrid()->GetData(local_id);
-            // KRATOS_WATCH(value)
+        // get the control grids of all patches
+        std::vector<typename ControlGrid<typename TVariableType::Type>::ConstPointer> grids;
+        this->GetControlGrids(rVariable, grids);
 
-            ModelPart::NodeType::Pointer pNode = mpModelPart->pGetNode(CONVERT_INDEX_IGA_TO_KRATOS(idof));
+        // transfer data from from control points to nodes
+        const int system_size = static_cast<int>(mpMultiPatch->EquationSystemSize());
+        #pragma omp parallel for
+        for (int idof = 0; idof < system_size; ++idof)
+        {
+            const std::size_t& patch_id = patch_ids[idof - offset];
+            const std::size_t& local_id = local_ids[idof - offset];
+            // KRATOS_WATCH(patch_id)
+            // KRATOS_WATCH(local_id)
 
-            pNode->GetSolutionStepValue(rVariable) = value;
+            node_table[idof]->GetSolutionStepValue(rVariable) = grids[patch_id]->GetData(local_id);
         }
     }
 
@@ -310,6 +335,9 @@ public:
     {
         if (!IsReady()) return;
 
+        std::vector<NodeType::Pointer> node_table;
+        this->BuildNodeTable(node_table);
+
         // loop through each patch, we construct a map from each function id to the patch id
         typedef typename MultiPatch<TDim>::patch_iterator patch_iterator;
         for (patch_iterator it = mpMultiPatch->begin();
@@ -328,20 +356,23 @@ public:
             // get the control grid
             typename ControlGrid<typename TVariableType::Type>::Pointer pControlGrid = it->pGetGridFunction(rVariable)->pControlGrid();
 
-            // set the data for the control grid
+            // check the global ids before the parallel loop
             for (std::size_t i = 0; i < pControlGrid->size(); ++i)
             {
-                std::size_t global_id = func_ids[i];
-                std::size_t node_id = CONVERT_INDEX_IGA_TO_KRATOS(global_id);
-
-                NodesContainerType::iterator it_node = mpModelPart->Nodes().find(node_id);
-                if (it_node == mpModelPart->Nodes().end())
+                if ((func_ids[i] >= node_table.size()) || (node_table[func_ids[i]] == NULL))
                 {
                     std::stringstream ss;
-                    ss << "Node " << node_id << " does not exist in the model_part " << mpModelPart->Name();
+                    ss << "Node " << CONVERT_INDEX_IGA_TO_KRATOS(func_ids[i]) << " does not exist in the model_part " << mpModelPart->Name();
                     KRATOS_THROW_ERROR(std::logic_error, ss.str(), "")
                 }
-                pControlGrid->SetData(i, it_node->GetSolutionStepValue(rVariable));
+            }
+
+            // set the data for the control grid
+            const int grid_size = static_cast<int>(pControlGrid->size());
+            #pragma omp parallel for
+            for (int i = 0; i < grid_size; ++i)
+            {
+                pControlGrid->SetData(i, node_table[func_ids[i]]->GetSolutionStepValue(rVariable));
             }
         }
     }
@@ -364,18 +395,45 @@ public:
         double start = OpenMPUtils::GetCurrentTime();
         #endif
 
-        // construct the cell manager out from the FESpace
+        // construct the cell manager out from the FESpace. The BSplinesFESpace may provide its cells in the flat layout.
+        typedef BSplinesFESpace_Helper<TFESpace::Dim()> FlatCellHelperType;
+        typedef typename FlatCellHelperType::FlatCellManagerType flat_cell_container_t;
+        typename flat_cell_container_t::Pointer pFlatCellManager = FlatCellHelperType::pConstructFlatCellManager(*pFESpace);
+
         typedef typename TFESpace::cell_container_t cell_container_t;
-        typename cell_container_t::Pointer pCellManager = pFESpace->ConstructCellManager();
+        typename cell_container_t::Pointer pCellManager;
+        if (pFlatCellManager == NULL)
+            pCellManager = pFESpace->ConstructCellManager();
 
         if (echo_level > 0)
         {
             #ifdef ENABLE_PROFILING
             std::cout << "  ++ ConstructCellManager: " << OpenMPUtils::GetCurrentTime()-start << " s" << std::endl;
-            start = OpenMPUtils::GetCurrentTime();
             #endif
         }
 
+        if (pFlatCellManager != NULL)
+            return CreateEntitiesFromCells<TEntityType, TFESpace, TControlGridType, TNodeContainerType, flat_cell_container_t>(*pFlatCellManager,
+                pFESpace, pControlPointGrid, rNodes, element_name, starting_id, p_temp_properties, echo_level);
+        else
+            return CreateEntitiesFromCells<TEntityType, TFESpace, TControlGridType, TNodeContainerType, cell_container_t>(*pCellManager,
+                pFESpace, pControlPointGrid, rNodes, element_name, starting_id, p_temp_properties, echo_level);
+    }
+
+    /// Create entities (elements/conditions) from the cells of the FESpace. TCellContainerType is the cell container of the FESpace
+    /// or the FlatBCellManager; both give access to the cells by (*it)->...
+    template<class TEntityType, class TFESpace, class TControlGridType, class TNodeContainerType, class TCellContainerType>
+    static PointerVectorSet<TEntityType, IndexedObject> CreateEntitiesFromCells(const TCellContainerType& rCells,
+        typename TFESpace::ConstPointer pFESpace,
+        typename TControlGridType::ConstPointer pControlPointGrid,
+        TNodeContainerType& rNodes, const std::string& element_name,
+        const std::size_t& starting_id, Properties::Pointer p_temp_properties,
+        const int& echo_level)
+    {
+        #ifdef ENABLE_PROFILING
+        double start = OpenMPUtils::GetCurrentTime();
+        #endif
+
         // container for newly created elements
         PointerVectorSet<TEntityType, IndexedObject> pNewElements;
 
@@ -390,129 +448,151 @@ public:
 
         TEntityType const& r_clone_element = KratosComponents<TEntityType>::Get(element_name);
 
-        // loop through each cell in the space
-        typename TEntityType::NodesArrayType temp_element_nodes;
-        typename IsogeometricGeometryType::Pointer p_temp_geometry;
-        std::size_t cnt = starting_id;
         Vector dummy;
         int max_integration_method = 1;
         if (p_temp_properties->Has(NUM_IGA_INTEGRATION_METHOD))
             max_integration_method = (*p_temp_properties)[NUM_IGA_INTEGRATION_METHOD];
 
-        for (typename cell_container_t::iterator it_cell = pCellManager->begin(); it_cell != pCellManager->end(); ++it_cell)
+        // pre-resolve the node pointers into a dense table indexed by node id, to avoid the search in the node container for every anchor
+        typedef typename TEntityType::NodeType::Pointer NodePointerType;
+        std::size_t max_node_id = 0;
+        for (typename TNodeContainerType::ptr_iterator it = rNodes.ptr_begin(); it != rNodes.ptr_end(); ++it)
+            if ((*it)->Id() > max_node_id)
+                max_node_id = (*it)->Id();
+        std::vector<NodePointerType> node_table(max_node_id + 1);
+        for (typename TNodeContainerType::ptr_iterator it = rNodes.ptr_begin(); it != rNodes.ptr_end(); ++it)
+            node_table[(*it)->Id()] = *it;
+
+        // collect the cells to allow for random access
+        std::vector<typename TCellContainerType::const_iterator> cells;
+        cells.reserve(rCells.size());
+        for (typename TCellContainerType::const_iterator it_cell = rCells.begin(); it_cell != rCells.end(); ++it_cell)
+            cells.push_back(it_cell);
+
+        // create the entities in parallel. The id of the entity created from the i-th cell is starting_id + i, which is the same as the serial loop.
+        // In debug mode (echo_level > 1) only one thread is used to keep the output readable.
+        std::vector<typename TEntityType::Pointer> new_entities(cells.size());
+        int number_of_threads = (echo_level > 1) ? 1 : OpenMPUtils::GetNumThreads();
+        std::vector<unsigned int> cell_partition;
+        OpenMPUtils::CreatePartition(number_of_threads, cells.size(), cell_partition);
+        std::vector<std::string> error_messages(number_of_threads);
+
+        #pragma omp parallel for
+        for (int k = 0; k < number_of_threads; ++k)
         {
-            // KRATOS_WATCH(*(*it_cell))
-            // get new nodes
-            temp_element_nodes.clear();
-
-            const std::vector<std::size_t>& anchors = (*it_cell)->GetSupportedAnchors();
-            Vector weights(anchors.size());
-            for (std::size_t i = 0; i < anchors.size(); ++i)
-            {
-                temp_element_nodes.push_back(( *(MultiPatchUtility::FindKey(rNodes, CONVERT_INDEX_IGA_TO_KRATOS(anchors[i]), "Node").base())));
-                weights[i] = pControlPointGrid->GetData(pFESpace->LocalId(anchors[i])).W();
-            }
-
-            if (echo_level > 1)
+            try
             {
-                std::cout << "anchors:";
-                for (std::size_t i = 0; i < anchors.size(); ++i)
-                    std::cout << " " << CONVERT_INDEX_IGA_TO_KRATOS(anchors[i]);
-                std::cout << std::endl;
-                KRATOS_WATCH(weights)
-                // KRATOS_WATCH((*it_cell)->GetExtractionOperator())
-                KRATOS_WATCH((*it_cell)->GetCompressedExtractionOperator())
-                KRATOS_WATCH(pFESpace->Order(0))
-                KRATOS_WATCH(pFESpace->Order(1))
-                KRATOS_WATCH(pFESpace->Order(2))
-            }
+                typename TEntityType::NodesArrayType temp_element_nodes;
+                typename IsogeometricGeometryType::Pointer p_temp_geometry;
 
-            // create the geometry
-            p_temp_geometry = boost::dynamic_pointer_cast<IsogeometricGeometryType>(r_clone_element.GetGeometry().Create(temp_element_nodes));
-            if (p_temp_geometry == NULL)
-                KRATOS_THROW_ERROR(std::runtime_error, "The cast to IsogeometricGeometry is failed.", "")
-
-            p_temp_geometry->AssignGeometryData(dummy,
-                                                dummy,
-                                                dummy,
-                                                weights,
-                                                // (*it_cell)->GetExtractionOperator(),
-                                                (*it_cell)->GetCompressedExtractionOperator(),
-                                                static_cast<int>(pFESpace->Order(0)),
-                                                static_cast<int>(pFESpace->Order(1)),
-                                                static_cast<int>(pFESpace->Order(2)),
-                                                max_integration_method);
-
-            if (echo_level > 1)
-            {
-                for (int irule = 0; irule < max_integration_method; ++irule)
+                for (std::size_t ic = cell_partition[k]; ic < cell_partition[k + 1]; ++ic)
                 {
-                    std::cout << "integration points for rule " << irule << ":" << std::endl;
-                    typedef typename IsogeometricGeometryType::IntegrationPointsArrayType IntegrationPointsArrayType;
-                    const IntegrationPointsArrayType& integration_points = p_temp_geometry->IntegrationPoints((GeometryData::IntegrationMethod) irule);
-                    for (std::size_t i = 0; i < integration_points.size(); ++i)
-                        std::cout << " " << i << ": " << integration_points[i] << std::endl;
+                    typename TCellContainerType::const_iterator it_cell = cells[ic];
+
+                    // KRATOS_WATCH(*(*it_cell))
+                    // get new nodes
+                    temp_element_nodes.clear();
+
+                    const std::vector<std::size_t>& anchors = (*it_cell)->GetSupportedAnchors();
+                    Vector weights(anchors.size());
+                    for (std::size_t i = 0; i < anchors.size(); ++i)
+                    {
+                        std::size_t node_id = CONVERT_INDEX_IGA_TO_KRATOS(anchors[i]);
+                        if (node_id > max_node_id || node_table[node_id] == NULL)
+                        {
+                            std::stringstream buffer;
+                            buffer << "Node #" << node_id << " is not found.";
+                            KRATOS_THROW_ERROR(std::invalid_argument, buffer.str(), "");
+                        }
+                        temp_element_nodes.push_back(node_table[node_id]);
+                        weights[i] = pControlPointGrid->GetData(pFESpace->LocalId(anchors[i])).W();
+                    }
+
+                    if (echo_level > 1)
+                    {
+                        std::cout << "anchors:";
+                        for (std::size_t i = 0; i < anchors.size(); ++i)
+                            std::cout << " " << CONVERT_INDEX_IGA_TO_KRATOS(anchors[i]);
+                        std::cout << std::endl;
+                        KRATOS_WATCH(weights)
+                        // KRATOS_WATCH((*it_cell)->GetExtractionOperator())
+                        KRATOS_WATCH((*it_cell)->GetCompressedExtractionOperator())
+                        KRATOS_WATCH(pFESpace->Order(0))
+                        KRATOS_WATCH(pFESpace->Order(1))
+                        KRATOS_WATCH(pFESpace->Order(2))
+                    }
+
+                    // create the geometry
+                    p_temp_geometry = boost::dynamic_pointer_cast<IsogeometricGeometryType>(r_clone_element.GetGeometry().Create(temp_element_nodes));
+                    if (p_temp_geometry == NULL)
+                        KRATOS_THROW_ERROR(std::runtime_error, "The cast to IsogeometricGeometry is failed.", "")
+
+                    // the integration rule is registered by the first geometry requiring it; the registry in BezierUtils is thread-safe
+                    p_temp_geometry->AssignGeometryData(dummy,
+                                                        dummy,
+                                                        dummy,
+                                                        weights,
+                                                        // (*it_cell)->GetExtractionOperator(),
+                                                        (*it_cell)->GetCompressedExtractionOperator(),
+                                                        static_cast<int>(pFESpace->Order(0)),
+                                                        static_cast<int>(pFESpace->Order(1)),
+                                                        static_cast<int>(pFESpace->Order(2)),
+                                                        max_integration_method);
+
+                    if (echo_level > 1)
+                    {
+                        for (int irule = 0; irule < max_integration_method; ++irule)
+                        {
+                            std::cout << "integration points for rule " << irule << ":" << std::endl;
+                            typedef typename IsogeometricGeometryType::IntegrationPointsArrayType IntegrationPointsArrayType;
+                            const IntegrationPointsArrayType& integration_points = p_temp_geometry->IntegrationPoints((GeometryData::IntegrationMethod) irule);
+                            for (std::size_t i = 0; i < integration_points.size(); ++i)
+                                std::cout << " " << i << ": " << integration_points[i] << std::endl;
+                        }
+                    }
+
+                    // create the element
+                    typename TEntityType::Pointer pNewElement = r_clone_element.Create(starting_id + ic, p_temp_geometry, p_temp_properties);
+                    pNewElement->SetValue(ACTIVATION_LEVEL, 0);
+                    #ifdef IS_INACTIVE
+                    pNewElement->SetValue(IS_INACTIVE, false);
+                    #endif
+                    pNewElement->Set(ACTIVE, true);
+                    new_entities[ic] = pNewElement;
+
+                    AssignCellKnotValues(*pNewElement, *it_cell, echo_level);
+
+                    // set the level
+                    pNewElement->SetValue(HIERARCHICAL_LEVEL, (*it_cell)->Level());
+                    pNewElement->SetValue(CELL_INDEX, (*it_cell)->Id());
+
+                    if (echo_level > 1)
+                    {
+                        std::cout << "Entity " << element_name << " " << pNewElement->Id() << " is created" << std::endl;
+                        std::cout << "  Connectivity:";
+                        for (unsigned int i = 0; i < p_temp_geometry->size(); ++i)
+                        {
+                            std::cout << " " << (*p_temp_geometry)[i].Id();
+                        }
+                        std::cout << std::endl;
+                    }
                 }
             }
-
-            // create the element and add to the list
-            typename TEntityType::Pointer pNewElement = r_clone_element.Create(cnt++, p_temp_geometry, p_temp_properties);
-            pNewElement->SetValue(ACTIVATION_LEVEL, 0);
-            #ifdef IS_INACTIVE
-            pNewElement->SetValue(IS_INACTIVE, false);
-            #endif
-            pNewElement->Set(ACTIVE, true);
-            pNewElements.push_back(pNewElement);
-
-            //////////
-            try
-            {
-                BCell& c = dynamic_cast<BCell&>(**it_cell);
-                pNewElement->SetValue( KNOT_LEFT, c.XiMinValue() );
-                pNewElement->SetValue( KNOT_RIGHT, c.XiMaxValue() );
-                pNewElement->SetValue( KNOT_BOTTOM, c.EtaMinValue() );
-                pNewElement->SetValue( KNOT_TOP, c.EtaMaxValue() );
-                pNewElement->SetValue( KNOT_FRONT, c.ZetaMinValue() );
-                pNewElement->SetValue( KNOT_BACK, c.ZetaMaxValue() );
-            }
-            catch (std::bad_cast& bc)
+            catch (std::exception& e)
             {
-                if (echo_level > 2)
-                    std::cout << "WARNING: cell " << (*it_cell)->Id() << " cannot be casted to BCell" << std::endl;
+                // the exception must not escape the parallel region; it is re-thrown below
+                error_messages[k] = e.what();
             }
+        }
 
-            try
-            {
-                TCell& c = dynamic_cast<TCell&>(**it_cell);
-                pNewElement->SetValue( KNOT_LEFT, c.XiMinValue() );
-                pNewElement->SetValue( KNOT_RIGHT, c.XiMaxValue() );
-                pNewElement->SetValue( KNOT_BOTTOM, c.EtaMinValue() );
-                pNewElement->SetValue( KNOT_TOP, c.EtaMaxValue() );
-                pNewElement->SetValue( KNOT_FRONT, c.ZetaMinValue() );
-                pNewElement->SetValue( KNOT_BACK, c.ZetaMaxValue() );
-            }
-            catch (std::bad_cast& bc)
-            {
-                if (echo_level > 2)
-                    std::cout << "WARNING: cell " << (*it_cell)->Id() << " cannot be casted to TCell" << std::endl;
-            }
-            //////////
-
-            // set the level
-            pNewElement->SetValue(HIERARCHICAL_LEVEL, (*it_cell)->Level());
-            pNewElement->SetValue(CELL_INDEX, (*it_cell)->Id());
+        for (int k = 0; k < number_of_threads; ++k)
+            if (!error_messages[k].empty())
+                KRATOS_THROW_ERROR(std::runtime_error, error_messages[k], "")
 
-            if (echo_level > 1)
-            {
-                std::cout << "Entity " << element_name << " " << pNewElement->Id() << " is created" << std::endl;
-                std::cout << "  Connectivity:";
-                for (unsigned int i = 0; i < p_temp_geometry->size(); ++i)
-                {
-                    std::cout << " " << (*p_temp_geometry)[i].Id();
-                }
-                std::cout << std::endl;
-            }
-        }
+        // add the entities to the list, in the order of the cells
+        pNewElements.reserve(new_entities.size());
+        for (std::size_t ic = 0; ic < new_entities.size(); ++ic)
+            pNewElements.push_back(new_entities[ic]);
 
         if (echo_level > 0)
         {
@@ -525,6 +605,55 @@ public:
         return pNewElements;
     }
 
+    /// Assign the knot values of the cell to the entity
+    template<class TEntityType>
+    static void AssignCellKnotValues(TEntityType& rEntity, Cell* pCell, const int& echo_level)
+    {
+        try
+        {
+            BCell& c = dynamic_cast<BCell&>(*pCell);
+            rEntity.SetValue( KNOT_LEFT, c.XiMinValue() );
+            rEntity.SetValue( KNOT_RIGHT, c.XiMaxValue() );
+            rEntity.SetValue( KNOT_BOTTOM, c.EtaMinValue() );
+            rEntity.SetValue( KNOT_TOP, c.EtaMaxValue() );
+            rEntity.SetValue( KNOT_FRONT, c.ZetaMinValue() );
+            rEntity.SetValue( KNOT_BACK, c.ZetaMaxValue() );
+        }
+        catch (std::bad_cast& bc)
+        {
+            if (echo_level > 2)
+                std::cout << "WARNING: cell " << pCell->Id() << " cannot be casted to BCell" << std::endl;
+        }
+
+        try
+        {
+            TCell& c = dynamic_cast<TCell&>(*pCell);
+            rEntity.SetValue( KNOT_LEFT, c.XiMinValue() );
+            rEntity.SetValue( KNOT_RIGHT, c.XiMaxValue() );
+            rEntity.SetValue( KNOT_BOTTOM, c.EtaMinValue() );
+            rEntity.SetValue( KNOT_TOP, c.EtaMaxValue() );
+            rEntity.SetValue( KNOT_FRONT, c.ZetaMinValue() );
+            rEntity.SetValue( KNOT_BACK, c.ZetaMaxValue() );
+        }
+        catch (std::bad_cast& bc)
+        {
+            if (echo_level > 2)
+                std::cout << "WARNING: cell " << pCell->Id() << " cannot be casted to TCell" << std::endl;
+        }
+    }
+
+    /// Assign the knot values of the cell in the flat layout to the entity
+    template<class TEntityType, int TCellDim>
+    static void AssignCellKnotValues(TEntityType& rEntity, const FlatBCellView<TCellDim>& rCell, const int& echo_level)
+    {
+        rEntity.SetValue( KNOT_LEFT, rCell.XiMinValue() );
+        rEntity.SetValue( KNOT_RIGHT, rCell.XiMaxValue() );
+        rEntity.SetValue( KNOT_BOTTOM, rCell.EtaMinValue() );
+        rEntity.SetValue( KNOT_TOP, rCell.EtaMaxValue() );
+        rEntity.SetValue( KNOT_FRONT, rCell.ZetaMinValue() );
+        rEntity.SetValue( KNOT_BACK, rCell.ZetaMaxValue() );
+    }
+
     /// Information
     virtual void PrintInfo(std::ostream& rOStream) const
     {
@@ -546,6 +675,35 @@ private:
     ModelPart::Pointer mpModelPart;
     typename MultiPatch<TDim>::Pointer mpMultiPatch;
 
+    /// Build the table of the nodes of the model_part indexed by the equation id, by one pass over the nodes. The table
+    /// is not kept between the calls, since the nodes of the model_part or the enumeration may change in between.
+    /// The entries of the equation ids without node are null.
+    void BuildNodeTable(std::vector<NodeType::Pointer>& rNodeTable) const
+    {
+        rNodeTable.assign(mpMultiPatch->EquationSystemSize(), NodeType::Pointer());
+        for (ModelPart::NodesContainerType::ptr_iterator it = mpModelPart->Nodes().ptr_begin(); it != mpModelPart->Nodes().ptr_end(); ++it)
+        {
+            const std::size_t idof = CONVERT_INDEX_KRATOS_TO_IGA((*it)->Id());
+            if (idof < rNodeTable.size())
+                rNodeTable[idof] = *it;
+        }
+    }
+
+    /// Get the control grids of the variable for all patches, indexed by the patch id
+    template<class TVariableType>
+    void GetControlGrids(const TVariableType& rVariable, std::vector<typename ControlGrid<typename TVariableType::Type>::ConstPointer>& rGrids) const
+    {
+        std::size_t max_patch_id = 0;
+        for (typename MultiPatch<TDim>::patch_const_iterator it = mpMultiPatch->begin(); it != mpMultiPatch->end(); ++it)
+            if (it->Id() > max_patch_id)
+                max_patch_id = it->Id();
+
+        rGrids.clear();
+        rGrids.resize(max_patch_id + 1);
+        for (typename MultiPatch<TDim>::patch_const_iterator it = mpMultiPatch->begin(); it != mpMultiPatch->end(); ++it)
+            rGrids[it->Id()] = it->pGetGridFunction(rVariable)->pControlGrid();
+    }
+
 };
 
 /// output stream function
@@ -0,0 +1,223 @@
+//
+//   Project Name:        Kratos
+//   Last Modified by:    $Author: hbui $
+//   Date:                $Date: 17 Oct 2026 $
+//   Revision:            $Revision: 1.0 $
+//
+//
+
+#if !defined(KRATOS_ISOGEOMETRIC_APPLICATION_NODE_WELDING_UTILITY_H_INCLUDED )
+#define  KRATOS_ISOGEOMETRIC_APPLICATION_NODE_WELDING_UTILITY_H_INCLUDED
+
+// System includes
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// External includes
+#include <omp.h>
+
+// Project includes
+#include "includes/define.h"
+#include "utilities/openmp_utils.h"
+
+namespace Kratos
+{
+
+/**
+ * Utility to weld (merge) coincident points in parallel. The points are hashed into a uniform grid, whose cells are
+ * sorted by their Morton keys; each point is then compared with the points of the neighbouring cells only.
+ * The welding is deterministic: a point is welded to the first point within the tolerance, and the welded nodes are
+ * numbered in order of first appearance, i.e. the same numbering as inserting the points one by one into a
+ * collapsing bin.
+ */
+class NodeWeldingUtility
+{
+public:
+    /// Pointer definition
+    KRATOS_CLASS_POINTER_DEFINITION(NodeWeldingUtility);
+
+    /// Type definitions
+    typedef std::size_t IndexType;
+    typedef unsigned long long KeyType;
+
+    /// Default constructor
+    NodeWeldingUtility()
+    {}
+
+    /// Destructor
+    virtual ~NodeWeldingUtility()
+    {}
+
+    /**
+     * Weld the points within the tolerance.
+     * @param rPoints               flat array of the point coordinates (x0, y0, z0, x1, y1, z1, ...)
+     * @param tol                   the tolerance to weld two points
+     * @param characteristic_length the preferred cell size, e.g. half of the smallest distance between the points
+     *                              generated on one element. The cell size is never smaller than the tolerance.
+     * @param rWeldedIndices        on output, the 0-based index of the welded node of each point
+     * @return                      the number of welded nodes
+     */
+    static IndexType Weld(const std::vector<double>& rPoints, const double& tol, const double& characteristic_length,
+            std::vector<IndexType>& rWeldedIndices)
+    {
+        const IndexType n = rPoints.size() / 3;
+        rWeldedIndices.resize(n);
+        if (n == 0)
+            return 0;
+
+        // bounding box of the points
+        double xmin[3], xmax[3];
+        for (int d = 0; d < 3; ++d)
+        {
+            xmin[d] = rPoints[d];
+            xmax[d] = rPoints[d];
+        }
+        for (IndexType i = 1; i < n; ++i)
+        {
+            for (int d = 0; d < 3; ++d)
+            {
+                xmin[d] = std::min(xmin[d], rPoints[3*i + d]);
+                xmax[d] = std::max(xmax[d], rPoints[3*i + d]);
+            }
+        }
+        double extent = 0.0;
+        for (int d = 0; d < 3; ++d)
+            extent = std::max(extent, xmax[d] - xmin[d]);
+
+        // the cell size shall not be smaller than the tolerance, so that only the neighbouring cells are searched,
+        // and the number of cells in each direction shall fit in the Morton key
+        double h = std::max(tol, characteristic_length);
+        if (extent / mMaxCells > h)
+            h = extent / mMaxCells;
+        if (h <= 0.0)
+            h = 1.0;
+
+        // compute the cells and the keys of the points in parallel
+        std::vector<unsigned int> cells(3*n);
+        std::vector<std::pair<KeyType, IndexType> > keys(n);
+
+        int number_of_threads = omp_get_max_threads();
+        std::vector<unsigned int> point_partition;
+        OpenMPUtils::CreatePartition(number_of_threads, n, point_partition);
+
+        #pragma omp parallel for
+        for (int k = 0; k < number_of_threads; ++k)
+        {
+            for (unsigned int i = point_partition[k]; i < point_partition[k + 1]; ++i)
+            {
+                for (int d = 0; d < 3; ++d)
+                    cells[3*i + d] = static_cast<unsigned int>(std::floor((rPoints[3*i + d] - xmin[d]) / h));
+                keys[i] = std::make_pair(MortonKey(cells[3*i], cells[3*i + 1], cells[3*i + 2]), i);
+            }
+        }
+
+        // sort the keys, in parallel for each partition and then merge the partitions
+        #pragma omp parallel for
+        for (int k = 0; k < number_of_threads; ++k)
+            std::sort(keys.begin() + point_partition[k], keys.begin() + point_partition[k + 1]);
+        for (int step = 1; step < number_of_threads; step *= 2)
+        {
+            for (int k = 0; k + step < number_of_threads; k += 2*step)
+            {
+                const int k_end = std::min(k + 2*step, number_of_threads);
+                std::inplace_merge(keys.begin() + point_partition[k], keys.begin() + point_partition[k + step],
+                        keys.begin() + point_partition[k_end]);
+            }
+        }
+
+        // for each point, find the first point within the tolerance in the neighbouring cells, in parallel
+        std::vector<IndexType> first(n);
+        const double tol2 = tol * tol;
+
+        #pragma omp parallel for
+        for (int k = 0; k < number_of_threads; ++k)
+        {
+            for (unsigned int i = point_partition[k]; i < point_partition[k + 1]; ++i)
+            {
+                IndexType best = i;
+                for (int di = -1; di <= 1; ++di)
+                for (int dj = -1; dj <= 1; ++dj)
+                for (int dk = -1; dk <= 1; ++dk)
+                {
+                    if ((di < 0 && cells[3*i] == 0) || (dj < 0 && cells[3*i + 1] == 0) || (dk < 0 && cells[3*i + 2] == 0))
+                        continue;
+
+                    const KeyType key = MortonKey(cells[3*i] + di, cells[3*i + 1] + dj, cells[3*i + 2] + dk);
+                    std::vector<std::pair<KeyType, IndexType> >::const_iterator it = std::lower_bound(keys.begin(), keys.end(),
+                            std::make_pair(key, static_cast<IndexType>(0)));
+                    for (; it != keys.end() && it->first == key && it->second < best; ++it)
+                    {
+                        const IndexType j = it->second;
+                        double dist2 = 0.0;
+                        for (int d = 0; d < 3; ++d)
+                            dist2 += std::pow(rPoints[3*i + d] - rPoints[3*j + d], 2);
+                        if (dist2 <= tol2)
+                            best = j;
+                    }
+                }
+                first[i] = best;
+            }
+        }
+
+        // number the welded nodes in order of first appearance. Since first[i] <= i, the welded node of first[i] is
+        // already known when point i is visited.
+        IndexType number_of_nodes = 0;
+        for (IndexType i = 0; i < n; ++i)
+        {
+            if (first[i] == i)
+                rWeldedIndices[i] = number_of_nodes++;
+            else
+                rWeldedIndices[i] = rWeldedIndices[first[i]];
+        }
+
+        return number_of_nodes;
+    }
+
+    /// Morton key of a cell, by interleaving the bits of the cell indices
+    static KeyType MortonKey(const unsigned int& i, const unsigned int& j, const unsigned int& k)
+    {
+        return SpreadBits(i) | (SpreadBits(j) << 1) | (SpreadBits(k) << 2);
+    }
+
+    /// Information
+    virtual void PrintInfo(std::ostream& rOStream) const
+    {
+        rOStream << "NodeWeldingUtility";
+    }
+
+    virtual void PrintData(std::ostream& rOStream) const
+    {}
+
+private:
+
+    /// Maximum number of cells in each direction, limited by the 21 bits of each direction in the Morton key
+    static constexpr double mMaxCells = 2097150.0;
+
+    /// Spread the lower 21 bits of x, such that there are two zero bits between each two bits
+    static KeyType SpreadBits(const unsigned int& x)
+    {
+        KeyType v = x & 0x1fffff;
+        v = (v | (v << 32)) & 0x1f00000000ffffULL;
+        v = (v | (v << 16)) & 0x1f0000ff0000ffULL;
+        v = (v | (v << 8)) & 0x100f00f00f00f00fULL;
+        v = (v | (v << 4)) & 0x10c30c30c30c30c3ULL;
+        v = (v | (v << 2)) & 0x1249249249249249ULL;
+        return v;
+    }
+
+}; // Class NodeWeldingUtility
+
+/// output stream function
+inline std::ostream& operator << (std::ostream& rOStream, const NodeWeldingUtility& rThis)
+{
+    rThis.PrintInfo(rOStream);
+    rOStream << std::endl;
+    rThis.PrintData(rOStream);
+    return rOStream;
+}
+
+}// namespace Kratos.
+
+#endif // KRATOS_ISOGEOMETRIC_APPLICATION_NODE_WELDING_UTILITY_H_INCLUDED
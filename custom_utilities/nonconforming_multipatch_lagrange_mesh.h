@@ -11,6 +11,8 @@
 
 // System includes
 #include <vector>
+#include <algorithm>
+#include <cmath>
 
 // External includes
 
@@ -23,6 +25,8 @@
 #include "custom_utilities/fespace.h"
 #include "custom_utilities/patch.h"
 #include "custom_utilities/multipatch_utility.h"
+#include "custom_utilities/nurbs/bsplines_fespace.h"
+#include "custom_utilities/nurbs/bsplines_patch_interface.h"
 #include "custom_utilities/isogeometric_post_utility.h"
 
 // #define DEBUG_MESH_GENERATION
@@ -34,6 +38,8 @@ namespace Kratos
 Construct the standard FEM mesh based on Lagrange basis functions from isogeometric multipatch. Each patch can have different division and is non-conformed at the boundary.
 The principle is that each patch will be sampled based on number of divisions defined by used. Therefore user is not able to see the knot density.
 At the end, the resulting model_part will have nodal values interpolated from patch. This class is useful for post-processing all types of isogeometric patches, including NURBS, hierarchical B-Splines and T-Splines.
+In the adaptive mode, each knot span is bisected until the deviation of the patch (and of the selected variables) from its linear interpolation is below the tolerance. The
+sampling parameters are then synchronized across the patch interfaces, so that the resulting mesh is geometrically crack-free.
  */
 template<int TDim>
 class NonConformingMultipatchLagrangeMesh : public IsogeometricEcho
@@ -47,10 +53,13 @@ public:
     typedef typename Element::GeometryType::PointType NodeType;
     typedef ModelPart::ElementsContainerType ElementsArrayType;
     typedef std::size_t IndexType;
+    typedef Patch<TDim> PatchType;
+    typedef typename PatchType::ControlPointType ControlPointType;
+    typedef boost::array<std::vector<double>, TDim> SamplingParametersType;
 
     /// Default constructor
     NonConformingMultipatchLagrangeMesh(typename MultiPatch<TDim>::Pointer pMultiPatch)
-    : mpMultiPatch(pMultiPatch), mEchoLevel(1)
+    : mpMultiPatch(pMultiPatch), mEchoLevel(1), mAdaptiveTolerance(0.0), mMaxAdaptiveLevel(0)
     {}
 
     /// Destructor
@@ -85,6 +94,25 @@ public:
         mNumDivision[patch_id][dim] = num_division;
     }
 
+    /// Enable the adaptive division. Each knot span is bisected at most max_level times, until the deviation of the
+    /// geometry from its linear interpolation is below tol. If tol <= 0, the division set by SetDivision is used.
+    /// Note that if the division is changed, the post_model_part must be generated again
+    void SetAdaptiveDivision(const double& tol, const IndexType& max_level)
+    {
+        mAdaptiveTolerance = tol;
+        mMaxAdaptiveLevel = max_level;
+    }
+
+    /// Add a variable to the error estimation of the adaptive division. The knot spans are also bisected until the
+    /// deviation of the variable from its linear interpolation is below tol.
+    void AddAdaptiveVariable(const Variable<double>& rVariable, const double& tol)
+    {
+        if (tol <= 0.0)
+            KRATOS_THROW_ERROR(std::logic_error, "The tolerance must be positive, tol =", tol)
+
+        mAdaptiveVariables.push_back(std::make_pair(&rVariable, tol));
+    }
+
     /// Set the base element name
     void SetBaseElementName(const std::string& BaseElementName) {mBaseElementName = BaseElementName;}
 
@@ -119,6 +147,10 @@ public:
 
         Element const& rCloneElement = KratosComponents<Element>::Get(element_name);
 
+        // compute the sampling parameters of all the patches
+        std::map<IndexType, SamplingParametersType> SamplingParameters;
+        this->ComputeSamplingParameters(SamplingParameters);
+
         // generate nodes and elements for each patch
         IndexType NodeCounter = mLastNodeId;
         IndexType ElementCounter = mLastElemId;
@@ -145,53 +177,28 @@ public:
             // generate the connectivities
             std::pair<std::vector<array_1d<double, 3> >, std::vector<std::vector<IndexType> > > points_and_connectivities;
 
+            const SamplingParametersType& rSamples = SamplingParameters[it->Id()];
+            if (mEchoLevel > 1)
+            {
+                std::cout << "Divisioning for patch " << it->Id() << ":";
+                for (IndexType dim = 0; dim < TDim; ++dim)
+                    std::cout << " " << rSamples[dim].size() - 1;
+                std::cout << std::endl;
+            }
+
             if (TDim == 2)
             {
                 // create new nodes and elements
-                typename std::map<IndexType, boost::array<IndexType, TDim> >::const_iterator it_num = mNumDivision.find(it->Id());
-                if (it_num == mNumDivision.end())
-                    KRATOS_THROW_ERROR(std::logic_error, "NumDivision is not set for patch", it->Id())
-
-                IndexType NumDivision1 = it_num->second[0];
-                IndexType NumDivision2 = it_num->second[1];
-                if (mEchoLevel > 1)
-                    std::cout << "Divisioning for patch " << it->Id() << ": " << NumDivision1
-                              << " " << NumDivision2 << std::endl;
-
-                std::vector<array_1d<double, 3> > corners(4);
-
-                IsogeometricPostUtility::GenerateRectangle(corners, 0.0, 1.0, 0.0, 1.0);
-
-                points_and_connectivities = IsogeometricPostUtility::GenerateQuadGrid(corners[0], corners[1],
-                        corners[2], corners[3], NodeCounter, NumDivision1, NumDivision2);
+                points_and_connectivities = IsogeometricPostUtility::GenerateQuadGrid<array_1d<double, 3> >(rSamples[0], rSamples[1], NodeCounter);
             }
             else if (TDim == 3)
             {
                 // create new nodes and elements
-                typename std::map<IndexType, boost::array<IndexType, TDim> >::const_iterator it_num = mNumDivision.find(it->Id());
-                if (it_num == mNumDivision.end())
-                    KRATOS_THROW_ERROR(std::logic_error, "NumDivision is not set for patch", it->Id())
-
-                IndexType NumDivision1 = it_num->second[0];
-                IndexType NumDivision2 = it_num->second[1];
-                IndexType NumDivision3 = it_num->second[2];
-                if (mEchoLevel > 1)
-                    std::cout << "Divisioning for patch " << it->Id() << ": " << NumDivision1
-                              << " " << NumDivision2 << " " << NumDivision3 << std::endl;
-
-                std::vector<array_1d<double, 3> > corners(8);
-
-                IsogeometricPostUtility::GenerateBox(corners, 0.0, 1.0, 0.0, 1.0, 0.0, 1.0);
-
-                points_and_connectivities = IsogeometricPostUtility::GenerateHexGrid(corners[0], corners[1], corners[2], corners[3],
-                        corners[4], corners[5], corners[6], corners[7], NodeCounter, NumDivision1, NumDivision2, NumDivision3);
+                points_and_connectivities = IsogeometricPostUtility::GenerateHexGrid<array_1d<double, 3> >(rSamples[0], rSamples[1], rSamples[2], NodeCounter);
             }
 
             // create nodes
-            for (std::size_t i = 0; i < points_and_connectivities.first.size(); ++i)
-            {
-                IsogeometricPostUtility::CreateNodeAndTransferValues(points_and_connectivities.first[i], *it, r_model_part, NodeCounter++);
-            }
+            IsogeometricPostUtility::CreateNodesAndTransferValues(points_and_connectivities.first, *it, r_model_part, NodeCounter);
 
             // create elements
             ElementsArrayType pNewElements = IsogeometricPostUtility::CreateEntities<std::vector<std::vector<IndexType> >, Element, ElementsArrayType>(
@@ -217,6 +224,41 @@ public:
         }
     }
 
+    /// Compute the sampling parameters of the active patches in each parametric direction, which are the grid lines of the
+    /// Lagrange mesh of the patches. The parametric domain of the patch is assumed to be [0, 1]^TDim.
+    void ComputeSamplingParameters(std::map<IndexType, SamplingParametersType>& rSamplingParameters) const
+    {
+        typedef typename MultiPatch<TDim>::patch_iterator patch_iterator;
+        for (patch_iterator it = mpMultiPatch->begin(); it != mpMultiPatch->end(); ++it)
+        {
+            if (!it->Is(ACTIVE))
+                continue;
+
+            SamplingParametersType& rSamples = rSamplingParameters[it->Id()];
+
+            if (mAdaptiveTolerance > 0.0)
+            {
+                this->ComputeAdaptiveSamplingParameters(*it, rSamples);
+            }
+            else
+            {
+                typename std::map<IndexType, boost::array<IndexType, TDim> >::const_iterator it_num = mNumDivision.find(it->Id());
+                if (it_num == mNumDivision.end())
+                    KRATOS_THROW_ERROR(std::logic_error, "NumDivision is not set for patch", it->Id())
+
+                for (IndexType dim = 0; dim < TDim; ++dim)
+                {
+                    rSamples[dim].resize(it_num->second[dim] + 1);
+                    for (IndexType i = 0; i <= it_num->second[dim]; ++i)
+                        rSamples[dim][i] = ((double) i) / it_num->second[dim];
+                }
+            }
+        }
+
+        if (mAdaptiveTolerance > 0.0)
+            this->SynchronizeSamplingParameters(rSamplingParameters);
+    }
+
     /// Information
     virtual void PrintInfo(std::ostream& rOStream) const
     {
@@ -238,6 +280,241 @@ private:
     IndexType mLastElemId;
 
     int mEchoLevel;
+
+    double mAdaptiveTolerance;
+    IndexType mMaxAdaptiveLevel;
+    std::vector<std::pair<const Variable<double>*, double> > mAdaptiveVariables;
+
+    /// Compute the sampling parameters of a patch by bisecting its knot spans. The deviation is estimated along the
+    /// probing lines passing through the knots and the span centers of the other directions. All the intervals of
+    /// the same bisection level are evaluated at once.
+    void ComputeAdaptiveSamplingParameters(const PatchType& rPatch, SamplingParametersType& rSamples) const
+    {
+        SamplingParametersType breakpoints, probes;
+        for (IndexType dim = 0; dim < TDim; ++dim)
+        {
+            breakpoints[dim] = ExtractBreakpoints(rPatch, dim);
+            probes[dim] = breakpoints[dim];
+            for (IndexType i = 0; i < breakpoints[dim].size() - 1; ++i)
+                probes[dim].push_back(0.5 * (breakpoints[dim][i] + breakpoints[dim][i+1]));
+        }
+
+        for (IndexType dim = 0; dim < TDim; ++dim)
+        {
+            // the probing lines are the tensor product of the probes in the other directions
+            std::vector<std::vector<double> > lines(1, std::vector<double>(TDim, 0.0));
+            for (IndexType other_dim = 0; other_dim < TDim; ++other_dim)
+            {
+                if (other_dim == dim)
+                    continue;
+
+                std::vector<std::vector<double> > new_lines;
+                for (IndexType i = 0; i < lines.size(); ++i)
+                {
+                    for (IndexType j = 0; j < probes[other_dim].size(); ++j)
+                    {
+                        new_lines.push_back(lines[i]);
+                        new_lines.back()[other_dim] = probes[other_dim][j];
+                    }
+                }
+                lines.swap(new_lines);
+            }
+
+            rSamples[dim] = breakpoints[dim];
+
+            std::vector<std::pair<double, double> > intervals;
+            for (IndexType i = 0; i < breakpoints[dim].size() - 1; ++i)
+                intervals.push_back(std::make_pair(breakpoints[dim][i], breakpoints[dim][i+1]));
+
+            IndexType level = 0;
+            while (!intervals.empty())
+            {
+                // 5 equidistant points on each interval and probing line
+                std::vector<double> xi;
+                xi.reserve(intervals.size() * lines.size() * 5 * TDim);
+                for (IndexType i = 0; i < intervals.size(); ++i)
+                {
+                    for (IndexType l = 0; l < lines.size(); ++l)
+                    {
+                        for (int t = 0; t < 5; ++t)
+                        {
+                            for (IndexType d = 0; d < TDim; ++d)
+                            {
+                                if (d == dim)
+                                    xi.push_back(intervals[i].first + 0.25 * t * (intervals[i].second - intervals[i].first));
+                                else
+                                    xi.push_back(lines[l][d]);
+                            }
+                        }
+                    }
+                }
+
+                std::vector<double> ratios;
+                this->ComputeDeviationRatios(rPatch, xi, ratios);
+
+                std::vector<std::pair<double, double> > new_intervals;
+                for (IndexType i = 0; i < intervals.size(); ++i)
+                {
+                    double ratio = 0.0;
+                    for (IndexType l = 0; l < lines.size(); ++l)
+                        ratio = std::max(ratio, ratios[i * lines.size() + l]);
+
+                    if (ratio > 1.0 && level < mMaxAdaptiveLevel)
+                    {
+                        const double mid = 0.5 * (intervals[i].first + intervals[i].second);
+                        rSamples[dim].push_back(mid);
+                        new_intervals.push_back(std::make_pair(intervals[i].first, mid));
+                        new_intervals.push_back(std::make_pair(mid, intervals[i].second));
+                    }
+                }
+
+                intervals.swap(new_intervals);
+                ++level;
+            }
+
+            std::sort(rSamples[dim].begin(), rSamples[dim].end());
+        }
+    }
+
+    /// Compute, for each group of 5 equidistant points (t = 0, 1/4, 1/2, 3/4, 1), the maximum ratio of the deviation
+    /// from the linear interpolation between the end points to the tolerance. The deviation at the mid point is the
+    /// second-order difference h^2/8*|f''| of the function over the interval of length h.
+    void ComputeDeviationRatios(const PatchType& rPatch, const std::vector<double>& xi, std::vector<double>& rRatios) const
+    {
+        const IndexType ngroups = xi.size() / (5 * TDim);
+        rRatios.assign(ngroups, 0.0);
+
+        std::vector<ControlPointType> points;
+        rPatch.pControlPointGridFunction()->GetValues(points, xi);
+        for (IndexType g = 0; g < ngroups; ++g)
+        {
+            const ControlPointType& p0 = points[5*g];
+            const ControlPointType& p4 = points[5*g + 4];
+            for (int t = 1; t < 4; ++t)
+            {
+                const double s = 0.25 * t;
+                const ControlPointType& p = points[5*g + t];
+                const double dev = sqrt(pow(p.X() - ((1.0 - s) * p0.X() + s * p4.X()), 2)
+                                      + pow(p.Y() - ((1.0 - s) * p0.Y() + s * p4.Y()), 2)
+                                      + pow(p.Z() - ((1.0 - s) * p0.Z() + s * p4.Z()), 2));
+                rRatios[g] = std::max(rRatios[g], dev / mAdaptiveTolerance);
+            }
+        }
+
+        for (IndexType v = 0; v < mAdaptiveVariables.size(); ++v)
+        {
+            const Variable<double>& rVariable = *(mAdaptiveVariables[v].first);
+            if (!rPatch.HasGridFunction(rVariable))
+                continue;
+
+            std::vector<double> values;
+            rPatch.pGetGridFunction(rVariable)->GetValues(values, xi);
+            for (IndexType g = 0; g < ngroups; ++g)
+            {
+                for (int t = 1; t < 4; ++t)
+                {
+                    const double s = 0.25 * t;
+                    const double dev = fabs(values[5*g + t] - ((1.0 - s) * values[5*g] + s * values[5*g + 4]));
+                    rRatios[g] = std::max(rRatios[g], dev / mAdaptiveVariables[v].second);
+                }
+            }
+        }
+    }
+
+    /// Synchronize the sampling parameters of the patches across the interfaces, until the sampling parameters on
+    /// both sides of each interface are the same
+    void SynchronizeSamplingParameters(std::map<IndexType, SamplingParametersType>& rSamplingParameters) const
+    {
+        typedef typename MultiPatch<TDim>::patch_iterator patch_iterator;
+        typedef typename PatchType::interface_iterator interface_iterator;
+
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+            for (patch_iterator it = mpMultiPatch->begin(); it != mpMultiPatch->end(); ++it)
+            {
+                for (interface_iterator it_interface = it->InterfaceBegin(); it_interface != it->InterfaceEnd(); ++it_interface)
+                {
+                    typename PatchType::Pointer pPatch1 = (*it_interface)->pPatch1();
+                    typename PatchType::Pointer pPatch2 = (*it_interface)->pPatch2();
+
+                    typename std::map<IndexType, SamplingParametersType>::iterator it_samples1 = rSamplingParameters.find(pPatch1->Id());
+                    typename std::map<IndexType, SamplingParametersType>::iterator it_samples2 = rSamplingParameters.find(pPatch2->Id());
+                    if (it_samples1 == rSamplingParameters.end() || it_samples2 == rSamplingParameters.end())
+                        continue;
+
+                    std::vector<int> dirs1 = ParameterDirection<TDim>::Get((*it_interface)->Side1());
+                    std::vector<int> dirs2 = ParameterDirection<TDim>::Get((*it_interface)->Side2());
+
+                    const BSplinesPatchInterface<TDim>* pBSplinesInterface = dynamic_cast<const BSplinesPatchInterface<TDim>*>(&(**it_interface));
+
+                    for (IndexType i = 0; i < TDim-1; ++i)
+                    {
+                        IndexType j = i;
+                        bool reversed = false;
+                        if (pBSplinesInterface != NULL)
+                        {
+                            j = pBSplinesInterface->LocalParameterMapping(i);
+                            reversed = (pBSplinesInterface->Direction(i) == _REVERSED_);
+                        }
+
+                        std::vector<double>& rSamples1 = it_samples1->second[dirs1[i]];
+                        std::vector<double>& rSamples2 = it_samples2->second[dirs2[j]];
+                        if (InsertSamplingParameters(rSamples1, rSamples2, reversed))
+                            changed = true;
+                        if (InsertSamplingParameters(rSamples2, rSamples1, reversed))
+                            changed = true;
+                    }
+                }
+            }
+        }
+    }
+
+    /// Insert the source sampling parameters, which are not yet in the target. Return true if the target is changed.
+    static bool InsertSamplingParameters(std::vector<double>& rTarget, const std::vector<double>& rSource, const bool& reversed)
+    {
+        const double tol = 1.0e-10;
+        std::vector<double> new_values;
+        for (IndexType i = 0; i < rSource.size(); ++i)
+        {
+            const double v = reversed ? (1.0 - rSource[i]) : rSource[i];
+            std::vector<double>::iterator it = std::lower_bound(rTarget.begin(), rTarget.end(), v - tol);
+            if (it == rTarget.end() || *it > v + tol)
+                new_values.push_back(v);
+        }
+
+        if (new_values.size() == 0)
+            return false;
+
+        rTarget.insert(rTarget.end(), new_values.begin(), new_values.end());
+        std::sort(rTarget.begin(), rTarget.end());
+        return true;
+    }
+
+    /// Extract the distinct knots of the patch in [0, 1] in a direction. Only the knots of the B-Splines patch are
+    /// considered, the other patches are started from the whole parametric domain.
+    static std::vector<double> ExtractBreakpoints(const PatchType& rPatch, const IndexType& dim)
+    {
+        std::vector<double> breakpoints{0.0, 1.0};
+
+        typename BSplinesFESpace<TDim>::ConstPointer pFESpace = boost::dynamic_pointer_cast<const BSplinesFESpace<TDim> >(rPatch.pFESpace());
+        if (pFESpace != NULL)
+        {
+            typedef typename BSplinesFESpace<TDim>::knot_container_t::const_iterator knot_iterator;
+            for (knot_iterator it = pFESpace->KnotVector(dim).begin(); it != pFESpace->KnotVector(dim).end(); ++it)
+            {
+                const double v = (*it)->Value();
+                if (v > 0.0 && v < 1.0)
+                    breakpoints.push_back(v);
+            }
+        }
+
+        std::sort(breakpoints.begin(), breakpoints.end());
+        breakpoints.erase(std::unique(breakpoints.begin(), breakpoints.end()), breakpoints.end());
+
+        return breakpoints;
+    }
 };
 
 /// output stream function
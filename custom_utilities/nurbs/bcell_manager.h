@@ -359,6 +359,27 @@ public:
         return it;
     }
 
+    /// Insert a list of new cells to the container. The cells must not exist in the container and their Ids must be increasing,
+    /// hence the search for the existing cells is skipped. This is used when a large number of cells is constructed at once.
+    virtual void insert(const std::vector<cell_t>& p_cells)
+    {
+        for(std::size_t i = 0; i < p_cells.size(); ++i)
+        {
+            const cell_t& p_cell = p_cells[i];
+            BaseType::mpCells.insert(BaseType::mpCells.end(), p_cell);
+            SuperType::insert(&(*p_cell));
+            if (p_cell->Id() > BaseType::mLastId) BaseType::mLastId = p_cell->Id();
+
+            #ifdef USE_R_TREE_TO_SEARCH_FOR_CELLS
+            // update the r-tree
+            double cmin[] = {p_cell->XiMinValue()};
+            double cmax[] = {p_cell->XiMaxValue()};
+            rtree_cells.Insert(cmin, cmax, p_cell->Id());
+            #endif
+        }
+        BaseType::cell_map_is_created = false;
+    }
+
     /// Remove a cell by its Id from the set
     virtual void erase(cell_t p_cell)
     {
@@ -518,6 +539,27 @@ public:
         return it;
     }
 
+    /// Insert a list of new cells to the container. The cells must not exist in the container and their Ids must be increasing,
+    /// hence the search for the existing cells is skipped. This is used when a large number of cells is constructed at once.
+    virtual void insert(const std::vector<cell_t>& p_cells)
+    {
+        for(std::size_t i = 0; i < p_cells.size(); ++i)
+        {
+            const cell_t& p_cell = p_cells[i];
+            BaseType::mpCells.insert(BaseType::mpCells.end(), p_cell);
+            SuperType::insert(&(*p_cell));
+            if (p_cell->Id() > BaseType::mLastId) BaseType::mLastId = p_cell->Id();
+
+            #ifdef USE_R_TREE_TO_SEARCH_FOR_CELLS
+            // update the r-tree
+            double cmin[] = {p_cell->XiMinValue(), p_cell->EtaMinValue()};
+            double cmax[] = {p_cell->XiMaxValue(), p_cell->EtaMaxValue()};
+            rtree_cells.Insert(cmin, cmax, p_cell->Id());
+            #endif
+        }
+        BaseType::cell_map_is_created = false;
+    }
+
     /// Remove a cell by its Id from the set
     virtual void erase(cell_t p_cell)
     {
@@ -679,6 +721,27 @@ public:
         return it;
     }
 
+    /// Insert a list of new cells to the container. The cells must not exist in the container and their Ids must be increasing,
+    /// hence the search for the existing cells is skipped. This is used when a large number of cells is constructed at once.
+    virtual void insert(const std::vector<cell_t>& p_cells)
+    {
+        for(std::size_t i = 0; i < p_cells.size(); ++i)
+        {
+            const cell_t& p_cell = p_cells[i];
+            BaseType::mpCells.insert(BaseType::mpCells.end(), p_cell);
+            SuperType::insert(&(*p_cell));
+            if (p_cell->Id() > BaseType::mLastId) BaseType::mLastId = p_cell->Id();
+
+            #ifdef USE_R_TREE_TO_SEARCH_FOR_CELLS
+            // update the r-tree
+            double cmin[] = {p_cell->XiMinValue(), p_cell->EtaMinValue(), p_cell->ZetaMinValue()};
+            double cmax[] = {p_cell->XiMaxValue(), p_cell->EtaMaxValue(), p_cell->ZetaMaxValue()};
+            rtree_cells.Insert(cmin, cmax, p_cell->Id());
+            #endif
+        }
+        BaseType::cell_map_is_created = false;
+    }
+
     /// Remove a cell by its Id from the set
     virtual void erase(cell_t p_cell)
     {
@@ -0,0 +1,192 @@
+//
+//   Project Name:        Kratos
+//   Last Modified by:    $Author: hbui $
+//   Date:                $Date: 17 Oct 2026 $
+//   Revision:            $Revision: 1.0 $
+//
+//
+
+#if !defined(KRATOS_ISOGEOMETRIC_APPLICATION_BEZIER_EXTRACTION_CACHE_H_INCLUDED )
+#define  KRATOS_ISOGEOMETRIC_APPLICATION_BEZIER_EXTRACTION_CACHE_H_INCLUDED
+
+// System includes
+#include <vector>
+#include <map>
+#include <cmath>
+#include <iostream>
+
+// External includes
+
+// Project includes
+#include "includes/define.h"
+#include "includes/ublas_interface.h"
+#include "custom_utilities/bezier_utils.h"
+
+namespace Kratos
+{
+
+/**
+ * Memo cache of the local Bezier extraction of the point-based splines basis functions. The extraction row of a basis
+ * function on a cell is the tensor product of the 1D rows in each direction. The 1D row is invariant to an affine map
+ * of the local knot vector and the cell, hence it is stored once for each degree and normalized configuration, i.e. the
+ * local knots and the cell bounds scaled to [0, 1] over the support of the basis function. Two configurations are
+ * identical if their normalized values agree within the tolerance.
+ * The cache is not thread-safe; a parallel loop shall use one cache per thread.
+ */
+class BezierExtractionCache
+{
+public:
+    /// Pointer definition
+    KRATOS_CLASS_POINTER_DEFINITION(BezierExtractionCache);
+
+    /// Type definitions
+    typedef std::vector<long long> KeyType;
+    typedef std::map<KeyType, Vector> RowContainerType;
+
+    /// Default constructor
+    BezierExtractionCache() : mTolerance(1.0e-10), mNumberOfHits(0)
+    {}
+
+    /// Destructor
+    virtual ~BezierExtractionCache()
+    {}
+
+    /// Set the tolerance to compare the normalized configurations
+    void SetTolerance(const double& Tol) {mTolerance = Tol;}
+
+    /// Get the tolerance to compare the normalized configurations
+    const double& GetTolerance() const {return mTolerance;}
+
+    /// Get the 1D extraction row of the basis function with local knot vector Xi on the cell [cmin, cmax]
+    const Vector& GetRow1D(const std::vector<double>& Xi, const double& cmin, const double& cmax, const int p)
+    {
+        const double xmin = Xi.front();
+        const double length = Xi.back() - xmin;
+
+        KeyType key(Xi.size() + 3);
+        key[0] = static_cast<long long>(p);
+        for (std::size_t i = 0; i < Xi.size(); ++i)
+            key[i + 1] = Normalize(Xi[i], xmin, length);
+        key[Xi.size() + 1] = Normalize(cmin, xmin, length);
+        key[Xi.size() + 2] = Normalize(cmax, xmin, length);
+
+        RowContainerType::iterator it = mRows.find(key);
+        if (it != mRows.end())
+        {
+            ++mNumberOfHits;
+            return it->second;
+        }
+
+        Vector& rRow = mRows[key];
+        BezierUtils::bezier_extraction_local_row_1d(rRow, Xi, cmin, cmax, p);
+        return rRow;
+    }
+
+    /// Compute the extraction row of the basis function with the given orders and local knot vectors on the cell. The
+    /// result is the same as PBBSplinesBasisFunction_Helper<TDim>::ComputeExtractionOperator.
+    template<int TDim, typename TVectorType, typename TIArrayType, typename TKnotContainerType, class TCellType>
+    void ComputeExtractionOperator(TVectorType& Crow, const TIArrayType& orders, const TKnotContainerType& local_knots,
+            const TCellType& r_cell)
+    {
+        const Vector* pRows[3];
+        std::size_t n = 1;
+        for (int dim = 0; dim < TDim; ++dim)
+        {
+            pRows[dim] = &GetRow1D(local_knots[dim], CellMinValue(r_cell, dim), CellMaxValue(r_cell, dim), orders[dim]);
+            n *= pRows[dim]->size();
+        }
+
+        if (Crow.size() != n)
+            Crow.resize(n);
+
+        // the first direction varies slowest, see BezierUtils::bezier_extraction_local_2d/3d
+        if (TDim == 1)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+                Crow[i] = (*pRows[0])[i];
+        }
+        else if (TDim == 2)
+        {
+            const Vector& Cxi = *pRows[0];
+            const Vector& Ceta = *pRows[1];
+            for (std::size_t j = 0; j < Cxi.size(); ++j)
+                for (std::size_t l = 0; l < Ceta.size(); ++l)
+                    Crow[j * Ceta.size() + l] = Cxi[j] * Ceta[l];
+        }
+        else if (TDim == 3)
+        {
+            const Vector& Cxi = *pRows[0];
+            const Vector& Ceta = *pRows[1];
+            const Vector& Czeta = *pRows[2];
+            for (std::size_t j = 0; j < Cxi.size(); ++j)
+                for (std::size_t l = 0; l < Ceta.size(); ++l)
+                    for (std::size_t m = 0; m < Czeta.size(); ++m)
+                        Crow[(j * Ceta.size() + l) * Czeta.size() + m] = Cxi[j] * Ceta[l] * Czeta[m];
+        }
+    }
+
+    /// Get the number of stored 1D rows
+    std::size_t size() const {return mRows.size();}
+
+    /// Get the number of the 1D rows taken from the cache
+    std::size_t NumberOfHits() const {return mNumberOfHits;}
+
+    /// Clear the cache
+    void Clear()
+    {
+        mRows.clear();
+        mNumberOfHits = 0;
+    }
+
+    /// Information
+    virtual void PrintInfo(std::ostream& rOStream) const
+    {
+        rOStream << "BezierExtractionCache";
+    }
+
+    virtual void PrintData(std::ostream& rOStream) const
+    {
+        rOStream << " number of rows: " << this->size() << ", number of hits: " << this->NumberOfHits();
+    }
+
+private:
+
+    double mTolerance;
+    std::size_t mNumberOfHits;
+    RowContainerType mRows;
+
+    long long Normalize(const double& v, const double& xmin, const double& length) const
+    {
+        return std::llround((v - xmin) / length / mTolerance);
+    }
+
+    template<class TCellType>
+    static double CellMinValue(const TCellType& r_cell, const int& dim)
+    {
+        if (dim == 0) return r_cell.XiMinValue();
+        else if (dim == 1) return r_cell.EtaMinValue();
+        return r_cell.ZetaMinValue();
+    }
+
+    template<class TCellType>
+    static double CellMaxValue(const TCellType& r_cell, const int& dim)
+    {
+        if (dim == 0) return r_cell.XiMaxValue();
+        else if (dim == 1) return r_cell.EtaMaxValue();
+        return r_cell.ZetaMaxValue();
+    }
+
+}; // Class BezierExtractionCache
+
+/// output stream function
+inline std::ostream& operator << (std::ostream& rOStream, const BezierExtractionCache& rThis)
+{
+    rThis.PrintInfo(rOStream);
+    rOStream << std::endl;
+    rThis.PrintData(rOStream);
+    return rOStream;
+}
+
+}// namespace Kratos.
+
+#endif // KRATOS_ISOGEOMETRIC_APPLICATION_BEZIER_EXTRACTION_CACHE_H_INCLUDED
@@ -26,6 +26,8 @@
 #include "custom_utilities/nurbs/bsplines_indexing_utility.h"
 #include "custom_utilities/nurbs/bcell.h"
 #include "custom_utilities/nurbs/bcell_manager.h"
+#include "custom_utilities/nurbs/flat_bcell_manager.h"
+#include "utilities/openmp_utils.h"
 
 // #define DEBUG_GEN_CELL
 
@@ -65,7 +67,7 @@ public:
     typedef BCellManager<TDim, BCell> cell_container_t;
 
     /// Default constructor
-    BSplinesFESpace() : BaseType() {}
+    BSplinesFESpace() : BaseType(), mUseFlatCellManager(false) {}
 
     /// Destructor
     virtual ~BSplinesFESpace()
@@ -233,6 +235,20 @@ public:
         BSplinesFESpace_Helper<TDim>::GetValuesAndDerivatives(*this, values, derivatives, xi);
     }
 
+    /// Get the values of the basis functions at a batch of points, see FESpace::GetValuesAtPoints
+    void GetValuesAtPoints(std::vector<std::size_t>& rRowPtr, std::vector<std::size_t>& rIndices,
+        std::vector<double>& rValues, const std::vector<double>& rPoints) const final
+    {
+        this->ComputeValuesAtPoints(rRowPtr, rIndices, rValues, NULL, rPoints);
+    }
+
+    /// Get the values and derivatives of the basis functions at a batch of points, see FESpace::GetValuesAndDerivativesAtPoints
+    void GetValuesAndDerivativesAtPoints(std::vector<std::size_t>& rRowPtr, std::vector<std::size_t>& rIndices,
+        std::vector<double>& rValues, std::vector<double>& rDerivatives, const std::vector<double>& rPoints) const final
+    {
+        this->ComputeValuesAtPoints(rRowPtr, rIndices, rValues, &rDerivatives, rPoints);
+    }
+
     /// Check if a point lies inside the parametric domain of the BSplinesFESpace
     bool IsInside(const std::vector<double>& xi) const final
     {
@@ -930,225 +946,132 @@ public:
     }
 
     /// Create the cell manager for all the cells in the support domain of the BSplinesFESpace
+    /// The 1D Bezier extraction operators are computed once per direction. The extraction operator of each cell is the Kronecker product
+    /// of the 1D operators, which is formed on the fly in sparse form. The cells are constructed in parallel and then inserted at once.
     typename BaseType::cell_container_t::Pointer ConstructCellManager() const final
     {
-        typename cell_container_t::Pointer pCellManager;
+        typename cell_container_t::Pointer pCellManager = typename cell_container_t::Pointer(new BCellManager<TDim, BCell>());
 
         std::vector<std::size_t> func_indices = this->FunctionIndices();
+        CellExtractionData data;
+        this->ComputeCellExtractionData(data);
 
-        pCellManager = typename cell_container_t::Pointer(new BCellManager<TDim, BCell>());
+        // construct cells in parallel. The cell counter is (i*ne[1] + j)*ne[2] + k, where (i, j, k) is the element index in each direction.
+        const std::size_t ncells = data.ne[0]*data.ne[1]*data.ne[2];
+        const std::size_t nbezier = data.nb[0]*data.nb[1]*data.nb[2];
+        std::vector<BCell::Pointer> cells(ncells);
 
-        if (TDim == 1)
+        int number_of_threads = OpenMPUtils::GetNumThreads();
+        std::vector<unsigned int> cell_partition;
+        OpenMPUtils::CreatePartition(number_of_threads, ncells, cell_partition);
+
+        #pragma omp parallel for
+        for (int t = 0; t < number_of_threads; ++t)
         {
-            // firstly compute the Bezier extraction operator on the patch
-            std::vector<Matrix> C;
-            int ne1;
-            // BezierUtils::bezier_extraction_2d(C, ne1, ne2, this->KnotVector(0), this->KnotVector(1), this->Order(0), this->Order(1));
-            BezierUtils::bezier_extraction_1d(C, ne1, this->KnotVector(0), this->Order(0));
-
-            #ifdef DEBUG_GEN_CELL
-            KRATOS_WATCH(ne1)
-            KRATOS_WATCH(C.size())
-            KRATOS_WATCH(C[0].size1())
-            KRATOS_WATCH(C[0].size2())
-            #endif
-
-            // construct cells and add to the manager
-            std::size_t n1 = this->Number(0);
-            std::size_t p1 = this->Order(0);
-            std::size_t i, j, k, l, b1 = p1+1, tmp, mul1, sum_mul1 = 0, id1, id;
-            std::size_t cnt = 0; // cell counter
-
-            for (i = 0; i < ne1; ++i)
-            {
-                // check the multiplicity
-                tmp = b1;
-                while (b1 <= (n1 + p1 + 1) && this->KnotVector(0)[b1] == this->KnotVector(0)[b1-1]) ++b1;
-                mul1 = b1 - tmp + 1;
-                b1 = b1 + 1;
-                sum_mul1 = sum_mul1 + (mul1 - 1);
-
-                std::vector<std::size_t> anchors;
-                anchors.reserve(p1+1);
-                for (k = 0; k < p1+1; ++k)
-                {
-                    id1 = i + k + sum_mul1;
-                    id = id1; // this is the local id
-                    anchors.push_back(id);
-                }
+            std::vector<std::size_t> indices;
+            std::vector<double> values;
+            indices.reserve(nbezier);
+            values.reserve(nbezier);
 
-                // add the cell
-                std::tuple<knot_t, knot_t> span1 = this->KnotVector(0).span(i+1);
-                BCell::Pointer p_cell = BCell::Pointer(new BCell(cnt, std::get<0>(span1), std::get<1>(span1)));
-                double W = 1.0; // here we set to one because B-Splines space does not have weight
-                for (std::size_t r = 0; r < (p1+1); ++r)
-                    p_cell->AddAnchor(func_indices[anchors[r]], W, row(C[cnt], r));
-                pCellManager->insert(p_cell);
-                ++cnt;
+            for (std::size_t cnt = cell_partition[t]; cnt < cell_partition[t+1]; ++cnt)
+            {
+                const std::size_t i = cnt / (data.ne[1]*data.ne[2]);
+                const std::size_t j = (cnt / data.ne[2]) % data.ne[1];
+                const std::size_t k = cnt % data.ne[2];
+
+                // create the cell
+                BCell::Pointer p_cell;
+                if (TDim == 1)
+                    p_cell = BCell::Pointer(new BCell(cnt, std::get<0>(data.spans[0][i]), std::get<1>(data.spans[0][i])));
+                else if (TDim == 2)
+                    p_cell = BCell::Pointer(new BCell(cnt, std::get<0>(data.spans[0][i]), std::get<1>(data.spans[0][i]),
+                            std::get<0>(data.spans[1][j]), std::get<1>(data.spans[1][j])));
+                else if (TDim == 3)
+                    p_cell = BCell::Pointer(new BCell(cnt, std::get<0>(data.spans[0][i]), std::get<1>(data.spans[0][i]),
+                            std::get<0>(data.spans[1][j]), std::get<1>(data.spans[1][j]), std::get<0>(data.spans[2][k]), std::get<1>(data.spans[2][k])));
+
+                p_cell->Reserve(nbezier, data.C[0][i].nnz()*data.C[1][j].nnz()*data.C[2][k].nnz());
+                this->AddCellAnchors(*p_cell, data, i, j, k, func_indices, indices, values);
+
+                cells[cnt] = p_cell;
             }
         }
-        else if (TDim == 2)
+
+        // add the cells to the manager
+        pCellManager->insert(cells);
+
+        return pCellManager;
+    }
+
+    /// Create the cells of the BSplinesFESpace in the structure-of-arrays layout of FlatBCellManager. The cells are the same as
+    /// ConstructCellManager, in the same order and with the same ids, but no cell object is allocated. Each thread fills its own
+    /// container, and the containers are appended in the order of the threads.
+    typename FlatBCellManager<TDim>::Pointer ConstructFlatCellManager() const
+    {
+        typename FlatBCellManager<TDim>::Pointer pCellManager = typename FlatBCellManager<TDim>::Pointer(new FlatBCellManager<TDim>());
+
+        std::vector<std::size_t> func_indices = this->FunctionIndices();
+        CellExtractionData data;
+        this->ComputeCellExtractionData(data);
+
+        const std::size_t ncells = data.ne[0]*data.ne[1]*data.ne[2];
+        const std::size_t nbezier = data.nb[0]*data.nb[1]*data.nb[2];
+
+        int number_of_threads = OpenMPUtils::GetNumThreads();
+        std::vector<unsigned int> cell_partition;
+        OpenMPUtils::CreatePartition(number_of_threads, ncells, cell_partition);
+        std::vector<FlatBCellManager<TDim> > local_cells(number_of_threads);
+
+        #pragma omp parallel for
+        for (int t = 0; t < number_of_threads; ++t)
         {
-            // firstly compute the Bezier extraction operator on the patch
-            std::vector<Matrix> C;
-            int ne1, ne2;
-            // BezierUtils::bezier_extraction_2d(C, ne1, ne2, this->KnotVector(0), this->KnotVector(1), this->Order(0), this->Order(1));
-            BezierUtils::bezier_extraction_2d(C, ne2, ne1, this->KnotVector(1), this->KnotVector(0), this->Order(1), this->Order(0)); // we rotate the order of input
-
-            #ifdef DEBUG_GEN_CELL
-            KRATOS_WATCH(ne1)
-            KRATOS_WATCH(ne2)
-            KRATOS_WATCH(C.size())
-            KRATOS_WATCH(C[0].size1())
-            KRATOS_WATCH(C[0].size2())
-            #endif
-
-            // construct cells and add to the manager
-            std::size_t n1 = this->Number(0);
-            std::size_t n2 = this->Number(1);
-            std::size_t p1 = this->Order(0);
-            std::size_t p2 = this->Order(1);
-            std::size_t i, j, k, l, b1 = p1+1, b2, tmp, mul1, mul2, sum_mul1 = 0, sum_mul2 = 0, id1, id2, id;
-            std::size_t cnt = 0; // cell counter
-
-            for (i = 0; i < ne1; ++i)
+            std::vector<std::size_t> indices;
+            std::vector<double> values;
+            indices.reserve(nbezier);
+            values.reserve(nbezier);
+
+            FlatBCellManager<TDim>& rCells = local_cells[t];
+            const std::size_t nlocal = cell_partition[t+1] - cell_partition[t];
+            rCells.reserve(nlocal, nlocal*nbezier, nlocal*nbezier*nbezier);
+
+            double bounds[6];
+            for (std::size_t cnt = cell_partition[t]; cnt < cell_partition[t+1]; ++cnt)
             {
-                // check the multiplicity
-                tmp = b1;
-                while (b1 <= (n1 + p1 + 1) && this->KnotVector(0)[b1] == this->KnotVector(0)[b1-1]) ++b1;
-                mul1 = b1 - tmp + 1;
-                b1 = b1 + 1;
-                sum_mul1 = sum_mul1 + (mul1 - 1);
-
-                b2 = p2 + 1;
-                sum_mul2 = 0;
-                for (j = 0; j < ne2; ++j)
-                {
-                    // check the multiplicity
-                    tmp = b2;
-                    while (b2 <= (n2 + p2 + 1) && this->KnotVector(1)[b2] == this->KnotVector(1)[b2-1]) ++b2;
-                    mul2 = b2 - tmp + 1;
-                    b2 = b2 + 1;
-                    sum_mul2 = sum_mul2 + (mul2 - 1);
-
-                    std::vector<std::size_t> anchors;
-                    anchors.reserve((p1+1)*(p2+1));
-                    for (k = 0; k < p1+1; ++k)
-                    {
-                        for (l = 0; l < p2+1; ++l)
-                        {
-                            id1 = i + k + sum_mul1;
-                            id2 = j + l + sum_mul2;
-                            id = id1 + id2*n1; // this is the local id
-                            anchors.push_back(id);
-                        }
-                    }
+                const std::size_t i = cnt / (data.ne[1]*data.ne[2]);
+                const std::size_t j = (cnt / data.ne[2]) % data.ne[1];
+                const std::size_t k = cnt % data.ne[2];
 
-                    // add the cell
-                    std::tuple<knot_t, knot_t> span1 = this->KnotVector(0).span(i+1);
-                    std::tuple<knot_t, knot_t> span2 = this->KnotVector(1).span(j+1);
-                    BCell::Pointer p_cell = BCell::Pointer(new BCell(cnt, std::get<0>(span1), std::get<1>(span1), std::get<0>(span2), std::get<1>(span2)));
-                    double W = 1.0; // here we set to one because B-Splines space does not have weight
-                    for (std::size_t r = 0; r < (p1+1)*(p2+1); ++r)
-                        p_cell->AddAnchor(func_indices[anchors[r]], W, row(C[cnt], r));
-                    pCellManager->insert(p_cell);
-                    ++cnt;
+                const std::size_t e[] = {i, j, k};
+                for (int dim = 0; dim < TDim; ++dim)
+                {
+                    bounds[2*dim] = std::get<0>(data.spans[dim][e[dim]])->Value();
+                    bounds[2*dim + 1] = std::get<1>(data.spans[dim][e[dim]])->Value();
                 }
+
+                rCells.AddCell(cnt, 1, bounds, nbezier);
+                this->AddCellAnchors(rCells, data, i, j, k, func_indices, indices, values);
             }
         }
-        else if(TDim == 3)
-        {
-            // firstly compute the Bezier extraction operator on the patch
-            std::vector<Matrix> C;
-            int ne1, ne2, ne3;
-            // BezierUtils::bezier_extraction_3d(C, ne1, ne2, ne3,
-            //     this->KnotVector(0), this->KnotVector(1), this->KnotVector(2),
-            //     this->Order(0), this->Order(1), this->Order(2));
-            BezierUtils::bezier_extraction_3d(C, ne3, ne2, ne1,
-                this->KnotVector(2), this->KnotVector(1), this->KnotVector(0),
-                this->Order(2), this->Order(1), this->Order(0)); // we rotate the order of input
-
-            // construct cells and add to the manager
-            std::size_t n1 = this->Number(0);
-            std::size_t n2 = this->Number(1);
-            std::size_t n3 = this->Number(2);
-            std::size_t p1 = this->Order(0);
-            std::size_t p2 = this->Order(1);
-            std::size_t p3 = this->Order(2);
-            std::size_t i, j, k, l, u, v, w, b1 = p1+1, b2, b3, tmp, mul1, mul2, mul3;
-            std::size_t sum_mul1 = 0, sum_mul2 = 0, sum_mul3 = 0, id1, id2, id3, id;
-            std::size_t cnt = 0; // cell counter
-
-            for (i = 0; i < ne1; ++i)
-            {
-                // check the multiplicity
-                tmp = b1;
-                while (b1 <= (n1 + p1 + 1) && this->KnotVector(0)[b1] == this->KnotVector(0)[b1-1]) ++b1;
-                mul1 = b1 - tmp + 1;
-                b1 = b1 + 1;
-                sum_mul1 = sum_mul1 + (mul1 - 1);
-
-                b2 = p2 + 1;
-                sum_mul2 = 0;
-                for (j = 0; j < ne2; ++j)
-                {
-                    // check the multiplicity
-                    tmp = b2;
-                    while (b2 <= (n2 + p2 + 1) && this->KnotVector(1)[b2] == this->KnotVector(1)[b2-1]) ++b2;
-                    mul2 = b2 - tmp + 1;
-                    b2 = b2 + 1;
-                    sum_mul2 = sum_mul2 + (mul2 - 1);
-
-                    b3 = p3 + 1;
-                    sum_mul3 = 0;
-                    for (k = 0; k < ne3; ++k)
-                    {
-                        // check the multiplicity
-                        tmp = b3;
-                        while (b3 <= (n3 + p3 + 1) && this->KnotVector(2)[b3] == this->KnotVector(2)[b3-1]) ++b3;
-                        mul3 = b3 - tmp + 1;
-                        b3 = b3 + 1;
-                        sum_mul3 = sum_mul3 + (mul3 - 1);
-
-                        std::vector<std::size_t> anchors;
-                        anchors.reserve((p1+1)*(p2+1)*(p3+1));
-                        for (u = 0; u < p1+1; ++u)
-                        {
-                            for (v = 0; v < p2+1; ++v)
-                            {
-                                for (v = 0; v < p2+1; ++v)
-                                {
-                                    for (w = 0; w < p3+1; ++w)
-                                    {
-                                        id1 = i + u + sum_mul1;
-                                        id2 = j + v + sum_mul2;
-                                        id3 = k + w + sum_mul3;
-                                        id = id1 + (id2 + id3 * n2) * n1; // this is the local id
-                                        anchors.push_back(id);
-                                    }
-                                }
-                            }
-                        }
 
-                        // add the cell
-                        std::tuple<knot_t, knot_t> span1 = this->KnotVector(0).span(i+1);
-                        std::tuple<knot_t, knot_t> span2 = this->KnotVector(1).span(j+1);
-                        std::tuple<knot_t, knot_t> span3 = this->KnotVector(2).span(k+1);
-                        BCell::Pointer p_cell = BCell::Pointer(new BCell(cnt, std::get<0>(span1), std::get<1>(span1),
-                                std::get<0>(span2), std::get<1>(span2), std::get<0>(span3), std::get<1>(span3)));
-                        double W = 1.0; // here we set to one because B-Splines space does not have weight
-                        for (std::size_t r = 0; r < (p1+1)*(p2+1)*(p3+1); ++r)
-                            p_cell->AddAnchor(func_indices[anchors[r]], W, row(C[cnt], r));
-                        pCellManager->insert(p_cell);
-                        ++cnt;
-                    }
-                }
-            }
+        std::size_t nanchors = 0, nnz = 0;
+        for (int t = 0; t < number_of_threads; ++t)
+        {
+            nanchors += local_cells[t].NumberOfAnchors();
+            nnz += local_cells[t].NumberOfNonZeros();
         }
+        pCellManager->reserve(ncells, nanchors, nnz);
+        for (int t = 0; t < number_of_threads; ++t)
+            pCellManager->Append(local_cells[t]);
 
         return pCellManager;
     }
 
+    /// Choose the FlatBCellManager to create the entities out from this FESpace, see MultiPatchModelPart::CreateEntitiesFromFESpace
+    void SetUseFlatCellManager(const bool& UseFlatCellManager) {mUseFlatCellManager = UseFlatCellManager;}
+
+    /// Check if the FlatBCellManager is used to create the entities out from this FESpace
+    bool UseFlatCellManager() const {return mUseFlatCellManager;}
+
     /// Overload assignment operator
     BSplinesFESpace<TDim>& operator=(const BSplinesFESpace<TDim>& rOther)
     {
@@ -1158,6 +1081,7 @@ public:
             this->SetInfo(dim, rOther.Number(dim), rOther.Order(dim));
         }
         this->mFunctionsIds = rOther.mFunctionsIds;
+        this->mUseFlatCellManager = rOther.mUseFlatCellManager;
         BaseType::operator=(rOther);
         return *this;
     }
@@ -1226,6 +1150,246 @@ public:
 
 private:
 
+    /// Evaluate the basis functions (and the derivatives if pDerivatives is not NULL) at a batch of points.
+    /// The span in each direction is only searched if the point is not in the span of the previous point,
+    /// and the 1D functions are only recomputed if the coordinate changes. Hence the points on a structured grid are
+    /// cheap to evaluate. There are exactly prod(p_i+1) non-zeros at each point inside the domain.
+    void ComputeValuesAtPoints(std::vector<std::size_t>& rRowPtr, std::vector<std::size_t>& rIndices,
+        std::vector<double>& rValues, std::vector<double>* pDerivatives, const std::vector<double>& rPoints) const
+    {
+        const std::size_t npoints = rPoints.size() / TDim;
+
+        std::size_t nnz = 1;
+        for (int dim = 0; dim < TDim; ++dim)
+            nnz *= this->Order(dim) + 1;
+
+        rRowPtr.resize(npoints + 1);
+        rRowPtr[0] = 0;
+        rIndices.resize(npoints * nnz);
+        rValues.resize(npoints * nnz);
+        if (pDerivatives != NULL)
+            pDerivatives->resize(npoints * nnz * TDim);
+
+        // 1D values and derivatives of the previous point in each direction
+        int span[TDim];
+        double last_xi[TDim];
+        std::vector<double> N[TDim], dN[TDim];
+        for (int dim = 0; dim < TDim; ++dim)
+        {
+            span[dim] = -1;
+            N[dim].resize(this->Order(dim) + 1);
+            dN[dim].resize(this->Order(dim) + 1);
+        }
+
+        std::size_t k = 0;
+        for (std::size_t ip = 0; ip < npoints; ++ip)
+        {
+            bool inside = true;
+            for (int dim = 0; dim < TDim; ++dim)
+            {
+                const double& xi = rPoints[ip*TDim + dim];
+                const int n = static_cast<int>(this->Number(dim));
+                const int p = static_cast<int>(this->Order(dim));
+                const knot_container_t& rU = this->KnotVector(dim);
+
+                if ((span[dim] > 0) && (xi == last_xi[dim]))
+                    continue;
+
+                if (!((span[dim] > 0) && (rU[span[dim]] <= xi) && (xi < rU[span[dim] + 1])))
+                    span[dim] = BSplineUtils::FindSpan(n, p, xi, rU);
+
+                if ((span[dim] >= n + p) || (span[dim] == 0))
+                {
+                    span[dim] = -1;
+                    inside = false;
+                    break;
+                }
+
+                BSplineUtils::BasisFunsAndFirstDer(&N[dim][0], (pDerivatives != NULL) ? &dN[dim][0] : NULL, span[dim], xi, p, rU);
+                last_xi[dim] = xi;
+            }
+
+            if (inside)
+            {
+                // tensor product of the 1D functions, the index is consistent with BSplinesIndexingUtility_Helper
+                std::size_t loc[TDim];
+                for (int dim = 0; dim < TDim; ++dim)
+                    loc[dim] = 0;
+
+                do
+                {
+                    std::size_t index = 0;
+                    double v = 1.0;
+                    for (int dim = TDim-1; dim >= 0; --dim)
+                    {
+                        index = index * this->Number(dim) + (span[dim] - this->Order(dim) + loc[dim]);
+                        v *= N[dim][loc[dim]];
+                    }
+                    rIndices[k] = index;
+                    rValues[k] = v;
+
+                    if (pDerivatives != NULL)
+                    {
+                        for (int dim = 0; dim < TDim; ++dim)
+                        {
+                            double dv = dN[dim][loc[dim]];
+                            for (int dim2 = 0; dim2 < TDim; ++dim2)
+                                if (dim2 != dim)
+                                    dv *= N[dim2][loc[dim2]];
+                            (*pDerivatives)[k*TDim + dim] = dv;
+                        }
+                    }
+
+                    ++k;
+
+                    // next local function, the first direction runs fastest
+                    int dim = 0;
+                    while (dim < TDim)
+                    {
+                        if (++loc[dim] <= this->Order(dim)) break;
+                        loc[dim] = 0;
+                        ++dim;
+                    }
+                    if (dim == TDim) break;
+                } while (true);
+            }
+
+            rRowPtr[ip + 1] = k;
+        }
+
+        rIndices.resize(k);
+        rValues.resize(k);
+        if (pDerivatives != NULL)
+            pDerivatives->resize(k * TDim);
+    }
+
+    /// The data to construct the cells: the 1D Bezier extraction operators, the knot spans and the first supported basis function
+    /// of each element, the number of elements, the number of Bezier functions and the number of basis functions in each direction.
+    struct CellExtractionData
+    {
+        boost::array<std::vector<CompressedExtractionOperator>, 3> C;
+        boost::array<std::vector<std::tuple<knot_t, knot_t> >, 3> spans;
+        boost::array<std::vector<std::size_t>, 3> first_func;
+        boost::array<std::size_t, 3> ne, nb, nf;
+    };
+
+    /// Compute the data to construct the cells. The missing directions are filled with a single element and the 1x1 identity operator,
+    /// so that the loops over the cells are the same for all dimensions.
+    void ComputeCellExtractionData(CellExtractionData& rData) const
+    {
+        for (int dim = 0; dim < 3; ++dim)
+        {
+            if (dim < TDim)
+            {
+                std::vector<Matrix> C1d;
+                int ne_dim;
+                BezierUtils::bezier_extraction_1d(C1d, ne_dim, this->KnotVector(dim), this->Order(dim));
+                rData.ne[dim] = static_cast<std::size_t>(ne_dim);
+                rData.C[dim].resize(rData.ne[dim]);
+                for (std::size_t i = 0; i < rData.ne[dim]; ++i)
+                    rData.C[dim][i].Assign(C1d[i]);
+                this->ExtractSpans(dim, rData.spans[dim]);
+                this->ComputeFirstFunctionIndices(dim, rData.ne[dim], rData.first_func[dim]);
+                rData.nb[dim] = this->Order(dim) + 1;
+                rData.nf[dim] = this->Number(dim);
+            }
+            else
+            {
+                rData.ne[dim] = 1;
+                Matrix I(1, 1);
+                I(0, 0) = 1.0;
+                rData.C[dim].resize(1);
+                rData.C[dim][0].Assign(I);
+                rData.first_func[dim].resize(1, 0);
+                rData.nb[dim] = 1;
+                rData.nf[dim] = 1;
+            }
+        }
+
+        #ifdef DEBUG_GEN_CELL
+        KRATOS_WATCH(rData.ne[0])
+        KRATOS_WATCH(rData.ne[1])
+        KRATOS_WATCH(rData.ne[2])
+        #endif
+    }
+
+    /// Add the anchors of the element (i, j, k) to the cell. The rows of the extraction operator are the Kronecker product of the
+    /// rows of the 1D operators. TCellType is BCell or FlatBCellManager, which both accept the rows in sparse form.
+    template<class TCellType>
+    void AddCellAnchors(TCellType& rCell, const CellExtractionData& rData,
+        const std::size_t& i, const std::size_t& j, const std::size_t& k,
+        const std::vector<std::size_t>& func_indices, std::vector<std::size_t>& indices, std::vector<double>& values) const
+    {
+        const std::size_t nbezier = rData.nb[0]*rData.nb[1]*rData.nb[2];
+        const CompressedExtractionOperator& C1 = rData.C[0][i];
+        const CompressedExtractionOperator& C2 = rData.C[1][j];
+        const CompressedExtractionOperator& C3 = rData.C[2][k];
+
+        double W = 1.0; // here we set to one because B-Splines space does not have weight
+        for (std::size_t u = 0; u < rData.nb[0]; ++u)
+        {
+            for (std::size_t v = 0; v < rData.nb[1]; ++v)
+            {
+                for (std::size_t w = 0; w < rData.nb[2]; ++w)
+                {
+                    std::size_t id1 = rData.first_func[0][i] + u;
+                    std::size_t id2 = rData.first_func[1][j] + v;
+                    std::size_t id3 = rData.first_func[2][k] + w;
+                    std::size_t id = id1 + (id2 + id3 * rData.nf[1]) * rData.nf[0]; // this is the local id
+
+                    indices.clear();
+                    values.clear();
+                    for (std::size_t k1 = C1.index1_data()[u]; k1 < C1.index1_data()[u+1]; ++k1)
+                        for (std::size_t k2 = C2.index1_data()[v]; k2 < C2.index1_data()[v+1]; ++k2)
+                            for (std::size_t k3 = C3.index1_data()[w]; k3 < C3.index1_data()[w+1]; ++k3)
+                            {
+                                indices.push_back((C1.index2_data()[k1]*rData.nb[1] + C2.index2_data()[k2])*rData.nb[2] + C3.index2_data()[k3]);
+                                values.push_back(C1.value_data()[k1] * C2.value_data()[k2] * C3.value_data()[k3]);
+                            }
+
+                    rCell.AddAnchor(func_indices[id], W, nbezier, indices, values);
+                }
+            }
+        }
+    }
+
+    /// Extract all the non-zero knot spans in a direction
+    void ExtractSpans(const int& dim, std::vector<std::tuple<knot_t, knot_t> >& rSpans) const
+    {
+        rSpans.clear();
+        typename knot_container_t::const_iterator it = this->KnotVector(dim).begin();
+        knot_t left = *it;
+        for (; it != this->KnotVector(dim).end(); ++it)
+        {
+            knot_t right = (*it);
+            if (right->Value() != left->Value())
+            {
+                rSpans.push_back(std::make_tuple(left, right));
+                left = right;
+            }
+        }
+    }
+
+    /// Compute the local id of the first basis function supported on each element (non-zero knot span) in a direction
+    void ComputeFirstFunctionIndices(const int& dim, const std::size_t& ne, std::vector<std::size_t>& rFirstIndices) const
+    {
+        std::size_t n = this->Number(dim);
+        std::size_t p = this->Order(dim);
+        std::size_t b = p+1, tmp, mul, sum_mul = 0;
+
+        rFirstIndices.resize(ne);
+        for (std::size_t i = 0; i < ne; ++i)
+        {
+            // check the multiplicity
+            tmp = b;
+            while (b <= (n + p + 1) && this->KnotVector(dim)[b] == this->KnotVector(dim)[b-1]) ++b;
+            mul = b - tmp + 1;
+            b = b + 1;
+            sum_mul = sum_mul + (mul - 1);
+            rFirstIndices[i] = i + sum_mul;
+        }
+    }
+
     /**
      * internal data to construct the shape functions on the BSplines
      */
@@ -1237,6 +1401,8 @@ private:
      * data for grid function interpolation
      */
     std::vector<std::size_t> mFunctionsIds; // this is to store a unique number of the shape function over the forest of FESpace(s).
+
+    bool mUseFlatCellManager;
 };
 
 /**
@@ -1321,6 +1487,35 @@ public:
     }
 };
 
+/**
+ * Helper to construct the FlatBCellManager out from an FESpace. The cells are only constructed if the FESpace is a BSplinesFESpace
+ * with the flat cell manager enabled; otherwise the null pointer is returned.
+ */
+template<int TDim>
+struct BSplinesFESpace_Helper
+{
+    typedef FlatBCellManager<TDim> FlatCellManagerType;
+
+    static typename FlatCellManagerType::Pointer pConstructFlatCellManager(const FESpace<TDim>& rFESpace)
+    {
+        const BSplinesFESpace<TDim>* pFESpace = dynamic_cast<const BSplinesFESpace<TDim>*>(&rFESpace);
+        if ((pFESpace != NULL) && pFESpace->UseFlatCellManager())
+            return pFESpace->ConstructFlatCellManager();
+        return typename FlatCellManagerType::Pointer();
+    }
+};
+
+template<>
+struct BSplinesFESpace_Helper<0>
+{
+    typedef FlatBCellManager<1> FlatCellManagerType;
+
+    static FlatCellManagerType::Pointer pConstructFlatCellManager(const FESpace<0>& rFESpace)
+    {
+        return FlatCellManagerType::Pointer();
+    }
+};
+
 /// output stream function
 template<int TDim>
 inline std::ostream& operator <<(std::ostream& rOStream, const BSplinesFESpace<TDim>& rThis)
@@ -0,0 +1,415 @@
+//
+//   Project Name:        Kratos
+//   Last Modified by:    $Author: hbui $
+//   Date:                $Date: 16 Oct 2026 $
+//   Revision:            $Revision: 1.0 $
+//
+//
+
+#if !defined(KRATOS_ISOGEOMETRIC_APPLICATION_FLAT_BCELL_MANAGER_H_INCLUDED )
+#define  KRATOS_ISOGEOMETRIC_APPLICATION_FLAT_BCELL_MANAGER_H_INCLUDED
+
+// System includes
+#include <vector>
+#include <iterator>
+#include <iostream>
+
+// External includes
+
+// Project includes
+#include "includes/define.h"
+#include "includes/ublas_interface.h"
+#include "custom_utilities/compressed_extraction_operator.h"
+
+namespace Kratos
+{
+
+template<int TDim>
+class FlatBCellManager;
+
+/**
+ * Lightweight view to a cell in the FlatBCellManager. It provides the same accessors as the BCell, but does not own any data.
+ */
+template<int TDim>
+class FlatBCellView
+{
+public:
+    /// Type definitions
+    typedef std::size_t IndexType;
+    typedef std::size_t SizeType;
+
+    FlatBCellView(const FlatBCellManager<TDim>* pManager, const IndexType& i) : mpManager(pManager), mIndex(i)
+    {}
+
+    /// Access the view with the same syntax as the pointer to cell, i.e. (*it)->Id()
+    const FlatBCellView* operator->() const {return this;}
+
+    /// Get the index of the cell in the container
+    IndexType Index() const {return mIndex;}
+
+    /// Get the Id of the cell
+    std::size_t Id() const {return mpManager->mIds[mIndex];}
+
+    /// Get the level of the cell
+    std::size_t Level() const {return mpManager->mLevels[mIndex];}
+
+    /// Get the bounding box of the cell
+    double XiMinValue() const {return this->Bound(0, 0);}
+    double XiMaxValue() const {return this->Bound(0, 1);}
+    double EtaMinValue() const {return this->Bound(1, 0);}
+    double EtaMaxValue() const {return this->Bound(1, 1);}
+    double ZetaMinValue() const {return this->Bound(2, 0);}
+    double ZetaMaxValue() const {return this->Bound(2, 1);}
+
+    /// Get the number of supported anchors of the cell
+    std::size_t NumberOfAnchors() const {return mpManager->mAnchorPtr[mIndex + 1] - mpManager->mAnchorPtr[mIndex];}
+
+    /// Get the number of Bezier functions of the cell
+    std::size_t NumberOfBezierFunctions() const {return mpManager->mNumberOfBezierFunctions[mIndex];}
+
+    /// Get the pointer to the supported anchors of the cell. The anchors are contiguous in memory.
+    const std::size_t* SupportedAnchors() const {return mpManager->mAnchors.data() + mpManager->mAnchorPtr[mIndex];}
+
+    /// Get the pointer to the weights of the supported anchors of the cell
+    const double* AnchorWeights() const {return mpManager->mWeights.data() + mpManager->mAnchorPtr[mIndex];}
+
+    /// Get the supported anchors of the cell
+    std::vector<std::size_t> GetSupportedAnchors() const
+    {
+        return std::vector<std::size_t>(mpManager->mAnchors.begin() + mpManager->mAnchorPtr[mIndex],
+                                        mpManager->mAnchors.begin() + mpManager->mAnchorPtr[mIndex + 1]);
+    }
+
+    /// Get the weights of the supported anchors of the cell
+    void GetAnchorWeights(Vector& rWeights) const
+    {
+        if (rWeights.size() != this->NumberOfAnchors())
+            rWeights.resize(this->NumberOfAnchors(), false);
+        std::copy(mpManager->mWeights.begin() + mpManager->mAnchorPtr[mIndex],
+                  mpManager->mWeights.begin() + mpManager->mAnchorPtr[mIndex + 1], rWeights.begin());
+    }
+
+    /// Get the extraction operator of the cell in the compact CSR form
+    void GetExtractionOperator(CompressedExtractionOperator& rC) const
+    {
+        const IndexType row_begin = mpManager->mAnchorPtr[mIndex];
+        const SizeType nrows = this->NumberOfAnchors();
+        const IndexType nz_begin = mpManager->mRowPtr[row_begin];
+
+        std::vector<IndexType> row_ptr(nrows + 1);
+        for (IndexType i = 0; i < nrows + 1; ++i)
+            row_ptr[i] = mpManager->mRowPtr[row_begin + i] - nz_begin;
+
+        std::vector<IndexType> col_ind(mpManager->mColInd.begin() + nz_begin, mpManager->mColInd.begin() + mpManager->mRowPtr[row_begin + nrows]);
+        std::vector<double> values(mpManager->mValues.begin() + nz_begin, mpManager->mValues.begin() + mpManager->mRowPtr[row_begin + nrows]);
+        rC.Assign(nrows, this->NumberOfBezierFunctions(), row_ptr, col_ind, values);
+    }
+
+    /// Get the extraction operator of the cell as compressed matrix
+    CompressedMatrix GetCompressedExtractionOperator() const
+    {
+        const IndexType row_begin = mpManager->mAnchorPtr[mIndex];
+        const SizeType nrows = this->NumberOfAnchors();
+        CompressedMatrix M(nrows, this->NumberOfBezierFunctions(), mpManager->mRowPtr[row_begin + nrows] - mpManager->mRowPtr[row_begin]);
+        for (IndexType i = 0; i < nrows; ++i)
+            for (IndexType k = mpManager->mRowPtr[row_begin + i]; k < mpManager->mRowPtr[row_begin + i + 1]; ++k)
+                M.push_back(i, mpManager->mColInd[k], mpManager->mValues[k]);
+        M.complete_index1_data();
+        return M;
+    }
+
+    /// Get the extraction operator of the cell as dense matrix
+    Matrix GetExtractionOperator() const
+    {
+        const IndexType row_begin = mpManager->mAnchorPtr[mIndex];
+        const SizeType nrows = this->NumberOfAnchors();
+        Matrix M(nrows, this->NumberOfBezierFunctions());
+        noalias(M) = ZeroMatrix(nrows, this->NumberOfBezierFunctions());
+        for (IndexType i = 0; i < nrows; ++i)
+            for (IndexType k = mpManager->mRowPtr[row_begin + i]; k < mpManager->mRowPtr[row_begin + i + 1]; ++k)
+                M(i, mpManager->mColInd[k]) = mpManager->mValues[k];
+        return M;
+    }
+
+    /// Check if a point is inside the cell
+    bool IsInside(const double& rXi, const double& rEta, const double& rZeta) const
+    {
+        bool is_inside = (this->XiMinValue() <= rXi && this->XiMaxValue() >= rXi);
+        if (TDim > 1) is_inside = is_inside && (this->EtaMinValue() <= rEta && this->EtaMaxValue() >= rEta);
+        if (TDim > 2) is_inside = is_inside && (this->ZetaMinValue() <= rZeta && this->ZetaMaxValue() >= rZeta);
+        return is_inside;
+    }
+
+private:
+    const FlatBCellManager<TDim>* mpManager;
+    IndexType mIndex;
+
+    double Bound(const int& dim, const int& side) const
+    {
+        if (dim >= TDim) return 0.0;
+        return mpManager->mBounds[2*(TDim*mIndex + dim) + side];
+    }
+};
+
+/**
+ * Cell manager for b-cells stored in the structure-of-arrays layout. All the data of the cells (bounding boxes, anchors, weights and
+ * Bezier extraction operators) are kept in a few contiguous arrays. The extraction operators of all cells are packed in a single CSR block.
+ * This container is meant for the large patches where the number of cells is large, and the cells are created once and traversed many times.
+ * It is accessed through the same iterator interface as the BCellManager, i.e. (*it)->Id(), (*it)->GetSupportedAnchors(), etc.
+ * BSplinesFESpace::ConstructFlatCellManager builds the cells of a B-Splines patch directly in this layout.
+ * The cells must be added sequentially: AddCell, followed by AddAnchor for all anchors of that cell.
+ */
+template<int TDim>
+class FlatBCellManager
+{
+public:
+    /// Pointer definition
+    KRATOS_CLASS_POINTER_DEFINITION(FlatBCellManager);
+
+    /// Type definitions
+    typedef std::size_t IndexType;
+    typedef std::size_t SizeType;
+    typedef FlatBCellView<TDim> CellView;
+
+    /// Iterator over the cells in the container
+    class const_iterator : public std::iterator<std::random_access_iterator_tag, CellView, std::ptrdiff_t, const CellView*, CellView>
+    {
+    public:
+        const_iterator(const FlatBCellManager<TDim>* pManager, const IndexType& i) : mpManager(pManager), mIndex(i)
+        {}
+
+        CellView operator*() const {return CellView(mpManager, mIndex);}
+        CellView operator[](const std::ptrdiff_t& n) const {return CellView(mpManager, mIndex + n);}
+
+        const_iterator& operator++() {++mIndex; return *this;}
+        const_iterator operator++(int) {const_iterator tmp(*this); ++mIndex; return tmp;}
+        const_iterator& operator--() {--mIndex; return *this;}
+        const_iterator operator--(int) {const_iterator tmp(*this); --mIndex; return tmp;}
+        const_iterator& operator+=(const std::ptrdiff_t& n) {mIndex += n; return *this;}
+        const_iterator& operator-=(const std::ptrdiff_t& n) {mIndex -= n; return *this;}
+        const_iterator operator+(const std::ptrdiff_t& n) const {return const_iterator(mpManager, mIndex + n);}
+        const_iterator operator-(const std::ptrdiff_t& n) const {return const_iterator(mpManager, mIndex - n);}
+        std::ptrdiff_t operator-(const const_iterator& rOther) const {return static_cast<std::ptrdiff_t>(mIndex) - static_cast<std::ptrdiff_t>(rOther.mIndex);}
+
+        bool operator==(const const_iterator& rOther) const {return mIndex == rOther.mIndex;}
+        bool operator!=(const const_iterator& rOther) const {return mIndex != rOther.mIndex;}
+        bool operator<(const const_iterator& rOther) const {return mIndex < rOther.mIndex;}
+
+    private:
+        const FlatBCellManager<TDim>* mpManager;
+        IndexType mIndex;
+    };
+
+    typedef const_iterator iterator;
+
+    /// Default constructor
+    FlatBCellManager() : mAnchorPtr(1, 0), mRowPtr(1, 0)
+    {}
+
+    /// Destructor
+    virtual ~FlatBCellManager()
+    {}
+
+    /// Reserve the memory for the given number of cells, anchors and non-zero entries of the extraction operators
+    void reserve(const SizeType& NumberOfCells, const SizeType& NumberOfAnchors, const SizeType& NumberOfNonZeros)
+    {
+        mIds.reserve(NumberOfCells);
+        mLevels.reserve(NumberOfCells);
+        mBounds.reserve(2*TDim*NumberOfCells);
+        mNumberOfBezierFunctions.reserve(NumberOfCells);
+        mAnchorPtr.reserve(NumberOfCells + 1);
+        mAnchors.reserve(NumberOfAnchors);
+        mWeights.reserve(NumberOfAnchors);
+        mRowPtr.reserve(NumberOfAnchors + 1);
+        mColInd.reserve(NumberOfNonZeros);
+        mValues.reserve(NumberOfNonZeros);
+    }
+
+    /// Clear all the cells
+    void clear()
+    {
+        mIds.clear();
+        mLevels.clear();
+        mBounds.clear();
+        mNumberOfBezierFunctions.clear();
+        mAnchorPtr.assign(1, 0);
+        mAnchors.clear();
+        mWeights.clear();
+        mRowPtr.assign(1, 0);
+        mColInd.clear();
+        mValues.clear();
+    }
+
+    /// Add a new cell at the end of the container. The bounds are given as [min_1, max_1, ..., min_TDim, max_TDim]. It returns the index of the new cell.
+    IndexType AddCell(const std::size_t& Id, const std::size_t& Level, const double* Bounds, const SizeType& NumberOfBezierFunctions)
+    {
+        mIds.push_back(Id);
+        mLevels.push_back(Level);
+        mBounds.insert(mBounds.end(), Bounds, Bounds + 2*TDim);
+        mNumberOfBezierFunctions.push_back(NumberOfBezierFunctions);
+        mAnchorPtr.push_back(mAnchors.size());
+        return mIds.size() - 1;
+    }
+
+    /// Add supported anchor and the respective row of the extraction operator to the last cell
+    template<class TVectorType>
+    void AddAnchor(const std::size_t& Id, const double& W, const TVectorType& Crow)
+    {
+        mAnchors.push_back(Id);
+        mWeights.push_back(W);
+        for (IndexType j = 0; j < Crow.size(); ++j)
+        {
+            if (Crow[j] != 0.0)
+            {
+                mColInd.push_back(j);
+                mValues.push_back(Crow[j]);
+            }
+        }
+        mRowPtr.push_back(mColInd.size());
+        mAnchorPtr.back() = mAnchors.size();
+    }
+
+    /// Add supported anchor and the respective row of the extraction operator given in sparse form to the last cell. The indices must be sorted.
+    void AddAnchor(const std::size_t& Id, const double& W, const SizeType& NumberOfBezierFunctions,
+            const std::vector<IndexType>& rIndices, const std::vector<double>& rValues)
+    {
+        mNumberOfBezierFunctions.back() = NumberOfBezierFunctions;
+        mAnchors.push_back(Id);
+        mWeights.push_back(W);
+        mColInd.insert(mColInd.end(), rIndices.begin(), rIndices.end());
+        mValues.insert(mValues.end(), rValues.begin(), rValues.end());
+        mRowPtr.push_back(mColInd.size());
+        mAnchorPtr.back() = mAnchors.size();
+    }
+
+    /// Append all the cells of another container at the end of this container. The offsets of the anchors and of the
+    /// extraction operators of the appended cells are shifted, so that the packed CSR block stays consistent.
+    void Append(const FlatBCellManager<TDim>& rOther)
+    {
+        const SizeType anchor_offset = mAnchors.size();
+        const SizeType nz_offset = mColInd.size();
+
+        mIds.insert(mIds.end(), rOther.mIds.begin(), rOther.mIds.end());
+        mLevels.insert(mLevels.end(), rOther.mLevels.begin(), rOther.mLevels.end());
+        mBounds.insert(mBounds.end(), rOther.mBounds.begin(), rOther.mBounds.end());
+        mNumberOfBezierFunctions.insert(mNumberOfBezierFunctions.end(), rOther.mNumberOfBezierFunctions.begin(), rOther.mNumberOfBezierFunctions.end());
+        for (IndexType i = 1; i < rOther.mAnchorPtr.size(); ++i)
+            mAnchorPtr.push_back(rOther.mAnchorPtr[i] + anchor_offset);
+        mAnchors.insert(mAnchors.end(), rOther.mAnchors.begin(), rOther.mAnchors.end());
+        mWeights.insert(mWeights.end(), rOther.mWeights.begin(), rOther.mWeights.end());
+        for (IndexType i = 1; i < rOther.mRowPtr.size(); ++i)
+            mRowPtr.push_back(rOther.mRowPtr[i] + nz_offset);
+        mColInd.insert(mColInd.end(), rOther.mColInd.begin(), rOther.mColInd.end());
+        mValues.insert(mValues.end(), rOther.mValues.begin(), rOther.mValues.end());
+    }
+
+    /// Copy all the cells of a BCellManager to the container, in the same order of iteration
+    template<class TCellManagerType>
+    void Assign(const TCellManagerType& rCells)
+    {
+        this->clear();
+
+        SizeType nanchors = 0, nnz = 0;
+        for (typename TCellManagerType::const_iterator it = rCells.begin(); it != rCells.end(); ++it)
+        {
+            nanchors += (*it)->NumberOfAnchors();
+            nnz += (*it)->GetCrowValues().size();
+        }
+        this->reserve(rCells.size(), nanchors, nnz);
+
+        double bounds[6];
+        for (typename TCellManagerType::const_iterator it = rCells.begin(); it != rCells.end(); ++it)
+        {
+            bounds[0] = (*it)->XiMinValue();
+            bounds[1] = (*it)->XiMaxValue();
+            if (TDim > 1)
+            {
+                bounds[2] = (*it)->EtaMinValue();
+                bounds[3] = (*it)->EtaMaxValue();
+            }
+            if (TDim > 2)
+            {
+                bounds[4] = (*it)->ZetaMinValue();
+                bounds[5] = (*it)->ZetaMaxValue();
+            }
+            this->AddCell((*it)->Id(), (*it)->Level(), bounds, (*it)->NumberOfBezierFunctions());
+
+            const std::vector<std::size_t>& row_ptr = (*it)->GetCrowPointers();
+            const std::vector<std::size_t>& col_ind = (*it)->GetCrowIndices();
+            const std::vector<double>& values = (*it)->GetCrowValues();
+            for (IndexType i = 0; i < (*it)->NumberOfAnchors(); ++i)
+            {
+                mAnchors.push_back((*it)->GetSupportedAnchors()[i]);
+                mWeights.push_back((*it)->GetAnchorWeights()[i]);
+                mColInd.insert(mColInd.end(), col_ind.begin() + row_ptr[i], col_ind.begin() + row_ptr[i + 1]);
+                mValues.insert(mValues.end(), values.begin() + row_ptr[i], values.begin() + row_ptr[i + 1]);
+                mRowPtr.push_back(mColInd.size());
+            }
+            mAnchorPtr.back() = mAnchors.size();
+        }
+    }
+
+    /// Iterators
+    const_iterator begin() const {return const_iterator(this, 0);}
+    const_iterator end() const {return const_iterator(this, this->size());}
+
+    /// Access the cell by its index in the container
+    CellView operator[](const IndexType& i) const {return CellView(this, i);}
+
+    /// Get the number of cells
+    SizeType size() const {return mIds.size();}
+
+    /// Get the total number of anchors of all cells
+    SizeType NumberOfAnchors() const {return mAnchors.size();}
+
+    /// Get the total number of non-zero entries of the extraction operators of all cells
+    SizeType NumberOfNonZeros() const {return mValues.size();}
+
+    /// Get the amount of memory used by the container, in bytes
+    SizeType MemorySize() const
+    {
+        return sizeof(std::size_t) * (mIds.capacity() + mLevels.capacity() + mNumberOfBezierFunctions.capacity()
+                                    + mAnchorPtr.capacity() + mAnchors.capacity() + mRowPtr.capacity() + mColInd.capacity())
+             + sizeof(double) * (mBounds.capacity() + mWeights.capacity() + mValues.capacity());
+    }
+
+    /// Information
+    virtual void PrintInfo(std::ostream& rOStream) const
+    {
+        rOStream << "FlatBCellManager" << TDim << "D";
+    }
+
+    virtual void PrintData(std::ostream& rOStream) const
+    {
+        rOStream << ", number of cells: " << this->size() << ", number of anchors: " << this->NumberOfAnchors()
+                 << ", number of non-zeros: " << this->NumberOfNonZeros();
+    }
+
+private:
+
+    friend class FlatBCellView<TDim>;
+
+    std::vector<std::size_t> mIds; // id of each cell
+    std::vector<std::size_t> mLevels; // level of each cell
+    std::vector<double> mBounds; // bounding box of each cell, 2*TDim values per cell
+    std::vector<std::size_t> mNumberOfBezierFunctions; // number of columns of the extraction operator of each cell
+    std::vector<std::size_t> mAnchorPtr; // the anchors of cell i are in [mAnchorPtr[i], mAnchorPtr[i+1])
+    std::vector<std::size_t> mAnchors; // supported anchors of all cells
+    std::vector<double> mWeights; // weights of the supported anchors of all cells
+    std::vector<std::size_t> mRowPtr; // packed CSR block of the extraction operators; each anchor of each cell is a row
+    std::vector<std::size_t> mColInd;
+    std::vector<double> mValues;
+};
+
+/// output stream function
+template<int TDim>
+inline std::ostream& operator <<(std::ostream& rOStream, const FlatBCellManager<TDim>& rThis)
+{
+    rThis.PrintInfo(rOStream);
+    rThis.PrintData(rOStream);
+    return rOStream;
+}
+
+}// namespace Kratos.
+
+#endif // KRATOS_ISOGEOMETRIC_APPLICATION_FLAT_BCELL_MANAGER_H_INCLUDED
@@ -23,6 +23,7 @@
 #include "custom_utilities/bezier_utils.h"
 #include "custom_utilities/nurbs/knot.h"
 #include "custom_utilities/nurbs/knot_array_1d.h"
+#include "custom_utilities/nurbs/bezier_extraction_cache.h"
 #include "custom_utilities/control_point.h"
 #include "custom_utilities/pbsplines_basis_function.h"
 
@@ -118,6 +119,15 @@ public:
             rKnots[i] = CellType::GetValue(mpLocalKnots[dim][i]);
     }
 
+    /// Get the local knot values to a raw array, which must have at least the size of the local knot vector
+    void LocalKnotValues(const int& dim, double* pKnots) const
+    {
+        if (mpLocalKnots[dim].size() > BSplineUtils::MaxLocalOrder+2)
+            KRATOS_THROW_ERROR(std::logic_error, "The local knot vector is too long:", mpLocalKnots[dim].size())
+        for(std::size_t i = 0; i < mpLocalKnots[dim].size(); ++i)
+            pKnots[i] = CellType::GetValue(mpLocalKnots[dim][i]);
+    }
+
     /// Set the local knot vectors to this basis function
     void SetLocalKnotVectors(const int& dim, const std::vector<knot_t>& rpKnots)
     {
@@ -188,25 +198,18 @@ public:
     virtual void GetValueAt(double& res, const std::vector<double>& xi) const
     {
         res = 1.0;
-        // std::cout << "----------" << std::endl;
-        // KRATOS_WATCH(this->Id())
-        // std::cout << "xi: " << xi[0] << " " << xi[1] << std::endl;
+        double local_knots[BSplineUtils::MaxLocalOrder+2];
         for (std::size_t dim = 0; dim < TDim; ++dim)
         {
-            std::vector<double> local_knots;
-            this->LocalKnots(dim, local_knots);
-            // std::cout << "local_knots " << dim << ":";
-            // for (int i = 0; i < local_knots.size(); ++i)
-            //     std::cout << " " << local_knots[i];
-            // std::cout << std::endl;
+            this->LocalKnotValues(dim, local_knots);
             int order = this->Order(dim);
             // double val = BSplineUtils::CoxDeBoor(xi[dim], 0, order, local_knots);
             // double val = CoxDeBoor2(xi[dim], 0, order, local_knots);
-            double val = BSplineUtils::CoxDeBoor3(xi[dim], 0, order, local_knots);
-            // KRATOS_WATCH(val)
+            // double val = BSplineUtils::CoxDeBoor3(xi[dim], 0, order, local_knots);
+            double val = BSplineUtils::CoxDeBoorLocal(xi[dim], order, local_knots);
             res *= val;
+            if (res == 0.0) return;
         }
-        // KRATOS_WATCH(res)
     }
 
     /// Get the derivative of point-based B-splines basis function
@@ -220,8 +223,35 @@ public:
     /// Get the derivative of point-based B-splines basis function
     virtual void GetDerivativeAt(std::vector<double>& res, const std::vector<double>& xi) const
     {
-        // TODO
-        KRATOS_THROW_ERROR(std::logic_error, "Error calling unimplemented function", __FUNCTION__)
+        double val;
+        this->GetValueAndDerivativeAt(val, res, xi);
+    }
+
+    /// Get the value and the derivative of point-based B-splines basis function at once
+    virtual void GetValueAndDerivativeAt(double& val, std::vector<double>& res, const std::vector<double>& xi) const
+    {
+        if (res.size() != TDim)
+            res.resize(TDim);
+
+        double v[TDim], dv[TDim];
+        double local_knots[BSplineUtils::MaxLocalOrder+2];
+        for (std::size_t dim = 0; dim < TDim; ++dim)
+        {
+            this->LocalKnotValues(dim, local_knots);
+            int order = this->Order(dim);
+            BSplineUtils::CoxDeBoorLocal(v[dim], dv[dim], xi[dim], order, local_knots);
+        }
+
+        // tensor product rule
+        val = 1.0;
+        for (std::size_t dim = 0; dim < TDim; ++dim)
+        {
+            val *= v[dim];
+            res[dim] = dv[dim];
+            for (std::size_t dim2 = 0; dim2 < TDim; ++dim2)
+                if (dim2 != dim)
+                    res[dim] *= v[dim2];
+        }
     }
 
     /**************************************************************************
@@ -242,6 +272,20 @@ public:
         PBBSplinesBasisFunction_Helper<TDim>::ComputeExtractionOperator(Crow, orders, LocalKnots, *p_cell);
     }
 
+    /// Compute the Bezier extraction operator of this basis function on the cell, reusing the 1D rows stored in the cache
+    void ComputeExtractionOperator(Vector& Crow, const_cell_t p_cell, BezierExtractionCache& rCache) const
+    {
+        std::vector<std::vector<double> > LocalKnots(TDim);
+        std::vector<std::size_t> orders(TDim);
+        for (int dim = 0; dim < TDim; ++dim)
+        {
+            orders[dim] = this->Order(dim);
+            this->LocalKnots(dim, LocalKnots[dim]);
+        }
+
+        rCache.ComputeExtractionOperator<TDim>(Crow, orders, LocalKnots, *p_cell);
+    }
+
     /**************************************************************************
                             COMPARISON SUBROUTINES
     **************************************************************************/
@@ -11,6 +11,9 @@
 
 // System includes
 #include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <atomic>
 
 // External includes
 #include <boost/array.hpp>
@@ -18,6 +21,7 @@
 // Project includes
 #include "includes/define.h"
 #include "containers/array_1d.h"
+#include "utilities/openmp_utils.h"
 #include "custom_utilities/iga_define.h"
 #include "custom_utilities/fespace.h"
 #include "isogeometric_application/isogeometric_application.h"
@@ -52,10 +56,10 @@ public:
     typedef typename CellType::knot_container_t knot_container_t;
     typedef typename CellType::knot_t knot_t;
 
-    typedef std::map<std::size_t, bf_t> function_map_t;
+    typedef std::unordered_map<std::size_t, bf_t> function_map_t;
 
     /// Default constructor
-    PBBSplinesFESpace() : BaseType(), m_function_map_is_created(false)
+    PBBSplinesFESpace() : BaseType(), m_span_index_is_created(false), m_span_index_is_valid(false)
     {
         mpCellManager = typename cell_container_t::Pointer(new TCellManagerType());
     }
@@ -77,7 +81,13 @@ public:
     /// Add a already constructed basis function to the internal list
     void AddBf(bf_t p_bf)
     {
-        mpBasisFuncs.insert(p_bf);
+        if (mpBasisFuncs.insert(p_bf).second)
+        {
+            mFunctionsMap[p_bf->Id()] = p_bf;
+            if (p_bf->EquationId() != static_cast<std::size_t>(-1))
+                mEquationIdMap[p_bf->EquationId()] = p_bf;
+        }
+        m_span_index_is_created = false;
     }
 
     /// Check if the bf exists in the list; otherwise create new bf and return
@@ -96,8 +106,7 @@ public:
             p_bf->SetLocalKnotVectors(dim, rpKnots[dim]);
             p_bf->SetInfo(dim, this->Order(dim));
         }
-        mpBasisFuncs.insert(p_bf);
-        m_function_map_is_created = false;
+        this->AddBf(p_bf);
 
         return p_bf;
     }
@@ -105,7 +114,30 @@ public:
     /// Remove the basis functions from the container
     void RemoveBf(bf_t p_bf)
     {
-        mpBasisFuncs.erase(p_bf);
+        if (mpBasisFuncs.erase(p_bf))
+        {
+            typename function_map_t::iterator it = mFunctionsMap.find(p_bf->Id());
+            if ((it != mFunctionsMap.end()) && (it->second == p_bf))
+                mFunctionsMap.erase(it);
+
+            it = mEquationIdMap.find(p_bf->EquationId());
+            if ((it != mEquationIdMap.end()) && (it->second == p_bf))
+                mEquationIdMap.erase(it);
+        }
+        m_span_index_is_created = false;
+    }
+
+    /// Assign the equation id of a basis function in the container. The equation id index is updated accordingly.
+    /// One shall use this function instead of bf->SetEquationId to keep the index consistent.
+    void SetBfEquationId(bf_t p_bf, const std::size_t& EquationId)
+    {
+        typename function_map_t::iterator it = mEquationIdMap.find(p_bf->EquationId());
+        if ((it != mEquationIdMap.end()) && (it->second == p_bf))
+            mEquationIdMap.erase(it);
+
+        p_bf->SetEquationId(EquationId);
+        if (EquationId != static_cast<std::size_t>(-1))
+            mEquationIdMap[EquationId] = p_bf;
     }
 
     // Iterators for the basis functions
@@ -199,6 +231,18 @@ public:
     {
         if (values.size() != this->TotalNumber())
             values.resize(this->TotalNumber());
+
+        // only the basis functions supporting xi are evaluated
+        if (this->IsSpanIndexUsable())
+        {
+            std::fill(values.begin(), values.end(), 0.0);
+            std::vector<std::size_t> bfs;
+            this->FindSupportingBfs(&xi[0], bfs);
+            for (std::size_t k = 0; k < bfs.size(); ++k)
+                mSpanIndexBfs[bfs[k]]->GetValueAt(values[bfs[k]], xi);
+            return;
+        }
+
         std::size_t i = 0;
         for (bf_const_iterator it = bf_begin(); it != bf_end(); ++it)
             values[i++] = (*it)->GetValueAt(xi);
@@ -231,6 +275,19 @@ public:
     {
         if (values.size() != this->TotalNumber())
             values.resize(this->TotalNumber());
+
+        // only the basis functions supporting xi are evaluated
+        if (this->IsSpanIndexUsable())
+        {
+            for (std::size_t i = 0; i < values.size(); ++i)
+                values[i].assign(TDim, 0.0);
+            std::vector<std::size_t> bfs;
+            this->FindSupportingBfs(&xi[0], bfs);
+            for (std::size_t k = 0; k < bfs.size(); ++k)
+                mSpanIndexBfs[bfs[k]]->GetDerivativeAt(values[bfs[k]], xi);
+            return;
+        }
+
         std::size_t i = 0;
         for (bf_const_iterator it = bf_begin(); it != bf_end(); ++it)
         {
@@ -251,17 +308,117 @@ public:
         if (derivatives.size() != this->TotalNumber())
             derivatives.resize(this->TotalNumber());
 
+        // only the basis functions supporting xi are evaluated
+        if (this->IsSpanIndexUsable())
+        {
+            std::fill(values.begin(), values.end(), 0.0);
+            for (std::size_t i = 0; i < derivatives.size(); ++i)
+                derivatives[i].assign(TDim, 0.0);
+            std::vector<std::size_t> bfs;
+            this->FindSupportingBfs(&xi[0], bfs);
+            for (std::size_t k = 0; k < bfs.size(); ++k)
+                mSpanIndexBfs[bfs[k]]->GetValueAndDerivativeAt(values[bfs[k]], derivatives[bfs[k]], xi);
+            return;
+        }
+
         std::size_t i = 0;
         for (bf_const_iterator it = bf_begin(); it != bf_end(); ++it)
         {
-            values[i] = (*it)->GetValueAt(xi);
-            if (derivatives[i].size() != TDim)
-                derivatives[i].resize(TDim);
-            (*it)->GetDerivativeAt(derivatives[i], xi);
+            (*it)->GetValueAndDerivativeAt(values[i], derivatives[i], xi);
             ++i;
         }
     }
 
+    /// Get the values of the basis functions at a batch of points, see FESpace::GetValuesAtPoints
+    virtual void GetValuesAtPoints(std::vector<std::size_t>& rRowPtr, std::vector<std::size_t>& rIndices,
+        std::vector<double>& rValues, const std::vector<double>& rPoints) const
+    {
+        if (!this->IsSpanIndexUsable())
+        {
+            BaseType::GetValuesAtPoints(rRowPtr, rIndices, rValues, rPoints);
+            return;
+        }
+
+        const std::size_t npoints = rPoints.size() / TDim;
+        rRowPtr.resize(npoints + 1);
+        rRowPtr[0] = 0;
+        rIndices.clear();
+        rValues.clear();
+
+        // the marker avoids to add a function twice when the point is on the cell boundary
+        std::vector<std::size_t> marker(mSpanIndexBfs.size(), npoints);
+        std::vector<std::size_t> bfs;
+        std::vector<double> xi(TDim);
+        std::size_t spans[TDim];
+        std::fill(spans, spans + TDim, 0);
+        for (std::size_t ip = 0; ip < npoints; ++ip)
+        {
+            std::copy(rPoints.begin() + ip*TDim, rPoints.begin() + (ip+1)*TDim, xi.begin());
+            this->FindSupportingBfs(&xi[0], bfs, spans);
+            for (std::size_t k = 0; k < bfs.size(); ++k)
+            {
+                const std::size_t i = bfs[k];
+                if (marker[i] == ip) continue;
+                marker[i] = ip;
+                double v;
+                mSpanIndexBfs[i]->GetValueAt(v, xi);
+                if (v != 0.0)
+                {
+                    rIndices.push_back(i);
+                    rValues.push_back(v);
+                }
+            }
+            rRowPtr[ip + 1] = rValues.size();
+        }
+    }
+
+    /// Get the values and derivatives of the basis functions at a batch of points, see FESpace::GetValuesAndDerivativesAtPoints
+    virtual void GetValuesAndDerivativesAtPoints(std::vector<std::size_t>& rRowPtr, std::vector<std::size_t>& rIndices,
+        std::vector<double>& rValues, std::vector<double>& rDerivatives, const std::vector<double>& rPoints) const
+    {
+        if (!this->IsSpanIndexUsable())
+        {
+            BaseType::GetValuesAndDerivativesAtPoints(rRowPtr, rIndices, rValues, rDerivatives, rPoints);
+            return;
+        }
+
+        const std::size_t npoints = rPoints.size() / TDim;
+        rRowPtr.resize(npoints + 1);
+        rRowPtr[0] = 0;
+        rIndices.clear();
+        rValues.clear();
+        rDerivatives.clear();
+
+        std::vector<std::size_t> marker(mSpanIndexBfs.size(), npoints);
+        std::vector<std::size_t> bfs;
+        std::vector<double> xi(TDim), dv(TDim);
+        std::size_t spans[TDim];
+        std::fill(spans, spans + TDim, 0);
+        for (std::size_t ip = 0; ip < npoints; ++ip)
+        {
+            std::copy(rPoints.begin() + ip*TDim, rPoints.begin() + (ip+1)*TDim, xi.begin());
+            this->FindSupportingBfs(&xi[0], bfs, spans);
+            for (std::size_t k = 0; k < bfs.size(); ++k)
+            {
+                const std::size_t i = bfs[k];
+                if (marker[i] == ip) continue;
+                marker[i] = ip;
+                double v;
+                mSpanIndexBfs[i]->GetValueAndDerivativeAt(v, dv, xi);
+                bool is_zero = (v == 0.0);
+                for (int dim = 0; dim < TDim; ++dim)
+                    is_zero = is_zero && (dv[dim] == 0.0);
+                if (!is_zero)
+                {
+                    rIndices.push_back(i);
+                    rValues.push_back(v);
+                    rDerivatives.insert(rDerivatives.end(), dv.begin(), dv.end());
+                }
+            }
+            rRowPtr[ip + 1] = rValues.size();
+        }
+    }
+
     /// Check if a point lies inside the parametric domain of the BSplinesFESpace
     virtual bool IsInside(const std::vector<double>& xi) const
     {
@@ -297,6 +454,7 @@ public:
     virtual void ResetFunctionIndices()
     {
         BaseType::mGlobalToLocal.clear();
+        mEquationIdMap.clear();
         for (bf_iterator it = bf_begin(); it != bf_end(); ++it)
         {
             (*it)->SetEquationId(-1);
@@ -317,10 +475,12 @@ public:
             KRATOS_THROW_ERROR(std::logic_error, "The func_indices vector does not have the same size as total number of basis functions", "")
         }
         std::size_t cnt = 0;
+        mEquationIdMap.clear();
         for (bf_iterator it = bf_begin(); it != bf_end(); ++it)
         {
             (*it)->SetEquationId(func_indices[cnt]);
             BaseType::mGlobalToLocal[(*it)->EquationId()] = cnt;
+            mEquationIdMap[(*it)->EquationId()] = *it;
             ++cnt;
         }
     }
@@ -331,11 +491,13 @@ public:
     virtual std::size_t& Enumerate(std::size_t& start)
     {
         BaseType::mGlobalToLocal.clear();
+        mEquationIdMap.clear();
         std::size_t cnt = 0;
         for (bf_iterator it = bf_begin(); it != bf_end(); ++it)
         {
             if ((*it)->EquationId() == -1) (*it)->SetEquationId(start++);
             BaseType::mGlobalToLocal[(*it)->EquationId()] = cnt++;
+            mEquationIdMap[(*it)->EquationId()] = *it;
         }
 
         return start;
@@ -359,6 +521,7 @@ public:
     {
         std::size_t cnt = 0;
         BaseType::mGlobalToLocal.clear();
+        mEquationIdMap.clear();
         for (bf_iterator it = bf_begin(); it != bf_end(); ++it)
         {
             std::map<std::size_t, std::size_t>::const_iterator it2 = indices_map.find((*it)->EquationId());
@@ -366,11 +529,14 @@ public:
             if (it2 == indices_map.end())
             {
                 std::cout << "WARNING!!! the indices_map does not contain " << (*it)->EquationId() << std::endl;
+                if ((*it)->EquationId() != static_cast<std::size_t>(-1))
+                    mEquationIdMap[(*it)->EquationId()] = *it;
                 continue;
             }
 
             (*it)->SetEquationId(it2->second);
             BaseType::mGlobalToLocal[(*it)->EquationId()] = cnt;
+            mEquationIdMap[(*it)->EquationId()] = *it;
             ++cnt;
         }
     }
@@ -428,28 +594,20 @@ public:
     /// Get the basis functions based on boundary flag. This allows to extract the corner bf.
     std::vector<bf_t> ExtractBoundaryBfsByFlag(const std::size_t& boundary_id) const
     {
-        // firstly we organize the basis functions based on its equation_id
-        // it may happen that one bf is encountered twice, so we use a map here
-        std::map<std::size_t, bf_t> map_bfs;
+        // firstly we collect the basis functions on the boundary
+        std::vector<bf_t> bf_list;
         for (bf_iterator it_bf = bf_begin(); it_bf != bf_end(); ++it_bf)
         {
             if ((*it_bf)->IsOnSide(boundary_id))
-            {
-                typename std::map<std::size_t, bf_t>::iterator it = map_bfs.find((*it_bf)->EquationId());
-                if (it == map_bfs.end())
-                    map_bfs[(*it_bf)->EquationId()] = (*it_bf);
-                else
-                    if (it->second != (*it_bf))
-                        KRATOS_THROW_ERROR(std::logic_error, "There are two bfs with the same equation_id. This is not valid.", "")
-            }
+                bf_list.push_back(*it_bf);
         }
 
-        // then we can extract the equation_id
-        std::vector<bf_t> bf_list(map_bfs.size());
-        std::size_t cnt = 0;
-        for (typename std::map<std::size_t, bf_t>::iterator it = map_bfs.begin(); it != map_bfs.end(); ++it)
+        // then we organize the basis functions based on its equation_id
+        std::sort(bf_list.begin(), bf_list.end(), bf_equation_id_compare());
+        for (std::size_t i = 1; i < bf_list.size(); ++i)
         {
-            bf_list[cnt++] = it->second;
+            if (bf_list[i]->EquationId() == bf_list[i-1]->EquationId())
+                KRATOS_THROW_ERROR(std::logic_error, "There are two bfs with the same equation_id. This is not valid.", "")
         }
 
         return bf_list;
@@ -510,7 +668,7 @@ public:
         std::size_t cnt = 0;
         for (typename std::map<std::size_t, bf_t>::iterator it = map_bfs.begin(); it != map_bfs.end(); ++it)
         {
-            it->second->SetEquationId(func_indices[cnt++]);
+            this->SetBfEquationId(it->second, func_indices[cnt++]);
         }
     }
 
@@ -531,17 +689,34 @@ public:
     virtual void UpdateCells()
     {
         this->ResetCells();
-
-        // for each cell compute the extraction operator and add to the anchor
-        Vector Crow;
+        m_span_index_is_created = false;
+
+        // collect the basis functions of each cell, in the order of the basis functions, in a cheap serial pass so that
+        // the parallel extraction works on plain arrays; it only reads the local knots of the bfs
+        std::vector<cell_t> cells;
+        std::vector<std::vector<bf_t> > cell_bfs;
+        std::vector<std::vector<double> > cell_weights;
+        std::unordered_map<const CellType*, std::size_t> cell_index;
         for (bf_iterator it = bf_begin(); it != bf_end(); ++it)
         {
+            const double W = (*it)->GetValue(CONTROL_POINT).W();
             for (typename BasisFunctionType::cell_iterator it_cell = (*it)->cell_begin(); it_cell != (*it)->cell_end(); ++it_cell)
             {
-                (*it)->ComputeExtractionOperator(Crow, *it_cell);
-                (*it_cell)->AddAnchor((*it)->EquationId(), (*it)->GetValue(CONTROL_POINT).W(), Crow);
+                std::pair<typename std::unordered_map<const CellType*, std::size_t>::iterator, bool> res
+                    = cell_index.insert(std::make_pair((*it_cell).get(), cells.size()));
+                if (res.second)
+                {
+                    cells.push_back(*it_cell);
+                    cell_bfs.push_back(std::vector<bf_t>());
+                    cell_weights.push_back(std::vector<double>());
+                }
+                cell_bfs[res.first->second].push_back(*it);
+                cell_weights[res.first->second].push_back(W);
             }
         }
+
+        // for each cell compute the extraction operator and add to the anchor
+        this->ComputeExtractionOperators(cells, cell_bfs, cell_weights);
     }
 
     /// Create the cell manager for all the cells in the support domain of the PBBSplinesFESpace
@@ -561,10 +736,6 @@ public:
     /// Overload operator(), this allows to access the basis function based on its id
     bf_t operator()(const std::size_t& Id)
     {
-        // create the index map if it's not created yet
-        if(!m_function_map_is_created)
-            CreateFunctionsMap();
-
         // return the bf if its Id exist in the list
         typename function_map_t::iterator it = mFunctionsMap.find(Id);
         if(it != mFunctionsMap.end())
@@ -576,7 +747,7 @@ public:
     /// Check if the functional space has the function with equation id
     bool HasBfByEquationId(const std::size_t& EquationId) const
     {
-        return (BaseType::mGlobalToLocal.find(EquationId) != BaseType::mGlobalToLocal.end());
+        return (FindBfByEquationId(EquationId) != NULL);
     }
 
     /// Check if the functional space has the function with Id
@@ -588,7 +759,22 @@ public:
     /// Get the basis function by equation id
     bf_t pGetBfByEquationId(const std::size_t& EquationId)
     {
-        return this->operator[](BaseType::mGlobalToLocal[EquationId]);
+        bf_t p_bf = FindBfByEquationId(EquationId);
+        if (p_bf == NULL)
+            KRATOS_THROW_ERROR(std::runtime_error, "Access equation id is not found:", EquationId)
+        return p_bf;
+    }
+
+    /// Find the basis function by equation id. Return a null pointer if it is not found.
+    /// The index is kept by all the operations on the equation ids of this space (AddBf, RemoveBf, SetBfEquationId, Enumerate,
+    /// ResetFunctionIndices, UpdateFunctionIndices, AssignBoundaryFunctionIndices), hence the lookup is logarithmic also when
+    /// the equation id does not belong to this space. The equation id of a bf in this space shall not be changed by bf.SetEquationId.
+    bf_t FindBfByEquationId(const std::size_t& EquationId) const
+    {
+        typename function_map_t::const_iterator it = mEquationIdMap.find(EquationId);
+        if (it == mEquationIdMap.end())
+            return bf_t();
+        return it->second;
     }
 
     /// Overload assignment operator
@@ -642,15 +828,260 @@ protected:
     typename cell_container_t::Pointer mpCellManager;
 
     bf_container_t mpBasisFuncs;
-    mutable function_map_t mFunctionsMap; // map from basis function id to the basis function. It's mainly used to search for the bf quickly. But it needs to be re-initialized whenever new bf is added to the set
-    bool m_function_map_is_created;
+    mutable function_map_t mFunctionsMap; // map from basis function id to the basis function, updated whenever a bf is added to or removed from the set
+    function_map_t mEquationIdMap; // map from equation id to the basis function, updated by the operations on the equation ids of this space
 
-    void CreateFunctionsMap()
+    struct bf_equation_id_compare { bool operator() (const bf_t& lhs, const bf_t& rhs) const {return lhs->EquationId() < rhs->EquationId();} };
+
+    /// Compute the extraction operators of the basis functions on each cell and add them to the anchors of the cell, in
+    /// parallel over the cells. The 1D extraction rows are memoized in one BezierExtractionCache for each thread, since
+    /// most of the cells share the same normalized local knot configurations. The cells shall be reset beforehand.
+    void ComputeExtractionOperators(const std::vector<cell_t>& cells, const std::vector<std::vector<bf_t> >& cell_bfs,
+            const std::vector<std::vector<double> >& cell_weights) const
     {
-        mFunctionsMap.clear();
-        for(bf_iterator it = bf_begin(); it != bf_end(); ++it)
-            mFunctionsMap[(*it)->Id()] = *it;
-        m_function_map_is_created = true;
+        int number_of_threads = OpenMPUtils::GetNumThreads();
+        std::vector<unsigned int> cell_partition;
+        OpenMPUtils::CreatePartition(number_of_threads, cells.size(), cell_partition);
+
+        #pragma omp parallel for
+        for (int k = 0; k < number_of_threads; ++k)
+        {
+            BezierExtractionCache cache;
+            Vector Crow;
+            for (unsigned int i = cell_partition[k]; i < cell_partition[k + 1]; ++i)
+            {
+                for (std::size_t j = 0; j < cell_bfs[i].size(); ++j)
+                {
+                    cell_bfs[i][j]->ComputeExtractionOperator(Crow, cells[i], cache);
+                    cells[i]->AddAnchor(cell_bfs[i][j]->EquationId(), cell_weights[i][j], Crow);
+                }
+            }
+        }
+    }
+
+    /// Span index: the cells supporting the basis functions are arranged on the tensor grid of all the cell boundaries. Each box
+    /// of the grid refers to the cell covering it, and each cell refers to the basis functions supporting it. The point evaluation
+    /// then only visits the basis functions of the cells containing the point. The index is built lazily and rebuilt when the
+    /// basis functions or the cells change. The creation flag is atomic, since the index may be created lazily by a point
+    /// evaluation in a parallel region; the index data are complete when the flag is seen set.
+    mutable std::atomic<bool> m_span_index_is_created;
+    mutable bool m_span_index_is_valid; // false if the cells do not partition the support of the basis functions
+    mutable std::vector<bf_t> mSpanIndexBfs; // the basis functions, in the order of mpBasisFuncs
+    mutable boost::array<std::vector<double>, TDim> mSpanIndexBreaks; // the sorted cell boundaries in each direction
+    mutable std::vector<int> mSpanIndexBoxToCell; // cell covering each box of the grid; empty if the grid is too large
+    mutable std::vector<double> mSpanIndexCellBounds; // [xi_min, xi_max, eta_min, eta_max, ...] of each cell
+    mutable std::vector<std::size_t> mSpanIndexCellPtr;
+    mutable std::vector<std::size_t> mSpanIndexCellBfs;
+
+    /// Check if the span index can be used for the point evaluation. The index is (re)created if needed. Every change of
+    /// the basis functions or the cells resets the creation flag.
+    bool IsSpanIndexUsable() const
+    {
+        if (!m_span_index_is_created.load(std::memory_order_acquire))
+        {
+            #pragma omp critical(pbbsplines_fespace_span_index)
+            {
+                if (!m_span_index_is_created.load(std::memory_order_relaxed))
+                    this->CreateSpanIndex();
+            }
+        }
+        return m_span_index_is_valid;
+    }
+
+    /// Create the span index
+    void CreateSpanIndex() const
+    {
+        m_span_index_is_valid = false;
+        mSpanIndexBfs.assign(bf_begin(), bf_end());
+        mSpanIndexBoxToCell.clear();
+        mSpanIndexCellBounds.clear();
+        mSpanIndexCellPtr.assign(1, 0);
+        mSpanIndexCellBfs.clear();
+        for (int dim = 0; dim < TDim; ++dim)
+            mSpanIndexBreaks[dim].clear();
+
+        // collect the cells and their supporting basis functions
+        std::map<std::size_t, std::size_t> cell_map;
+        std::vector<std::vector<std::size_t> > cell_bfs;
+        bool valid = (mSpanIndexBfs.size() > 0);
+        for (std::size_t i = 0; i < mSpanIndexBfs.size(); ++i)
+        {
+            const BasisFunctionType& r_bf = *mSpanIndexBfs[i];
+            if (r_bf.cell_begin() == r_bf.cell_end())
+                valid = false;
+
+            for (typename BasisFunctionType::cell_const_iterator it_cell = r_bf.cell_begin(); it_cell != r_bf.cell_end(); ++it_cell)
+            {
+                std::map<std::size_t, std::size_t>::iterator it_map = cell_map.find((*it_cell)->Id());
+                if (it_map == cell_map.end())
+                {
+                    it_map = cell_map.insert(std::make_pair((*it_cell)->Id(), cell_bfs.size())).first;
+                    cell_bfs.push_back(std::vector<std::size_t>());
+                    double bounds[2*TDim];
+                    this->GetCellBounds(**it_cell, bounds);
+                    for (int j = 0; j < 2*TDim; ++j)
+                        mSpanIndexCellBounds.push_back(bounds[j]);
+                }
+                cell_bfs[it_map->second].push_back(i);
+            }
+        }
+
+        const std::size_t ncells = cell_bfs.size();
+        mSpanIndexCellPtr.resize(ncells + 1);
+        for (std::size_t c = 0; c < ncells; ++c)
+        {
+            mSpanIndexCellPtr[c + 1] = mSpanIndexCellPtr[c] + cell_bfs[c].size();
+            mSpanIndexCellBfs.insert(mSpanIndexCellBfs.end(), cell_bfs[c].begin(), cell_bfs[c].end());
+        }
+
+        // arrange the cells on the tensor grid of the cell boundaries
+        std::size_t nboxes = 1;
+        for (int dim = 0; dim < TDim; ++dim)
+        {
+            std::vector<double>& breaks = mSpanIndexBreaks[dim];
+            for (std::size_t c = 0; c < ncells; ++c)
+            {
+                breaks.push_back(mSpanIndexCellBounds[2*(c*TDim + dim)]);
+                breaks.push_back(mSpanIndexCellBounds[2*(c*TDim + dim) + 1]);
+            }
+            std::sort(breaks.begin(), breaks.end());
+            breaks.erase(std::unique(breaks.begin(), breaks.end()), breaks.end());
+            if (breaks.size() < 2)
+                valid = false;
+            else
+                nboxes *= breaks.size() - 1;
+        }
+
+        // the grid is not used if it is much larger than the number of cells, e.g. for highly graded hierarchical meshes.
+        // In that case the cells are searched linearly by their bounds.
+        if (valid && (nboxes <= 16*ncells + 100000))
+        {
+            mSpanIndexBoxToCell.assign(nboxes, -1);
+            for (std::size_t c = 0; c < ncells && valid; ++c)
+            {
+                std::size_t lo[TDim], hi[TDim];
+                for (int dim = 0; dim < TDim; ++dim)
+                {
+                    const std::vector<double>& breaks = mSpanIndexBreaks[dim];
+                    lo[dim] = std::lower_bound(breaks.begin(), breaks.end(), mSpanIndexCellBounds[2*(c*TDim + dim)]) - breaks.begin();
+                    hi[dim] = std::lower_bound(breaks.begin(), breaks.end(), mSpanIndexCellBounds[2*(c*TDim + dim) + 1]) - breaks.begin();
+                }
+
+                std::size_t ib[TDim];
+                if (!this->FirstBox(ib, lo, hi)) continue;
+                do
+                {
+                    int& box_cell = mSpanIndexBoxToCell[this->BoxIndex(ib)];
+                    if (box_cell != -1)
+                        valid = false; // overlapping cells
+                    box_cell = static_cast<int>(c);
+                } while (this->NextBox(ib, lo, hi));
+            }
+
+            if (!valid)
+                mSpanIndexBoxToCell.clear();
+        }
+
+        m_span_index_is_valid = valid;
+        m_span_index_is_created.store(true, std::memory_order_release);
+    }
+
+    /// Find the indices of the basis functions supporting xi. At the cell boundaries, the basis functions of all the
+    /// adjacent cells are returned, hence some indices may appear more than once.
+    /// pSpans (optional, TDim entries initialized to 0) keeps the spans of the previous point, which are checked before searching.
+    void FindSupportingBfs(const double* xi, std::vector<std::size_t>& rBfs, std::size_t* pSpans = NULL) const
+    {
+        rBfs.clear();
+        if (mSpanIndexBoxToCell.size() == 0)
+        {
+            for (std::size_t c = 0; c < mSpanIndexCellPtr.size() - 1; ++c)
+            {
+                bool inside = true;
+                for (int dim = 0; dim < TDim && inside; ++dim)
+                    inside = (xi[dim] >= mSpanIndexCellBounds[2*(c*TDim + dim)]) && (xi[dim] <= mSpanIndexCellBounds[2*(c*TDim + dim) + 1]);
+                if (inside)
+                    for (std::size_t k = mSpanIndexCellPtr[c]; k < mSpanIndexCellPtr[c + 1]; ++k)
+                        rBfs.push_back(mSpanIndexCellBfs[k]);
+            }
+            return;
+        }
+
+        // locate the span(s) in each direction; a point on a break belongs to the two adjacent spans
+        std::size_t lo[TDim], hi[TDim];
+        for (int dim = 0; dim < TDim; ++dim)
+        {
+            const std::vector<double>& breaks = mSpanIndexBreaks[dim];
+            if ((xi[dim] < breaks.front()) || (xi[dim] > breaks.back()))
+                return;
+
+            std::size_t k;
+            if ((pSpans != NULL) && (pSpans[dim] > 0) && (breaks[pSpans[dim]-1] < xi[dim]) && (xi[dim] < breaks[pSpans[dim]]))
+                k = pSpans[dim];
+            else
+            {
+                k = std::upper_bound(breaks.begin(), breaks.end(), xi[dim]) - breaks.begin();
+                if (k == breaks.size()) --k;
+                if (pSpans != NULL) pSpans[dim] = k;
+            }
+            hi[dim] = k;
+            lo[dim] = ((breaks[k-1] == xi[dim]) && (k > 1)) ? k-2 : k-1;
+        }
+
+        std::size_t ib[TDim];
+        this->FirstBox(ib, lo, hi);
+        do
+        {
+            const int c = mSpanIndexBoxToCell[this->BoxIndex(ib)];
+            if (c != -1)
+                for (std::size_t k = mSpanIndexCellPtr[c]; k < mSpanIndexCellPtr[c + 1]; ++k)
+                    rBfs.push_back(mSpanIndexCellBfs[k]);
+        } while (this->NextBox(ib, lo, hi));
+    }
+
+    /// Iterate over the boxes [lo, hi) of the span index grid
+    bool FirstBox(std::size_t* ib, const std::size_t* lo, const std::size_t* hi) const
+    {
+        for (int dim = 0; dim < TDim; ++dim)
+        {
+            if (lo[dim] >= hi[dim]) return false;
+            ib[dim] = lo[dim];
+        }
+        return true;
+    }
+
+    bool NextBox(std::size_t* ib, const std::size_t* lo, const std::size_t* hi) const
+    {
+        for (int dim = 0; dim < TDim; ++dim)
+        {
+            if (++ib[dim] < hi[dim]) return true;
+            ib[dim] = lo[dim];
+        }
+        return false;
+    }
+
+    std::size_t BoxIndex(const std::size_t* ib) const
+    {
+        std::size_t index = 0;
+        for (int dim = TDim-1; dim >= 0; --dim)
+            index = index * (mSpanIndexBreaks[dim].size() - 1) + ib[dim];
+        return index;
+    }
+
+    /// Get the bounds of a cell as [xi_min, xi_max, eta_min, eta_max, ...]
+    static void GetCellBounds(const CellType& r_cell, double* bounds)
+    {
+        bounds[0] = r_cell.XiMinValue();
+        bounds[1] = r_cell.XiMaxValue();
+        if (TDim > 1)
+        {
+            bounds[2] = r_cell.EtaMinValue();
+            bounds[3] = r_cell.EtaMaxValue();
+        }
+        if (TDim > 2)
+        {
+            bounds[4] = r_cell.ZetaMinValue();
+            bounds[5] = r_cell.ZetaMaxValue();
+        }
     }
 };
 
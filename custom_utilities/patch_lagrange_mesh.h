@@ -104,8 +104,7 @@ public:
         }
 
         // create nodes
-        for (std::size_t i = 0; i < points_and_connectivities.first.size(); ++i)
-            IsogeometricPostUtility::CreateNodeAndTransferValues(points_and_connectivities.first[i], *pPatch, r_model_part, last_node_id++);
+        IsogeometricPostUtility::CreateNodesAndTransferValues(points_and_connectivities.first, *pPatch, r_model_part, last_node_id);
 
         // create elements
         const std::string NodeKey = std::string("Node");
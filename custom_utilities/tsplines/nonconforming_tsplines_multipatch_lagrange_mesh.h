@@ -158,10 +158,7 @@ public:
                         = IsogeometricPostUtility::GenerateQuadGrid(corners[0], corners[1], corners[2], corners[3],
                             NodeCounter, NumDivision1, NumDivision2);
 
-                    for (std::size_t i = 0; i < points_and_connectivities.first.size(); ++i)
-                    {
-                        IsogeometricPostUtility::CreateNodeAndTransferValues(points_and_connectivities.first[i], *it, r_model_part, NodeCounter++);
-                    }
+                    IsogeometricPostUtility::CreateNodesAndTransferValues(points_and_connectivities.first, *it, r_model_part, NodeCounter);
 
                     ElementsArrayType pNewElements = IsogeometricPostUtility::CreateEntities<std::vector<std::vector<IndexType> >, Element, ElementsArrayType>(
                         points_and_connectivities.second, r_model_part, rCloneElement, ElementCounter, pNewProperties, NodeKey);
@@ -218,10 +215,7 @@ public:
                         = IsogeometricPostUtility::GenerateHexGrid(corners[0], corners[1], corners[2], corners[3],
                             corners[4], corners[5], corners[6], corners[7], NodeCounter, NumDivision1, NumDivision2, NumDivision3);
 
-                    for (std::size_t i = 0; i < points_and_connectivities.first.size(); ++i)
-                    {
-                        IsogeometricPostUtility::CreateNodeAndTransferValues(points_and_connectivities.first[i], *it, r_model_part, NodeCounter++);
-                    }
+                    IsogeometricPostUtility::CreateNodesAndTransferValues(points_and_connectivities.first, *it, r_model_part, NodeCounter);
 
                     ElementsArrayType pNewElements = IsogeometricPostUtility::CreateEntities<std::vector<std::vector<IndexType> >, Element, ElementsArrayType>(
                         points_and_connectivities.second, r_model_part, rCloneElement, ElementCounter, pNewProperties, NodeKey);
@@ -212,6 +212,67 @@ public:
         //     KRATOS_WATCH(new_dvalues[i][0])
     }
 
+    /// Get the values of the basis functions at a batch of points, see FESpace::GetValuesAtPoints
+    /// The underlying FESpace is evaluated in batch and each row is weighted afterwards.
+    virtual void GetValuesAtPoints(std::vector<std::size_t>& rRowPtr, std::vector<std::size_t>& rIndices,
+        std::vector<double>& rValues, const std::vector<double>& rPoints) const
+    {
+        mpFESpace->GetValuesAtPoints(rRowPtr, rIndices, rValues, rPoints);
+
+        for (std::size_t ip = 0; ip < rRowPtr.size() - 1; ++ip)
+        {
+            double sum_value = 0.0;
+            for (std::size_t k = rRowPtr[ip]; k < rRowPtr[ip + 1]; ++k)
+                sum_value += mWeights[rIndices[k]] * rValues[k];
+
+            for (std::size_t k = rRowPtr[ip]; k < rRowPtr[ip + 1]; ++k)
+            {
+                if (sum_value == 0.0)
+                    rValues[k] = 0.0;
+                else
+                    rValues[k] = mWeights[rIndices[k]] * rValues[k] / sum_value;
+            }
+        }
+    }
+
+    /// Get the values and derivatives of the basis functions at a batch of points, see FESpace::GetValuesAndDerivativesAtPoints
+    virtual void GetValuesAndDerivativesAtPoints(std::vector<std::size_t>& rRowPtr, std::vector<std::size_t>& rIndices,
+        std::vector<double>& rValues, std::vector<double>& rDerivatives, const std::vector<double>& rPoints) const
+    {
+        mpFESpace->GetValuesAndDerivativesAtPoints(rRowPtr, rIndices, rValues, rDerivatives, rPoints);
+
+        double dsum_value[TDim];
+        for (std::size_t ip = 0; ip < rRowPtr.size() - 1; ++ip)
+        {
+            double sum_value = 0.0;
+            std::fill(dsum_value, dsum_value + TDim, 0.0);
+            for (std::size_t k = rRowPtr[ip]; k < rRowPtr[ip + 1]; ++k)
+            {
+                const double& w = mWeights[rIndices[k]];
+                sum_value += w * rValues[k];
+                for (int dim = 0; dim < TDim; ++dim)
+                    dsum_value[dim] += w * rDerivatives[k*TDim + dim];
+            }
+
+            for (std::size_t k = rRowPtr[ip]; k < rRowPtr[ip + 1]; ++k)
+            {
+                const double& w = mWeights[rIndices[k]];
+                if (sum_value == 0.0)
+                {
+                    rValues[k] = 0.0;
+                    for (int dim = 0; dim < TDim; ++dim)
+                        rDerivatives[k*TDim + dim] = 0.0;
+                }
+                else
+                {
+                    for (int dim = 0; dim < TDim; ++dim)
+                        rDerivatives[k*TDim + dim] = w * (rDerivatives[k*TDim + dim]/sum_value - rValues[k]*dsum_value[dim]/pow(sum_value, 2));
+                    rValues[k] = w * rValues[k] / sum_value;
+                }
+            }
+        }
+    }
+
     /////////////////////////////////////////////////////////////////////////////////////////////////////
 
     /// Check if a point lies inside the parametric domain of the BSplinesFESpace
@@ -0,0 +1,96 @@
+##################################################################
+# test the batched refinement of the two rectangles multipatch
+# the result of RefineBfs shall be the same as refining the basis
+# functions one by one, and the interface shall stay conforming
+##################################################################
+#importing Kratos modules
+from KratosMultiphysics import *
+from KratosMultiphysics.IsogeometricApplication import *
+kernel = Kernel()   #defining kernel
+
+hbsplines_patch_util = HBSplinesPatchUtility()
+hbsplines_refinement_util = HBSplinesRefinementUtility()
+
+nurbs_fespace_library = BSplinesFESpaceLibrary()
+grid_lib = ControlGridLibrary()
+multipatch_util = MultiPatchUtility()
+
+def CreateMultiPatch():
+
+    ### create B-Splines patches
+
+    fes1 = nurbs_fespace_library.CreateRectangularFESpace(3, 3)
+    ctrl_grid_1 = grid_lib.CreateRectangularControlPointGrid(0.0, 0.0, fes1.Number(0), fes1.Number(1), 1.0, 1.0)
+    patch1_ptr = multipatch_util.CreatePatchPointer(1, fes1)
+    patch1 = patch1_ptr.GetReference()
+    patch1.CreateControlPointGridFunction(ctrl_grid_1)
+
+    fes2 = nurbs_fespace_library.CreateRectangularFESpace(3, 3)
+    ctrl_grid_2 = grid_lib.CreateRectangularControlPointGrid(1.0, 0.0, fes2.Number(0), fes2.Number(1), 2.0, 1.0)
+    patch2_ptr = multipatch_util.CreatePatchPointer(2, fes2)
+    patch2 = patch2_ptr.GetReference()
+    patch2.CreateControlPointGridFunction(ctrl_grid_2)
+
+    ### create hierarchical B-Splines multipatch
+
+    hpatch1_ptr = hbsplines_patch_util.CreatePatchFromBSplines(patch1)
+    hpatch1 = hpatch1_ptr.GetReference()
+
+    hpatch2_ptr = hbsplines_patch_util.CreatePatchFromBSplines(patch2)
+    hpatch2 = hpatch2_ptr.GetReference()
+
+    hmpatch = MultiPatch2D()
+    hmpatch.AddPatch(hpatch1_ptr)
+    hmpatch.AddPatch(hpatch2_ptr)
+    multipatch_util.MakeInterface(hpatch1, BoundarySide.Right, hpatch2, BoundarySide.Left)
+    hmpatch.Enumerate()
+
+    ### refine once, so that the next refinements cover two levels
+    hbsplines_refinement_util.Refine(hpatch1, 4, 0)
+    hmpatch.Enumerate()
+
+    return hmpatch
+
+def Summary(hmpatch):
+    hpatch1 = hmpatch[1].GetReference()
+    hpatch2 = hmpatch[2].GetReference()
+
+    boundary_basis_1 = hpatch1.FESpace().GetBoundaryBfs(BoundaryFlag.Right)
+    boundary_basis_2 = hpatch2.FESpace().GetBoundaryBfs(BoundaryFlag.Left)
+
+    # the interface is conforming if the bfs on both sides share the same equation ids
+    interface_ids_1 = sorted([bf.EquationId for bf in boundary_basis_1])
+    interface_ids_2 = sorted([bf.EquationId for bf in boundary_basis_2])
+    conforming = (interface_ids_1 == interface_ids_2)
+
+    levels_1 = sorted([bf.Level() for bf in boundary_basis_1])
+    levels_2 = sorted([bf.Level() for bf in boundary_basis_2])
+
+    return [hmpatch.EquationSystemSize(), hpatch1.TotalNumber(), hpatch2.TotalNumber(), levels_1, levels_2], conforming
+
+def main():
+    # bf 5 is of level 1, bfs 20 and 26 are the children of bf 4 of level 2
+    bf_ids = [5, 20, 26]
+
+    # refine the basis functions one by one
+    hmpatch_ref = CreateMultiPatch()
+    for bf_id in bf_ids:
+        hbsplines_refinement_util.Refine(hmpatch_ref[1].GetReference(), bf_id, 0)
+        hmpatch_ref.Enumerate()
+
+    # refine the basis functions in one batch
+    hmpatch = CreateMultiPatch()
+    hbsplines_refinement_util.RefineBfs(hmpatch[1].GetReference(), bf_ids, 0)
+
+    summary_ref, conforming_ref = Summary(hmpatch_ref)
+    summary, conforming = Summary(hmpatch)
+    print("one by one: equation system size " + str(summary_ref[0]) + ", number of bfs " + str(summary_ref[1]) + ", " + str(summary_ref[2]) + ", conforming interface: " + str(conforming_ref))
+    print("RefineBfs : equation system size " + str(summary[0]) + ", number of bfs " + str(summary[1]) + ", " + str(summary[2]) + ", conforming interface: " + str(conforming))
+
+    if (summary == summary_ref) and conforming and conforming_ref:
+        print("Test passed")
+    else:
+        print("Test failed")
+
+if __name__ == "__main__":
+    main()
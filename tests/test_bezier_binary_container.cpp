@@ -0,0 +1,98 @@
+#include <fstream>
+#include <iterator>
+#include "includes/define.h"
+#include "includes/ublas_interface.h"
+#include "custom_io/bezier_binary_container.h"
+
+using namespace Kratos;
+
+/// Copy the container, overwrite one word of a section and check that the container rejects the copy
+void test_corrupted(const std::string& filename, const std::size_t& section, const std::size_t& index,
+        const BezierBinaryLayout::WordType& value, const std::string& label)
+{
+    std::ifstream infile(filename.c_str(), std::ios::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(infile)), std::istreambuf_iterator<char>());
+    infile.close();
+
+    std::vector<BezierBinaryLayout::WordType> offsets;
+    BezierBinaryLayout::ComputeOffsets(*reinterpret_cast<const BezierBinaryLayout::Header*>(&data[0]), offsets);
+    std::memcpy(&data[offsets[section] + index * sizeof(BezierBinaryLayout::WordType)], &value, sizeof(value));
+
+    const std::string corrupted_filename = "corrupted_" + filename;
+    std::ofstream outfile(corrupted_filename.c_str(), std::ios::binary);
+    outfile.write(&data[0], data.size());
+    outfile.close();
+
+    bool is_rejected = false;
+    try
+    {
+        BezierBinaryContainer Container(corrupted_filename);
+    }
+    catch (std::exception& e)
+    {
+        is_rejected = true;
+    }
+    std::cout << label << ": " << (is_rejected ? "rejected" : "NOT rejected") << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    // two quadratic Bezier geometries sharing the middle node
+    Matrix C(3, 3);
+    noalias(C) = ZeroMatrix(3, 3);
+    C(0, 0) = 1.0;
+    C(1, 1) = 1.0; C(1, 2) = 0.5;
+    C(2, 2) = 0.5;
+    CompressedExtractionOperator Op;
+    Op.Assign(C);
+
+    Vector w(3);
+    w(0) = 1.0; w(1) = 0.7; w(2) = 1.0;
+
+    BezierBinaryWriter Writer;
+    for (std::size_t i = 0; i < 5; ++i)
+        Writer.AddNode(i + 1, 0.5 * i, 1.0, 0.0);
+    Writer.AddGeometry(10, 3, 1, 2, 2, 0, 0, w, Op);
+    Writer.AddGeometry(20, 3, 1, 2, 2, 0, 0, w, Op);
+
+    std::vector<std::size_t> nodes(3);
+    Writer.AddGroup("KinematicLinearGeo1dBezier", BezierBinaryLayout::ELEMENT);
+    nodes[0] = 1; nodes[1] = 2; nodes[2] = 3;
+    Writer.AddEntity(1, 1, 20, nodes);
+    nodes[0] = 3; nodes[1] = 4; nodes[2] = 5;
+    Writer.AddEntity(2, 1, 10, nodes);
+    Writer.Write("test_bezier_binary_container.bmdpa");
+
+    BezierBinaryContainer Container("test_bezier_binary_container.bmdpa");
+    std::cout << "number of nodes: " << Container.NumberOfNodes() << std::endl;
+    std::cout << "number of geometries: " << Container.NumberOfGeometries() << std::endl;
+    std::cout << "number of entities: " << Container.NumberOfEntities() << std::endl;
+    std::cout << "group: " << Container.Group(0).Name << ", " << Container.Group(0).NumberOfEntities << " entities" << std::endl;
+    std::cout << "coordinates of node " << Container.NodeIds()[3] << ": " << Container.NodeCoordinates()[9]
+              << " " << Container.NodeCoordinates()[10] << " " << Container.NodeCoordinates()[11] << std::endl;
+
+    double err = 0.0;
+    CompressedExtractionOperator ReadOp;
+    for (std::size_t i = 0; i < Container.NumberOfEntities(); ++i)
+    {
+        const BezierBinaryContainer::EntityRecordType& r_entity = Container.Entity(i);
+        const BezierBinaryContainer::GeometryRecordType& r_geometry = Container.Geometry(r_entity.GeometryIndex);
+        Container.GetExtractionOperator(r_geometry, ReadOp);
+        err += norm_frobenius(ReadOp.ToMatrix() - C);
+        for (std::size_t j = 0; j < r_geometry.NumberOfNodes; ++j)
+            err += fabs(Container.Weights(r_geometry)[j] - w(j));
+        std::cout << "entity " << r_entity.Id << ": geometry " << r_geometry.Id << ", nodes";
+        for (std::size_t j = 0; j < r_geometry.NumberOfNodes; ++j)
+            std::cout << " " << Container.Connectivities(r_entity)[j];
+        std::cout << std::endl;
+    }
+    std::cout << "read back error: " << err << std::endl;
+
+    // the CSR arrays are checked when the container is opened, since the extraction operators are views on them
+    test_corrupted("test_bezier_binary_container.bmdpa", 4, 2, 0, "non-monotone row pointers");
+    test_corrupted("test_bezier_binary_container.bmdpa", 4, 0, 1, "row pointers not starting at zero");
+    test_corrupted("test_bezier_binary_container.bmdpa", 4, 3, 100, "row pointers past the non-zeros");
+    test_corrupted("test_bezier_binary_container.bmdpa", 5, 1, 3, "column index out of range");
+
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include "includes/define.h"
+#include "includes/ublas_interface.h"
+#include "custom_utilities/nurbs/pbbsplines_basis_function.h"
+#include "custom_utilities/nurbs/bezier_extraction_cache.h"
+
+using namespace Kratos;
+
+/// Simple cell with the bounds of a box in the parameter space
+struct TestCell
+{
+    double mBounds[6];
+    double XiMinValue() const {return mBounds[0];}
+    double XiMaxValue() const {return mBounds[1];}
+    double EtaMinValue() const {return mBounds[2];}
+    double EtaMaxValue() const {return mBounds[3];}
+    double ZetaMinValue() const {return mBounds[4];}
+    double ZetaMaxValue() const {return mBounds[5];}
+};
+
+/// Compare the cached extraction of the hierarchical-like basis functions on a uniform grid of cells with the reference
+/// extraction. The basis functions of the same level are translated and scaled copies, hence most of the rows are hits.
+template<int TDim>
+void test(const std::size_t& p, const std::size_t& n)
+{
+    BezierExtractionCache cache;
+    std::vector<std::size_t> orders(TDim, p);
+    std::vector<std::vector<double> > local_knots(TDim);
+    Vector Crow, Crow_ref;
+    double max_error = 0.0;
+    std::size_t number_of_rows = 0;
+
+    for (std::size_t level = 1; level <= 2; ++level)
+    {
+        const double h = 1.0 / level;
+        for (std::size_t b = 0; b < n; ++b)
+        {
+            // local knots of the bf, shifted by b spans and partially repeated at the first knot of the first bf
+            for (int dim = 0; dim < TDim; ++dim)
+            {
+                local_knots[dim].resize(p + 2);
+                for (std::size_t i = 0; i < p + 2; ++i)
+                    local_knots[dim][i] = (b == 0 && i < p / 2 + 1) ? 0.0 : h * (b + i + dim);
+            }
+
+            // the cells of the bf are the spans of the local knots, subdivided once
+            std::size_t number_of_cells = 1;
+            for (int dim = 0; dim < TDim; ++dim)
+                number_of_cells *= 2 * (p + 1);
+            for (std::size_t c = 0; c < number_of_cells; ++c)
+            {
+                TestCell cell;
+                for (int dim = 0; dim < 3; ++dim)
+                {
+                    cell.mBounds[2*dim] = 0.0;
+                    cell.mBounds[2*dim + 1] = 1.0;
+                }
+
+                std::size_t cc = c;
+                bool empty = false;
+                for (int dim = 0; dim < TDim; ++dim)
+                {
+                    const std::size_t s = cc % (2 * (p + 1));
+                    cc /= 2 * (p + 1);
+                    const double a = local_knots[dim][s / 2], z = local_knots[dim][s / 2 + 1];
+                    if (z <= a)
+                        empty = true;
+                    cell.mBounds[2*dim] = a + 0.5 * (s % 2) * (z - a);
+                    cell.mBounds[2*dim + 1] = a + 0.5 * (s % 2 + 1) * (z - a);
+                }
+                if (empty)
+                    continue;
+
+                cache.ComputeExtractionOperator<TDim>(Crow, orders, local_knots, cell);
+                PBBSplinesBasisFunction_Helper<TDim>::ComputeExtractionOperator(Crow_ref, orders, local_knots, cell);
+                if (Crow.size() != Crow_ref.size())
+                {
+                    std::cout << "size mismatch: " << Crow.size() << " != " << Crow_ref.size() << std::endl;
+                    continue;
+                }
+                max_error = std::max(max_error, norm_inf(Crow - Crow_ref));
+                ++number_of_rows;
+            }
+        }
+    }
+
+    std::cout << TDim << "D, p = " << p << ": number of rows: " << number_of_rows << ", max error: " << max_error << std::endl;
+    std::cout << cache << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    test<2>(2, 4);
+    test<2>(3, 4);
+    test<3>(2, 3);
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include "includes/define.h"
+#include "includes/ublas_interface.h"
+#include "custom_io/bezier_info_parser.h"
+
+using namespace Kratos;
+
+int main(int argc, char** argv)
+{
+    // the same quadratic geometry given with the three formats of the extraction operator, with repeated ids
+    std::stringstream ss;
+    for (std::size_t k = 0; k < 300; ++k)
+    {
+        ss << "  " << (k * 37) % 200 + 1 << " 3 1 2 2 0 0" << std::endl;
+        ss << "  [3] ( 1.0, " << 0.5 + 1.0e-3 * k << ", 1.0)" << std::endl;
+        if (k % 3 == 0)
+            ss << "  Full" << std::endl << "  [3, 3] ((1, 0, 0),(0, 1, 0.5)," << std::endl << "  (0, 0, 0.5))" << std::endl;
+        else if (k % 3 == 1)
+            ss << "  CSR [4] (0, 1, 3, 4) [4] (0, 1, 2, 2) [4] (1.0, 1.0, 0.5, 0.5)" << std::endl;
+        else
+            ss << "  MCSR" << std::endl << "  [2, 5] ((4, 4, 5, 5, 2),(1.0, 1.0, 0.5, 0.0, 0.5))" << std::endl;
+    }
+    const std::string text = ss.str();
+
+    Matrix C(3, 3);
+    noalias(C) = ZeroMatrix(3, 3);
+    C(0, 0) = 1.0;
+    C(1, 1) = 1.0; C(1, 2) = 0.5;
+    C(2, 2) = 0.5;
+
+    // parse the whole text at once
+    std::vector<BezierInfo::Pointer> infos;
+    std::size_t consumed = BezierInfoParser::ParseRecords(text.data(), text.data() + text.size(), infos);
+    std::cout << "number of records: " << infos.size() << ", consumed: " << consumed << "/" << text.size() << std::endl;
+
+    // parse the text in small batches of lines, as in the parallel reading of BezierModelPartIO
+    std::vector<BezierInfo::Pointer> batched_infos;
+    std::string buffer, line;
+    std::istringstream iss(text);
+    while (std::getline(iss, line))
+    {
+        buffer += line;
+        buffer += '\n';
+        if (buffer.size() > 500)
+            buffer.erase(0, BezierInfoParser::ParseRecords(buffer.data(), buffer.data() + buffer.size(), batched_infos));
+    }
+    buffer.erase(0, BezierInfoParser::ParseRecords(buffer.data(), buffer.data() + buffer.size(), batched_infos));
+    std::cout << "number of batched records: " << batched_infos.size() << ", remaining: " << buffer.size() << std::endl;
+
+    double err = 0.0;
+    for (std::size_t i = 0; i < infos.size(); ++i)
+    {
+        err += norm_frobenius(infos[i]->C - C) + norm_frobenius(batched_infos[i]->C - C);
+        err += norm_2(infos[i]->weights - batched_infos[i]->weights);
+    }
+    std::cout << "parse error: " << err << std::endl;
+
+    // the last geometry with the same id is kept
+    BezierModelPartIO::BezierInfoContainerType container;
+    BezierInfoParser::Insert(container, infos);
+    std::cout << "number of geometries: " << container.size() << std::endl;
+    std::size_t k_last = 0;
+    for (std::size_t k = 0; k < 300; ++k)
+        if ((k * 37) % 200 == 0)
+            k_last = k;
+    std::cout << "weight of geometry 1: " << (*container.ptr_begin())->weights[1] << ", expected: " << 0.5 + 1.0e-3 * k_last << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,112 @@
+#include "includes/define.h"
+#include "includes/ublas_interface.h"
+#include "custom_utilities/bezier_utils.h"
+#include "custom_utilities/compressed_extraction_operator.h"
+
+using namespace Kratos;
+
+/// Compare the sum factorized Bernstein and rational shape functions of the hexahedral Bezier integration rules with the
+/// pointwise evaluation, i.e. the products of the univariate Bernstein functions at each integration point.
+void test(const std::size_t& p1, const std::size_t& p2, const std::size_t& p3)
+{
+    const std::size_t number_of_integration_methods = 2;
+    BezierUtils::RegisterIntegrationRule<3, 3, 3>(number_of_integration_methods, p1, p2, p3);
+    GeometryData::Pointer pGeometryData = BezierUtils::RetrieveIntegrationRule<3, 3, 3>(number_of_integration_methods, p1, p2, p3);
+
+    const std::size_t nb = (p1 + 1) * (p2 + 1) * (p3 + 1);
+
+    // the extraction operator and the weights of a rational element with nb control points
+    Matrix C(nb, nb);
+    for (std::size_t i = 0; i < nb; ++i)
+        for (std::size_t j = 0; j < nb; ++j)
+            C(i, j) = (i == j) ? 1.0 : ((i + 2 * j) % 7 == 0 ? 0.25 : 0.0);
+    CompressedExtractionOperator extraction_operator;
+    extraction_operator.Assign(C);
+    Vector ctrl_weights(nb);
+    for (std::size_t i = 0; i < nb; ++i)
+        ctrl_weights(i) = 1.0 + 0.1 * (i % 5);
+    Vector bezier_weights = prod(trans(C), ctrl_weights);
+
+    for (std::size_t m = 0; m < number_of_integration_methods; ++m)
+    {
+        const GeometryData::IntegrationMethod ThisMethod = static_cast<GeometryData::IntegrationMethod>(m);
+        const GeometryData::IntegrationPointsArrayType& integration_points = pGeometryData->IntegrationPoints(ThisMethod);
+        const Matrix& bezier_values = pGeometryData->ShapeFunctionsValues(ThisMethod);
+        const GeometryData::ShapeFunctionsGradientsType& bezier_local_gradients = pGeometryData->ShapeFunctionsLocalGradients(ThisMethod);
+
+        // the rational shape functions by sum factorization, twice to check that the 1D factorization is reused
+        Matrix values;
+        GeometryData::ShapeFunctionsGradientsType local_gradients;
+        const std::size_t number_of_sum_factorizations = BezierUtils::NumberOfSumFactorizations();
+        bool is_tensor_product = BezierUtils::CalculateRationalShapeFunctionsValuesAndLocalGradients(3, *pGeometryData, ThisMethod,
+            p1, p2, p3, extraction_operator, ctrl_weights, bezier_weights, values, local_gradients);
+        is_tensor_product = is_tensor_product && BezierUtils::CalculateRationalShapeFunctionsValuesAndLocalGradients(3, *pGeometryData, ThisMethod,
+            p1, p2, p3, extraction_operator, ctrl_weights, bezier_weights, values, local_gradients);
+        if (!is_tensor_product)
+        {
+            std::cout << "p = (" << p1 << ", " << p2 << ", " << p3 << "), method " << m << ": the integration rule is not a tensor product" << std::endl;
+            continue;
+        }
+
+        double max_error_bernstein = 0.0, max_error_rational = 0.0;
+        Vector B1(p1 + 1), D1(p1 + 1), B2(p2 + 1), D2(p2 + 1), B3(p3 + 1), D3(p3 + 1);
+        Vector B(nb);
+        Matrix dB(3, nb);
+        for (std::size_t q = 0; q < integration_points.size(); ++q)
+        {
+            // pointwise Bernstein functions
+            BezierUtils::bernstein(B1, D1, p1, integration_points[q][0]);
+            BezierUtils::bernstein(B2, D2, p2, integration_points[q][1]);
+            BezierUtils::bernstein(B3, D3, p3, integration_points[q][2]);
+            for (std::size_t i = 0; i < p1 + 1; ++i)
+            {
+                for (std::size_t j = 0; j < p2 + 1; ++j)
+                {
+                    for (std::size_t k = 0; k < p3 + 1; ++k)
+                    {
+                        const std::size_t index = k + (j + i * (p2 + 1)) * (p3 + 1);
+                        B(index) = B1(i) * B2(j) * B3(k);
+                        dB(0, index) = D1(i) * B2(j) * B3(k);
+                        dB(1, index) = B1(i) * D2(j) * B3(k);
+                        dB(2, index) = B1(i) * B2(j) * D3(k);
+                    }
+                }
+            }
+
+            max_error_bernstein = std::max(max_error_bernstein, norm_inf(row(bezier_values, q) - B));
+            for (std::size_t d = 0; d < 3; ++d)
+                max_error_bernstein = std::max(max_error_bernstein, norm_inf(row(bezier_local_gradients[q], d) - row(dB, d)));
+
+            // pointwise rational shape functions N_A = w_A * (C * B)_A / W
+            const double W = inner_prod(bezier_weights, B);
+            Vector CB = prod(C, B);
+            for (std::size_t a = 0; a < nb; ++a)
+            {
+                const double N = ctrl_weights(a) * CB(a) / W;
+                max_error_rational = std::max(max_error_rational, fabs(values(q, a) - N));
+                for (std::size_t d = 0; d < 3; ++d)
+                {
+                    const double dW = inner_prod(bezier_weights, row(dB, d));
+                    const double dCB = inner_prod(row(C, a), row(dB, d));
+                    const double dN = (ctrl_weights(a) * dCB - N * dW) / W;
+                    max_error_rational = std::max(max_error_rational, fabs(local_gradients[q](a, d) - dN));
+                }
+            }
+        }
+
+        std::cout << "p = (" << p1 << ", " << p2 << ", " << p3 << "), method " << m
+                  << ": number of points: " << integration_points.size()
+                  << ", max error of Bernstein values and gradients: " << max_error_bernstein
+                  << ", max error of rational values and gradients: " << max_error_rational
+                  << ", number of new sum factorizations: " << BezierUtils::NumberOfSumFactorizations() - number_of_sum_factorizations
+                  << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    test(3, 3, 3);
+    test(4, 4, 4);
+    test(3, 4, 5);
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include "includes/define.h"
+#include "custom_utilities/bounding_box_tree.h"
+
+using namespace Kratos;
+
+int main(int argc, char** argv)
+{
+    // the XY boxes of the knot spans of a n x n surface, enlarged as the control point boxes of the quadratic spans,
+    // plus a few large boxes covering many spans
+    const std::size_t n = 50;
+    const double h = 1.0 / n;
+    std::vector<double> boxes;
+    for (std::size_t j = 0; j < n; ++j)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            boxes.push_back((i - 0.5) * h);
+            boxes.push_back((i + 1.5) * h);
+            boxes.push_back((j - 0.5) * h);
+            boxes.push_back((j + 1.5) * h);
+        }
+    }
+    for (std::size_t k = 0; k < 5; ++k)
+    {
+        boxes.push_back(0.1 * k);
+        boxes.push_back(0.1 * k + 0.5);
+        boxes.push_back(0.2 * k);
+        boxes.push_back(0.2 * k + 0.3);
+    }
+
+    BoundingBoxTree<2> tree;
+    tree.Build(boxes);
+    std::cout << tree << std::endl;
+
+    // compare the search with the brute force on a grid of points, including points outside all the boxes
+    const std::size_t m = 97;
+    const double tol = 1.0e-10;
+    std::size_t number_of_errors = 0, number_of_candidates = 0;
+    std::vector<std::size_t> results, expected;
+    for (std::size_t j = 0; j <= m; ++j)
+    {
+        for (std::size_t i = 0; i <= m; ++i)
+        {
+            const double P[2] = {-0.1 + 1.2 * i / m, -0.1 + 1.2 * j / m};
+            tree.Search(P, tol, results);
+
+            expected.clear();
+            for (std::size_t k = 0; k < tree.size(); ++k)
+            {
+                const double* box = tree.Box(k);
+                if (P[0] >= box[0] - tol && P[0] <= box[1] + tol && P[1] >= box[2] - tol && P[1] <= box[3] + tol)
+                    expected.push_back(k);
+            }
+
+            if (results != expected)
+                ++number_of_errors;
+            number_of_candidates += results.size();
+        }
+    }
+    std::cout << "average number of candidates: " << double(number_of_candidates) / ((m + 1) * (m + 1)) << std::endl;
+    std::cout << "number of differences with the brute force search: " << number_of_errors << std::endl;
+
+    // an empty tree returns nothing
+    BoundingBoxTree<2> empty_tree;
+    empty_tree.Build(std::vector<double>());
+    const double Q[2] = {0.5, 0.5};
+    empty_tree.Search(Q, tol, results);
+    std::cout << "number of results in the empty tree: " << results.size() << std::endl;
+
+    return 0;
+}
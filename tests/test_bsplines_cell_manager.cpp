@@ -0,0 +1,109 @@
+#include "includes/define.h"
+#include "includes/ublas_interface.h"
+#include "custom_utilities/bezier_utils.h"
+#include "custom_utilities/nurbs/bsplines_fespace.h"
+
+using namespace Kratos;
+
+/// Create the B-Splines FESpace of the given open knot vectors and enumerate it
+template<int TDim>
+typename BSplinesFESpace<TDim>::Pointer CreateFESpace(const std::vector<std::vector<double> >& knots, const std::vector<std::size_t>& orders)
+{
+    typename BSplinesFESpace<TDim>::Pointer pFESpace = BSplinesFESpace<TDim>::Create();
+    for (int dim = 0; dim < TDim; ++dim)
+    {
+        pFESpace->SetKnotVector(dim, knots[dim]);
+        pFESpace->SetInfo(dim, knots[dim].size() - orders[dim] - 1, orders[dim]);
+    }
+    pFESpace->ResetFunctionIndices();
+    std::size_t start = 0;
+    pFESpace->Enumerate(start);
+    return pFESpace;
+}
+
+/// The local id of the first basis function supported on each non-zero knot span, i.e. the index of the left knot minus the order
+std::vector<std::size_t> FirstFunctions(const std::vector<double>& knots, const std::size_t& order)
+{
+    std::vector<std::size_t> first;
+    for (std::size_t s = order; s < knots.size() - order - 1; ++s)
+        if (knots[s+1] > knots[s])
+            first.push_back(s - order);
+    return first;
+}
+
+/// Compare the cells of ConstructCellManager, which are built in parallel from the Kronecker products of the sparse 1D
+/// operators, with the dense operators of BezierUtils::bezier_extraction_2d/3d. The dense operators are computed with
+/// the rotated argument order, hence the element counter is (i*ne2 + j)*ne3 + k as for the cells.
+template<int TDim>
+void test(const std::vector<std::vector<double> >& knots, const std::vector<std::size_t>& orders)
+{
+    typename BSplinesFESpace<TDim>::Pointer pFESpace = CreateFESpace<TDim>(knots, orders);
+    typename BSplinesFESpace<TDim>::cell_container_t::Pointer pCells
+        = boost::dynamic_pointer_cast<typename BSplinesFESpace<TDim>::cell_container_t>(pFESpace->ConstructCellManager());
+    const std::vector<std::size_t> func_indices = pFESpace->FunctionIndices();
+
+    std::vector<Matrix> C;
+    int ne[3] = {1, 1, 1};
+    if (TDim == 2)
+        BezierUtils::bezier_extraction_2d(C, ne[1], ne[0], pFESpace->KnotVector(1), pFESpace->KnotVector(0), orders[1], orders[0]);
+    else if (TDim == 3)
+        BezierUtils::bezier_extraction_3d(C, ne[2], ne[1], ne[0], pFESpace->KnotVector(2), pFESpace->KnotVector(1), pFESpace->KnotVector(0),
+            orders[2], orders[1], orders[0]);
+
+    std::vector<std::vector<std::size_t> > first(3, std::vector<std::size_t>(1, 0));
+    std::size_t nb[3] = {1, 1, 1}, nf[3] = {1, 1, 1};
+    for (int dim = 0; dim < TDim; ++dim)
+    {
+        first[dim] = FirstFunctions(knots[dim], orders[dim]);
+        nb[dim] = orders[dim] + 1;
+        nf[dim] = pFESpace->Number(dim);
+    }
+
+    double err = 0.0;
+    std::size_t number_of_differences = 0;
+    if (pCells->size() != C.size())
+        ++number_of_differences;
+
+    for (std::size_t cnt = 0; cnt < std::min(pCells->size(), C.size()); ++cnt)
+    {
+        const std::size_t i = cnt / (ne[1]*ne[2]);
+        const std::size_t j = (cnt / ne[2]) % ne[1];
+        const std::size_t k = cnt % ne[2];
+
+        // the anchors of the dense operator rows, in the order of its rows
+        std::vector<std::size_t> anchors;
+        for (std::size_t u = 0; u < nb[0]; ++u)
+            for (std::size_t v = 0; v < nb[1]; ++v)
+                for (std::size_t w = 0; w < nb[2]; ++w)
+                    anchors.push_back(func_indices[(first[0][i] + u) + ((first[1][j] + v) + (first[2][k] + w) * nf[1]) * nf[0]]);
+
+        BCell::Pointer p_cell = pCells->get(cnt);
+        if (p_cell->GetSupportedAnchors() != anchors)
+        {
+            ++number_of_differences;
+            continue;
+        }
+        err += norm_frobenius(p_cell->GetExtractionOperator() - C[cnt]);
+    }
+
+    std::cout << TDim << "D, orders (" << orders[0];
+    for (int dim = 1; dim < TDim; ++dim)
+        std::cout << ", " << orders[dim];
+    std::cout << "), number of cells: " << pCells->size() << ", number of dense operators: " << C.size()
+              << ", number of differences: " << number_of_differences << ", error: " << err << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    // mixed degrees, with repeated interior knots
+    const std::vector<double> U = {0.0, 0.0, 0.0, 0.25, 0.5, 0.5, 0.75, 1.0, 1.0, 1.0};
+    const std::vector<double> V = {0.0, 0.0, 0.0, 0.0, 0.4, 0.4, 0.4, 0.7, 1.0, 1.0, 1.0, 1.0};
+    const std::vector<double> W = {0.0, 0.0, 0.3, 0.6, 0.6, 1.0, 1.0};
+
+    test<2>({U, V}, {2, 3});
+    test<2>({V, W}, {3, 1});
+    test<3>({U, V, W}, {2, 3, 1});
+    test<3>({W, U, V}, {1, 2, 3});
+
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include "includes/define.h"
+#include "includes/ublas_interface.h"
+#include "custom_utilities/compressed_extraction_operator.h"
+
+using namespace Kratos;
+
+int main(int argc, char** argv)
+{
+    // extraction operator of a quadratic element with an interior knot
+    Matrix C(4, 3);
+    noalias(C) = ZeroMatrix(4, 3);
+    C(0, 0) = 1.0;
+    C(1, 1) = 1.0; C(1, 2) = 0.5;
+    C(2, 2) = 0.5;
+    // the last row is left empty to check the row pointers
+
+    CompressedMatrix Cc = C;
+
+    CompressedExtractionOperator Op1, Op2;
+    Op1.Assign(C);
+    Op2.Assign(Cc);
+    std::cout << "Op1: " << Op1 << ", nnz = " << Op1.nnz() << std::endl;
+    std::cout << "Op2: " << Op2 << ", nnz = " << Op2.nnz() << std::endl;
+    std::cout << "dense conversion error: " << norm_frobenius(Op2.ToMatrix() - C) << std::endl;
+
+    Vector v(3);
+    v(0) = 0.25; v(1) = 0.5; v(2) = 0.25;
+    Vector w(4);
+    w(0) = 1.0; w(1) = 0.8; w(2) = 0.9; w(3) = 1.0;
+
+    std::cout << "prod error: " << norm_2(prod(Op1, v) - prod(C, v)) << std::endl;
+
+    Vector tw(3);
+    Op2.TransProd(tw, w);
+    std::cout << "trans prod error: " << norm_2(tw - prod(trans(C), w)) << std::endl;
+
+    Vector N(4);
+    Op1.ApplyValues(N, v, w, 2.0);
+    double err = 0.0;
+    Vector Cv = prod(C, v);
+    for (std::size_t i = 0; i < 4; ++i)
+        err += fabs(N(i) - 2.0 * w(i) * Cv(i));
+    std::cout << "values kernel error: " << err << std::endl;
+
+    Matrix dB(2, 3);
+    dB(0, 0) = -1.0; dB(0, 1) = 0.0; dB(0, 2) = 1.0;
+    dB(1, 0) = 0.5; dB(1, 1) = -1.0; dB(1, 2) = 0.5;
+    Matrix dN(4, 2);
+    Op1.ApplyDerivatives(dN, dB, w);
+    Matrix dN_ref = prod(C, trans(dB));
+    err = 0.0;
+    for (std::size_t i = 0; i < 4; ++i)
+        for (std::size_t d = 0; d < 2; ++d)
+            err += fabs(dN(i, d) - w(i) * dN_ref(i, d));
+    std::cout << "derivatives kernel error: " << err << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include "includes/define.h"
+#include "custom_utilities/bspline_utils.h"
+
+using namespace Kratos;
+
+double CompareLocalBasisFun(int p, const std::vector<double>& Xi)
+{
+    double err = 0.0;
+    int n = 20;
+    for (int i = 0; i <= n + 2; ++i)
+    {
+        // sample the support with some points outside and exactly on the knots
+        double xi;
+        if (i <= n)
+            xi = Xi.front() - 0.1 + (Xi.back() - Xi.front() + 0.2) * i / n;
+        else
+            xi = Xi[i - n];
+
+        double v, dv;
+        BSplineUtils::CoxDeBoorLocal(v, dv, xi, p, Xi);
+        double v_ref = BSplineUtils::CoxDeBoor3(xi, 0, p, Xi);
+        err += fabs(v - v_ref);
+    }
+
+    std::cout << "local knots:";
+    for (std::size_t i = 0; i < Xi.size(); ++i)
+        std::cout << " " << Xi[i];
+    std::cout << "; p = " << p;
+    std::cout << "; error = " << err;
+    std::cout << std::endl;
+
+    return err;
+}
+
+int main(int argc, char** argv)
+{
+    double err = 0.0;
+
+    err += CompareLocalBasisFun(0, {0.0, 0.5});
+    err += CompareLocalBasisFun(1, {0.0, 0.0, 0.5});
+    err += CompareLocalBasisFun(1, {0.0, 0.5, 0.5});
+    err += CompareLocalBasisFun(2, {0.0, 0.0, 0.0, 0.5});
+    err += CompareLocalBasisFun(2, {0.0, 0.25, 0.5, 1.0});
+    err += CompareLocalBasisFun(2, {0.0, 0.5, 0.5, 0.5});
+    err += CompareLocalBasisFun(3, {0.0, 0.25, 0.25, 0.75, 1.0});
+    err += CompareLocalBasisFun(4, {0.0, 0.0, 0.0, 0.0, 0.0, 1.0});
+
+    std::cout << "-----------------" << std::endl;
+
+    // derivative by central difference
+    std::vector<double> Xi = {0.0, 0.25, 0.5, 1.0};
+    double xi = 0.6, h = 1.0e-6;
+    double v, dv;
+    BSplineUtils::CoxDeBoorLocal(v, dv, xi, 2, Xi);
+    double dv_ref = (BSplineUtils::CoxDeBoor3(xi + h, 0, 2, Xi) - BSplineUtils::CoxDeBoor3(xi - h, 0, 2, Xi)) / (2.0*h);
+    std::cout << "derivative: " << dv << ", reference: " << dv_ref << std::endl;
+
+    std::cout << "total error: " << err << std::endl;
+
+    return 0;
+}
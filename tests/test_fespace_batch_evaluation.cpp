@@ -0,0 +1,106 @@
+#include "includes/define.h"
+#include "custom_utilities/weighted_fespace.h"
+#include "custom_utilities/multipatch_utility.h"
+#include "custom_utilities/control_grid_library.h"
+#include "custom_utilities/nurbs/bsplines_fespace_library.h"
+#include "custom_utilities/hbsplines/hbsplines_fespace.h"
+#include "custom_utilities/hbsplines/hbsplines_patch_utility.h"
+#include "custom_utilities/hbsplines/hbsplines_refinement_utility.h"
+
+using namespace Kratos;
+
+/// Compare the batch evaluation with the point-wise GetValues and GetDerivatives, which are implemented by all FESpaces
+template<int TDim>
+double CompareBatchEvaluation(const FESpace<TDim>& rFESpace, const std::vector<double>& points)
+{
+    std::vector<std::size_t> row_ptr, indices, row_ptr_v, indices_v;
+    std::vector<double> values, derivatives, values_v;
+    rFESpace.GetValuesAndDerivativesAtPoints(row_ptr, indices, values, derivatives, points);
+    rFESpace.GetValuesAtPoints(row_ptr_v, indices_v, values_v, points);
+
+    double err = 0.0;
+    std::vector<double> xi(TDim), ref_values, ref_values_v;
+    std::vector<std::vector<double> > ref_derivatives;
+    for (std::size_t ip = 0; ip < row_ptr.size() - 1; ++ip)
+    {
+        std::copy(points.begin() + ip*TDim, points.begin() + (ip+1)*TDim, xi.begin());
+        rFESpace.GetValues(ref_values, xi);
+        rFESpace.GetDerivatives(ref_derivatives, xi);
+        ref_values_v = ref_values;
+
+        for (std::size_t k = row_ptr[ip]; k < row_ptr[ip+1]; ++k)
+        {
+            err += fabs(values[k] - ref_values[indices[k]]);
+            ref_values[indices[k]] = 0.0;
+            for (int dim = 0; dim < TDim; ++dim)
+            {
+                err += fabs(derivatives[k*TDim + dim] - ref_derivatives[indices[k]][dim]);
+                ref_derivatives[indices[k]][dim] = 0.0;
+            }
+        }
+
+        for (std::size_t k = row_ptr_v[ip]; k < row_ptr_v[ip+1]; ++k)
+        {
+            err += fabs(values_v[k] - ref_values_v[indices_v[k]]);
+            ref_values_v[indices_v[k]] = 0.0;
+        }
+
+        // the remaining functions must be zero
+        for (std::size_t i = 0; i < ref_values.size(); ++i)
+        {
+            err += fabs(ref_values[i]) + fabs(ref_values_v[i]);
+            for (int dim = 0; dim < TDim; ++dim)
+                err += fabs(ref_derivatives[i][dim]);
+        }
+    }
+
+    std::cout << rFESpace.Type() << ", number of points: " << row_ptr.size() - 1 << ", number of non-zeros: " << values.size() << std::endl;
+
+    return err;
+}
+
+/// Points on a structured grid of [0, 1] x [0, 1], including the boundary
+std::vector<double> GridPoints2D(const std::size_t& n)
+{
+    std::vector<double> points;
+    for (std::size_t j = 0; j <= n; ++j)
+        for (std::size_t i = 0; i <= n; ++i)
+        {
+            points.push_back(((double) i) / n);
+            points.push_back(((double) j) / n);
+        }
+    return points;
+}
+
+int main(int argc, char** argv)
+{
+    // 2D, points on a structured grid, including the boundary and one point outside
+    BSplinesFESpace<2>::Pointer pFESpace2 = BSplinesFESpaceLibrary::CreateUniformFESpace<2>({6, 5}, {2, 3});
+    std::vector<double> points2 = GridPoints2D(10);
+    points2.push_back(1.5);
+    points2.push_back(0.5);
+    std::cout << "2D error: " << CompareBatchEvaluation<2>(*pFESpace2, points2) << std::endl;
+
+    // 3D, unsorted points
+    BSplinesFESpace<3>::Pointer pFESpace3 = BSplinesFESpaceLibrary::CreateUniformFESpace<3>({4, 5, 3}, {2, 1, 2});
+    std::vector<double> points3 = {0.3, 0.2, 0.9, 0.0, 0.0, 0.0, 1.0, 1.0, 1.0, 0.3, 0.7, 0.9, 0.55, 0.2, 0.1};
+    std::cout << "3D error: " << CompareBatchEvaluation<3>(*pFESpace3, points3) << std::endl;
+
+    // rational, the weights of the underlying 2D B-Splines space are not uniform
+    std::vector<double> weights(pFESpace2->TotalNumber());
+    for (std::size_t i = 0; i < weights.size(); ++i)
+        weights[i] = 1.0 + 0.25 * (i % 3);
+    WeightedFESpace<2>::Pointer pWeightedFESpace = WeightedFESpace<2>::Create(pFESpace2, weights);
+    std::cout << "2D weighted error: " << CompareBatchEvaluation<2>(*pWeightedFESpace, points2) << std::endl;
+
+    // hierarchical B-Splines, evaluated through the span index of the point-based FESpace. The bf 5 of level 1 and then
+    // its first child 21 of level 2 are refined, hence the cells are not uniform.
+    Patch<2>::Pointer pBPatch = MultiPatchUtility::CreatePatchPointer<2>(1, BSplinesFESpaceLibrary::CreateUniformFESpace<2>({5, 4}, {2, 2}));
+    pBPatch->CreateControlPointGridFunction(ControlGridLibrary::CreateStructuredControlPointGrid<2>({0.0, 0.0}, {5, 4}, {1.0, 1.0}));
+    Patch<2>::Pointer pHBPatch = HBSplinesPatchUtility::CreatePatchFromBSplines<2>(pBPatch);
+    HBSplinesRefinementUtility::Refine<2>(pHBPatch, 5, 0);
+    HBSplinesRefinementUtility::Refine<2>(pHBPatch, 21, 0);
+    std::cout << "2D hierarchical error: " << CompareBatchEvaluation<2>(*pHBPatch->pFESpace(), GridPoints2D(16)) << std::endl;
+
+    return 0;
+}
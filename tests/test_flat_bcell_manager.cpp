@@ -0,0 +1,116 @@
+#include "includes/define.h"
+#include "includes/ublas_interface.h"
+#include "custom_utilities/cell.h"
+#include "custom_utilities/nurbs/flat_bcell_manager.h"
+#include "custom_utilities/nurbs/bsplines_fespace_library.h"
+
+using namespace Kratos;
+
+/// Compare the cells of a uniform B-Splines FESpace constructed in the flat layout with the cells of the cell manager
+template<int TDim>
+void test_bsplines(const std::vector<std::size_t>& numbers, const std::vector<std::size_t>& orders)
+{
+    typename BSplinesFESpace<TDim>::Pointer pFESpace = BSplinesFESpaceLibrary::CreateUniformFESpace<TDim>(numbers, orders);
+    std::size_t start = 0;
+    pFESpace->Enumerate(start);
+
+    typename BSplinesFESpace<TDim>::cell_container_t::Pointer pCells
+        = boost::dynamic_pointer_cast<typename BSplinesFESpace<TDim>::cell_container_t>(pFESpace->ConstructCellManager());
+    typename FlatBCellManager<TDim>::Pointer pFlatCells = pFESpace->ConstructFlatCellManager();
+
+    double err = 0.0;
+    std::size_t number_of_differences = 0;
+    if (pCells->size() != pFlatCells->size())
+        ++number_of_differences;
+
+    typename FlatBCellManager<TDim>::const_iterator it_flat = pFlatCells->begin();
+    for (typename BSplinesFESpace<TDim>::cell_container_t::iterator it = pCells->begin();
+            (it != pCells->end()) && (it_flat != pFlatCells->end()); ++it, ++it_flat)
+    {
+        if (((*it)->Id() != (*it_flat)->Id()) || ((*it)->Level() != (*it_flat)->Level())
+                || ((*it)->GetSupportedAnchors() != (*it_flat)->GetSupportedAnchors()))
+            ++number_of_differences;
+
+        err += fabs((*it)->XiMinValue() - (*it_flat)->XiMinValue()) + fabs((*it)->XiMaxValue() - (*it_flat)->XiMaxValue());
+        err += fabs((*it)->EtaMinValue() - (*it_flat)->EtaMinValue()) + fabs((*it)->EtaMaxValue() - (*it_flat)->EtaMaxValue());
+        if (TDim > 2)
+            err += fabs((*it)->ZetaMinValue() - (*it_flat)->ZetaMinValue()) + fabs((*it)->ZetaMaxValue() - (*it_flat)->ZetaMaxValue());
+        err += norm_frobenius((*it)->GetExtractionOperator() - (*it_flat)->GetExtractionOperator());
+    }
+
+    std::cout << TDim << "D B-Splines, number of cells: " << pCells->size() << ", " << *pFlatCells << std::endl;
+    std::cout << " number of differences: " << number_of_differences << ", error: " << err << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    // two 2D cells of a quadratic patch, with the rows of the extraction operator given per anchor
+    Matrix C1(3, 3);
+    noalias(C1) = ZeroMatrix(3, 3);
+    C1(0, 0) = 1.0; C1(0, 1) = 0.5;
+    C1(1, 1) = 0.5; C1(1, 2) = 0.5;
+    C1(2, 2) = 0.5;
+
+    Matrix C2(2, 3);
+    noalias(C2) = ZeroMatrix(2, 3);
+    C2(0, 0) = 0.5;
+    C2(1, 1) = 0.5; C2(1, 2) = 1.0;
+
+    // the reference cells
+    Cell cell1(1), cell2(2);
+    for (std::size_t i = 0; i < C1.size1(); ++i)
+        cell1.AddAnchor(10 + i, 1.0 + 0.1*i, row(C1, i));
+    for (std::size_t i = 0; i < C2.size1(); ++i)
+        cell2.AddAnchor(20 + i, 0.9, row(C2, i));
+
+    // the flat storage
+    FlatBCellManager<2> cells;
+    cells.reserve(2, 5, 9);
+    double bounds1[] = {0.0, 0.5, 0.0, 1.0};
+    double bounds2[] = {0.5, 1.0, 0.0, 1.0};
+    cells.AddCell(1, 1, bounds1, 3);
+    for (std::size_t i = 0; i < C1.size1(); ++i)
+        cells.AddAnchor(10 + i, 1.0 + 0.1*i, row(C1, i));
+    cells.AddCell(2, 1, bounds2, 3);
+    for (std::size_t i = 0; i < C2.size1(); ++i)
+        cells.AddAnchor(20 + i, 0.9, row(C2, i));
+
+    std::cout << cells << std::endl;
+
+    double err = 0.0;
+    std::size_t cnt = 0;
+    for (FlatBCellManager<2>::const_iterator it = cells.begin(); it != cells.end(); ++it)
+    {
+        const Cell& ref = (cnt == 0) ? cell1 : cell2;
+        const Matrix& C = (cnt == 0) ? C1 : C2;
+        std::cout << "cell " << (*it)->Id() << ": [" << (*it)->XiMinValue() << ", " << (*it)->XiMaxValue()
+                  << "] x [" << (*it)->EtaMinValue() << ", " << (*it)->EtaMaxValue() << "], anchors:";
+        for (std::size_t i = 0; i < (*it)->NumberOfAnchors(); ++i)
+        {
+            std::cout << " " << (*it)->SupportedAnchors()[i];
+            err += fabs((*it)->AnchorWeights()[i] - ref.GetAnchorWeights()[i]);
+            if ((*it)->SupportedAnchors()[i] != ref.GetSupportedAnchors()[i])
+                err += 1.0;
+        }
+        std::cout << std::endl;
+
+        err += norm_frobenius((*it)->GetExtractionOperator() - C);
+        err += norm_frobenius(Matrix((*it)->GetCompressedExtractionOperator()) - C);
+        err += norm_frobenius(ref.GetExtractionOperator() - C);
+        err += norm_frobenius(Matrix(ref.GetCompressedExtractionOperator()) - C);
+
+        CompressedExtractionOperator Op, RefOp;
+        (*it)->GetExtractionOperator(Op);
+        ref.GetExtractionOperator(RefOp);
+        err += norm_frobenius(Op.ToMatrix() - C);
+        err += norm_frobenius(RefOp.ToMatrix() - C);
+
+        ++cnt;
+    }
+    std::cout << "flat cell manager error: " << err << std::endl;
+
+    test_bsplines<2>({7, 5}, {2, 3});
+    test_bsplines<3>({5, 4, 6}, {2, 2, 3});
+
+    return 0;
+}
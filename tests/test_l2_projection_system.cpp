@@ -0,0 +1,161 @@
+#include "includes/define.h"
+#include "includes/ublas_interface.h"
+#include "custom_utilities/l2_projection_system.h"
+#include <boost/numeric/ublas/lu.hpp>
+
+using namespace Kratos;
+
+/// Dense LU solver for the consistent projection
+struct DenseLUSolver
+{
+    bool Solve(CompressedMatrix& rA, Matrix& rX, Matrix& rB)
+    {
+        Matrix A = rA;
+        permutation_matrix<std::size_t> pm(A.size1());
+        lu_factorize(A, pm);
+        rX = rB;
+        lu_substitute(A, pm, rX);
+        return true;
+    }
+
+    bool Solve(CompressedMatrix& rA, Vector& rX, Vector& rB)
+    {
+        Matrix A = rA;
+        permutation_matrix<std::size_t> pm(A.size1());
+        lu_factorize(A, pm);
+        rX = rB;
+        lu_substitute(A, pm, rX);
+        return true;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    // a structured grid of n x n bilinear elements, the last row of elements is inactive
+    const std::size_t n = 20;
+    const std::size_t NumberOfRows = (n + 1) * (n + 1) + 3; // the last 3 rows are not connected to any element
+    std::vector<std::size_t> element_ptr(1, 0);
+    std::vector<std::size_t> element_rows;
+    std::vector<int> element_status;
+    for (std::size_t j = 0; j < n; ++j)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            element_rows.push_back(j * (n + 1) + i);
+            element_rows.push_back(j * (n + 1) + i + 1);
+            element_rows.push_back((j + 1) * (n + 1) + i + 1);
+            element_rows.push_back((j + 1) * (n + 1) + i);
+            element_ptr.push_back(element_rows.size());
+            element_status.push_back((j == n - 1) ? 1 : 0);
+        }
+    }
+
+    L2ProjectionSystem System;
+    std::cout << "compatible before initialize: " << System.IsCompatible(NumberOfRows, element_ptr, element_rows, element_status) << std::endl;
+    System.Initialize(NumberOfRows, element_ptr, element_rows, element_status);
+    std::cout << "compatible after initialize: " << System.IsCompatible(NumberOfRows, element_ptr, element_rows, element_status) << std::endl;
+    std::cout << System << std::endl;
+
+    // the elements of the same color must not share any row
+    std::size_t number_of_conflicts = 0, number_of_colored_elements = 0;
+    for (std::size_t c = 0; c < System.NumberOfColors(); ++c)
+    {
+        std::vector<int> visited(NumberOfRows, 0);
+        for (std::size_t k = 0; k < System.Color(c).size(); ++k)
+        {
+            const std::size_t e = System.Color(c)[k];
+            for (std::size_t i = 0; i < System.NumberOfElementRows(e); ++i)
+                if (visited[System.ElementRow(e, i)]++)
+                    ++number_of_conflicts;
+            ++number_of_colored_elements;
+        }
+    }
+    std::cout << "number of colored elements: " << number_of_colored_elements << "/" << System.NumberOfElements()
+              << ", number of conflicts: " << number_of_conflicts << std::endl;
+
+    // assemble a mass matrix in parallel and compare with the serial assembly
+    Matrix Ke(4, 4);
+    for (std::size_t i = 0; i < 4; ++i)
+        for (std::size_t j = 0; j < 4; ++j)
+            Ke(i, j) = (i == j) ? 4.0 / 36 : (((i + j) % 2 == 1) ? 2.0 / 36 : 1.0 / 36);
+
+    System.ResetMassMatrix();
+    for (std::size_t c = 0; c < System.NumberOfColors(); ++c)
+    {
+        const std::vector<std::size_t>& color = System.Color(c);
+
+        #pragma omp parallel for
+        for (int k = 0; k < static_cast<int>(color.size()); ++k)
+        {
+            const std::size_t e = color[k];
+            for (std::size_t i = 0; i < System.NumberOfElementRows(e); ++i)
+            {
+                if (element_status[e] == 0)
+                {
+                    for (std::size_t j = 0; j < System.NumberOfElementRows(e); ++j)
+                        System.AddToMassMatrix(System.ElementRow(e, i), System.ElementRow(e, j), Ke(i, j));
+                    System.AddToScaledDiagonalMass(System.ElementRow(e, i), 0.25);
+                }
+                else
+                {
+                    System.AddToMassMatrix(System.ElementRow(e, i), System.ElementRow(e, i), 1.0);
+                    System.AddToScaledDiagonalMass(System.ElementRow(e, i), 1.0);
+                }
+            }
+        }
+    }
+    System.FinalizeMassMatrix();
+
+    Matrix M(NumberOfRows, NumberOfRows);
+    noalias(M) = ZeroMatrix(NumberOfRows, NumberOfRows);
+    for (std::size_t e = 0; e < element_status.size(); ++e)
+    {
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            const std::size_t row = element_rows[element_ptr[e] + i];
+            if (element_status[e] == 0)
+            {
+                for (std::size_t j = 0; j < 4; ++j)
+                    M(row, element_rows[element_ptr[e] + j]) += Ke(i, j);
+            }
+            else
+                M(row, row) += 1.0;
+        }
+    }
+    for (std::size_t i = NumberOfRows - 3; i < NumberOfRows; ++i)
+        M(i, i) = 1.0;
+
+    Matrix Mp = System.MassMatrix();
+    std::cout << "mass matrix assembled: " << System.IsMassMatrixAssembled() << std::endl;
+    std::cout << "assembly error: " << norm_frobenius(Mp - M) << std::endl;
+
+    // project a constant and a linear field with the three projection types. The right hand sides are the columns
+    // of M * X; the rows of the inactive elements are not projected.
+    Matrix X(NumberOfRows, 2), B(NumberOfRows, 2), G;
+    for (std::size_t i = 0; i < NumberOfRows; ++i)
+    {
+        X(i, 0) = 1.0;
+        X(i, 1) = (i < (n + 1) * (n + 1)) ? double(i % (n + 1)) / n : 0.0;
+    }
+    noalias(B) = prod(M, X);
+
+    boost::shared_ptr<DenseLUSolver> pSolver(new DenseLUSolver());
+    System.Solve(pSolver, _CONSISTENT_L2_PROJECTION_, G, B);
+    std::cout << "consistent projection error: " << norm_frobenius(G - X) << std::endl;
+
+    double err_lumped = 0.0, err_scaled = 0.0;
+    System.Solve(pSolver, _LUMPED_L2_PROJECTION_, G, B);
+    for (std::size_t i = 0; i < NumberOfRows; ++i)
+        err_lumped += fabs(G(i, 0) - 1.0);
+    System.Solve(pSolver, _DIAGONAL_SCALED_L2_PROJECTION_, G, B);
+    for (std::size_t i = 0; i < (n + 1) * (n - 1); ++i)
+        err_scaled += fabs(G(i, 0) - 1.0);
+    std::cout << "lumped projection error of the constant field: " << err_lumped << std::endl;
+    std::cout << "diagonal scaled projection error of the constant field (interior): " << err_scaled << std::endl;
+
+    // a change of activation invalidates the system
+    element_status[0] = 1;
+    std::cout << "compatible after deactivation: " << System.IsCompatible(NumberOfRows, element_ptr, element_rows, element_status) << std::endl;
+
+    return 0;
+}
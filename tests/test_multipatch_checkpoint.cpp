@@ -0,0 +1,299 @@
+#include "includes/define.h"
+#include "custom_utilities/multipatch.h"
+#include "custom_utilities/multipatch_utility.h"
+#include "custom_utilities/control_grid_library.h"
+#include "custom_utilities/nurbs/bsplines_fespace_library.h"
+#include "custom_utilities/nurbs/bsplines_patch_utility.h"
+#include "custom_utilities/hbsplines/hbsplines_patch_utility.h"
+#include "custom_utilities/hbsplines/hbsplines_refinement_utility.h"
+#include "custom_utilities/tsplines/tcell.h"
+#include "custom_utilities/nurbs/pbbsplines_basis_function.h"
+#include "custom_utilities/tsplines/tsplines_fespace.h"
+#include "custom_utilities/import_export/multipatch_checkpoint.h"
+
+using namespace Kratos;
+
+typedef TSplinesFESpace<2, PBBSplinesBasisFunction<2, TCell>, BCellManager<2, TCell> > TSplinesFESpaceType;
+
+/// Two square B-Splines patches [0, 1] x [0, 1] and [1, 2] x [0, 1], connected at the right side of the first patch
+MultiPatch<2>::Pointer CreateBSplinesMultiPatch()
+{
+    MultiPatch<2>::Pointer pMultiPatch = MultiPatch<2>::Pointer(new MultiPatch<2>());
+
+    std::vector<Patch<2>::Pointer> pPatches(2);
+    for (std::size_t i = 0; i < 2; ++i)
+    {
+        BSplinesFESpace<2>::Pointer pFESpace = BSplinesFESpaceLibrary::CreateUniformFESpace<2>({5, 4}, {2, 2});
+        pPatches[i] = MultiPatchUtility::CreatePatchPointer<2>(i + 1, pFESpace);
+        pPatches[i]->CreateControlPointGridFunction(ControlGridLibrary::CreateStructuredControlPointGrid<2>({1.0*i, 0.0}, {5, 4}, {1.0*i + 1.0, 1.0}));
+        pMultiPatch->AddPatch(pPatches[i]);
+    }
+
+    BSplinesPatchUtility::MakeInterface2D(pPatches[0], _BRIGHT_, pPatches[1], _BLEFT_, _FORWARD_);
+    pMultiPatch->Enumerate();
+
+    return pMultiPatch;
+}
+
+/// The hierarchical B-Splines multipatch of the same geometry. The bf 5 of level 1 and then its first child 21 of
+/// level 2 are refined.
+MultiPatch<2>::Pointer CreateHBSplinesMultiPatch()
+{
+    MultiPatch<2>::Pointer pBMultiPatch = CreateBSplinesMultiPatch();
+    MultiPatch<2>::Pointer pMultiPatch = MultiPatch<2>::Pointer(new MultiPatch<2>());
+
+    Patch<2>::Pointer pPatch1 = HBSplinesPatchUtility::CreatePatchFromBSplines<2>(pBMultiPatch->pGetPatch(1));
+    Patch<2>::Pointer pPatch2 = HBSplinesPatchUtility::CreatePatchFromBSplines<2>(pBMultiPatch->pGetPatch(2));
+    pMultiPatch->AddPatch(pPatch1);
+    pMultiPatch->AddPatch(pPatch2);
+    MultiPatchUtility::MakeInterface<2>(pPatch1, _BRIGHT_, pPatch2, _BLEFT_);
+    pMultiPatch->Enumerate();
+
+    HBSplinesRefinementUtility::Refine<2>(pPatch1, 5, 0);
+    pMultiPatch->Enumerate();
+    HBSplinesRefinementUtility::Refine<2>(pPatch1, 21, 0);
+    pMultiPatch->Enumerate();
+
+    return pMultiPatch;
+}
+
+/// The T-Splines patch [0, 1] x [0, 1] of the tensor product knot vectors {0, 0, 0, 0.5, 1, 1, 1} x {0, 0, 0, 1, 1, 1},
+/// constructed as by the T-Splines importer: the basis functions by their local knot vectors, the cells of their spans and
+/// the faces of the T-mesh
+MultiPatch<2>::Pointer CreateTSplinesMultiPatch()
+{
+    typedef TSplinesFESpaceType::cell_t cell_t;
+
+    const std::vector<std::vector<double> > knots = {{0.0, 0.0, 0.0, 0.5, 1.0, 1.0, 1.0}, {0.0, 0.0, 0.0, 1.0, 1.0, 1.0}};
+    const std::size_t order = 2;
+
+    TSplinesFESpaceType::Pointer pFESpace = TSplinesFESpaceType::Create();
+    pFESpace->SetInfo(0, order);
+    pFESpace->SetInfo(1, order);
+
+    std::size_t id = 0;
+    std::vector<std::vector<double> > knot_vecs(2);
+    for (std::size_t j = 0; j < knots[1].size() - order - 1; ++j)
+    {
+        for (std::size_t i = 0; i < knots[0].size() - order - 1; ++i)
+        {
+            knot_vecs[0].assign(knots[0].begin() + i, knots[0].begin() + i + order + 2);
+            knot_vecs[1].assign(knots[1].begin() + j, knots[1].begin() + j + order + 2);
+            TSplinesFESpaceType::bf_t p_bf = pFESpace->CreateBf(++id, knot_vecs);
+
+            for (std::size_t i1 = 0; i1 < order + 1; ++i1)
+            {
+                for (std::size_t j1 = 0; j1 < order + 1; ++j1)
+                {
+                    if ((knot_vecs[0][i1+1] - knot_vecs[0][i1]) * (knot_vecs[1][j1+1] - knot_vecs[1][j1]) > 1.0e-10)
+                    {
+                        cell_t p_cell = pFESpace->pCellManager()->CreateCell(std::vector<double>{knot_vecs[0][i1], knot_vecs[0][i1+1], knot_vecs[1][j1], knot_vecs[1][j1+1]});
+                        p_bf->AddCell(p_cell);
+                    }
+                }
+            }
+
+            // the control points at the Greville abscissae
+            const double x = (knot_vecs[0][1] + knot_vecs[0][2]) / 2;
+            const double y = (knot_vecs[1][1] + knot_vecs[1][2]) / 2;
+            p_bf->SetValue(CONTROL_POINT, ControlPoint<double>(x, y, 0.0, 1.0));
+        }
+    }
+
+    for (std::size_t i = 0; i < knots[0].size() - 1; ++i)
+        if (knots[0][i+1] > knots[0][i])
+            pFESpace->pFaceManager()->CreateCell(std::vector<double>{knots[0][i], knots[0][i+1], 0.0, 1.0});
+
+    Patch<2>::Pointer pPatch = Patch<2>::Create(1, pFESpace);
+    pPatch->CreateControlPointGridFunction(ControlGridUtility::CreatePointBasedControlGrid<ControlPoint<double>, TSplinesFESpaceType>(CONTROL_POINT, pFESpace));
+
+    MultiPatch<2>::Pointer pMultiPatch = MultiPatch<2>::Pointer(new MultiPatch<2>());
+    pMultiPatch->AddPatch(pPatch);
+    pMultiPatch->Enumerate();
+
+    return pMultiPatch;
+}
+
+double ControlPointDistance(const ControlPoint<double>& rP1, const ControlPoint<double>& rP2)
+{
+    return fabs(rP1.X() - rP2.X()) + fabs(rP1.Y() - rP2.Y()) + fabs(rP1.Z() - rP2.Z()) + fabs(rP1.W() - rP2.W());
+}
+
+/// Count the differences of the knot vectors between two FESpaces
+template<class TFESpaceType>
+std::size_t CompareKnotVectors(const TFESpaceType& rFESpace1, const TFESpaceType& rFESpace2)
+{
+    std::size_t number_of_differences = 0;
+    for (std::size_t dim = 0; dim < 2; ++dim)
+    {
+        if (rFESpace1.Order(dim) != rFESpace2.Order(dim))
+            ++number_of_differences;
+        if (rFESpace1.KnotVector(dim).size() != rFESpace2.KnotVector(dim).size())
+        {
+            ++number_of_differences;
+            continue;
+        }
+        for (std::size_t i = 0; i < rFESpace1.KnotVector(dim).size(); ++i)
+            if (rFESpace1.KnotVector(dim).pKnotAt(i)->Value() != rFESpace2.KnotVector(dim).pKnotAt(i)->Value())
+                ++number_of_differences;
+    }
+    return number_of_differences;
+}
+
+inline std::size_t BfLevel(const HBSplinesFESpace<2>::bf_t& p_bf) {return p_bf->Level();}
+
+inline std::size_t BfLevel(const TSplinesFESpaceType::bf_t& p_bf) {return 1;}
+
+/// Count the differences of the cells and the basis functions between two point-based FESpaces. The basis functions
+/// are matched by their ids.
+template<class TFESpaceType>
+std::size_t ComparePointBasedFESpace(const TFESpaceType& rFESpace1, TFESpaceType& rFESpace2)
+{
+    std::size_t number_of_differences = 0;
+
+    if (rFESpace1.pCellManager()->size() != rFESpace2.pCellManager()->size())
+        ++number_of_differences;
+
+    std::vector<double> knots1, knots2;
+    for (typename TFESpaceType::bf_const_iterator it = rFESpace1.bf_begin(); it != rFESpace1.bf_end(); ++it)
+    {
+        if (!rFESpace2.HasBfById((*it)->Id()))
+        {
+            ++number_of_differences;
+            continue;
+        }
+        typename TFESpaceType::bf_t p_bf = rFESpace2((*it)->Id());
+
+        if ((BfLevel(p_bf) != BfLevel(*it))
+                || (std::distance(p_bf->cell_begin(), p_bf->cell_end()) != std::distance((*it)->cell_begin(), (*it)->cell_end())))
+            ++number_of_differences;
+        if (p_bf->EquationId() != (*it)->EquationId())
+            ++number_of_differences;
+        for (std::size_t dim = 0; dim < 2; ++dim)
+        {
+            (*it)->LocalKnots(dim, knots1);
+            p_bf->LocalKnots(dim, knots2);
+            if (knots1 != knots2)
+                ++number_of_differences;
+        }
+        if (ControlPointDistance((*it)->GetValue(CONTROL_POINT), p_bf->GetValue(CONTROL_POINT)) > 1.0e-13)
+            ++number_of_differences;
+    }
+
+    return number_of_differences;
+}
+
+/// Count the differences between two patches: knots, equation ids and control points. The basis functions of the
+/// hierarchical B-Splines and T-Splines patches are matched by their ids.
+std::size_t ComparePatch(Patch<2>::Pointer pPatch1, Patch<2>::Pointer pPatch2)
+{
+    std::size_t number_of_differences = 0;
+
+    if ((pPatch1->Id() != pPatch2->Id()) || (pPatch1->pFESpace()->Type() != pPatch2->pFESpace()->Type())
+            || (pPatch1->TotalNumber() != pPatch2->TotalNumber()))
+    {
+        std::cout << "patch " << pPatch1->Id() << ": the FESpaces are different" << std::endl;
+        return 1;
+    }
+
+    if (pPatch1->pFESpace()->FunctionIndices() != pPatch2->pFESpace()->FunctionIndices())
+        ++number_of_differences;
+
+    if (pPatch1->pFESpace()->Type() == BSplinesFESpace<2>::StaticType())
+    {
+        BSplinesFESpace<2>::Pointer pFESpace1 = boost::dynamic_pointer_cast<BSplinesFESpace<2> >(pPatch1->pFESpace());
+        BSplinesFESpace<2>::Pointer pFESpace2 = boost::dynamic_pointer_cast<BSplinesFESpace<2> >(pPatch2->pFESpace());
+        number_of_differences += CompareKnotVectors(*pFESpace1, *pFESpace2);
+
+        const ControlGrid<ControlPoint<double> >& rGrid1 = *(pPatch1->ControlPointGridFunction().pControlGrid());
+        const ControlGrid<ControlPoint<double> >& rGrid2 = *(pPatch2->ControlPointGridFunction().pControlGrid());
+        for (std::size_t i = 0; i < rGrid1.size(); ++i)
+            if (ControlPointDistance(rGrid1[i], rGrid2[i]) > 1.0e-13)
+                ++number_of_differences;
+    }
+    else if (pPatch1->pFESpace()->Type() == HBSplinesFESpace<2>::StaticType())
+    {
+        HBSplinesFESpace<2>::Pointer pFESpace1 = boost::dynamic_pointer_cast<HBSplinesFESpace<2> >(pPatch1->pFESpace());
+        HBSplinesFESpace<2>::Pointer pFESpace2 = boost::dynamic_pointer_cast<HBSplinesFESpace<2> >(pPatch2->pFESpace());
+        number_of_differences += CompareKnotVectors(*pFESpace1, *pFESpace2);
+        number_of_differences += ComparePointBasedFESpace(*pFESpace1, *pFESpace2);
+    }
+    else
+    {
+        TSplinesFESpaceType::Pointer pFESpace1 = boost::dynamic_pointer_cast<TSplinesFESpaceType>(pPatch1->pFESpace());
+        TSplinesFESpaceType::Pointer pFESpace2 = boost::dynamic_pointer_cast<TSplinesFESpaceType>(pPatch2->pFESpace());
+        for (std::size_t dim = 0; dim < 2; ++dim)
+            if (pFESpace1->Order(dim) != pFESpace2->Order(dim))
+                ++number_of_differences;
+        if (pFESpace1->pFaceManager()->size() != pFESpace2->pFaceManager()->size())
+            ++number_of_differences;
+        number_of_differences += ComparePointBasedFESpace(*pFESpace1, *pFESpace2);
+    }
+
+    return number_of_differences;
+}
+
+/// Count the differences between two multipatches, including the interfaces
+std::size_t CompareMultiPatch(MultiPatch<2>::Pointer pMultiPatch1, MultiPatch<2>::Pointer pMultiPatch2)
+{
+    std::size_t number_of_differences = 0;
+
+    if ((pMultiPatch1->size() != pMultiPatch2->size()) || (pMultiPatch1->EquationSystemSize() != pMultiPatch2->EquationSystemSize()))
+        ++number_of_differences;
+
+    for (MultiPatch<2>::patch_ptr_iterator it = pMultiPatch1->Patches().ptr_begin(); it != pMultiPatch1->Patches().ptr_end(); ++it)
+    {
+        Patch<2>::Pointer pPatch2 = pMultiPatch2->pGetPatch((*it)->Id());
+        number_of_differences += ComparePatch(*it, pPatch2);
+
+        if ((*it)->NumberOfInterfaces() != pPatch2->NumberOfInterfaces())
+        {
+            ++number_of_differences;
+            continue;
+        }
+        for (std::size_t i = 0; i < (*it)->NumberOfInterfaces(); ++i)
+        {
+            PatchInterface<2>::Pointer pInterface1 = (*it)->pInterface(i);
+            PatchInterface<2>::Pointer pInterface2 = pPatch2->pInterface(i);
+            if ((pInterface1->Side1() != pInterface2->Side1()) || (pInterface1->Side2() != pInterface2->Side2())
+                    || (pInterface1->pPatch2()->Id() != pInterface2->pPatch2()->Id())
+                    || (typeid(*pInterface1) != typeid(*pInterface2)))
+                ++number_of_differences;
+        }
+    }
+
+    return number_of_differences;
+}
+
+/// Write the multipatch, then read it back fully and lazily and compare with the original
+void test(MultiPatch<2>::Pointer pMultiPatch, const std::string& filename)
+{
+    MultiPatchCheckpointWriter().Export<2>(pMultiPatch, filename);
+
+    MultiPatchCheckpointReader<2> reader(filename);
+    std::cout << filename << ": number of patches: " << reader.NumberOfPatches() << std::endl;
+
+    // read all
+    MultiPatch<2>::Pointer pNewMultiPatch = reader.pReadMultiPatch();
+    std::cout << " full read, number of differences: " << CompareMultiPatch(pMultiPatch, pNewMultiPatch) << std::endl;
+
+    // read the last patch; the equation ids are restored as written
+    const std::size_t last_id = pMultiPatch->size();
+    Patch<2>::Pointer pNewPatch = reader.pReadPatch(last_id);
+    std::cout << " lazy read of patch " << last_id << ", number of differences: " << ComparePatch(pMultiPatch->pGetPatch(last_id), pNewPatch)
+              << ", number of interfaces: " << pNewPatch->NumberOfInterfaces() << std::endl;
+
+    // read a subset of patches; the interfaces to the other patches are not restored
+    MultiPatch<2>::Pointer pSubMultiPatch = reader.pReadMultiPatch(std::vector<std::size_t>{1});
+    std::cout << " lazy read of patch 1, number of patches: " << pSubMultiPatch->size()
+              << ", number of differences: " << ComparePatch(pMultiPatch->pGetPatch(1), pSubMultiPatch->pGetPatch(1))
+              << ", number of interfaces: " << pSubMultiPatch->pGetPatch(1)->NumberOfInterfaces() << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    test(CreateBSplinesMultiPatch(), "test_multipatch_checkpoint_bsplines.bin");
+    test(CreateHBSplinesMultiPatch(), "test_multipatch_checkpoint_hbsplines.bin");
+    test(CreateTSplinesMultiPatch(), "test_multipatch_checkpoint_tsplines.bin");
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include "includes/define.h"
+#include "custom_utilities/node_welding_utility.h"
+
+using namespace Kratos;
+
+int main(int argc, char** argv)
+{
+    // the sampling points of a n x n grid of quadrilateral patches with m x m divisions, the points on the patch
+    // boundaries are repeated and perturbed below the tolerance
+    const std::size_t n = 30, m = 4;
+    const double tol = 1.0e-6;
+    std::vector<double> points;
+    for (std::size_t p = 0; p < n; ++p)
+    {
+        for (std::size_t q = 0; q < n; ++q)
+        {
+            for (std::size_t i = 0; i <= m; ++i)
+            {
+                for (std::size_t j = 0; j <= m; ++j)
+                {
+                    const double perturbation = 1.0e-3 * tol * ((p * 7 + q * 3 + i + j) % 5);
+                    points.push_back(double(p * m + i) / m + perturbation);
+                    points.push_back(double(q * m + j) / m - perturbation);
+                    points.push_back(0.0);
+                }
+            }
+        }
+    }
+
+    std::vector<std::size_t> welded;
+    std::size_t number_of_nodes = NodeWeldingUtility::Weld(points, tol, 0.5 / m, welded);
+    std::cout << "number of points: " << welded.size() << std::endl;
+    std::cout << "number of welded nodes: " << number_of_nodes << ", expected: " << (n * m + 1) * (n * m + 1) << std::endl;
+
+    // compare with the serial search of the first point within the tolerance
+    std::size_t number_of_errors = 0;
+    std::vector<std::size_t> serial_welded(welded.size());
+    std::size_t serial_number_of_nodes = 0;
+    for (std::size_t i = 0; i < welded.size(); ++i)
+    {
+        std::size_t first = i;
+        for (std::size_t j = 0; j < i; ++j)
+        {
+            double dist2 = 0.0;
+            for (int d = 0; d < 3; ++d)
+                dist2 += pow(points[3*i + d] - points[3*j + d], 2);
+            if (dist2 <= tol * tol)
+            {
+                first = j;
+                break;
+            }
+        }
+        serial_welded[i] = (first == i) ? serial_number_of_nodes++ : serial_welded[first];
+        if (serial_welded[i] != welded[i])
+            ++number_of_errors;
+    }
+    std::cout << "number of differences with the serial welding: " << number_of_errors << std::endl;
+
+    // a too small characteristic length shall not break the welding
+    number_of_nodes = NodeWeldingUtility::Weld(points, tol, 0.0, welded);
+    std::cout << "number of welded nodes with the cell size of the tolerance: " << number_of_nodes << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,202 @@
+#include "includes/define.h"
+#include "custom_utilities/multipatch.h"
+#include "custom_utilities/multipatch_utility.h"
+#include "custom_utilities/control_grid_library.h"
+#include "custom_utilities/nurbs/bsplines_fespace_library.h"
+#include "custom_utilities/nurbs/bsplines_patch_utility.h"
+#include "custom_utilities/nonconforming_multipatch_lagrange_mesh.h"
+
+using namespace Kratos;
+
+typedef NonConformingMultipatchLagrangeMesh<2>::SamplingParametersType SamplingParametersType;
+
+/// Bend the straight control grid: the control points are moved by a smooth function of their position, hence the
+/// control points shared by two patches stay matched
+void BendControlGrid(ControlGrid<ControlPoint<double> >& rGrid)
+{
+    for (std::size_t i = 0; i < rGrid.size(); ++i)
+    {
+        const double x = rGrid[i].X(), y = rGrid[i].Y();
+        rGrid.SetData(i, ControlPoint<double>(x + 0.15 * y * y, y + 0.2 * x * x, 0.0, 1.0));
+    }
+}
+
+/// Two curved B-Splines patches over [0, 1] x [0, 1] and [1, 2] x [0, 1], with different knot spans. The second patch is
+/// parameterized from the top, hence the interface at the right side of the first patch is reversed.
+MultiPatch<2>::Pointer CreateCurvedMultiPatch()
+{
+    MultiPatch<2>::Pointer pMultiPatch = MultiPatch<2>::Pointer(new MultiPatch<2>());
+
+    BSplinesFESpace<2>::Pointer pFESpace1 = BSplinesFESpaceLibrary::CreateUniformFESpace<2>({5, 4}, {2, 2});
+    Patch<2>::Pointer pPatch1 = MultiPatchUtility::CreatePatchPointer<2>(1, pFESpace1);
+    ControlGrid<ControlPoint<double> >::Pointer pGrid1 = ControlGridLibrary::CreateStructuredControlPointGrid<2>({0.0, 0.0}, {5, 4}, {1.0, 1.0});
+    BendControlGrid(*pGrid1);
+    pPatch1->CreateControlPointGridFunction(pGrid1);
+    pMultiPatch->AddPatch(pPatch1);
+
+    BSplinesFESpace<2>::Pointer pFESpace2 = BSplinesFESpaceLibrary::CreateUniformFESpace<2>({7, 4}, {3, 2});
+    Patch<2>::Pointer pPatch2 = MultiPatchUtility::CreatePatchPointer<2>(2, pFESpace2);
+    ControlGrid<ControlPoint<double> >::Pointer pGrid2 = ControlGridLibrary::CreateStructuredControlPointGrid<2>({1.0, 1.0}, {7, 4}, {2.0, 0.0});
+    BendControlGrid(*pGrid2);
+    pPatch2->CreateControlPointGridFunction(pGrid2);
+    pMultiPatch->AddPatch(pPatch2);
+
+    BSplinesPatchUtility::MakeInterface2D(pPatch1, _BRIGHT_, pPatch2, _BLEFT_, _REVERSED_);
+    pMultiPatch->Enumerate();
+
+    return pMultiPatch;
+}
+
+/// Distinct knots of the patch in [0, 1] and the centers of the knot spans, i.e. the probing lines of the adaptive sampling
+std::vector<double> ProbingLines(Patch<2>::Pointer pPatch, const std::size_t& dim)
+{
+    BSplinesFESpace<2>::Pointer pFESpace = boost::dynamic_pointer_cast<BSplinesFESpace<2> >(pPatch->pFESpace());
+    std::vector<double> knots;
+    for (std::size_t i = 0; i < pFESpace->KnotVector(dim).size(); ++i)
+        knots.push_back(pFESpace->KnotVector(dim).pKnotAt(i)->Value());
+    std::sort(knots.begin(), knots.end());
+    knots.erase(std::unique(knots.begin(), knots.end()), knots.end());
+
+    std::vector<double> lines = knots;
+    for (std::size_t i = 0; i < knots.size() - 1; ++i)
+        lines.push_back(0.5 * (knots[i] + knots[i+1]));
+    return lines;
+}
+
+/// The maximum ratio of the deviation of the geometry from its linear interpolation on the sampling intervals to the tolerance
+double MaxDeviationRatio(Patch<2>::Pointer pPatch, const SamplingParametersType& rSamples, const double& tol, std::size_t& number_of_intervals_above)
+{
+    double max_ratio = 0.0;
+    number_of_intervals_above = 0;
+    std::vector<double> xi(2);
+    ControlPoint<double> p[5];
+    for (std::size_t dim = 0; dim < 2; ++dim)
+    {
+        const std::size_t other_dim = 1 - dim;
+        const std::vector<double> lines = ProbingLines(pPatch, other_dim);
+        for (std::size_t i = 0; i < rSamples[dim].size() - 1; ++i)
+        {
+            const double a = rSamples[dim][i], b = rSamples[dim][i+1];
+            double ratio = 0.0;
+            for (std::size_t l = 0; l < lines.size(); ++l)
+            {
+                for (int t = 0; t < 5; ++t)
+                {
+                    xi[dim] = a + 0.25 * t * (b - a);
+                    xi[other_dim] = lines[l];
+                    p[t] = pPatch->pControlPointGridFunction()->GetValue(xi);
+                }
+                for (int t = 1; t < 4; ++t)
+                {
+                    const double s = 0.25 * t;
+                    const double dev = sqrt(pow(p[t].X() - ((1.0 - s) * p[0].X() + s * p[4].X()), 2)
+                                          + pow(p[t].Y() - ((1.0 - s) * p[0].Y() + s * p[4].Y()), 2));
+                    ratio = std::max(ratio, dev / tol);
+                }
+            }
+            if (ratio > 1.0)
+                ++number_of_intervals_above;
+            max_ratio = std::max(max_ratio, ratio);
+        }
+    }
+    return max_ratio;
+}
+
+/// Count the sampling parameters which do not match on both sides of the interfaces
+std::size_t CountInterfaceMismatches(MultiPatch<2>::Pointer pMultiPatch, std::map<std::size_t, SamplingParametersType>& rSamplingParameters)
+{
+    std::size_t number_of_mismatches = 0;
+    for (MultiPatch<2>::patch_iterator it = pMultiPatch->begin(); it != pMultiPatch->end(); ++it)
+    {
+        for (Patch<2>::interface_iterator it_interface = it->InterfaceBegin(); it_interface != it->InterfaceEnd(); ++it_interface)
+        {
+            const BSplinesPatchInterface<2>& rInterface = dynamic_cast<const BSplinesPatchInterface<2>&>(**it_interface);
+            const std::vector<int> dirs1 = ParameterDirection<2>::Get(rInterface.Side1());
+            const std::vector<int> dirs2 = ParameterDirection<2>::Get(rInterface.Side2());
+            const bool reversed = (rInterface.Direction(0) == _REVERSED_);
+
+            const std::vector<double>& rSamples1 = rSamplingParameters[rInterface.pPatch1()->Id()][dirs1[0]];
+            std::vector<double> samples2 = rSamplingParameters[rInterface.pPatch2()->Id()][dirs2[rInterface.LocalParameterMapping(0)]];
+            if (reversed)
+            {
+                for (std::size_t i = 0; i < samples2.size(); ++i)
+                    samples2[i] = 1.0 - samples2[i];
+                std::sort(samples2.begin(), samples2.end());
+            }
+
+            if (rSamples1.size() != samples2.size())
+            {
+                number_of_mismatches += std::max(rSamples1.size(), samples2.size()) - std::min(rSamples1.size(), samples2.size());
+                continue;
+            }
+            for (std::size_t i = 0; i < rSamples1.size(); ++i)
+                if (fabs(rSamples1[i] - samples2[i]) > 1.0e-10)
+                    ++number_of_mismatches;
+        }
+    }
+    return number_of_mismatches;
+}
+
+/// Adaptive sampling: the bisection shall stop below the tolerance and the sampling parameters shall match at the interface
+void test_adaptive(const double& tol, const std::size_t& max_level)
+{
+    MultiPatch<2>::Pointer pMultiPatch = CreateCurvedMultiPatch();
+    NonConformingMultipatchLagrangeMesh<2> mesh(pMultiPatch);
+    mesh.SetAdaptiveDivision(tol, max_level);
+
+    std::map<std::size_t, SamplingParametersType> SamplingParameters;
+    mesh.ComputeSamplingParameters(SamplingParameters);
+
+    std::cout << "adaptive, tol = " << tol << ", max level = " << max_level << ":" << std::endl;
+    for (MultiPatch<2>::patch_ptr_iterator it = pMultiPatch->Patches().ptr_begin(); it != pMultiPatch->Patches().ptr_end(); ++it)
+    {
+        std::size_t number_of_intervals_above;
+        const double max_ratio = MaxDeviationRatio(*it, SamplingParameters[(*it)->Id()], tol, number_of_intervals_above);
+        std::cout << " patch " << (*it)->Id() << ": number of samples: " << SamplingParameters[(*it)->Id()][0].size()
+                  << " x " << SamplingParameters[(*it)->Id()][1].size()
+                  << ", max deviation / tol: " << max_ratio
+                  << ", number of intervals above tol: " << number_of_intervals_above << std::endl;
+    }
+    std::cout << " number of mismatched sampling parameters at the interfaces: " << CountInterfaceMismatches(pMultiPatch, SamplingParameters) << std::endl;
+}
+
+/// Uniform sampling: the sampling parameters shall be the equidistant points of the division, as before the adaptive mode
+void test_uniform(const std::size_t& num_division)
+{
+    MultiPatch<2>::Pointer pMultiPatch = CreateCurvedMultiPatch();
+    NonConformingMultipatchLagrangeMesh<2> mesh(pMultiPatch);
+    mesh.SetUniformDivision(num_division);
+    mesh.SetDivision(2, 0, 2 * num_division);
+
+    std::map<std::size_t, SamplingParametersType> SamplingParameters;
+    mesh.ComputeSamplingParameters(SamplingParameters);
+
+    double max_difference = 0.0;
+    std::size_t number_of_size_differences = 0;
+    for (MultiPatch<2>::patch_ptr_iterator it = pMultiPatch->Patches().ptr_begin(); it != pMultiPatch->Patches().ptr_end(); ++it)
+    {
+        for (std::size_t dim = 0; dim < 2; ++dim)
+        {
+            const std::size_t n = ((*it)->Id() == 2 && dim == 0) ? 2 * num_division : num_division;
+            const std::vector<double>& rSamples = SamplingParameters[(*it)->Id()][dim];
+            if (rSamples.size() != n + 1)
+            {
+                ++number_of_size_differences;
+                continue;
+            }
+            for (std::size_t i = 0; i <= n; ++i)
+                max_difference = std::max(max_difference, fabs(rSamples[i] - ((double) i) / n));
+        }
+    }
+
+    std::cout << "uniform, division = " << num_division << ": number of size differences: " << number_of_size_differences
+              << ", max difference to the equidistant points: " << max_difference << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    test_adaptive(1.0e-2, 10);
+    test_adaptive(1.0e-4, 10);
+    test_uniform(5);
+    return 0;
+}